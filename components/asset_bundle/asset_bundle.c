@@ -0,0 +1,169 @@
+#include "asset_bundle.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+
+#define TAG "ASSET_BUNDLE"
+
+// Data offsets are aligned so sprites and PCM can feed vector code directly
+#define ASSET_BUNDLE_ALIGN 16
+
+_Static_assert(sizeof(asset_bundle_header_t) == 16, "header layout is shared with tools/asset_pack.py");
+_Static_assert(sizeof(asset_bundle_entry_t) == 48, "entry layout is shared with tools/asset_pack.py");
+
+static const uint8_t* s_image;
+static const asset_bundle_entry_t* s_index;
+static uint32_t s_count;
+static esp_partition_mmap_handle_t s_mmap_handle;
+static bool s_mapped;
+
+uint32_t asset_bundle_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static esp_err_t check_header(const asset_bundle_header_t* header, size_t available) {
+    if (header->magic != ASSET_BUNDLE_MAGIC || header->version != ASSET_BUNDLE_VERSION) {
+        ESP_LOGE(TAG, "No bundle (magic 0x%08lx, version %u)", (unsigned long)header->magic, header->version);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    size_t index_end = sizeof(asset_bundle_header_t) + (size_t)header->count * sizeof(asset_bundle_entry_t);
+    if (header->size > available || index_end > header->size) {
+        ESP_LOGE(TAG, "Bundle of %lu bytes with %u entries does not fit in %u bytes",
+                 (unsigned long)header->size, header->count, (unsigned)available);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+// One pass over the index so lookups can trust it: CRC, bounds, NUL
+// terminated names, and hash order for the binary search
+static esp_err_t check_index(const uint8_t* image) {
+    const asset_bundle_header_t* header = (const asset_bundle_header_t*)image;
+    const asset_bundle_entry_t* index = (const asset_bundle_entry_t*)(image + sizeof(asset_bundle_header_t));
+
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)index, header->count * sizeof(asset_bundle_entry_t));
+    if (crc != header->index_crc) {
+        ESP_LOGE(TAG, "Index CRC 0x%08lx, expected 0x%08lx", (unsigned long)crc, (unsigned long)header->index_crc);
+        return ESP_ERR_INVALID_CRC;
+    }
+    for (uint32_t i = 0; i < header->count; i++) {
+        const asset_bundle_entry_t* e = &index[i];
+        if (e->offset % ASSET_BUNDLE_ALIGN != 0 || e->offset > header->size || e->size > header->size - e->offset ||
+            memchr(e->name, '\0', sizeof(e->name)) == NULL || (i > 0 && e->hash < index[i - 1].hash)) {
+            ESP_LOGE(TAG, "Bad index entry %lu", (unsigned long)i);
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t asset_bundle_init_image(const void* image, size_t size) {
+    if (!image || size < sizeof(asset_bundle_header_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    asset_bundle_deinit();
+    esp_err_t ret = check_header(image, size);
+    if (ret == ESP_OK) {
+        ret = check_index(image);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    s_image = image;
+    s_index = (const asset_bundle_entry_t*)(s_image + sizeof(asset_bundle_header_t));
+    s_count = ((const asset_bundle_header_t*)image)->count;
+    return ESP_OK;
+}
+
+esp_err_t asset_bundle_init(const char* partition_label) {
+    int64_t start_us = esp_timer_get_time();
+    // Matching the subtype too keeps a mislabelled data partition from being mapped
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)ASSET_BUNDLE_PARTITION_SUBTYPE, partition_label);
+    if (!partition) {
+        ESP_LOGW(TAG, "No '%s' partition of subtype 0x%02x", partition_label, ASSET_BUNDLE_PARTITION_SUBTYPE);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Read the header first so only the bundle, not the whole partition,
+    // is mapped
+    asset_bundle_header_t header;
+    esp_err_t ret = esp_partition_read(partition, 0, &header, sizeof(header));
+    if (ret == ESP_OK) {
+        ret = check_header(&header, partition->size);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    const void* mapped = NULL;
+    esp_partition_mmap_handle_t handle;
+    ret = esp_partition_mmap(partition, 0, header.size, ESP_PARTITION_MMAP_DATA, &mapped, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map %lu bytes: %s", (unsigned long)header.size, esp_err_to_name(ret));
+        return ret;
+    }
+    ret = asset_bundle_init_image(mapped, header.size);
+    if (ret != ESP_OK) {
+        esp_partition_munmap(handle);
+        return ret;
+    }
+    s_mmap_handle = handle;
+    s_mapped = true;
+
+    ESP_LOGI(TAG, "Mapped %lu assets (%lu bytes) from '%s' in %lld us", (unsigned long)s_count,
+             (unsigned long)header.size, partition_label, (long long)(esp_timer_get_time() - start_us));
+    return ESP_OK;
+}
+
+void asset_bundle_deinit(void) {
+    if (s_mapped) {
+        esp_partition_munmap(s_mmap_handle);
+        s_mapped = false;
+    }
+    s_image = NULL;
+    s_index = NULL;
+    s_count = 0;
+}
+
+esp_err_t asset_bundle_find(const char* name, asset_t* out) {
+    if (!s_image) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint32_t hash = asset_bundle_hash(name);
+
+    // Lower bound on the hash, then walk the (rarely more than one) entries
+    // that share it
+    uint32_t lo = 0;
+    uint32_t hi = s_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (s_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (; lo < s_count && s_index[lo].hash == hash; lo++) {
+        const asset_bundle_entry_t* e = &s_index[lo];
+        if (strcmp(e->name, name) == 0) {
+            out->data = s_image + e->offset;
+            out->size = e->size;
+            out->type = (asset_type_t)e->type;
+            out->param = e->param;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+uint32_t asset_bundle_count(void) {
+    return s_count;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Read-only asset bundle mapped straight from flash
+ *
+ * A bundle is one image, written by tools/asset_pack.py into its own data
+ * partition, laid out as (all fields little endian):
+ *
+ *     asset_bundle_header_t
+ *     asset_bundle_entry_t x count, sorted by name hash
+ *     asset data, each asset 16-byte aligned
+ *
+ * asset_bundle_init maps the image with esp_partition_mmap and checks the
+ * index once; lookups then binary-search the index in place. Assets are
+ * handed out as pointers into the mapping, so nothing is copied to RAM and
+ * the data stays valid until asset_bundle_deinit.
+ */
+
+#define ASSET_BUNDLE_MAGIC              0x4241434E  // "NCAB"
+#define ASSET_BUNDLE_VERSION            1
+/** Partition subtype of the bundle partition (custom data subtype) */
+#define ASSET_BUNDLE_PARTITION_SUBTYPE  0x40
+/** Longest asset name, including the terminating NUL */
+#define ASSET_BUNDLE_NAME_MAX           28
+
+typedef enum {
+    ASSET_TYPE_RAW = 0,
+    ASSET_TYPE_PCM16 = 1,       ///< Mono 16-bit PCM; param is the sample rate
+    ASSET_TYPE_SPRITE = 2,      ///< RGB565 pixels, rows top to bottom; param is width << 16 | height
+    ASSET_TYPE_LED_ANIM = 3,    ///< RGB888 frames of every LED; param is LED count << 16 | frame ms
+} asset_type_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;             ///< Index entries
+    uint32_t size;              ///< Whole image in bytes
+    uint32_t index_crc;         ///< CRC-32 of the index entries
+} asset_bundle_header_t;
+
+typedef struct {
+    uint32_t hash;              ///< asset_bundle_hash of the name
+    uint32_t offset;            ///< From the start of the image
+    uint32_t size;
+    uint32_t param;             ///< Meaning depends on type
+    uint16_t type;              ///< asset_type_t
+    uint16_t reserved;
+    char name[ASSET_BUNDLE_NAME_MAX];
+} asset_bundle_entry_t;
+
+/**
+ * @brief An asset as found in the bundle
+ */
+typedef struct {
+    const void* data;           ///< Points into the flash mapping
+    size_t size;
+    asset_type_t type;
+    uint32_t param;
+} asset_t;
+
+#define ASSET_PCM_RATE(a)       ((a)->param)
+#define ASSET_SPRITE_WIDTH(a)   ((a)->param >> 16)
+#define ASSET_SPRITE_HEIGHT(a)  ((a)->param & 0xFFFF)
+#define ASSET_LED_COUNT(a)      ((a)->param >> 16)
+#define ASSET_LED_FRAME_MS(a)   ((a)->param & 0xFFFF)
+
+/**
+ * @brief Map the bundle partition and check its index
+ *
+ * @param partition_label Label of the bundle partition, a data partition of
+ *                        subtype ASSET_BUNDLE_PARTITION_SUBTYPE
+ * @return ESP_OK, ESP_ERR_NOT_FOUND without the partition,
+ *         ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_CRC for a bad image,
+ *         or the esp_partition_mmap error
+ */
+esp_err_t asset_bundle_init(const char* partition_label);
+
+/**
+ * @brief Use a bundle image already in memory instead of a partition
+ *
+ * The image must stay valid until asset_bundle_deinit.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_CRC
+ */
+esp_err_t asset_bundle_init_image(const void* image, size_t size);
+
+/**
+ * @brief Drop the bundle and unmap it; earlier asset pointers become invalid
+ */
+void asset_bundle_deinit(void);
+
+/**
+ * @brief Look up an asset by name
+ *
+ * @param name Asset name as given to the pack tool
+ * @param out Receives the asset
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, or ESP_ERR_INVALID_STATE without a bundle
+ */
+esp_err_t asset_bundle_find(const char* name, asset_t* out);
+
+/**
+ * @brief Number of assets in the bundle, 0 without one
+ */
+uint32_t asset_bundle_count(void);
+
+/**
+ * @brief 32-bit FNV-1a hash of a name, as stored in the index
+ */
+uint32_t asset_bundle_hash(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,356 @@
+#include "audio_aec.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "audio_dsp.h"
+#include "audio_dsp_fft.h"
+
+#define TAG "AUDIO_AEC"
+
+// NLMS step size and the floor it may be throttled to during double talk
+#define AEC_MU              0.5f
+#define AEC_MU_FLOOR        0.1f
+// Smoothing for per-bin reference power and block energies
+#define AEC_POWER_ALPHA     0.1f
+#define AEC_ENERGY_ALPHA    0.3f
+// Reference blocks quieter than this RMS (in LSBs) do not drive adaptation
+#define AEC_FAR_ACTIVE_RMS  64.0f
+// Regularization added to each bin's power, as an RMS in LSBs
+#define AEC_DELTA_RMS       16.0f
+// Cap on the ERLE estimate used to predict the residual echo
+#define AEC_ERLE_MAX_DB     40.0f
+// Output louder than the input for this many active blocks means divergence
+#define AEC_DIVERGE_BLOCKS  8
+
+struct audio_aec {
+    audio_aec_config_t config;
+    uint32_t n;                 // block size
+    uint32_t partitions;
+
+    // Reference FIFO: written by playback, read by capture
+    int16_t* fifo;
+    uint32_t fifo_mask;
+    uint32_t fifo_max_lead;
+    atomic_uint fifo_head;
+    atomic_uint fifo_tail;
+    atomic_uint ref_dropped;
+
+    // Bulk delay line applied after the FIFO
+    int16_t* delay;
+    uint32_t delay_len;
+    uint32_t delay_pos;
+
+    audio_dsp_rfft_f32_t fft;   // 2n-point real FFT
+    float* xbuf;                // last two reference blocks, time domain
+    float* X;                   // partitions x 2n packed reference spectra
+    float* W;                   // partitions x 2n packed filter spectra
+    float* power;               // n+1 smoothed reference power per bin
+    float* work;                // 2n scratch
+    float* err;                 // 2n scratch
+    uint32_t x_head;            // partition slot holding the newest spectrum
+    uint32_t constrain_next;    // partition to constrain on the next block
+
+    float delta;
+    float far_active_energy;
+    float ed_smooth;            // mic energy
+    float ee_smooth;            // residual energy
+    float ey_smooth;            // echo estimate energy
+    uint32_t diverge_count;
+
+    float erle_db;
+    uint32_t blocks;
+    uint32_t ref_realigned;
+    uint32_t resets;
+    uint64_t cycles_total;
+};
+
+esp_err_t audio_aec_create(const audio_aec_config_t* config, audio_aec_t** out_aec) {
+    if (!config || !out_aec || config->sample_rate == 0 || config->block_size < 16 ||
+        (config->block_size & (config->block_size - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_aec_t* aec = calloc(1, sizeof(audio_aec_t));
+    if (!aec) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const uint32_t n = config->block_size;
+    aec->config = *config;
+    aec->n = n;
+
+    uint32_t tail_samples = config->sample_rate * config->tail_ms / 1000;
+    aec->partitions = (tail_samples + n - 1) / n;
+    if (aec->partitions == 0) {
+        aec->partitions = 1;
+    }
+
+    uint32_t fifo_len = 1;
+    while (fifo_len < config->sample_rate * config->ref_fifo_ms / 1000 || fifo_len < 2 * n) {
+        fifo_len <<= 1;
+    }
+    aec->fifo_mask = fifo_len - 1;
+    aec->fifo_max_lead = fifo_len - fifo_len / 4;
+    aec->delay_len = config->sample_rate * config->bulk_delay_ms / 1000;
+
+    aec->fifo = calloc(fifo_len, sizeof(int16_t));
+    aec->delay = aec->delay_len ? calloc(aec->delay_len, sizeof(int16_t)) : NULL;
+    aec->xbuf = calloc(2 * n, sizeof(float));
+    aec->X = calloc(aec->partitions * 2 * n, sizeof(float));
+    aec->W = calloc(aec->partitions * 2 * n, sizeof(float));
+    aec->power = calloc(n + 1, sizeof(float));
+    aec->work = calloc(2 * n, sizeof(float));
+    aec->err = calloc(2 * n, sizeof(float));
+
+    if (!aec->fifo || (aec->delay_len && !aec->delay) || !aec->xbuf || !aec->X || !aec->W ||
+        !aec->power || !aec->work || !aec->err || audio_dsp_rfft_f32_init(&aec->fft, 2 * n) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate echo canceller (%lu partitions)", (unsigned long)aec->partitions);
+        audio_aec_destroy(aec);
+        return ESP_ERR_NO_MEM;
+    }
+
+    atomic_init(&aec->fifo_head, 0);
+    atomic_init(&aec->fifo_tail, 0);
+    atomic_init(&aec->ref_dropped, 0);
+
+    // Energies are sums over a block, bin powers are |X|^2 of a 2n-point FFT
+    aec->delta = AEC_DELTA_RMS * AEC_DELTA_RMS * 2.0f * n * 2.0f * n;
+    aec->far_active_energy = AEC_FAR_ACTIVE_RMS * AEC_FAR_ACTIVE_RMS * n;
+
+    ESP_LOGI(TAG, "Echo canceller: %lu-sample blocks, %lu partitions (%u ms tail), %u ms bulk delay",
+             (unsigned long)n, (unsigned long)aec->partitions, config->tail_ms, config->bulk_delay_ms);
+
+    *out_aec = aec;
+    return ESP_OK;
+}
+
+void audio_aec_destroy(audio_aec_t* aec) {
+    if (!aec) {
+        return;
+    }
+    audio_dsp_rfft_f32_deinit(&aec->fft);
+    free(aec->fifo);
+    free(aec->delay);
+    free(aec->xbuf);
+    free(aec->X);
+    free(aec->W);
+    free(aec->power);
+    free(aec->work);
+    free(aec->err);
+    free(aec);
+}
+
+void audio_aec_push_reference(audio_aec_t* aec, const int16_t* samples, size_t count) {
+    unsigned head = atomic_load_explicit(&aec->fifo_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&aec->fifo_tail, memory_order_acquire);
+    size_t space = (aec->fifo_mask + 1) - (head - tail);
+
+    if (count > space) {
+        atomic_fetch_add_explicit(&aec->ref_dropped, count - space, memory_order_relaxed);
+        count = space;
+    }
+    for (size_t i = 0; i < count; i++) {
+        aec->fifo[(head + i) & aec->fifo_mask] = samples[i];
+    }
+    atomic_store_explicit(&aec->fifo_head, head + count, memory_order_release);
+}
+
+// Pull one block of reference in step with capture. Silence is substituted
+// when nothing is playing, matching what the speaker actually emits.
+static void pull_reference(audio_aec_t* aec, int16_t* out) {
+    unsigned tail = atomic_load_explicit(&aec->fifo_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&aec->fifo_head, memory_order_acquire);
+    unsigned avail = head - tail;
+
+    // More queued than playback can hold means capture was not running while
+    // audio played; that reference is stale, skip to the live part
+    if (avail > aec->fifo_max_lead) {
+        tail += avail - aec->fifo_max_lead;
+        avail = aec->fifo_max_lead;
+        aec->ref_realigned++;
+    }
+
+    uint32_t take = avail < aec->n ? avail : aec->n;
+    for (uint32_t i = 0; i < take; i++) {
+        out[i] = aec->fifo[(tail + i) & aec->fifo_mask];
+    }
+    memset(out + take, 0, (aec->n - take) * sizeof(int16_t));
+    atomic_store_explicit(&aec->fifo_tail, tail + take, memory_order_release);
+
+    for (uint32_t i = 0; aec->delay_len && i < aec->n; i++) {
+        int16_t delayed = aec->delay[aec->delay_pos];
+        aec->delay[aec->delay_pos] = out[i];
+        out[i] = delayed;
+        if (++aec->delay_pos == aec->delay_len) {
+            aec->delay_pos = 0;
+        }
+    }
+}
+
+// Packed-spectrum helpers: bins 0 (DC) and 1 (Nyquist) are real
+static void spectrum_mac(float* acc, const float* x, const float* w, uint32_t len) {
+    acc[0] += x[0] * w[0];
+    acc[1] += x[1] * w[1];
+    for (uint32_t i = 2; i < len; i += 2) {
+        acc[i] += x[i] * w[i] - x[i + 1] * w[i + 1];
+        acc[i + 1] += x[i] * w[i + 1] + x[i + 1] * w[i];
+    }
+}
+
+// w += conj(x) * e * norm[bin]
+static void spectrum_update(float* w, const float* x, const float* e, const float* norm, uint32_t len) {
+    w[0] += x[0] * e[0] * norm[0];
+    w[1] += x[1] * e[1] * norm[len / 2];
+    for (uint32_t i = 2; i < len; i += 2) {
+        float g = norm[i / 2];
+        w[i] += (x[i] * e[i] + x[i + 1] * e[i + 1]) * g;
+        w[i + 1] += (x[i] * e[i + 1] - x[i + 1] * e[i]) * g;
+    }
+}
+
+static void process_block(audio_aec_t* aec, int16_t* mic) {
+    const uint32_t n = aec->n;
+    const uint32_t len = 2 * n;
+    int16_t ref[n];
+
+    // Newest reference spectrum from the last two blocks (overlap-save)
+    pull_reference(aec, ref);
+    memmove(aec->xbuf, aec->xbuf + n, n * sizeof(float));
+    float ex = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        aec->xbuf[n + i] = ref[i];
+        ex += (float)ref[i] * ref[i];
+    }
+    aec->x_head = (aec->x_head + aec->partitions - 1) % aec->partitions;
+    float* x0 = aec->X + aec->x_head * len;
+    memcpy(x0, aec->xbuf, len * sizeof(float));
+    audio_dsp_rfft_f32_forward(&aec->fft, x0);
+
+    // Echo estimate: sum over partitions of X[p] * W[p], last n samples valid
+    memset(aec->work, 0, len * sizeof(float));
+    for (uint32_t p = 0; p < aec->partitions; p++) {
+        const float* xp = aec->X + ((aec->x_head + p) % aec->partitions) * len;
+        spectrum_mac(aec->work, xp, aec->W + p * len, len);
+    }
+    audio_dsp_rfft_f32_inverse(&aec->fft, aec->work);
+
+    float ed = 0.0f, ee = 0.0f, ey = 0.0f;
+    memset(aec->err, 0, n * sizeof(float));
+    for (uint32_t i = 0; i < n; i++) {
+        float d = mic[i];
+        float y = aec->work[n + i];
+        float e = d - y;
+        ed += d * d;
+        ey += y * y;
+        ee += e * e;
+        aec->err[n + i] = e;
+        mic[i] = audio_dsp_sat16(lrintf(e));
+    }
+
+    // Per-bin reference power for normalization
+    aec->power[0] += AEC_POWER_ALPHA * (x0[0] * x0[0] - aec->power[0]);
+    aec->power[n] += AEC_POWER_ALPHA * (x0[1] * x0[1] - aec->power[n]);
+    for (uint32_t k = 1; k < n; k++) {
+        float p = x0[2 * k] * x0[2 * k] + x0[2 * k + 1] * x0[2 * k + 1];
+        aec->power[k] += AEC_POWER_ALPHA * (p - aec->power[k]);
+    }
+
+    aec->ed_smooth += AEC_ENERGY_ALPHA * (ed - aec->ed_smooth);
+    aec->ee_smooth += AEC_ENERGY_ALPHA * (ee - aec->ee_smooth);
+    aec->ey_smooth += AEC_ENERGY_ALPHA * (ey - aec->ey_smooth);
+
+    if (ex < aec->far_active_energy) {
+        return;     // nothing to learn from
+    }
+
+    // Once converged the residual should sit about ERLE below the echo
+    // estimate. Much more than that is near-end speech (or a path change):
+    // slow adaptation down instead of letting it wreck the filter, and keep
+    // the ERLE estimate from learning the speech as residual echo. It still
+    // drifts slowly so a genuine path change eventually reopens adaptation.
+    float expected = 4.0f * aec->ey_smooth * powf(10.0f, -aec->erle_db / 10.0f) + aec->far_active_energy;
+    float ratio = expected / (aec->ee_smooth + 1.0f);
+    float mu = AEC_MU * (ratio > 1.0f ? 1.0f : (ratio < AEC_MU_FLOOR ? AEC_MU_FLOOR : ratio));
+
+    if (aec->ed_smooth > 0.0f && aec->ee_smooth > 0.0f) {
+        float erle = 10.0f * log10f(aec->ed_smooth / aec->ee_smooth);
+        aec->erle_db += (ratio > AEC_MU_FLOOR ? 0.05f : 0.005f) * (erle - aec->erle_db);
+        if (aec->erle_db > AEC_ERLE_MAX_DB) {
+            aec->erle_db = AEC_ERLE_MAX_DB;
+        }
+    }
+
+    // Divergence guard
+    if (aec->ee_smooth > 2.0f * aec->ed_smooth) {
+        if (++aec->diverge_count >= AEC_DIVERGE_BLOCKS) {
+            ESP_LOGW(TAG, "Echo canceller diverged, resetting filter");
+            memset(aec->W, 0, aec->partitions * len * sizeof(float));
+            aec->diverge_count = 0;
+            aec->resets++;
+            return;
+        }
+    } else {
+        aec->diverge_count = 0;
+    }
+
+    // Error spectrum of [0, e] and the per-bin normalized step
+    audio_dsp_rfft_f32_forward(&aec->fft, aec->err);
+    float* norm = aec->work;
+    for (uint32_t k = 0; k <= n; k++) {
+        norm[k] = mu / (aec->partitions * aec->power[k] + aec->delta);
+    }
+    for (uint32_t p = 0; p < aec->partitions; p++) {
+        const float* xp = aec->X + ((aec->x_head + p) % aec->partitions) * len;
+        spectrum_update(aec->W + p * len, xp, aec->err, norm, len);
+    }
+
+    // Gradient constraint on one partition per block: keep the filter's
+    // impulse response to n taps so circular convolution stays linear
+    float* wc = aec->W + aec->constrain_next * len;
+    audio_dsp_rfft_f32_inverse(&aec->fft, wc);
+    memset(wc + n, 0, n * sizeof(float));
+    audio_dsp_rfft_f32_forward(&aec->fft, wc);
+    aec->constrain_next = (aec->constrain_next + 1) % aec->partitions;
+}
+
+void audio_aec_process(audio_aec_t* aec, int16_t* samples, size_t count) {
+    size_t offset = 0;
+
+    while (count - offset >= aec->n) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        process_block(aec, samples + offset);
+        aec->cycles_total += esp_cpu_get_cycle_count() - start;
+        aec->blocks++;
+        offset += aec->n;
+    }
+}
+
+void audio_aec_reset(audio_aec_t* aec) {
+    const uint32_t len = 2 * aec->n;
+
+    unsigned head = atomic_load_explicit(&aec->fifo_head, memory_order_acquire);
+    atomic_store_explicit(&aec->fifo_tail, head, memory_order_release);
+
+    if (aec->delay) {
+        memset(aec->delay, 0, aec->delay_len * sizeof(int16_t));
+    }
+    memset(aec->xbuf, 0, len * sizeof(float));
+    memset(aec->X, 0, aec->partitions * len * sizeof(float));
+    memset(aec->W, 0, aec->partitions * len * sizeof(float));
+    memset(aec->power, 0, (aec->n + 1) * sizeof(float));
+    aec->ed_smooth = aec->ee_smooth = aec->ey_smooth = 0.0f;
+    aec->diverge_count = 0;
+    aec->erle_db = 0.0f;
+}
+
+void audio_aec_get_stats(const audio_aec_t* aec, audio_aec_stats_t* stats) {
+    stats->erle_db = aec->erle_db;
+    stats->blocks = aec->blocks;
+    stats->ref_dropped = atomic_load_explicit(&aec->ref_dropped, memory_order_relaxed);
+    stats->ref_realigned = aec->ref_realigned;
+    stats->resets = aec->resets;
+    stats->cycles_per_block = aec->blocks ? (uint32_t)(aec->cycles_total / aec->blocks) : 0;
+}
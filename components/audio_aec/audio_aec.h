@@ -0,0 +1,95 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Acoustic echo canceller
+ *
+ * A partitioned-block frequency-domain adaptive filter (overlap-save NLMS
+ * with alternating gradient constraint) models the speaker-to-mic path and
+ * subtracts the predicted echo from the capture stream.
+ *
+ * The far-end reference is the exact PCM accepted by the output I2S driver,
+ * pushed with audio_aec_push_reference from the playback side. It is pulled
+ * in lockstep with capture, so the reference FIFO depth tracks the playback
+ * DMA queue; a fixed bulk delay then covers capture latency.
+ */
+typedef struct audio_aec audio_aec_t;
+
+/**
+ * @brief Echo canceller configuration
+ */
+typedef struct {
+    uint32_t sample_rate;   ///< Capture and playback sample rate in Hz
+    uint16_t block_size;    ///< Adaptation block in samples, power of two
+    uint16_t tail_ms;       ///< Echo path length the filter covers
+    uint16_t bulk_delay_ms; ///< Fixed delay applied to the reference before the filter
+    uint16_t ref_fifo_ms;   ///< Capacity of the reference FIFO
+} audio_aec_config_t;
+
+#define AUDIO_AEC_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,            \
+    .block_size = 128,               \
+    .tail_ms = 64,                   \
+    .bulk_delay_ms = 40,             \
+    .ref_fifo_ms = 512,              \
+}
+
+/**
+ * @brief Echo canceller statistics
+ */
+typedef struct {
+    float erle_db;              ///< Smoothed echo return loss enhancement while far-end is active
+    uint32_t blocks;            ///< Blocks processed
+    uint32_t ref_dropped;       ///< Reference samples dropped because the FIFO was full
+    uint32_t ref_realigned;     ///< Times stale reference was skipped to restore alignment
+    uint32_t resets;            ///< Filter resets after divergence
+    uint32_t cycles_per_block;  ///< Average CPU cycles per block
+} audio_aec_stats_t;
+
+/**
+ * @brief Create an echo canceller
+ */
+esp_err_t audio_aec_create(const audio_aec_config_t* config, audio_aec_t** out_aec);
+
+/**
+ * @brief Free an echo canceller
+ */
+void audio_aec_destroy(audio_aec_t* aec);
+
+/**
+ * @brief Feed far-end samples exactly as they were handed to the speaker
+ *
+ * Lock-free; call from the single playback context only.
+ */
+void audio_aec_push_reference(audio_aec_t* aec, const int16_t* samples, size_t count);
+
+/**
+ * @brief Cancel echo from captured samples in place
+ *
+ * Call from the single capture context only. count should be a multiple of
+ * block_size; a trailing partial block is passed through unprocessed.
+ */
+void audio_aec_process(audio_aec_t* aec, int16_t* samples, size_t count);
+
+/**
+ * @brief Forget the learned echo path and any queued reference
+ *
+ * Capture side only.
+ */
+void audio_aec_reset(audio_aec_t* aec);
+
+/**
+ * @brief Read statistics
+ */
+void audio_aec_get_stats(const audio_aec_t* aec, audio_aec_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,301 @@
+#include "audio_codec.h"
+#include <string.h>
+
+// G.711 segment (exponent) of a biased magnitude, indexed by magnitude >> 7
+static const uint8_t s_g711_segment[256] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+};
+
+static const int16_t s_ulaw_decode[256] = {
+    -32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+    -23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+    -15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+    -11900, -11388, -10876, -10364,  -9852,  -9340,  -8828,  -8316,
+     -7932,  -7676,  -7420,  -7164,  -6908,  -6652,  -6396,  -6140,
+     -5884,  -5628,  -5372,  -5116,  -4860,  -4604,  -4348,  -4092,
+     -3900,  -3772,  -3644,  -3516,  -3388,  -3260,  -3132,  -3004,
+     -2876,  -2748,  -2620,  -2492,  -2364,  -2236,  -2108,  -1980,
+     -1884,  -1820,  -1756,  -1692,  -1628,  -1564,  -1500,  -1436,
+     -1372,  -1308,  -1244,  -1180,  -1116,  -1052,   -988,   -924,
+      -876,   -844,   -812,   -780,   -748,   -716,   -684,   -652,
+      -620,   -588,   -556,   -524,   -492,   -460,   -428,   -396,
+      -372,   -356,   -340,   -324,   -308,   -292,   -276,   -260,
+      -244,   -228,   -212,   -196,   -180,   -164,   -148,   -132,
+      -120,   -112,   -104,    -96,    -88,    -80,    -72,    -64,
+       -56,    -48,    -40,    -32,    -24,    -16,     -8,      0,
+     32124,  31100,  30076,  29052,  28028,  27004,  25980,  24956,
+     23932,  22908,  21884,  20860,  19836,  18812,  17788,  16764,
+     15996,  15484,  14972,  14460,  13948,  13436,  12924,  12412,
+     11900,  11388,  10876,  10364,   9852,   9340,   8828,   8316,
+      7932,   7676,   7420,   7164,   6908,   6652,   6396,   6140,
+      5884,   5628,   5372,   5116,   4860,   4604,   4348,   4092,
+      3900,   3772,   3644,   3516,   3388,   3260,   3132,   3004,
+      2876,   2748,   2620,   2492,   2364,   2236,   2108,   1980,
+      1884,   1820,   1756,   1692,   1628,   1564,   1500,   1436,
+      1372,   1308,   1244,   1180,   1116,   1052,    988,    924,
+       876,    844,    812,    780,    748,    716,    684,    652,
+       620,    588,    556,    524,    492,    460,    428,    396,
+       372,    356,    340,    324,    308,    292,    276,    260,
+       244,    228,    212,    196,    180,    164,    148,    132,
+       120,    112,    104,     96,     88,     80,     72,     64,
+        56,     48,     40,     32,     24,     16,      8,      0,
+};
+
+static const int16_t s_alaw_decode[256] = {
+     -5504,  -5248,  -6016,  -5760,  -4480,  -4224,  -4992,  -4736,
+     -7552,  -7296,  -8064,  -7808,  -6528,  -6272,  -7040,  -6784,
+     -2752,  -2624,  -3008,  -2880,  -2240,  -2112,  -2496,  -2368,
+     -3776,  -3648,  -4032,  -3904,  -3264,  -3136,  -3520,  -3392,
+    -22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+    -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+    -11008, -10496, -12032, -11520,  -8960,  -8448,  -9984,  -9472,
+    -15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+      -344,   -328,   -376,   -360,   -280,   -264,   -312,   -296,
+      -472,   -456,   -504,   -488,   -408,   -392,   -440,   -424,
+       -88,    -72,   -120,   -104,    -24,     -8,    -56,    -40,
+      -216,   -200,   -248,   -232,   -152,   -136,   -184,   -168,
+     -1376,  -1312,  -1504,  -1440,  -1120,  -1056,  -1248,  -1184,
+     -1888,  -1824,  -2016,  -1952,  -1632,  -1568,  -1760,  -1696,
+      -688,   -656,   -752,   -720,   -560,   -528,   -624,   -592,
+      -944,   -912,  -1008,   -976,   -816,   -784,   -880,   -848,
+      5504,   5248,   6016,   5760,   4480,   4224,   4992,   4736,
+      7552,   7296,   8064,   7808,   6528,   6272,   7040,   6784,
+      2752,   2624,   3008,   2880,   2240,   2112,   2496,   2368,
+      3776,   3648,   4032,   3904,   3264,   3136,   3520,   3392,
+     22016,  20992,  24064,  23040,  17920,  16896,  19968,  18944,
+     30208,  29184,  32256,  31232,  26112,  25088,  28160,  27136,
+     11008,  10496,  12032,  11520,   8960,   8448,   9984,   9472,
+     15104,  14592,  16128,  15616,  13056,  12544,  14080,  13568,
+       344,    328,    376,    360,    280,    264,    312,    296,
+       472,    456,    504,    488,    408,    392,    440,    424,
+        88,     72,    120,    104,     24,      8,     56,     40,
+       216,    200,    248,    232,    152,    136,    184,    168,
+      1376,   1312,   1504,   1440,   1120,   1056,   1248,   1184,
+      1888,   1824,   2016,   1952,   1632,   1568,   1760,   1696,
+       688,    656,    752,    720,    560,    528,    624,    592,
+       944,    912,   1008,    976,    816,    784,    880,    848,
+};
+
+static const int16_t s_adpcm_step[89] = {
+        7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+      130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+      337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+      876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+     2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+     5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t s_adpcm_index_adjust[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static const char* const s_names[AUDIO_CODEC_MAX] = {
+    [AUDIO_CODEC_PCM16] = "pcm16",
+    [AUDIO_CODEC_G711_ULAW] = "g711_ulaw",
+    [AUDIO_CODEC_G711_ALAW] = "g711_alaw",
+    [AUDIO_CODEC_IMA_ADPCM] = "ima_adpcm",
+};
+
+static inline uint8_t ulaw_encode(int32_t pcm) {
+    uint8_t sign = 0;
+    if (pcm < 0) {
+        pcm = -pcm;
+        sign = 0x80;
+    }
+    if (pcm > 32635) {
+        pcm = 32635;
+    }
+    pcm += 0x84;
+    uint8_t seg = s_g711_segment[pcm >> 7];
+    uint8_t mantissa = (pcm >> (seg + 3)) & 0x0F;
+    return (uint8_t)~(sign | (seg << 4) | mantissa);
+}
+
+static inline uint8_t alaw_encode(int32_t pcm) {
+    uint8_t mask = 0xD5;
+    if (pcm < 0) {
+        pcm = ~pcm;
+        mask = 0x55;
+    }
+    uint8_t seg = s_g711_segment[pcm >> 7];
+    uint8_t mantissa = seg < 2 ? (pcm >> 4) & 0x0F : (pcm >> (seg + 3)) & 0x0F;
+    return (uint8_t)(((seg << 4) | mantissa) ^ mask);
+}
+
+// Applies one code to the predictor; the encoder and decoder share this so
+// they stay in lockstep
+static inline int16_t adpcm_apply(audio_codec_t* codec, uint8_t code) {
+    int32_t step = s_adpcm_step[codec->step_index];
+    int32_t diff = step >> 3;
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+
+    int32_t pred = codec->predictor + ((code & 8) ? -diff : diff);
+    pred = pred > INT16_MAX ? INT16_MAX : (pred < INT16_MIN ? INT16_MIN : pred);
+    codec->predictor = pred;
+
+    int32_t index = codec->step_index + s_adpcm_index_adjust[code];
+    codec->step_index = index < 0 ? 0 : (index > 88 ? 88 : index);
+    return (int16_t)pred;
+}
+
+static inline uint8_t adpcm_encode(audio_codec_t* codec, int32_t sample) {
+    int32_t step = s_adpcm_step[codec->step_index];
+    int32_t diff = sample - codec->predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    if (diff >= (step >> 1)) {
+        code |= 2;
+        diff -= step >> 1;
+    }
+    if (diff >= (step >> 2)) {
+        code |= 1;
+    }
+    adpcm_apply(codec, code);
+    return code;
+}
+
+void audio_codec_init(audio_codec_t* codec, audio_codec_type_t type) {
+    codec->type = type < AUDIO_CODEC_MAX ? type : AUDIO_CODEC_PCM16;
+    audio_codec_reset(codec);
+}
+
+void audio_codec_reset(audio_codec_t* codec) {
+    codec->predictor = 0;
+    codec->step_index = 0;
+}
+
+size_t audio_codec_encode(audio_codec_t* codec, const int16_t* pcm, size_t samples, uint8_t* out) {
+    switch (codec->type) {
+    case AUDIO_CODEC_G711_ULAW:
+        for (size_t i = 0; i < samples; i++) {
+            out[i] = ulaw_encode(pcm[i]);
+        }
+        return samples;
+    case AUDIO_CODEC_G711_ALAW:
+        for (size_t i = 0; i < samples; i++) {
+            out[i] = alaw_encode(pcm[i]);
+        }
+        return samples;
+    case AUDIO_CODEC_IMA_ADPCM: {
+        size_t bytes = 0;
+        for (size_t i = 0; i + 1 < samples; i += 2) {
+            uint8_t lo = adpcm_encode(codec, pcm[i]);
+            uint8_t hi = adpcm_encode(codec, pcm[i + 1]);
+            out[bytes++] = lo | (hi << 4);
+        }
+        if (samples & 1) {
+            out[bytes++] = adpcm_encode(codec, pcm[samples - 1]);
+        }
+        return bytes;
+    }
+    default:
+        memcpy(out, pcm, samples * sizeof(int16_t));
+        return samples * sizeof(int16_t);
+    }
+}
+
+size_t audio_codec_decode(audio_codec_t* codec, const uint8_t* in, size_t bytes, int16_t* pcm) {
+    switch (codec->type) {
+    case AUDIO_CODEC_G711_ULAW:
+        for (size_t i = 0; i < bytes; i++) {
+            pcm[i] = s_ulaw_decode[in[i]];
+        }
+        return bytes;
+    case AUDIO_CODEC_G711_ALAW:
+        for (size_t i = 0; i < bytes; i++) {
+            pcm[i] = s_alaw_decode[in[i]];
+        }
+        return bytes;
+    case AUDIO_CODEC_IMA_ADPCM:
+        for (size_t i = 0; i < bytes; i++) {
+            pcm[2 * i] = adpcm_apply(codec, in[i] & 0x0F);
+            pcm[2 * i + 1] = adpcm_apply(codec, in[i] >> 4);
+        }
+        return bytes * 2;
+    default:
+        memcpy(pcm, in, bytes & ~(size_t)1);
+        return bytes / sizeof(int16_t);
+    }
+}
+
+size_t audio_codec_encoded_size(audio_codec_type_t type, size_t samples) {
+    switch (type) {
+    case AUDIO_CODEC_G711_ULAW:
+    case AUDIO_CODEC_G711_ALAW:
+        return samples;
+    case AUDIO_CODEC_IMA_ADPCM:
+        return (samples + 1) / 2;
+    default:
+        return samples * sizeof(int16_t);
+    }
+}
+
+size_t audio_codec_decoded_samples(audio_codec_type_t type, size_t bytes) {
+    switch (type) {
+    case AUDIO_CODEC_G711_ULAW:
+    case AUDIO_CODEC_G711_ALAW:
+        return bytes;
+    case AUDIO_CODEC_IMA_ADPCM:
+        return bytes * 2;
+    default:
+        return bytes / sizeof(int16_t);
+    }
+}
+
+uint32_t audio_codec_sample_rate(audio_codec_type_t type) {
+    switch (type) {
+    case AUDIO_CODEC_G711_ULAW:
+    case AUDIO_CODEC_G711_ALAW:
+        return 8000;
+    case AUDIO_CODEC_IMA_ADPCM:
+        return 16000;
+    default:
+        return 24000;
+    }
+}
+
+const char* audio_codec_name(audio_codec_type_t type) {
+    return type < AUDIO_CODEC_MAX ? s_names[type] : "unknown";
+}
+
+bool audio_codec_is_wire_format(audio_codec_type_t type) {
+    return type == AUDIO_CODEC_PCM16 || type == AUDIO_CODEC_G711_ULAW || type == AUDIO_CODEC_G711_ALAW;
+}
+
+bool audio_codec_from_name(const char* name, audio_codec_type_t* out_type) {
+    for (int i = 0; i < AUDIO_CODEC_MAX; i++) {
+        if (strcmp(name, s_names[i]) == 0) {
+            *out_type = (audio_codec_type_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Audio formats for the Realtime service and the device
+ *
+ * PCM16 and G.711 are the Realtime wire formats. IMA-ADPCM is internal
+ * only (the service rejects it); see audio_codec_is_wire_format. All codecs are sample-by-sample and table driven: G.711 packs one sample
+ * per byte, IMA-ADPCM two samples per byte (low nibble first). ADPCM is a
+ * continuous stream whose predictor state lives in audio_codec_t, so each
+ * direction needs its own instance.
+ */
+typedef enum {
+    AUDIO_CODEC_PCM16 = 0,      ///< 16-bit little-endian PCM, 2 bytes per sample
+    AUDIO_CODEC_G711_ULAW,      ///< G.711 μ-law, 1 byte per sample
+    AUDIO_CODEC_G711_ALAW,      ///< G.711 A-law, 1 byte per sample
+    AUDIO_CODEC_IMA_ADPCM,      ///< IMA-ADPCM, 4 bits per sample
+    AUDIO_CODEC_MAX,
+} audio_codec_type_t;
+
+typedef struct {
+    audio_codec_type_t type;
+    int32_t predictor;          ///< ADPCM: last reconstructed sample
+    int32_t step_index;         ///< ADPCM: index into the step table
+} audio_codec_t;
+
+/**
+ * @brief Set up a codec instance and clear its state
+ */
+void audio_codec_init(audio_codec_t* codec, audio_codec_type_t type);
+
+/**
+ * @brief Clear the stream state, e.g. at the start of a conversation
+ */
+void audio_codec_reset(audio_codec_t* codec);
+
+/**
+ * @brief Encode PCM samples
+ *
+ * For IMA-ADPCM pass an even number of samples; an odd trailing sample is
+ * padded with a zero nibble.
+ *
+ * @param pcm Input samples
+ * @param samples Number of input samples
+ * @param out Output buffer, at least audio_codec_encoded_size(type, samples) bytes
+ * @return Number of bytes written
+ */
+size_t audio_codec_encode(audio_codec_t* codec, const int16_t* pcm, size_t samples, uint8_t* out);
+
+/**
+ * @brief Decode encoded bytes to PCM samples
+ *
+ * @param in Encoded input
+ * @param bytes Number of input bytes
+ * @param pcm Output buffer, at least audio_codec_decoded_samples(type, bytes) samples
+ * @return Number of samples written
+ */
+size_t audio_codec_decode(audio_codec_t* codec, const uint8_t* in, size_t bytes, int16_t* pcm);
+
+/**
+ * @brief Encoded size in bytes of the given number of samples
+ */
+size_t audio_codec_encoded_size(audio_codec_type_t type, size_t samples);
+
+/**
+ * @brief Number of samples the given number of encoded bytes decodes to
+ */
+size_t audio_codec_decoded_samples(audio_codec_type_t type, size_t bytes);
+
+/**
+ * @brief Sample rate the format is carried at on the wire
+ *
+ * PCM16 and G.711 use the rates the Realtime API defines for them
+ * (24 kHz and 8 kHz); IMA-ADPCM keeps the 16 kHz device rate.
+ */
+uint32_t audio_codec_sample_rate(audio_codec_type_t type);
+
+/**
+ * @brief Config/API name of a format ("pcm16", "g711_ulaw", "g711_alaw", "ima_adpcm")
+ */
+const char* audio_codec_name(audio_codec_type_t type);
+
+/**
+ * @brief Whether the Realtime service accepts the format on the wire
+ *
+ * True for PCM16 and G.711; IMA-ADPCM is for internal use only.
+ */
+bool audio_codec_is_wire_format(audio_codec_type_t type);
+
+/**
+ * @brief Look up a format by name
+ *
+ * @return true if the name is known
+ */
+bool audio_codec_from_name(const char* name, audio_codec_type_t* out_type);
+
+#ifdef __cplusplus
+}
+#endif
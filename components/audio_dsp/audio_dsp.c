@@ -0,0 +1,173 @@
+#include "audio_dsp.h"
+#include <math.h>
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+// audio_dsp_esp32s3.S; vectors are 8 samples, buffers 16-byte aligned
+extern void audio_dsp_gain_s16_aes3(int16_t* samples, size_t vectors, const int16_t* params, uint32_t shift);
+extern void audio_dsp_mix_s16_aes3(int16_t* dst, const int16_t* src, size_t vectors);
+#define AUDIO_DSP_HAVE_PIE 1
+#else
+#define AUDIO_DSP_HAVE_PIE 0
+#endif
+
+#define BIQUAD_Q 14
+
+void audio_dsp_dc_block_init(audio_dsp_dc_block_t* dc, int16_t pole_q15) {
+    dc->pole_q15 = pole_q15;
+    dc->x1 = 0;
+    dc->y1 = 0;
+}
+
+void audio_dsp_dc_block_s16(audio_dsp_dc_block_t* dc, int16_t* samples, size_t count) {
+    int32_t pole = dc->pole_q15;
+    int32_t x1 = dc->x1;
+    int32_t y1 = dc->y1;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x = samples[i];
+        int32_t y = x - x1 + ((y1 * pole + (1 << 14)) >> 15);
+        x1 = x;
+        y1 = audio_dsp_sat16(y);
+        samples[i] = (int16_t)y1;
+    }
+
+    dc->x1 = (int16_t)x1;
+    dc->y1 = (int16_t)y1;
+}
+
+static void biquad_store(audio_dsp_biquad_t* bq, float b0, float b1, float b2, float a0, float a1, float a2) {
+    const float scale = (float)(1 << BIQUAD_Q) / a0;
+    bq->b0 = audio_dsp_sat16(lrintf(b0 * scale));
+    bq->b1 = audio_dsp_sat16(lrintf(b1 * scale));
+    bq->b2 = audio_dsp_sat16(lrintf(b2 * scale));
+    bq->a1 = audio_dsp_sat16(lrintf(a1 * scale));
+    bq->a2 = audio_dsp_sat16(lrintf(a2 * scale));
+    bq->x1 = bq->x2 = bq->y1 = bq->y2 = 0;
+}
+
+void audio_dsp_biquad_highpass_init(audio_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_rate, uint32_t q_x1000) {
+    float w0 = 2.0f * (float)M_PI * (float)cutoff_hz / (float)sample_rate;
+    float cosw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * (float)q_x1000 / 1000.0f);
+
+    biquad_store(bq, (1.0f + cosw) / 2.0f, -(1.0f + cosw), (1.0f + cosw) / 2.0f,
+                 1.0f + alpha, -2.0f * cosw, 1.0f - alpha);
+}
+
+void audio_dsp_biquad_lowpass_init(audio_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_rate, uint32_t q_x1000) {
+    float w0 = 2.0f * (float)M_PI * (float)cutoff_hz / (float)sample_rate;
+    float cosw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * (float)q_x1000 / 1000.0f);
+
+    biquad_store(bq, (1.0f - cosw) / 2.0f, 1.0f - cosw, (1.0f - cosw) / 2.0f,
+                 1.0f + alpha, -2.0f * cosw, 1.0f - alpha);
+}
+
+void audio_dsp_biquad_s16(audio_dsp_biquad_t* bq, int16_t* samples, size_t count) {
+    const int32_t b0 = bq->b0, b1 = bq->b1, b2 = bq->b2, a1 = bq->a1, a2 = bq->a2;
+    int32_t x1 = bq->x1, x2 = bq->x2, y1 = bq->y1, y2 = bq->y2;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x = samples[i];
+        // Five Q14 x Q15 products can exceed 32 bits near full scale
+        int64_t acc = (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2
+                    - (int64_t)a1 * y1 - (int64_t)a2 * y2;
+        int32_t y = audio_dsp_sat16((int32_t)((acc + (1 << (BIQUAD_Q - 1))) >> BIQUAD_Q));
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        samples[i] = (int16_t)y;
+    }
+
+    bq->x1 = (int16_t)x1;
+    bq->x2 = (int16_t)x2;
+    bq->y1 = (int16_t)y1;
+    bq->y2 = (int16_t)y2;
+}
+
+void audio_dsp_gain_s16(int16_t* samples, size_t count, int16_t gain_q10) {
+    if (gain_q10 <= 0) {
+        for (size_t i = 0; i < count; i++) {
+            samples[i] = 0;
+        }
+        return;
+    }
+
+    // Clamping the input first keeps every product inside int16 after the
+    // shift, which is what lets the vector path use a plain multiply.
+    int32_t limit = ((int32_t)INT16_MAX << 10) / gain_q10;
+    if (limit > INT16_MAX) {
+        limit = INT16_MAX;
+    }
+
+    size_t i = 0;
+#if AUDIO_DSP_HAVE_PIE
+    if (((uintptr_t)samples & 15) == 0 && count >= 8) {
+        int16_t params[24] __attribute__((aligned(16)));
+        for (int lane = 0; lane < 8; lane++) {
+            params[lane] = gain_q10;
+            params[8 + lane] = (int16_t)limit;
+            params[16 + lane] = (int16_t)-limit;
+        }
+        audio_dsp_gain_s16_aes3(samples, count / 8, params, 10);
+        i = count & ~(size_t)7;
+    }
+#endif
+
+    for (; i < count; i++) {
+        int32_t x = samples[i];
+        x = x > limit ? limit : (x < -limit ? -limit : x);
+        samples[i] = (int16_t)((x * gain_q10) >> 10);
+    }
+}
+
+void audio_dsp_gain_ramp_s16(int16_t* samples, size_t count, int16_t from_q10, int16_t to_q10) {
+    if (count == 0) {
+        return;
+    }
+
+    // Gain in Q26 so the per-sample step keeps 16 fractional bits
+    int32_t gain = (int32_t)from_q10 << 16;
+    int32_t step = ((int32_t)to_q10 - from_q10) * 65536 / (int32_t)count;
+    for (size_t i = 0; i < count; i++) {
+        gain += step;
+        int32_t g = i + 1 == count ? to_q10 : gain >> 16;
+        samples[i] = audio_dsp_sat16((samples[i] * g) >> 10);
+    }
+}
+
+void audio_dsp_mix_s16(int16_t* dst, const int16_t* src, size_t count) {
+    size_t i = 0;
+#if AUDIO_DSP_HAVE_PIE
+    if ((((uintptr_t)dst | (uintptr_t)src) & 15) == 0 && count >= 8) {
+        audio_dsp_mix_s16_aes3(dst, src, count / 8);
+        i = count & ~(size_t)7;
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = audio_dsp_sat16((int32_t)dst[i] + src[i]);
+    }
+}
+
+uint32_t audio_dsp_peak_s16(const int16_t* samples, size_t count) {
+    int32_t max = 0;
+    int32_t min = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t s = samples[i];
+        max = s > max ? s : max;
+        min = s < min ? s : min;
+    }
+    return (uint32_t)(max > -min ? max : -min);
+}
+
+int32_t audio_dsp_correlate_s16(const int16_t* a, const int16_t* b, size_t count, size_t step) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < count; i += step) {
+        sum += ((int32_t)a[i] * b[i]) >> 8;
+    }
+    return sum;
+}
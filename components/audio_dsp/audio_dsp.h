@@ -0,0 +1,120 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-point building blocks for 16-bit PCM processing
+ *
+ * All kernels work in place on blocks of int16 samples. Block kernels use
+ * the ESP32-S3 vector instructions when the buffer is 16-byte aligned and
+ * fall back to portable C otherwise (and on every other target); both paths
+ * produce identical results.
+ */
+
+/** Unity gain in the Q10 format used by audio_dsp_gain_s16 */
+#define AUDIO_DSP_GAIN_UNITY 1024
+
+/**
+ * @brief One-pole DC blocker state: y[n] = x[n] - x[n-1] + R * y[n-1]
+ */
+typedef struct {
+    int16_t pole_q15;   // R in Q15
+    int16_t x1;
+    int16_t y1;
+} audio_dsp_dc_block_t;
+
+/**
+ * @brief Direct-form I biquad with Q14 coefficients
+ */
+typedef struct {
+    int16_t b0, b1, b2, a1, a2;
+    int16_t x1, x2, y1, y2;
+} audio_dsp_biquad_t;
+
+/**
+ * @brief Initialize a DC blocker
+ *
+ * @param pole_q15 Pole radius in Q15; 32604 (0.995) puts the corner near 13 Hz at 16 kHz
+ */
+void audio_dsp_dc_block_init(audio_dsp_dc_block_t* dc, int16_t pole_q15);
+
+/**
+ * @brief Remove DC from a block in place
+ */
+void audio_dsp_dc_block_s16(audio_dsp_dc_block_t* dc, int16_t* samples, size_t count);
+
+/**
+ * @brief Design a second-order Butterworth-style high-pass filter
+ *
+ * Coefficients are computed once in floating point and stored as Q14.
+ *
+ * @param cutoff_hz -3 dB corner frequency
+ * @param sample_rate Sample rate in Hz
+ * @param q_x1000 Filter Q times 1000 (707 for Butterworth)
+ */
+void audio_dsp_biquad_highpass_init(audio_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_rate, uint32_t q_x1000);
+
+/**
+ * @brief Design a second-order low-pass filter (same conventions as the high-pass)
+ */
+void audio_dsp_biquad_lowpass_init(audio_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_rate, uint32_t q_x1000);
+
+/**
+ * @brief Run a biquad over a block in place
+ */
+void audio_dsp_biquad_s16(audio_dsp_biquad_t* bq, int16_t* samples, size_t count);
+
+/**
+ * @brief Apply a constant Q10 gain with saturation, in place
+ *
+ * @param gain_q10 Gain in Q10 (1024 = 0 dB), 0 .. 32767
+ */
+void audio_dsp_gain_s16(int16_t* samples, size_t count, int16_t gain_q10);
+
+/**
+ * @brief Apply a gain moving linearly from one Q10 value to another, in place
+ *
+ * The gain changes a little on every sample and reaches to_q10 on the
+ * last one, so a gain change spread over a block does not click.
+ *
+ * @param from_q10 Gain before the block, 0 .. 32767
+ * @param to_q10 Gain at the last sample, 0 .. 32767
+ */
+void audio_dsp_gain_ramp_s16(int16_t* samples, size_t count, int16_t from_q10, int16_t to_q10);
+
+/**
+ * @brief Add src into dst with int16 saturation
+ */
+void audio_dsp_mix_s16(int16_t* dst, const int16_t* src, size_t count);
+
+/**
+ * @brief Largest absolute sample value in a block (0 .. 32768)
+ */
+uint32_t audio_dsp_peak_s16(const int16_t* samples, size_t count);
+
+/**
+ * @brief Correlation of two blocks on every step-th sample
+ *
+ * Each product is shifted down by 8 bits, so a few hundred full-scale
+ * samples fit in the 32-bit sum. Used by the pitch and splice-point
+ * searches of the PLC and the time stretcher.
+ *
+ * @param step 1 for every sample, 2 for every other one, ...
+ */
+int32_t audio_dsp_correlate_s16(const int16_t* a, const int16_t* b, size_t count, size_t step);
+
+/**
+ * @brief Saturate a 32-bit value to int16
+ */
+static inline int16_t audio_dsp_sat16(int32_t v) {
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+}
+
+#ifdef __cplusplus
+}
+#endif
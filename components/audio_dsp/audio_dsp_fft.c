@@ -0,0 +1,419 @@
+#include "audio_dsp_fft.h"
+#include <math.h>
+#include <stdlib.h>
+
+esp_err_t audio_dsp_fft_f32_init(audio_dsp_fft_f32_t* fft, uint32_t n) {
+    if (!fft || n < 4 || n > 65536 || (n & (n - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fft->n = n;
+    fft->twiddle = malloc(n * sizeof(float));
+    fft->bitrev = malloc(n * sizeof(uint16_t));
+    if (!fft->twiddle || !fft->bitrev) {
+        audio_dsp_fft_f32_deinit(fft);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t k = 0; k < n / 2; k++) {
+        double phase = -2.0 * M_PI * k / n;
+        fft->twiddle[2 * k] = (float)cos(phase);
+        fft->twiddle[2 * k + 1] = (float)sin(phase);
+    }
+
+    uint32_t bits = 0;
+    while ((1u << bits) < n) {
+        bits++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        fft->bitrev[i] = (uint16_t)r;
+    }
+
+    return ESP_OK;
+}
+
+void audio_dsp_fft_f32_deinit(audio_dsp_fft_f32_t* fft) {
+    if (!fft) {
+        return;
+    }
+    free(fft->twiddle);
+    free(fft->bitrev);
+    fft->twiddle = NULL;
+    fft->bitrev = NULL;
+}
+
+void audio_dsp_fft_f32(const audio_dsp_fft_f32_t* fft, float* data, bool inverse) {
+    const uint32_t n = fft->n;
+    const float sign = inverse ? -1.0f : 1.0f;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t j = fft->bitrev[i];
+        if (j > i) {
+            float re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    // Iterative decimation-in-time butterflies
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        const uint32_t half = len >> 1;
+        const uint32_t stride = n / len;
+        for (uint32_t start = 0; start < n; start += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                float wr = fft->twiddle[2 * k * stride];
+                float wi = sign * fft->twiddle[2 * k * stride + 1];
+                float* a = &data[2 * (start + k)];
+                float* b = &data[2 * (start + k + half)];
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+esp_err_t audio_dsp_rfft_f32_init(audio_dsp_rfft_f32_t* fft, uint32_t n) {
+    if (!fft || n < 8 || n > 65536 || (n & (n - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fft->n = n;
+    fft->split = malloc(n * sizeof(float));
+    esp_err_t ret = audio_dsp_fft_f32_init(&fft->half, n / 2);
+    if (ret != ESP_OK || !fft->split) {
+        audio_dsp_rfft_f32_deinit(fft);
+        return ret != ESP_OK ? ret : ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t k = 0; k < n / 2; k++) {
+        double phase = -2.0 * M_PI * k / n;
+        fft->split[2 * k] = (float)cos(phase);
+        fft->split[2 * k + 1] = (float)sin(phase);
+    }
+    return ESP_OK;
+}
+
+void audio_dsp_rfft_f32_deinit(audio_dsp_rfft_f32_t* fft) {
+    if (!fft) {
+        return;
+    }
+    audio_dsp_fft_f32_deinit(&fft->half);
+    free(fft->split);
+    fft->split = NULL;
+}
+
+// The n reals are transformed as n/2 complex values z = x[even] + i x[odd];
+// the split step separates the two interleaved spectra:
+//   X[k] = Fe[k] + W^k Fo[k],  Fe = (Z[k] + Z*[m-k]) / 2,  Fo = (Z[k] - Z*[m-k]) / 2i
+void audio_dsp_rfft_f32_forward(const audio_dsp_rfft_f32_t* fft, float* data) {
+    const uint32_t m = fft->n / 2;
+
+    audio_dsp_fft_f32(&fft->half, data, false);
+
+    float z0r = data[0], z0i = data[1];
+    data[0] = z0r + z0i;    // DC
+    data[1] = z0r - z0i;    // Nyquist
+
+    for (uint32_t k = 1; k <= m / 2; k++) {
+        uint32_t j = m - k;
+        float ar = data[2 * k], ai = data[2 * k + 1];
+        float br = data[2 * j], bi = data[2 * j + 1];
+
+        float fe_r = 0.5f * (ar + br), fe_i = 0.5f * (ai - bi);
+        float fo_r = 0.5f * (ai + bi), fo_i = -0.5f * (ar - br);
+
+        float wr = fft->split[2 * k], wi = fft->split[2 * k + 1];
+        float tr = fo_r * wr - fo_i * wi;
+        float ti = fo_r * wi + fo_i * wr;
+        data[2 * k] = fe_r + tr;
+        data[2 * k + 1] = fe_i + ti;
+
+        // Bin m-k reuses the pair: Fe[m-k] = Fe*[k], Fo[m-k] = Fo*[k]
+        float wjr = fft->split[2 * j], wji = fft->split[2 * j + 1];
+        float tjr = fo_r * wjr + fo_i * wji;
+        float tji = fo_r * wji - fo_i * wjr;
+        data[2 * j] = fe_r + tjr;
+        data[2 * j + 1] = -fe_i + tji;
+    }
+}
+
+void audio_dsp_rfft_f32_inverse(const audio_dsp_rfft_f32_t* fft, float* data) {
+    const uint32_t m = fft->n / 2;
+
+    float dc = data[0], nyq = data[1];
+    data[0] = 0.5f * (dc + nyq);
+    data[1] = 0.5f * (dc - nyq);
+
+    for (uint32_t k = 1; k <= m / 2; k++) {
+        uint32_t j = m - k;
+        float ar = data[2 * k], ai = data[2 * k + 1];
+        float br = data[2 * j], bi = data[2 * j + 1];
+
+        // Fe[k] = (X[k] + X*[m-k]) / 2,  Fo[k] = (X[k] - X*[m-k]) / (2 W^k)
+        float fe_r = 0.5f * (ar + br), fe_i = 0.5f * (ai - bi);
+        float dr = 0.5f * (ar - br), di = 0.5f * (ai + bi);
+        float wr = fft->split[2 * k], wi = fft->split[2 * k + 1];
+        float fo_r = dr * wr + di * wi;     // divide by W^k = multiply by conj(W^k)
+        float fo_i = di * wr - dr * wi;
+
+        // Z[k] = Fe[k] + i Fo[k],  Z[m-k] = Fe*[k] + i Fo*[k]
+        data[2 * k] = fe_r - fo_i;
+        data[2 * k + 1] = fe_i + fo_r;
+        data[2 * j] = fe_r + fo_i;
+        data[2 * j + 1] = -fe_i + fo_r;
+    }
+
+    audio_dsp_fft_f32(&fft->half, data, true);
+
+    const float scale = 1.0f / (float)m;
+    for (uint32_t i = 0; i < fft->n; i++) {
+        data[i] *= scale;
+    }
+}
+
+// Symmetric range so a twiddle can always be conjugated or negated
+static int16_t q15_from_double(double v) {
+    long q = lrint(v * 32768.0);
+    return (int16_t)(q > INT16_MAX ? INT16_MAX : (q < -INT16_MAX ? -INT16_MAX : q));
+}
+
+esp_err_t audio_dsp_fft_s32_init(audio_dsp_fft_s32_t* fft, uint32_t n) {
+    if (!fft || n < 4 || n > 4096 || (n & (n - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fft->n = n;
+    fft->twiddle = malloc(2 * (3 * n / 4) * sizeof(int16_t));
+    fft->bitrev = malloc(n * sizeof(uint16_t));
+    if (!fft->twiddle || !fft->bitrev) {
+        audio_dsp_fft_s32_deinit(fft);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Radix-4 butterflies need W^j, W^2j and W^3j, hence 3n/4 entries
+    for (uint32_t k = 0; k < 3 * n / 4; k++) {
+        double phase = -2.0 * M_PI * k / n;
+        fft->twiddle[2 * k] = q15_from_double(cos(phase));
+        fft->twiddle[2 * k + 1] = q15_from_double(sin(phase));
+    }
+
+    uint32_t bits = 0;
+    while ((1u << bits) < n) {
+        bits++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        fft->bitrev[i] = (uint16_t)r;
+    }
+
+    return ESP_OK;
+}
+
+void audio_dsp_fft_s32_deinit(audio_dsp_fft_s32_t* fft) {
+    if (!fft) {
+        return;
+    }
+    free(fft->twiddle);
+    free(fft->bitrev);
+    fft->twiddle = NULL;
+    fft->bitrev = NULL;
+}
+
+static inline int32_t round_shift(int32_t v, uint32_t shift) {
+    return shift ? (v + (1 << (shift - 1))) >> shift : v;
+}
+
+// (re, im) *= w, w in Q15
+static inline void cmul_q15(int32_t* re, int32_t* im, const int16_t* w) {
+    int64_t r = (int64_t)*re * w[0] - (int64_t)*im * w[1];
+    int64_t i = (int64_t)*re * w[1] + (int64_t)*im * w[0];
+    *re = (int32_t)((r + (1 << 14)) >> 15);
+    *im = (int32_t)((i + (1 << 14)) >> 15);
+}
+
+// Forward decimation-in-frequency radix-2^2 pass. Each radix-4 butterfly is
+// two radix-2 stages fused, so outputs land in plain bit-reversed order.
+// shift4/shift2 scale the radix-4 and radix-2 stages.
+static void fft_s32_dif(const audio_dsp_fft_s32_t* fft, int32_t* data, uint32_t shift4, uint32_t shift2) {
+    const uint32_t n = fft->n;
+    uint32_t len = n;
+
+    for (; len >= 4; len >>= 2) {
+        const uint32_t q = len >> 2;
+        const uint32_t stride = n / len;
+        for (uint32_t start = 0; start < n; start += len) {
+            for (uint32_t j = 0; j < q; j++) {
+                int32_t* a = &data[2 * (start + j)];
+                int32_t* b = a + 2 * q;
+                int32_t* c = b + 2 * q;
+                int32_t* d = c + 2 * q;
+
+                int32_t ar = round_shift(a[0], shift4), ai = round_shift(a[1], shift4);
+                int32_t br = round_shift(b[0], shift4), bi = round_shift(b[1], shift4);
+                int32_t cr = round_shift(c[0], shift4), ci = round_shift(c[1], shift4);
+                int32_t dr = round_shift(d[0], shift4), di = round_shift(d[1], shift4);
+
+                int32_t t0r = ar + cr, t0i = ai + ci;
+                int32_t t1r = ar - cr, t1i = ai - ci;
+                int32_t t2r = br + dr, t2i = bi + di;
+                int32_t t3r = bi - di, t3i = dr - br;      // (b - d) * -i
+
+                a[0] = t0r + t2r;
+                a[1] = t0i + t2i;
+                b[0] = t0r - t2r;
+                b[1] = t0i - t2i;
+                c[0] = t1r + t3r;
+                c[1] = t1i + t3i;
+                d[0] = t1r - t3r;
+                d[1] = t1i - t3i;
+
+                if (j > 0) {
+                    cmul_q15(&b[0], &b[1], &fft->twiddle[2 * (2 * j * stride)]);
+                    cmul_q15(&c[0], &c[1], &fft->twiddle[2 * (j * stride)]);
+                    cmul_q15(&d[0], &d[1], &fft->twiddle[2 * (3 * j * stride)]);
+                }
+            }
+        }
+    }
+
+    // Odd power of two: one trailing radix-2 stage, all twiddles are 1
+    if (len == 2) {
+        for (uint32_t i = 0; i < n; i += 2) {
+            int32_t* a = &data[2 * i];
+            int32_t ar = round_shift(a[0], shift2), ai = round_shift(a[1], shift2);
+            int32_t br = round_shift(a[2], shift2), bi = round_shift(a[3], shift2);
+            a[0] = ar + br;
+            a[1] = ai + bi;
+            a[2] = ar - br;
+            a[3] = ai - bi;
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t j = fft->bitrev[i];
+        if (j > i) {
+            int32_t re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+}
+
+void audio_dsp_fft_s32(const audio_dsp_fft_s32_t* fft, int32_t* data, bool inverse) {
+    if (!inverse) {
+        fft_s32_dif(fft, data, 0, 0);
+        return;
+    }
+
+    // ifft(x) = conj(fft(conj(x))) / n, with the 1/n spread over the stages
+    for (uint32_t i = 0; i < fft->n; i++) {
+        data[2 * i + 1] = -data[2 * i + 1];
+    }
+    fft_s32_dif(fft, data, 2, 1);
+    for (uint32_t i = 0; i < fft->n; i++) {
+        data[2 * i + 1] = -data[2 * i + 1];
+    }
+}
+
+esp_err_t audio_dsp_rfft_s32_init(audio_dsp_rfft_s32_t* fft, uint32_t n) {
+    if (!fft || n < 8 || n > 8192 || (n & (n - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fft->n = n;
+    fft->split = malloc(n * sizeof(int16_t));
+    esp_err_t ret = audio_dsp_fft_s32_init(&fft->half, n / 2);
+    if (ret != ESP_OK || !fft->split) {
+        audio_dsp_rfft_s32_deinit(fft);
+        return ret != ESP_OK ? ret : ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t k = 0; k < n / 2; k++) {
+        double phase = -2.0 * M_PI * k / n;
+        fft->split[2 * k] = q15_from_double(cos(phase));
+        fft->split[2 * k + 1] = q15_from_double(sin(phase));
+    }
+    return ESP_OK;
+}
+
+void audio_dsp_rfft_s32_deinit(audio_dsp_rfft_s32_t* fft) {
+    if (!fft) {
+        return;
+    }
+    audio_dsp_fft_s32_deinit(&fft->half);
+    free(fft->split);
+    fft->split = NULL;
+}
+
+// Same split as the float version; the halvings are exact arithmetic shifts
+void audio_dsp_rfft_s32_forward(const audio_dsp_rfft_s32_t* fft, int32_t* data) {
+    const uint32_t m = fft->n / 2;
+
+    audio_dsp_fft_s32(&fft->half, data, false);
+
+    int32_t z0r = data[0], z0i = data[1];
+    data[0] = z0r + z0i;
+    data[1] = z0r - z0i;
+
+    for (uint32_t k = 1; k <= m / 2; k++) {
+        uint32_t j = m - k;
+        int32_t ar = data[2 * k], ai = data[2 * k + 1];
+        int32_t br = data[2 * j], bi = data[2 * j + 1];
+
+        int32_t fe_r = (ar + br) >> 1, fe_i = (ai - bi) >> 1;
+        int32_t fo_r = (ai + bi) >> 1, fo_i = (br - ar) >> 1;
+
+        int32_t tr = fo_r, ti = fo_i;
+        cmul_q15(&tr, &ti, &fft->split[2 * k]);
+        data[2 * k] = fe_r + tr;
+        data[2 * k + 1] = fe_i + ti;
+
+        // W^(m-k) applied to conj(Fo)
+        int32_t tjr = fo_r, tji = -fo_i;
+        cmul_q15(&tjr, &tji, &fft->split[2 * j]);
+        data[2 * j] = fe_r + tjr;
+        data[2 * j + 1] = -fe_i + tji;
+    }
+}
+
+void audio_dsp_rfft_s32_inverse(const audio_dsp_rfft_s32_t* fft, int32_t* data) {
+    const uint32_t m = fft->n / 2;
+
+    int32_t dc = data[0], nyq = data[1];
+    data[0] = (dc + nyq) >> 1;
+    data[1] = (dc - nyq) >> 1;
+
+    for (uint32_t k = 1; k <= m / 2; k++) {
+        uint32_t j = m - k;
+        int32_t ar = data[2 * k], ai = data[2 * k + 1];
+        int32_t br = data[2 * j], bi = data[2 * j + 1];
+
+        int32_t fe_r = (ar + br) >> 1, fe_i = (ai - bi) >> 1;
+        int32_t fo_r = (ar - br) >> 1, fo_i = (ai + bi) >> 1;
+        // Divide by W^k: multiply by its conjugate
+        const int16_t w[2] = { fft->split[2 * k], (int16_t)-fft->split[2 * k + 1] };
+        cmul_q15(&fo_r, &fo_i, w);
+
+        data[2 * k] = fe_r - fo_i;
+        data[2 * k + 1] = fe_i + fo_r;
+        data[2 * j] = fe_r + fo_i;
+        data[2 * j + 1] = -fe_i + fo_r;
+    }
+
+    audio_dsp_fft_s32(&fft->half, data, true);
+}
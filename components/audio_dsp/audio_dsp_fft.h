@@ -0,0 +1,145 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Single-precision and fixed-point FFTs with precomputed twiddle tables
+ *
+ * Complex data is interleaved (re, im). Real transforms use a packed
+ * spectrum of n values: [DC, Nyquist, re(1), im(1), ..., re(n/2-1), im(n/2-1)].
+ *
+ * The fixed-point variants keep samples in int32 with Q15 twiddles. Forward
+ * transforms are unscaled, so 16-bit input of up to 4096 points cannot
+ * overflow; inverse transforms scale by 1/n stage by stage.
+ */
+
+/**
+ * @brief Complex radix-2 FFT plan
+ */
+typedef struct {
+    uint32_t n;             // complex points, power of two
+    float* twiddle;         // n/2 (cos, sin) pairs
+    uint16_t* bitrev;       // bit-reversal permutation
+} audio_dsp_fft_f32_t;
+
+/**
+ * @brief Real FFT plan built on an n/2-point complex FFT
+ */
+typedef struct {
+    uint32_t n;             // real points, power of two
+    audio_dsp_fft_f32_t half;
+    float* split;           // n/2 (cos, sin) pairs for the split step
+} audio_dsp_rfft_f32_t;
+
+/**
+ * @brief Create a complex FFT plan
+ *
+ * @param n Number of complex points, power of two between 4 and 65536
+ */
+esp_err_t audio_dsp_fft_f32_init(audio_dsp_fft_f32_t* fft, uint32_t n);
+
+/**
+ * @brief Free a complex FFT plan
+ */
+void audio_dsp_fft_f32_deinit(audio_dsp_fft_f32_t* fft);
+
+/**
+ * @brief In-place complex FFT
+ *
+ * @param data n interleaved complex values
+ * @param inverse Compute the unscaled inverse transform
+ */
+void audio_dsp_fft_f32(const audio_dsp_fft_f32_t* fft, float* data, bool inverse);
+
+/**
+ * @brief Create a real FFT plan
+ *
+ * @param n Number of real points, power of two between 8 and 65536
+ */
+esp_err_t audio_dsp_rfft_f32_init(audio_dsp_rfft_f32_t* fft, uint32_t n);
+
+/**
+ * @brief Free a real FFT plan
+ */
+void audio_dsp_rfft_f32_deinit(audio_dsp_rfft_f32_t* fft);
+
+/**
+ * @brief In-place forward real FFT: n samples in, packed spectrum out
+ */
+void audio_dsp_rfft_f32_forward(const audio_dsp_rfft_f32_t* fft, float* data);
+
+/**
+ * @brief In-place inverse real FFT: packed spectrum in, n samples out (scaled by 1/n)
+ */
+void audio_dsp_rfft_f32_inverse(const audio_dsp_rfft_f32_t* fft, float* data);
+
+/**
+ * @brief Fixed-point complex FFT plan (radix-4 stages, one radix-2 stage for odd powers)
+ */
+typedef struct {
+    uint32_t n;             // complex points, power of two
+    int16_t* twiddle;       // 3n/4 (cos, sin) pairs, Q15
+    uint16_t* bitrev;       // bit-reversal permutation
+} audio_dsp_fft_s32_t;
+
+/**
+ * @brief Fixed-point real FFT plan built on an n/2-point complex FFT
+ */
+typedef struct {
+    uint32_t n;             // real points, power of two
+    audio_dsp_fft_s32_t half;
+    int16_t* split;         // n/2 (cos, sin) pairs for the split step, Q15
+} audio_dsp_rfft_s32_t;
+
+/**
+ * @brief Create a fixed-point complex FFT plan
+ *
+ * @param n Number of complex points, power of two between 4 and 4096
+ */
+esp_err_t audio_dsp_fft_s32_init(audio_dsp_fft_s32_t* fft, uint32_t n);
+
+/**
+ * @brief Free a fixed-point complex FFT plan
+ */
+void audio_dsp_fft_s32_deinit(audio_dsp_fft_s32_t* fft);
+
+/**
+ * @brief In-place fixed-point complex FFT
+ *
+ * @param data n interleaved complex values
+ * @param inverse Compute the inverse transform, scaled by 1/n
+ */
+void audio_dsp_fft_s32(const audio_dsp_fft_s32_t* fft, int32_t* data, bool inverse);
+
+/**
+ * @brief Create a fixed-point real FFT plan
+ *
+ * @param n Number of real points, power of two between 8 and 8192
+ */
+esp_err_t audio_dsp_rfft_s32_init(audio_dsp_rfft_s32_t* fft, uint32_t n);
+
+/**
+ * @brief Free a fixed-point real FFT plan
+ */
+void audio_dsp_rfft_s32_deinit(audio_dsp_rfft_s32_t* fft);
+
+/**
+ * @brief In-place forward real FFT: n samples (16-bit range) in, unscaled packed spectrum out
+ */
+void audio_dsp_rfft_s32_forward(const audio_dsp_rfft_s32_t* fft, int32_t* data);
+
+/**
+ * @brief In-place inverse real FFT: packed spectrum in, n samples out (scaled by 1/n)
+ */
+void audio_dsp_rfft_s32_inverse(const audio_dsp_rfft_s32_t* fft, int32_t* data);
+
+#ifdef __cplusplus
+}
+#endif
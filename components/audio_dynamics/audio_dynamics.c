@@ -0,0 +1,250 @@
+#include "audio_dynamics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "audio_dsp.h"
+
+#define Q15_UNITY   (1 << 15)
+// Levels and gains in the compressor are log2 in Q8: 256 is one doubling
+// (6.02 dB), 0 is full scale
+#define LOG_ONE     256
+#define LOG_FLOOR   (-16 * LOG_ONE)
+#define MAX_SLOTS   (AUDIO_DYNAMICS_MAX_LOOKAHEAD_MS + 1)
+
+struct audio_dynamics {
+    size_t block;                   // samples per 1 ms block
+    uint32_t slots;                 // look-ahead blocks plus the one going out
+    uint32_t out_slot;              // oldest block in the delay line
+    bool pending;                   // the delay line holds audio, not silence
+    int16_t* delay;                 // slots blocks, circular
+    int32_t pre_gain[MAX_SLOTS];    // compressor and volume gain of each delayed block (Q15)
+    int32_t need[MAX_SLOTS];        // limiter gain each delayed block needs (Q15)
+
+    int32_t threshold_log;
+    int32_t makeup_log;
+    int32_t slope_q15;              // 1 - 1/ratio
+    int32_t attack_q15;             // envelope smoothing per block
+    int32_t release_q15;
+    int32_t env_log;
+
+    volatile int32_t volume_target_q15;
+    int32_t volume_q15;
+    int32_t volume_step_q15;
+
+    int32_t ceiling;                // sample magnitude
+    int32_t limit_release_q15;
+    int32_t limit_q15;              // limiter gain at the end of the last block
+    int32_t last_pre_gain;          // pre_gain of the newest block
+    int16_t last_total_q10;         // gain the last output block ended on
+
+    audio_dynamics_stats_t stats;
+    int32_t min_limit_q15;
+    int32_t max_reduce_log;
+};
+
+// Piecewise-linear log2 and its exact inverse; within 0.5 dB, which is
+// plenty for a level detector
+static int32_t log2_q8(uint32_t v) {
+    int32_t e = 31 - __builtin_clz(v);
+    uint32_t frac = e >= 8 ? v >> (e - 8) : v << (8 - e);
+    return e * LOG_ONE + (int32_t)(frac & 0xFF);
+}
+
+static int32_t exp2_q8_q15(int32_t l) {
+    int32_t n = l >> 8;
+    int32_t m = (LOG_ONE + (l & 0xFF)) << 7;    // 1.0 .. 2.0 in Q15
+    if (n >= 0) {
+        return n > 15 ? INT32_MAX : m << n;
+    }
+    return n < -30 ? 0 : m >> -n;
+}
+
+static int32_t db_to_log(int32_t db) {
+    return db * 4252 / 100;     // 256 / 6.0206
+}
+
+static uint32_t log_to_db(int32_t log) {
+    return (uint32_t)(log * 100 / 4252);
+}
+
+static int32_t time_coef_q15(uint32_t ms) {
+    return ms == 0 ? Q15_UNITY : (int32_t)(Q15_UNITY * (1.0f - expf(-1.0f / (float)ms)));
+}
+
+static int32_t volume_q15(uint32_t pct) {
+    pct = pct < 100 ? pct : 100;
+    return (int32_t)(Q15_UNITY * pct * pct / 10000);
+}
+
+static int16_t q15_to_q10(int32_t gain) {
+    gain >>= 5;
+    return (int16_t)(gain < INT16_MAX ? gain : INT16_MAX);
+}
+
+void audio_dynamics_reset(audio_dynamics_t* dyn) {
+    // The delay line holds silence at the gain silence would get
+    dyn->env_log = LOG_FLOOR;
+    dyn->volume_q15 = dyn->volume_target_q15;
+    int32_t gain = (int32_t)(((int64_t)exp2_q8_q15(dyn->makeup_log) * dyn->volume_q15) >> 15);
+    memset(dyn->delay, 0, dyn->slots * dyn->block * sizeof(int16_t));
+    for (uint32_t i = 0; i < dyn->slots; i++) {
+        dyn->pre_gain[i] = gain;
+        dyn->need[i] = Q15_UNITY;
+    }
+    dyn->out_slot = 0;
+    dyn->pending = false;
+    dyn->limit_q15 = Q15_UNITY;
+    dyn->last_pre_gain = gain;
+    dyn->last_total_q10 = q15_to_q10(gain);
+}
+
+esp_err_t audio_dynamics_create(const audio_dynamics_config_t* config, audio_dynamics_t** out_dyn) {
+    if (!config || !out_dyn || config->sample_rate < 8000 || config->sample_rate % 1000 != 0 ||
+        config->lookahead_ms == 0 || config->lookahead_ms > AUDIO_DYNAMICS_MAX_LOOKAHEAD_MS ||
+        config->ceiling_db > 0 || config->ratio == 0 || config->makeup_db < -60 || config->makeup_db > 24) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    audio_dynamics_t* dyn = calloc(1, sizeof(audio_dynamics_t));
+    if (!dyn) {
+        return ESP_ERR_NO_MEM;
+    }
+    dyn->block = config->sample_rate / 1000;
+    dyn->slots = config->lookahead_ms + 1;
+    dyn->delay = calloc(dyn->slots * dyn->block, sizeof(int16_t));
+    if (!dyn->delay) {
+        free(dyn);
+        return ESP_ERR_NO_MEM;
+    }
+
+    dyn->threshold_log = db_to_log(config->threshold_db);
+    dyn->makeup_log = db_to_log(config->makeup_db);
+    dyn->slope_q15 = Q15_UNITY - Q15_UNITY / (int32_t)config->ratio;
+    dyn->attack_q15 = time_coef_q15(config->attack_ms);
+    dyn->release_q15 = time_coef_q15(config->release_ms);
+    dyn->volume_target_q15 = volume_q15(config->volume_pct);
+    dyn->volume_step_q15 = config->volume_ramp_ms ? Q15_UNITY / (int32_t)config->volume_ramp_ms : Q15_UNITY;
+    dyn->ceiling = (int32_t)(32768.0f * powf(10.0f, (float)config->ceiling_db / 20.0f));
+    dyn->ceiling = dyn->ceiling < INT16_MAX ? dyn->ceiling : INT16_MAX;
+    dyn->limit_release_q15 = time_coef_q15(config->limiter_release_ms);
+    audio_dynamics_reset(dyn);
+    audio_dynamics_reset_stats(dyn);
+    *out_dyn = dyn;
+    return ESP_OK;
+}
+
+void audio_dynamics_destroy(audio_dynamics_t* dyn) {
+    if (!dyn) {
+        return;
+    }
+    free(dyn->delay);
+    free(dyn);
+}
+
+size_t audio_dynamics_block_samples(const audio_dynamics_t* dyn) {
+    return dyn->block;
+}
+
+// Takes one block in, puts the block lookahead_ms older out in its place
+static void process_block(audio_dynamics_t* dyn, int16_t* io) {
+    const size_t block = dyn->block;
+
+    int32_t peak = 0;
+    for (size_t i = 0; i < block; i++) {
+        int32_t a = io[i] < 0 ? -io[i] : io[i];
+        peak = a > peak ? a : peak;
+    }
+
+    // Compressor: smoothed peak level, reduced by the ratio above threshold
+    int32_t level = peak > 0 ? log2_q8((uint32_t)peak) - 15 * LOG_ONE : LOG_FLOOR;
+    int32_t coef = level > dyn->env_log ? dyn->attack_q15 : dyn->release_q15;
+    dyn->env_log += ((level - dyn->env_log) * coef) >> 15;
+    int32_t reduce = 0;
+    if (dyn->env_log > dyn->threshold_log) {
+        reduce = ((dyn->env_log - dyn->threshold_log) * dyn->slope_q15) >> 15;
+        dyn->stats.compressed_blocks++;
+        dyn->max_reduce_log = reduce > dyn->max_reduce_log ? reduce : dyn->max_reduce_log;
+    }
+
+    int32_t target = dyn->volume_target_q15;
+    if (dyn->volume_q15 < target) {
+        dyn->volume_q15 = target - dyn->volume_q15 > dyn->volume_step_q15 ? dyn->volume_q15 + dyn->volume_step_q15 : target;
+    } else if (dyn->volume_q15 > target) {
+        dyn->volume_q15 = dyn->volume_q15 - target > dyn->volume_step_q15 ? dyn->volume_q15 - dyn->volume_step_q15 : target;
+    }
+    int32_t gain = (int32_t)(((int64_t)exp2_q8_q15(dyn->makeup_log - reduce) * dyn->volume_q15) >> 15);
+
+    // The gain ramps from the previous block's, so the peak may meet either
+    int32_t worst = gain > dyn->last_pre_gain ? gain : dyn->last_pre_gain;
+    int64_t loud = ((int64_t)peak * worst) >> 15;
+    int32_t need = loud > dyn->ceiling ? (int32_t)(((int64_t)dyn->ceiling << 15) / loud) : Q15_UNITY;
+    dyn->last_pre_gain = gain;
+
+    uint32_t newest = (dyn->out_slot + dyn->slots - 1) % dyn->slots;
+    memcpy(dyn->delay + newest * block, io, block * sizeof(int16_t));
+    dyn->pre_gain[newest] = gain;
+    dyn->need[newest] = need;
+
+    // Limiter: release toward unity, but head for every block in the
+    // look-ahead window in a straight line that reaches its need just
+    // before it goes out. Both ends of the ramp over the block going out
+    // are then within its need, so nothing crosses the ceiling.
+    int32_t g = dyn->limit_q15;
+    int32_t next = g + (int32_t)(((int64_t)(Q15_UNITY - g) * dyn->limit_release_q15) >> 15);
+    for (uint32_t i = 0; i < dyn->slots; i++) {
+        int32_t n = dyn->need[(dyn->out_slot + i) % dyn->slots];
+        if (n < next) {
+            int32_t c = i == 0 ? n : g + (n - g) / (int32_t)i;
+            next = c < next ? c : next;
+        }
+    }
+    dyn->limit_q15 = next;
+    if (next < Q15_UNITY) {
+        dyn->stats.limited_blocks++;
+        dyn->min_limit_q15 = next < dyn->min_limit_q15 ? next : dyn->min_limit_q15;
+    }
+
+    uint32_t out = dyn->out_slot;
+    int16_t total_q10 = q15_to_q10((int32_t)(((int64_t)dyn->pre_gain[out] * next) >> 15));
+    memcpy(io, dyn->delay + out * block, block * sizeof(int16_t));
+    audio_dsp_gain_ramp_s16(io, block, dyn->last_total_q10, total_q10);
+    dyn->last_total_q10 = total_q10;
+    dyn->out_slot = (out + 1) % dyn->slots;
+    dyn->stats.blocks++;
+}
+
+void audio_dynamics_process(audio_dynamics_t* dyn, int16_t* samples, size_t count) {
+    for (size_t i = 0; i + dyn->block <= count; i += dyn->block) {
+        process_block(dyn, samples + i);
+    }
+    dyn->pending = true;
+}
+
+size_t audio_dynamics_drain(audio_dynamics_t* dyn, int16_t* out) {
+    if (!dyn->pending) {
+        return 0;
+    }
+    // Silence pushes the delayed blocks out with the gains already planned
+    size_t count = (dyn->slots - 1) * dyn->block;
+    memset(out, 0, count * sizeof(int16_t));
+    for (size_t i = 0; i < count; i += dyn->block) {
+        process_block(dyn, out + i);
+    }
+    dyn->pending = false;
+    return count;
+}
+
+void audio_dynamics_set_volume(audio_dynamics_t* dyn, uint32_t volume_pct) {
+    dyn->volume_target_q15 = volume_q15(volume_pct);
+}
+
+void audio_dynamics_get_stats(const audio_dynamics_t* dyn, audio_dynamics_stats_t* stats) {
+    *stats = dyn->stats;
+    stats->max_limit_db = dyn->min_limit_q15 < Q15_UNITY ? log_to_db(15 * LOG_ONE - log2_q8(dyn->min_limit_q15 > 0 ? dyn->min_limit_q15 : 1)) : 0;
+    stats->max_compress_db = log_to_db(dyn->max_reduce_log);
+}
+
+void audio_dynamics_reset_stats(audio_dynamics_t* dyn) {
+    memset(&dyn->stats, 0, sizeof(dyn->stats));
+    dyn->min_limit_q15 = Q15_UNITY;
+    dyn->max_reduce_log = 0;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Fixed-point dynamics for 16-bit mono speaker audio
+ *
+ * Three stages run on 1 ms blocks, all in integer arithmetic:
+ *
+ * - Compressor: the block peak is tracked in a log2 domain with separate
+ *   attack and release times; above the threshold the level is reduced by
+ *   the ratio, then makeup gain lifts the whole signal. On a small driver
+ *   this trades peaks, which it cannot reproduce, for loudness.
+ * - Master volume, ramped toward its target so changes do not click.
+ * - Look-ahead limiter: audio is delayed by lookahead_ms while the gain
+ *   each block needs to stay under the ceiling is known in advance, so
+ *   the gain ramps down before a peak arrives instead of clipping it.
+ *
+ * Gains change linearly across each block. The delay is the only latency
+ * added; audio_dynamics_drain pushes the delayed tail out when a stream
+ * ends. Not thread-safe except audio_dynamics_set_volume.
+ */
+typedef struct audio_dynamics audio_dynamics_t;
+
+/** Longest limiter look-ahead */
+#define AUDIO_DYNAMICS_MAX_LOOKAHEAD_MS 8
+
+/**
+ * @brief Processor settings
+ */
+typedef struct {
+    uint32_t sample_rate;       ///< Multiple of 1000
+    uint32_t lookahead_ms;      ///< Limiter look-ahead and added latency, 1 .. AUDIO_DYNAMICS_MAX_LOOKAHEAD_MS
+    int32_t ceiling_db;         ///< Limiter ceiling in dBFS
+    uint32_t limiter_release_ms;
+    int32_t threshold_db;       ///< Compressor threshold in dBFS
+    uint32_t ratio;             ///< n:1 above the threshold, 1 disables the compressor
+    uint32_t attack_ms;
+    uint32_t release_ms;
+    int32_t makeup_db;          ///< Gain after compression
+    uint32_t volume_pct;        ///< Initial master volume, 0 .. 100
+    uint32_t volume_ramp_ms;    ///< Time a change from mute to full volume takes
+} audio_dynamics_config_t;
+
+#define AUDIO_DYNAMICS_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,                 \
+    .lookahead_ms = 2,                    \
+    .ceiling_db = -1,                     \
+    .limiter_release_ms = 60,             \
+    .threshold_db = -18,                  \
+    .ratio = 3,                           \
+    .attack_ms = 5,                       \
+    .release_ms = 150,                    \
+    .makeup_db = 6,                       \
+    .volume_pct = 100,                    \
+    .volume_ramp_ms = 50,                 \
+}
+
+/**
+ * @brief Processing statistics since create or audio_dynamics_reset_stats
+ */
+typedef struct {
+    uint32_t blocks;                ///< 1 ms blocks processed
+    uint32_t limited_blocks;        ///< Blocks the limiter turned down
+    uint32_t compressed_blocks;     ///< Blocks above the compressor threshold
+    uint32_t max_limit_db;          ///< Deepest limiter gain reduction
+    uint32_t max_compress_db;       ///< Deepest compressor gain reduction
+} audio_dynamics_stats_t;
+
+/**
+ * @brief Create a processor
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_dynamics_create(const audio_dynamics_config_t* config, audio_dynamics_t** out_dyn);
+
+/**
+ * @brief Free a processor
+ */
+void audio_dynamics_destroy(audio_dynamics_t* dyn);
+
+/**
+ * @brief Samples per processing block (1 ms)
+ */
+size_t audio_dynamics_block_samples(const audio_dynamics_t* dyn);
+
+/**
+ * @brief Process audio in place
+ *
+ * The output is the input delayed by the look-ahead: the first call
+ * returns lookahead_ms of silence at its start.
+ *
+ * @param samples Audio, replaced by the processed, delayed audio
+ * @param count Number of samples, a multiple of audio_dynamics_block_samples
+ */
+void audio_dynamics_process(audio_dynamics_t* dyn, int16_t* samples, size_t count);
+
+/**
+ * @brief Take the delayed tail after the last audio_dynamics_process
+ *
+ * @param out Receives up to lookahead_ms of samples
+ * @return Samples written, 0 if nothing is pending
+ */
+size_t audio_dynamics_drain(audio_dynamics_t* dyn, int16_t* out);
+
+/**
+ * @brief Drop delayed audio and forget the signal level; volume is kept
+ */
+void audio_dynamics_reset(audio_dynamics_t* dyn);
+
+/**
+ * @brief Set the master volume; the gain ramps to it over the next blocks
+ *
+ * Safe to call from any task. The percentage maps to gain on a square
+ * law, so 50 % is about -12 dB.
+ *
+ * @param volume_pct 0 (mute) .. 100
+ */
+void audio_dynamics_set_volume(audio_dynamics_t* dyn, uint32_t volume_pct);
+
+/**
+ * @brief Get processing statistics
+ */
+void audio_dynamics_get_stats(const audio_dynamics_t* dyn, audio_dynamics_stats_t* stats);
+
+/**
+ * @brief Clear the statistics
+ */
+void audio_dynamics_reset_stats(audio_dynamics_t* dyn);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,189 @@
+#include "audio_jitter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Clean playout that relaxes the late-chunk boost by 1 ms
+#define JITTER_RELAX_MS     100
+// Smoothing of the jitter estimate, as in RFC 3550
+#define JITTER_GAIN_SHIFT   4
+
+struct audio_jitter {
+    audio_jitter_config_t config;
+    uint32_t samples_per_ms;
+    int16_t* buf;
+    size_t capacity;            // samples
+    size_t read_pos;
+    size_t count;
+    bool playing;
+    bool starved;               // ran dry with the stream still going
+    int64_t starved_us;
+    bool has_last;
+    int64_t last_put_us;
+    int64_t last_duration_us;   // of the previous chunk
+    int32_t jitter_us;
+    uint32_t boost_ms;          // added by late chunks
+    uint32_t clean_samples;     // played since the boost last moved
+    uint32_t chunks;
+    uint32_t late;
+    uint32_t early;
+    uint64_t gap_us;
+    uint64_t dropped_samples;
+    size_t max_count;
+};
+
+static uint32_t target_ms(const audio_jitter_t* jb) {
+    uint32_t jitter_ms = (uint32_t)(jb->jitter_us * AUDIO_JITTER_MULT / 1000);
+    uint32_t target = (jitter_ms > jb->config.start_ms ? jitter_ms : jb->config.start_ms) + jb->boost_ms;
+    return target < jb->config.max_ms ? target : jb->config.max_ms;
+}
+
+esp_err_t audio_jitter_create(const audio_jitter_config_t* config, audio_jitter_t** out_jb) {
+    if (!config || !out_jb || config->sample_rate < 1000 || config->start_ms == 0 ||
+        config->max_ms < config->start_ms || config->capacity_ms <= config->max_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    audio_jitter_t* jb = calloc(1, sizeof(audio_jitter_t));
+    if (!jb) {
+        return ESP_ERR_NO_MEM;
+    }
+    jb->config = *config;
+    jb->samples_per_ms = config->sample_rate / 1000;
+    jb->capacity = (size_t)config->capacity_ms * jb->samples_per_ms;
+    jb->buf = malloc(jb->capacity * sizeof(int16_t));
+    if (!jb->buf) {
+        free(jb);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_jb = jb;
+    return ESP_OK;
+}
+
+void audio_jitter_destroy(audio_jitter_t* jb) {
+    if (!jb) {
+        return;
+    }
+    free(jb->buf);
+    free(jb);
+}
+
+void audio_jitter_flush(audio_jitter_t* jb) {
+    jb->read_pos = 0;
+    jb->count = 0;
+    jb->playing = false;
+    jb->starved = false;
+    jb->has_last = false;
+}
+
+// Copies samples into the ring; what does not fit counts as dropped
+static size_t store(audio_jitter_t* jb, const int16_t* samples, size_t count) {
+    size_t space = jb->capacity - jb->count;
+    size_t take = count < space ? count : space;
+    size_t write_pos = (jb->read_pos + jb->count) % jb->capacity;
+    size_t first = jb->capacity - write_pos;
+    first = first < take ? first : take;
+    memcpy(jb->buf + write_pos, samples, first * sizeof(int16_t));
+    memcpy(jb->buf, samples + first, (take - first) * sizeof(int16_t));
+    jb->count += take;
+    jb->dropped_samples += count - take;
+    jb->max_count = jb->count > jb->max_count ? jb->count : jb->max_count;
+    return take;
+}
+
+size_t audio_jitter_put(audio_jitter_t* jb, const int16_t* samples, size_t count, int64_t now_us) {
+    const int64_t talkspurt_us = (int64_t)AUDIO_JITTER_TALKSPURT_MS * 1000;
+    const size_t target = (size_t)target_ms(jb) * jb->samples_per_ms;
+    jb->chunks++;
+
+    // Spacing versus the previous chunk's duration is the transit time
+    // difference; a long silence is a new stream, not network delay
+    bool continues = jb->has_last && now_us - jb->last_put_us < talkspurt_us;
+    if (continues) {
+        int64_t d = now_us - jb->last_put_us - jb->last_duration_us;
+        d = d < 0 ? -d : d;
+        jb->jitter_us += (int32_t)((d - jb->jitter_us) >> JITTER_GAIN_SHIFT);
+    }
+
+    if (jb->starved && continues) {
+        // The target was short by the gap; raise it by that and a margin
+        int64_t gap_us = now_us - jb->starved_us;
+        jb->late++;
+        jb->gap_us += gap_us;
+        jb->boost_ms += (uint32_t)(gap_us / 1000) + AUDIO_JITTER_LATE_STEP_MS;
+        jb->boost_ms = jb->boost_ms < jb->config.max_ms ? jb->boost_ms : jb->config.max_ms;
+        jb->clean_samples = 0;
+    } else if (jb->count > 2 * target) {
+        jb->early++;
+    }
+    jb->starved = false;
+
+    jb->has_last = true;
+    jb->last_put_us = now_us;
+    jb->last_duration_us = (int64_t)count * 1000 / jb->samples_per_ms;
+    return store(jb, samples, count);
+}
+
+size_t audio_jitter_append(audio_jitter_t* jb, const int16_t* samples, size_t count) {
+    // The arrival was timed by its first slice; the rest only lengthen it
+    jb->last_duration_us += (int64_t)count * 1000 / jb->samples_per_ms;
+    return store(jb, samples, count);
+}
+
+size_t audio_jitter_get(audio_jitter_t* jb, int16_t* out, size_t count, int64_t now_us) {
+    const uint32_t target = target_ms(jb);
+
+    if (!jb->playing) {
+        // Start at the target depth, or play what there is once arrivals stop
+        bool paused = jb->has_last && now_us - jb->last_put_us >= (int64_t)target * 1000;
+        if (jb->count == 0 || (jb->count < (size_t)target * jb->samples_per_ms && !paused)) {
+            return 0;
+        }
+        jb->playing = true;
+    }
+
+    size_t take = count < jb->count ? count : jb->count;
+    size_t first = jb->capacity - jb->read_pos;
+    first = first < take ? first : take;
+    memcpy(out, jb->buf + jb->read_pos, first * sizeof(int16_t));
+    memcpy(out + first, jb->buf, (take - first) * sizeof(int16_t));
+    jb->read_pos = (jb->read_pos + take) % jb->capacity;
+    jb->count -= take;
+
+    if (take < count) {
+        // Dry: a stall if more arrives, the end of the stream if not
+        jb->playing = false;
+        jb->starved = true;
+        jb->starved_us = now_us;
+    } else if (jb->boost_ms > 0) {
+        jb->clean_samples += take;
+        if (jb->clean_samples >= JITTER_RELAX_MS * jb->samples_per_ms) {
+            jb->clean_samples -= JITTER_RELAX_MS * jb->samples_per_ms;
+            jb->boost_ms--;
+        }
+    }
+    return take;
+}
+
+uint32_t audio_jitter_depth_ms(const audio_jitter_t* jb) {
+    return (uint32_t)(jb->count / jb->samples_per_ms);
+}
+
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats) {
+    stats->chunks = jb->chunks;
+    stats->late = jb->late;
+    stats->early = jb->early;
+    stats->gap_ms = (uint32_t)(jb->gap_us / 1000);
+    stats->dropped_ms = (uint32_t)(jb->dropped_samples / jb->samples_per_ms);
+    stats->depth_ms = audio_jitter_depth_ms(jb);
+    stats->max_depth_ms = (uint32_t)(jb->max_count / jb->samples_per_ms);
+    stats->target_ms = target_ms(jb);
+    stats->jitter_ms = (uint32_t)(jb->jitter_us / 1000);
+}
+
+void audio_jitter_reset_stats(audio_jitter_t* jb) {
+    jb->chunks = 0;
+    jb->late = 0;
+    jb->early = 0;
+    jb->gap_us = 0;
+    jb->dropped_samples = 0;
+    jb->max_count = jb->count;
+}
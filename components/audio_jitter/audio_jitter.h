@@ -0,0 +1,150 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Adaptive playout buffer for 16-bit mono PCM arriving in bursts
+ *
+ * Chunks are stored as they arrive and played from a circular sample
+ * buffer. Playout starts (and restarts after running dry) once the buffer
+ * holds the target depth. The target follows the measured arrival jitter:
+ * an RFC 3550 style estimate of how far chunk spacing strays from chunk
+ * duration, times AUDIO_JITTER_MULT, raised by the length of every gap
+ * playback had to wait through and relaxed again while it runs clean.
+ * When nothing has arrived for a target's worth of time the stream is
+ * taken to have paused and whatever is buffered plays out without waiting
+ * for the target depth.
+ *
+ * A chunk is late if playback ran dry waiting for it, and early if it
+ * arrived with more than twice the target depth already buffered, i.e. in
+ * a burst the buffer had no use for. A chunk that follows more than
+ * AUDIO_JITTER_TALKSPURT_MS of silence starts a new stream and is neither.
+ *
+ * Not thread-safe: the caller serializes audio_jitter_put and
+ * audio_jitter_get. Times are passed in so the buffer can be driven from
+ * a simulated clock.
+ */
+typedef struct audio_jitter audio_jitter_t;
+
+/**
+ * @brief Buffer sizing
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t capacity_ms;   ///< Storage; chunks that do not fit are dropped
+    uint32_t start_ms;      ///< Depth required before playout starts, and the lowest target
+    uint32_t max_ms;        ///< Highest target depth
+} audio_jitter_config_t;
+
+#define AUDIO_JITTER_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,               \
+    .capacity_ms = 1500,                \
+    .start_ms = 80,                     \
+    .max_ms = 400,                      \
+}
+
+/** Target depth in units of the jitter estimate */
+#define AUDIO_JITTER_MULT           3
+/** Margin a late chunk adds to the target on top of the gap it caused */
+#define AUDIO_JITTER_LATE_STEP_MS   20
+/** Silence after which arrivals start a new stream */
+#define AUDIO_JITTER_TALKSPURT_MS   1000
+
+/**
+ * @brief Buffer statistics since create or audio_jitter_reset_stats
+ */
+typedef struct {
+    uint32_t chunks;            ///< Chunks put
+    uint32_t late;              ///< Chunks that arrived after playback ran dry
+    uint32_t early;             ///< Chunks that arrived above twice the target depth
+    uint32_t gap_ms;            ///< Silence played while waiting for late chunks
+    uint32_t dropped_ms;        ///< Audio dropped because the buffer was full
+    uint32_t depth_ms;          ///< Currently buffered
+    uint32_t max_depth_ms;      ///< Deepest the buffer has been
+    uint32_t target_ms;         ///< Current target depth
+    uint32_t jitter_ms;         ///< Current arrival jitter estimate
+} audio_jitter_stats_t;
+
+/**
+ * @brief Create a playout buffer
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_jitter_create(const audio_jitter_config_t* config, audio_jitter_t** out_jb);
+
+/**
+ * @brief Free a playout buffer
+ */
+void audio_jitter_destroy(audio_jitter_t* jb);
+
+/**
+ * @brief Drop buffered audio and wait for the start depth again
+ *
+ * The jitter estimate and target are kept, so the next stream starts with
+ * what was learned about the network.
+ */
+void audio_jitter_flush(audio_jitter_t* jb);
+
+/**
+ * @brief Store an arriving chunk
+ *
+ * A chunk stored in slices is put with its first slice and the rest
+ * appended with audio_jitter_append, so it counts as one arrival.
+ *
+ * @param samples Chunk samples
+ * @param count Number of samples
+ * @param now_us Arrival time
+ * @return Samples stored; the rest did not fit and counts as dropped
+ */
+size_t audio_jitter_put(audio_jitter_t* jb, const int16_t* samples, size_t count, int64_t now_us);
+
+/**
+ * @brief Store the next slice of the chunk last put
+ *
+ * Lengthens that arrival without timing a new one, so slicing a chunk
+ * does not read as arrival jitter.
+ *
+ * @param samples Slice samples
+ * @param count Number of samples
+ * @return Samples stored; the rest did not fit and counts as dropped
+ */
+size_t audio_jitter_append(audio_jitter_t* jb, const int16_t* samples, size_t count);
+
+/**
+ * @brief Take samples for playback
+ *
+ * Returns count samples while playing, 0 while buffering, and fewer than
+ * count when a paused stream plays out its last samples.
+ *
+ * @param out Receives up to count samples
+ * @param count Samples wanted, normally one playout period
+ * @param now_us Current time
+ * @return Samples written to out
+ */
+size_t audio_jitter_get(audio_jitter_t* jb, int16_t* out, size_t count, int64_t now_us);
+
+/**
+ * @brief Buffered audio in milliseconds
+ */
+uint32_t audio_jitter_depth_ms(const audio_jitter_t* jb);
+
+/**
+ * @brief Get buffer statistics
+ */
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats);
+
+/**
+ * @brief Clear the counters; depth, target and jitter are kept
+ */
+void audio_jitter_reset_stats(audio_jitter_t* jb);
+
+#ifdef __cplusplus
+}
+#endif
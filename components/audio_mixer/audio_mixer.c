@@ -0,0 +1,187 @@
+#include "audio_mixer.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "audio_dsp.h"
+#include "audio_ring.h"
+
+typedef struct {
+    audio_ring_t* queue;
+    volatile int16_t gain_q10;
+    volatile int16_t duck_q10;
+    int16_t current_q10;        // gain the last period ended on
+} mixer_channel_t;
+
+struct audio_mixer {
+    audio_mixer_config_t config;
+    size_t period;              // samples
+    int16_t max_step_q10;       // gain change allowed per period
+    int16_t* scratch;           // one channel's period while it is scaled
+    mixer_channel_t channels[AUDIO_MIXER_MAX_CHANNELS];
+};
+
+esp_err_t audio_mixer_create(const audio_mixer_config_t* config, audio_mixer_t** out_mixer) {
+    if (!config || !out_mixer || config->channels == 0 || config->channels > AUDIO_MIXER_MAX_CHANNELS ||
+        config->sample_rate < 1000 || config->period_ms == 0 || config->queue_periods == 0 ||
+        (config->queue_periods & (config->queue_periods - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    audio_mixer_t* mixer = calloc(1, sizeof(audio_mixer_t));
+    if (!mixer) {
+        return ESP_ERR_NO_MEM;
+    }
+    mixer->config = *config;
+    mixer->period = (size_t)config->sample_rate / 1000 * config->period_ms;
+    uint32_t step = config->ramp_ms ? AUDIO_DSP_GAIN_UNITY * config->period_ms / config->ramp_ms : INT16_MAX;
+    mixer->max_step_q10 = (int16_t)(step > INT16_MAX ? INT16_MAX : (step > 0 ? step : 1));
+
+    // Aligned like the queue slots so both sides of every add can vectorize
+    mixer->scratch = heap_caps_aligned_alloc(16, mixer->period * sizeof(int16_t), MALLOC_CAP_8BIT);
+    bool ok = mixer->scratch != NULL;
+    for (uint32_t ch = 0; ok && ch < config->channels; ch++) {
+        mixer_channel_t* c = &mixer->channels[ch];
+        c->gain_q10 = AUDIO_DSP_GAIN_UNITY;
+        c->duck_q10 = AUDIO_DSP_GAIN_UNITY;
+        c->current_q10 = AUDIO_DSP_GAIN_UNITY;
+        ok = audio_ring_create(config->queue_periods, mixer->period * sizeof(int16_t), MALLOC_CAP_8BIT,
+                               &c->queue) == ESP_OK;
+    }
+    if (!ok) {
+        audio_mixer_destroy(mixer);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_mixer = mixer;
+    return ESP_OK;
+}
+
+void audio_mixer_destroy(audio_mixer_t* mixer) {
+    if (!mixer) {
+        return;
+    }
+    for (uint32_t ch = 0; ch < mixer->config.channels; ch++) {
+        if (mixer->channels[ch].queue) {
+            audio_ring_delete(mixer->channels[ch].queue);
+        }
+    }
+    heap_caps_free(mixer->scratch);
+    free(mixer);
+}
+
+size_t audio_mixer_period_samples(const audio_mixer_t* mixer) {
+    return mixer->period;
+}
+
+size_t audio_mixer_write(audio_mixer_t* mixer, uint32_t channel, const int16_t* samples, size_t count) {
+    if (channel >= mixer->config.channels) {
+        return 0;
+    }
+    audio_ring_t* queue = mixer->channels[channel].queue;
+    size_t done = 0;
+    while (done < count) {
+        int16_t* slot = audio_ring_write_acquire(queue);
+        if (!slot) {
+            break;
+        }
+        size_t n = count - done < mixer->period ? count - done : mixer->period;
+        memcpy(slot, samples + done, n * sizeof(int16_t));
+        audio_ring_write_commit(queue, n * sizeof(int16_t));
+        done += n;
+    }
+    return done;
+}
+
+void audio_mixer_set_gain(audio_mixer_t* mixer, uint32_t channel, int16_t gain_q10) {
+    if (channel < mixer->config.channels) {
+        mixer->channels[channel].gain_q10 = gain_q10 < 0 ? 0 : gain_q10;
+    }
+}
+
+void audio_mixer_set_duck(audio_mixer_t* mixer, uint32_t channel, int16_t duck_q10) {
+    if (channel < mixer->config.channels) {
+        mixer->channels[channel].duck_q10 = duck_q10 < 0 ? 0 : duck_q10;
+    }
+}
+
+void audio_mixer_flush(audio_mixer_t* mixer, uint32_t channel) {
+    if (channel < mixer->config.channels) {
+        audio_ring_flush(mixer->channels[channel].queue);
+    }
+}
+
+bool audio_mixer_is_busy(const audio_mixer_t* mixer) {
+    for (uint32_t ch = 0; ch < mixer->config.channels; ch++) {
+        if (audio_ring_count(mixer->channels[ch].queue) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t audio_mixer_mix(audio_mixer_t* mixer, int16_t* out) {
+    const uint32_t channels = mixer->config.channels;
+    const size_t period = mixer->period;
+    const int16_t* slots[AUDIO_MIXER_MAX_CHANNELS];
+    size_t lens[AUDIO_MIXER_MAX_CHANNELS];
+    int16_t ducks[AUDIO_MIXER_MAX_CHANNELS];
+    bool any = false;
+
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        slots[ch] = audio_ring_read_acquire(mixer->channels[ch].queue, &lens[ch]);
+        lens[ch] /= sizeof(int16_t);
+        ducks[ch] = mixer->channels[ch].duck_q10;
+        any |= slots[ch] != NULL;
+    }
+    if (!any) {
+        return 0;
+    }
+
+    bool first = true;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        mixer_channel_t* c = &mixer->channels[ch];
+
+        // Every other playing channel's duck applies on top of the gain
+        int32_t target = c->gain_q10;
+        for (uint32_t other = 0; other < channels; other++) {
+            if (other != ch && slots[other]) {
+                target = (target * ducks[other]) >> 10;
+            }
+        }
+        target = target < INT16_MAX ? target : INT16_MAX;
+        if (!slots[ch]) {
+            // A channel that starts later starts at its gain, nothing to ramp from
+            c->current_q10 = (int16_t)target;
+            continue;
+        }
+
+        int32_t from = c->current_q10;
+        int32_t to = target;
+        if (to > from + mixer->max_step_q10) {
+            to = from + mixer->max_step_q10;
+        } else if (to < from - mixer->max_step_q10) {
+            to = from - mixer->max_step_q10;
+        }
+        c->current_q10 = (int16_t)to;
+
+        // The first channel is scaled in the output buffer itself, later
+        // ones in scratch; a full period at unity is added straight from
+        // its slot
+        if (!first && from == to && to == AUDIO_DSP_GAIN_UNITY && lens[ch] == period) {
+            audio_dsp_mix_s16(out, slots[ch], period);
+        } else {
+            int16_t* dst = first ? out : mixer->scratch;
+            memcpy(dst, slots[ch], lens[ch] * sizeof(int16_t));
+            memset(dst + lens[ch], 0, (period - lens[ch]) * sizeof(int16_t));
+            if (from != to) {
+                audio_dsp_gain_ramp_s16(dst, period, (int16_t)from, (int16_t)to);
+            } else if (to != AUDIO_DSP_GAIN_UNITY) {
+                audio_dsp_gain_s16(dst, period, (int16_t)to);
+            }
+            if (!first) {
+                audio_dsp_mix_s16(out, dst, period);
+            }
+        }
+        first = false;
+        audio_ring_read_release(c->queue);
+    }
+    return period;
+}
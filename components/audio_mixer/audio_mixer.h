@@ -0,0 +1,123 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Mixer for several 16-bit mono sources sharing one output
+ *
+ * Every channel has its own queue of period-sized slots, filled by one
+ * producer task with audio_mixer_write. The task that feeds the output
+ * calls audio_mixer_mix once per period; it takes one slot from every
+ * channel that has one, applies each channel's gain and sums them with
+ * saturating int16 adds (vector instructions on the ESP32-S3).
+ *
+ * A channel with a duck gain below unity scales every other channel by it
+ * while it is playing, e.g. to pull the response voice down under a
+ * notification. Gain changes, ducking included, ramp sample by sample at
+ * no more than unity per ramp_ms, so they do not click.
+ *
+ * Writes are cut into periods. A period left short by the end of a write
+ * plays padded with silence, so streaming writers should write whole
+ * periods.
+ */
+typedef struct audio_mixer audio_mixer_t;
+
+/** Most channels a mixer can have */
+#define AUDIO_MIXER_MAX_CHANNELS    8
+
+/**
+ * @brief Mixer sizing
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t channels;      ///< 1 .. AUDIO_MIXER_MAX_CHANNELS
+    uint32_t period_ms;     ///< Audio produced per audio_mixer_mix
+    uint32_t queue_periods; ///< Queue per channel in periods (power of two)
+    uint32_t ramp_ms;       ///< Time a unity gain change takes; 0 makes any change within one period
+} audio_mixer_config_t;
+
+#define AUDIO_MIXER_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,              \
+    .channels = 2,                     \
+    .period_ms = 20,                   \
+    .queue_periods = 16,               \
+    .ramp_ms = 20,                     \
+}
+
+/**
+ * @brief Create a mixer; channels start at unity gain and no ducking
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_mixer_create(const audio_mixer_config_t* config, audio_mixer_t** out_mixer);
+
+/**
+ * @brief Free a mixer
+ */
+void audio_mixer_destroy(audio_mixer_t* mixer);
+
+/**
+ * @brief Samples produced by each audio_mixer_mix
+ */
+size_t audio_mixer_period_samples(const audio_mixer_t* mixer);
+
+/**
+ * @brief Queue audio on a channel without waiting
+ *
+ * Only one task may write to a given channel.
+ *
+ * @param channel Channel index
+ * @param samples Audio to queue
+ * @param count Number of samples
+ * @return Samples queued; fewer than count when the channel's queue is full
+ */
+size_t audio_mixer_write(audio_mixer_t* mixer, uint32_t channel, const int16_t* samples, size_t count);
+
+/**
+ * @brief Set a channel's gain; may be called from any task
+ *
+ * @param gain_q10 Gain in Q10 (AUDIO_DSP_GAIN_UNITY = 0 dB), 0 .. 32767
+ */
+void audio_mixer_set_gain(audio_mixer_t* mixer, uint32_t channel, int16_t gain_q10);
+
+/**
+ * @brief Set the gain a channel applies to all others while it plays
+ *
+ * Ducks from several playing channels multiply. May be called from any task.
+ *
+ * @param duck_q10 Gain in Q10, AUDIO_DSP_GAIN_UNITY for no ducking
+ */
+void audio_mixer_set_duck(audio_mixer_t* mixer, uint32_t channel, int16_t duck_q10);
+
+/**
+ * @brief Drop a channel's queued audio (mixing task only)
+ */
+void audio_mixer_flush(audio_mixer_t* mixer, uint32_t channel);
+
+/**
+ * @brief Check whether any channel has audio queued
+ */
+bool audio_mixer_is_busy(const audio_mixer_t* mixer);
+
+/**
+ * @brief Mix the next period
+ *
+ * Channels with nothing queued are skipped; when every channel is empty
+ * nothing is produced, so an idle mixer adds no silence to the output.
+ *
+ * @param out Receives audio_mixer_period_samples samples; 16-byte aligned
+ *            for the vector path
+ * @return audio_mixer_period_samples, or 0 when every channel is empty
+ */
+size_t audio_mixer_mix(audio_mixer_t* mixer, int16_t* out);
+
+#ifdef __cplusplus
+}
+#endif
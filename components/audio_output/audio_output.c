@@ -3,7 +3,12 @@
 #include "driver/i2s.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+#include "media_clock.h"
+#include "latency_trace.h"
 
 #define TAG "AUDIO_OUTPUT"
 
@@ -13,10 +18,88 @@
 #define I2S_WS_PIN      0   // I2S word select pin
 #define I2S_DATA_PIN    2   // I2S data pin
 #define I2S_BUFFER_SIZE 2048
+#define I2S_DMA_BUF_COUNT 8
+#define I2S_DMA_BUF_FRAMES (I2S_BUFFER_SIZE / 4)
+// A write that takes longer than this waited for DMA space
+#define I2S_BLOCKED_US  1000
+// Driver event queue; one TX-done arrives per DMA buffer played
+#define I2S_EVENT_QUEUE_LEN 8
+
+// The event task shares the audio core with the other real-time tasks
+#define OUTPUT_EVENT_CORE   (portNUM_PROCESSORS - 1)
+
+// s_events bits
+#define OUTPUT_EVENT_DRAINED    (1 << 0)    // everything written has played
+#define OUTPUT_EVENT_TASK_EXIT  (1 << 1)
+#define OUTPUT_EVENT_SPACE      (1 << 2)    // a DMA buffer was freed, or the queue flushed
 
 static SemaphoreHandle_t s_audio_mutex = NULL;
 static bool s_is_initialized = false;
-static bool s_is_playing = false;
+static bool s_standby = false;
+static audio_output_tap_cb_t s_tap_cb = NULL;
+static void* s_tap_user_data = NULL;
+static size_t s_bytes_per_frame = 2;
+static uint32_t s_sample_rate = 16000;
+
+static QueueHandle_t s_i2s_events = NULL;
+static EventGroupHandle_t s_events = NULL;
+static TaskHandle_t s_event_task = NULL;
+
+// Playback position, written by writers and the event task
+static portMUX_TYPE s_pos_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t s_written_frames;
+static uint64_t s_played_frames;
+static uint32_t s_lead_buffers;     // buffers that finish before s_played_frames starts playing
+static int64_t s_buffer_start_us;   // when the DMA buffer now playing started
+static uint32_t s_zeroed_buffers;   // flushed buffers the DMA has yet to play through
+static volatile uint32_t s_flush_count;
+
+// Writes into an idle queue land in the buffer after the one playing now;
+// from then on every TX-done completes one buffer of written frames
+static void output_event_task(void* pv) {
+    i2s_event_t event;
+
+    while (xQueueReceive(s_i2s_events, &event, portMAX_DELAY) == pdTRUE) {
+        if (event.type == I2S_EVENT_MAX) {
+            break;
+        }
+        if (event.type != I2S_EVENT_TX_DONE) {
+            continue;
+        }
+
+        bool drained = false;
+        portENTER_CRITICAL(&s_pos_lock);
+        s_buffer_start_us = esp_timer_get_time();
+        if (s_zeroed_buffers > 0) {
+            s_zeroed_buffers--;
+        }
+        if (s_played_frames < s_written_frames) {
+            if (s_lead_buffers > 0) {
+                s_lead_buffers--;
+            } else {
+                uint64_t left = s_written_frames - s_played_frames;
+                s_played_frames += left < I2S_DMA_BUF_FRAMES ? left : I2S_DMA_BUF_FRAMES;
+                drained = s_played_frames == s_written_frames;
+            }
+        }
+        portEXIT_CRITICAL(&s_pos_lock);
+
+        xEventGroupSetBits(s_events, drained ? OUTPUT_EVENT_SPACE | OUTPUT_EVENT_DRAINED : OUTPUT_EVENT_SPACE);
+    }
+
+    xEventGroupSetBits(s_events, OUTPUT_EVENT_TASK_EXIT);
+    vTaskDelete(NULL);
+}
+
+// Everything queued is gone, played or discarded
+static void position_drained(void) {
+    portENTER_CRITICAL(&s_pos_lock);
+    s_played_frames = s_written_frames;
+    s_lead_buffers = 0;
+    s_zeroed_buffers = 0;
+    portEXIT_CRITICAL(&s_pos_lock);
+    xEventGroupSetBits(s_events, OUTPUT_EVENT_DRAINED);
+}
 
 esp_err_t audio_output_init(uint32_t sample_rate, uint8_t bits_per_sample, uint8_t channels) {
     if (s_is_initialized) {
@@ -26,8 +109,17 @@ esp_err_t audio_output_init(uint32_t sample_rate, uint8_t bits_per_sample, uint8
 
     // Create mutex for thread safety
     s_audio_mutex = xSemaphoreCreateMutex();
-    if (!s_audio_mutex) {
+    s_events = xEventGroupCreate();
+    if (!s_audio_mutex || !s_events) {
         ESP_LOGE(TAG, "Failed to create audio mutex");
+        if (s_audio_mutex) {
+            vSemaphoreDelete(s_audio_mutex);
+            s_audio_mutex = NULL;
+        }
+        if (s_events) {
+            vEventGroupDelete(s_events);
+            s_events = NULL;
+        }
         return ESP_ERR_NO_MEM;
     }
 
@@ -39,8 +131,8 @@ esp_err_t audio_output_init(uint32_t sample_rate, uint8_t bits_per_sample, uint8
         .channel_format = (channels == 1) ? I2S_CHANNEL_FMT_ONLY_RIGHT : I2S_CHANNEL_FMT_RIGHT_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
-        .dma_buf_len = I2S_BUFFER_SIZE / 4,
+        .dma_buf_count = I2S_DMA_BUF_COUNT,
+        .dma_buf_len = I2S_DMA_BUF_FRAMES,
         .use_apll = false,
         .tx_desc_auto_clear = true,
         .fixed_mclk = 0
@@ -53,26 +145,44 @@ esp_err_t audio_output_init(uint32_t sample_rate, uint8_t bits_per_sample, uint8
         .data_in_num = I2S_PIN_NO_CHANGE
     };
 
-    esp_err_t ret = i2s_driver_install(I2S_NUM, &i2s_config, 0, NULL);
+    esp_err_t ret = i2s_driver_install(I2S_NUM, &i2s_config, I2S_EVENT_QUEUE_LEN, &s_i2s_events);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install I2S driver: %d", ret);
         vSemaphoreDelete(s_audio_mutex);
+        vEventGroupDelete(s_events);
         s_audio_mutex = NULL;
+        s_events = NULL;
         return ret;
     }
 
     ret = i2s_set_pin(I2S_NUM, &pin_config);
+    if (ret == ESP_OK && xTaskCreatePinnedToCore(output_event_task, "audio_out_evt", 2048, NULL, 7,
+                                                 &s_event_task, OUTPUT_EVENT_CORE) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+    }
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set I2S pins: %d", ret);
+        ESP_LOGE(TAG, "Failed to set up I2S output: %d", ret);
         i2s_driver_uninstall(I2S_NUM);
         vSemaphoreDelete(s_audio_mutex);
+        vEventGroupDelete(s_events);
         s_audio_mutex = NULL;
+        s_events = NULL;
+        s_i2s_events = NULL;
         return ret;
     }
 
     s_is_initialized = true;
-    s_is_playing = false;
-    ESP_LOGI(TAG, "Audio output initialized: %lu Hz, %u bits, %u channels", 
+    s_standby = false;
+    s_bytes_per_frame = (bits_per_sample / 8) * channels;
+    s_sample_rate = sample_rate;
+    s_written_frames = 0;
+    s_played_frames = 0;
+    s_lead_buffers = 0;
+    s_zeroed_buffers = 0;
+    s_buffer_start_us = esp_timer_get_time();
+    xEventGroupSetBits(s_events, OUTPUT_EVENT_DRAINED);
+    media_clock_start(MEDIA_CLOCK_PLAYBACK, sample_rate, I2S_DMA_BUF_COUNT * I2S_DMA_BUF_FRAMES);
+    ESP_LOGI(TAG, "Audio output initialized: %lu Hz, %u bits, %u channels",
              sample_rate, bits_per_sample, channels);
     return ESP_OK;
 }
@@ -82,101 +192,224 @@ void audio_output_deinit(void) {
         return;
     }
 
+    // The event task reads the driver's queue, so it goes first
+    i2s_event_t stop = { .type = I2S_EVENT_MAX };
+    xQueueSend(s_i2s_events, &stop, portMAX_DELAY);
+    xEventGroupWaitBits(s_events, OUTPUT_EVENT_TASK_EXIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    s_event_task = NULL;
+
     if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
         i2s_driver_uninstall(I2S_NUM);
+        s_i2s_events = NULL;
         s_is_initialized = false;
-        s_is_playing = false;
         xSemaphoreGive(s_audio_mutex);
     }
+    position_drained();
 
     vSemaphoreDelete(s_audio_mutex);
+    vEventGroupDelete(s_events);
     s_audio_mutex = NULL;
+    s_events = NULL;
 
     ESP_LOGI(TAG, "Audio output deinitialized");
 }
 
+// Queues data with the mutex held; returns bytes accepted or -1
+static int queue_locked(const void* data, size_t size, TickType_t wait_ticks) {
+    size_t bytes_written = 0;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = i2s_write(I2S_NUM, data, size, &bytes_written, wait_ticks);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write audio data: %d", ret);
+        return -1;
+    }
+    if (bytes_written == 0) {
+        return 0;
+    }
+
+    uint32_t frames = bytes_written / s_bytes_per_frame;
+    portENTER_CRITICAL(&s_pos_lock);
+    if (s_played_frames == s_written_frames) {
+        // After a flush the zeroed buffers still play ahead of new audio
+        s_lead_buffers = s_zeroed_buffers > 1 ? s_zeroed_buffers : 1;
+    }
+    s_written_frames += frames;
+    portEXIT_CRITICAL(&s_pos_lock);
+
+    // A short write, or one that had to wait for DMA space, means the
+    // queue is full right now
+    int64_t now_us = esp_timer_get_time();
+    bool queue_full = bytes_written < size || now_us - start_us > I2S_BLOCKED_US;
+    media_clock_stamp_t stamp = media_clock_playback(frames, queue_full, now_us);
+    latency_trace_record(LATENCY_SPAN_OUTPUT, stamp.time_us - start_us);
+
+    if (s_tap_cb) {
+        s_tap_cb(data, bytes_written, s_tap_user_data);
+    }
+    return (int)bytes_written;
+}
+
 int audio_output_write(const void* data, size_t size, bool wait_for_completion) {
-    if (!s_is_initialized || !data || size == 0) {
+    if (!s_is_initialized || s_standby || !data || size == 0) {
         return -1;
     }
 
     int bytes_written = 0;
 
     if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
-        s_is_playing = true;
-        
         // Write data to I2S
-        size_t bytes_written_temp = 0;
-        esp_err_t ret = i2s_write(I2S_NUM, data, size, &bytes_written_temp, wait_for_completion ? portMAX_DELAY : 0);
-        
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to write audio data: %d", ret);
-            bytes_written = -1;
-        } else {
-            bytes_written = bytes_written_temp;
-            
-            // If not waiting for completion, we consider it "not playing" after data is queued
-            if (!wait_for_completion) {
-                s_is_playing = false;
-            }
-        }
-        
+        bytes_written = queue_locked(data, size, wait_for_completion ? portMAX_DELAY : 0);
         xSemaphoreGive(s_audio_mutex);
     }
 
-    // If we're waiting for completion, wait until all bytes are played
+    // If we're waiting for completion, sleep until the last buffer has played
     if (wait_for_completion && bytes_written > 0) {
-        size_t bytes_remaining = 0;
-        do {
-            i2s_get_tx_buffer_state(I2S_NUM, &bytes_remaining);
-            if (bytes_remaining > 0) {
-                vTaskDelay(pdMS_TO_TICKS(10));
-            }
-        } while (bytes_remaining > 0);
-        
-        if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
-            s_is_playing = false;
-            xSemaphoreGive(s_audio_mutex);
-        }
+        audio_output_wait_completion(0);
     }
 
     return bytes_written;
 }
 
-bool audio_output_is_busy(void) {
-    bool is_busy = false;
-    
-    if (s_is_initialized && s_audio_mutex) {
+int audio_output_enqueue(const void* data, size_t size, uint32_t timeout_ms) {
+    if (!s_is_initialized || s_standby || !data || size == 0) {
+        return -1;
+    }
+
+    // Waits for space happen outside the mutex, so a blocked feeder never
+    // holds up audio_output_flush; a flush ends the wait
+    const uint8_t* bytes = data;
+    size_t queued = 0;
+    uint32_t flushes = s_flush_count;
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (true) {
+        int n = -1;
         if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
-            is_busy = s_is_playing;
+            if (s_flush_count == flushes) {
+                n = s_standby ? -1 : queue_locked(bytes + queued, size - queued, 0);
+            } else {
+                n = 0;
+            }
             xSemaphoreGive(s_audio_mutex);
         }
+        if (n < 0) {
+            return queued > 0 ? (int)queued : -1;
+        }
+        queued += n;
+
+        int64_t left_us = deadline_us - esp_timer_get_time();
+        if (queued == size || s_flush_count != flushes || left_us <= 0) {
+            break;
+        }
+        xEventGroupWaitBits(s_events, OUTPUT_EVENT_SPACE, pdTRUE, pdTRUE, pdMS_TO_TICKS((left_us + 999) / 1000));
+    }
+
+    return (int)queued;
+}
+
+esp_err_t audio_output_flush(void) {
+    if (!s_is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
+        if (!s_standby) {
+            // The driver has no way to rewind its queue: the buffers are
+            // zeroed in place and play out as silence
+            i2s_zero_dma_buffer(I2S_NUM);
+            portENTER_CRITICAL(&s_pos_lock);
+            uint64_t left = s_written_frames - s_played_frames;
+            uint32_t queued = s_lead_buffers + (uint32_t)((left + I2S_DMA_BUF_FRAMES - 1) / I2S_DMA_BUF_FRAMES);
+            s_played_frames = s_written_frames;
+            s_lead_buffers = 0;
+            s_zeroed_buffers = queued > s_zeroed_buffers ? queued : s_zeroed_buffers;
+            portEXIT_CRITICAL(&s_pos_lock);
+            xEventGroupSetBits(s_events, OUTPUT_EVENT_DRAINED);
+        }
+        s_flush_count++;
+        xSemaphoreGive(s_audio_mutex);
+    }
+    xEventGroupSetBits(s_events, OUTPUT_EVENT_SPACE);
+    return ESP_OK;
+}
+
+esp_err_t audio_output_set_standby(bool standby) {
+    if (!s_is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE) {
+        if (standby && !s_standby) {
+            i2s_stop(I2S_NUM);
+            i2s_zero_dma_buffer(I2S_NUM);
+            // Queued audio is discarded; no TX-done will account for it
+            position_drained();
+        } else if (!standby && s_standby) {
+            // The media clock sees the first write after this as a fresh start
+            i2s_start(I2S_NUM);
+        }
+        s_standby = standby;
+        xSemaphoreGive(s_audio_mutex);
+    }
+
+    ESP_LOGD(TAG, "Audio output %s", standby ? "in standby" : "resumed");
+    return ESP_OK;
+}
+
+void audio_output_set_tap(audio_output_tap_cb_t callback, void* user_data) {
+    // Writers hold the mutex while calling the tap; before init there are none
+    bool locked = s_audio_mutex && xSemaphoreTake(s_audio_mutex, portMAX_DELAY) == pdTRUE;
+
+    s_tap_cb = callback;
+    s_tap_user_data = user_data;
+
+    if (locked) {
+        xSemaphoreGive(s_audio_mutex);
     }
-    
+}
+
+bool audio_output_is_busy(void) {
+    portENTER_CRITICAL(&s_pos_lock);
+    bool is_busy = s_played_frames < s_written_frames;
+    portEXIT_CRITICAL(&s_pos_lock);
     return is_busy;
 }
 
+uint64_t audio_output_get_played_samples(void) {
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_pos_lock);
+    uint64_t played = s_played_frames;
+    if (played < s_written_frames && s_lead_buffers == 0) {
+        // Part of the buffer playing now; the DMA runs at the sample rate
+        uint64_t partial = (uint64_t)(now_us - s_buffer_start_us) * s_sample_rate / 1000000;
+        uint64_t left = s_written_frames - played;
+        partial = partial < I2S_DMA_BUF_FRAMES ? partial : I2S_DMA_BUF_FRAMES;
+        played += partial < left ? partial : left;
+    }
+    portEXIT_CRITICAL(&s_pos_lock);
+
+    return played;
+}
+
 bool audio_output_wait_completion(uint32_t timeout_ms) {
     if (!s_is_initialized) {
         return true;  // Not initialized means not playing
     }
-    
-    TickType_t start_ticks = xTaskGetTickCount();
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-    bool timed_out = false;
-    
+
+    // The event task sets the bit when playback catches up with the writes;
+    // a bit left over from an earlier drain only costs one more check
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
     while (audio_output_is_busy()) {
-        vTaskDelay(pdMS_TO_TICKS(10));
-        
-        // Check for timeout if specified
+        TickType_t wait_ticks = portMAX_DELAY;
         if (timeout_ms > 0) {
-            TickType_t elapsed_ticks = xTaskGetTickCount() - start_ticks;
-            if (elapsed_ticks >= timeout_ticks) {
-                timed_out = true;
-                break;
+            int64_t left_us = deadline_us - esp_timer_get_time();
+            if (left_us <= 0) {
+                return false;
             }
+            wait_ticks = pdMS_TO_TICKS((left_us + 999) / 1000);
         }
+        xEventGroupWaitBits(s_events, OUTPUT_EVENT_DRAINED, pdTRUE, pdTRUE, wait_ticks);
     }
-    
-    return !timed_out;
+
+    return true;
 }
@@ -5,9 +5,19 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
 
+/**
+ * @brief Callback that observes audio as it is handed to the output device
+ * 
+ * @param data Audio data exactly as accepted by the I2S driver
+ * @param size Number of bytes accepted
+ * @param user_data User data pointer passed to audio_output_set_tap
+ */
+typedef void (*audio_output_tap_cb_t)(const void* data, size_t size, void* user_data);
+
 /**
  * @brief Initialize the audio output component
  * 
@@ -26,6 +36,11 @@ void audio_output_deinit(void);
 /**
  * @brief Write audio data to the output device
  * 
+ * Every accepted chunk is stamped on the playback media clock;
+ * media_clock_get(MEDIA_CLOCK_PLAYBACK, ...) right after the call returns
+ * its first sample index and predicted play time. The time from the call
+ * to that play time is recorded as the LATENCY_SPAN_OUTPUT span.
+ * 
  * @param data Pointer to audio data buffer
  * @param size Size of audio data in bytes
  * @param wait_for_completion If true, wait until all data is played
@@ -33,16 +48,89 @@ void audio_output_deinit(void);
  */
 int audio_output_write(const void* data, size_t size, bool wait_for_completion);
 
+/**
+ * @brief Queue audio for playback, waiting for DMA space if necessary
+ * 
+ * Unlike audio_output_write(..., false), which takes only what fits at the
+ * moment, this blocks for up to timeout_ms until the driver has room, so a
+ * feeder task calling it in a loop runs at the output clock. It returns as
+ * soon as the data is queued, not when it has played. Stamping and the tap
+ * work as for audio_output_write. The wait does not hold the output lock,
+ * and an audio_output_flush ends it.
+ * 
+ * @param data Pointer to audio data buffer
+ * @param size Size of audio data in bytes
+ * @param timeout_ms Longest time to wait for space
+ * @return Number of bytes queued (fewer than size on timeout or flush), or negative error code
+ */
+int audio_output_enqueue(const void* data, size_t size, uint32_t timeout_ms);
+
+/**
+ * @brief Discard all queued audio at once
+ * 
+ * Zeroes the DMA buffers in place, so the speaker goes silent within the
+ * I2S FIFO's few samples rather than after the queue has played. The
+ * zeroed buffers still play out as silence, which delays the next write
+ * by up to the queue length; the playback position accounts for it. A
+ * pending audio_output_enqueue returns with what it queued so far.
+ * 
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t audio_output_flush(void);
+
+/**
+ * @brief Register a tap that sees every chunk written to the output device
+ * 
+ * The tap runs in the writer's context, after the driver accepted the data
+ * and before audio_output_write returns, so it must not block. Only the
+ * bytes actually queued are reported, which makes the tap suitable as an
+ * echo cancellation reference.
+ * 
+ * @param callback Tap function, or NULL to remove it
+ * @param user_data User data to pass to the tap
+ */
+void audio_output_set_tap(audio_output_tap_cb_t callback, void* user_data);
+
+/**
+ * @brief Pause or resume the output DMA without uninstalling the driver
+ * 
+ * In standby the I2S clock and DMA are stopped and the queued audio is
+ * discarded, so the speaker is silent and the driver costs no bus time;
+ * writes fail until standby is left again. Leaving standby takes no
+ * allocation or driver setup.
+ * 
+ * @param standby true to pause, false to resume
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t audio_output_set_standby(bool standby);
+
 /**
  * @brief Check if audio output is busy playing
  * 
- * @return true if audio is currently playing, false otherwise
+ * Playback is tracked with the driver's TX-done events, one per DMA buffer,
+ * so this stays true until the last queued sample has left the DMA.
+ * 
+ * @return true if queued audio has not finished playing, false otherwise
  */
 bool audio_output_is_busy(void);
 
+/**
+ * @brief Samples played since audio_output_init
+ * 
+ * Counts only written audio, not the silence the DMA plays while the
+ * queue is empty. Whole DMA buffers are counted on their TX-done event
+ * and the buffer playing now is interpolated from the time it started,
+ * so the position is good to within the event latency.
+ * 
+ * @return Played sample frames; audio dropped by standby counts as played
+ */
+uint64_t audio_output_get_played_samples(void);
+
 /**
  * @brief Wait for audio playback to complete
  * 
+ * Sleeps until the TX-done event for the last queued buffer; nothing polls.
+ * 
  * @param timeout_ms Timeout in milliseconds, or 0 to wait indefinitely
  * @return true if playback completed, false if timed out
  */
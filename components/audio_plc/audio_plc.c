@@ -0,0 +1,295 @@
+#include "audio_plc.h"
+#include <stdlib.h>
+#include <string.h>
+#include "audio_dsp.h"
+
+// Pitch search range and the window matched against the history
+#define PLC_PITCH_MIN_HZ    400
+#define PLC_PITCH_MAX_MS    15
+#define PLC_WINDOW_MS       10
+// The extension holds its level this long, and grows from one period to
+// three at the first loop seam after it
+#define PLC_HOLD_MS         10
+// Comfort noise fades in from here to fade_ms, and out over the last
+// PLC_NOISE_RAMP_MS before max_ms
+#define PLC_NOISE_START_MS  20
+#define PLC_NOISE_RAMP_MS   20
+#define Q15_UNITY           (1 << 15)
+
+typedef enum {
+    PLC_IDLE,           // no history to conceal from
+    PLC_PLAYING,
+    PLC_CONCEALING,
+    PLC_EXPIRED,        // gap outlasted max_ms
+} plc_state_t;
+
+struct audio_plc {
+    size_t per_ms;              // samples per ms
+    size_t pitch_min;
+    size_t pitch_max;
+    size_t window;
+    size_t overlap;
+    size_t fade;
+    size_t max;
+    plc_state_t state;
+    int16_t* hist;              // most recent good audio, oldest first
+    size_t hist_len;
+    size_t hist_fill;
+    int16_t* loop;              // periods being repeated, seam cross-faded
+    size_t loop_len;
+    size_t loop_pos;
+    size_t period;
+    size_t lost;                // samples concealed in this gap
+    int16_t* xfade;             // concealment blended into recovered audio
+    int32_t noise_rms;          // background level, see audio_plc_good
+    uint32_t rng;
+    int32_t noise_lp;           // lowpassed noise, tilted like room tone
+    audio_plc_stats_t stats;
+    uint64_t concealed_samples;
+    uint64_t noise_samples;
+    size_t longest;
+};
+
+esp_err_t audio_plc_create(const audio_plc_config_t* config, audio_plc_t** out_plc) {
+    if (!config || !out_plc || config->sample_rate < 8000 || config->overlap_ms == 0 ||
+        config->fade_ms <= PLC_NOISE_START_MS || config->max_ms < config->fade_ms + PLC_NOISE_RAMP_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    audio_plc_t* plc = calloc(1, sizeof(audio_plc_t));
+    if (!plc) {
+        return ESP_ERR_NO_MEM;
+    }
+    plc->per_ms = config->sample_rate / 1000;
+    plc->pitch_min = config->sample_rate / PLC_PITCH_MIN_HZ;
+    plc->pitch_max = plc->per_ms * PLC_PITCH_MAX_MS;
+    plc->window = plc->per_ms * PLC_WINDOW_MS;
+    plc->overlap = plc->per_ms * config->overlap_ms;
+    plc->fade = plc->per_ms * config->fade_ms;
+    plc->max = plc->per_ms * config->max_ms;
+    // Three of the longest periods plus the seam before them
+    plc->hist_len = 3 * plc->pitch_max + plc->pitch_max / 4;
+    plc->hist = calloc(plc->hist_len, sizeof(int16_t));
+    plc->loop = calloc(3 * plc->pitch_max, sizeof(int16_t));
+    plc->xfade = calloc(plc->overlap, sizeof(int16_t));
+    if (!plc->hist || !plc->loop || !plc->xfade) {
+        audio_plc_destroy(plc);
+        return ESP_ERR_NO_MEM;
+    }
+    plc->rng = 0x12345678;
+    *out_plc = plc;
+    return ESP_OK;
+}
+
+void audio_plc_destroy(audio_plc_t* plc) {
+    if (!plc) {
+        return;
+    }
+    free(plc->hist);
+    free(plc->loop);
+    free(plc->xfade);
+    free(plc);
+}
+
+void audio_plc_reset(audio_plc_t* plc) {
+    plc->state = PLC_IDLE;
+    plc->hist_fill = 0;
+    plc->lost = 0;
+}
+
+static float pitch_score(const int16_t* recent, const int16_t* past, size_t count, size_t step) {
+    int32_t corr = audio_dsp_correlate_s16(recent, past, count, step);
+    int32_t energy = audio_dsp_correlate_s16(past, past, count, step);
+    return corr > 0 ? (float)corr * (float)corr / (float)(energy + 1) : 0.0f;
+}
+
+// Lag at which the last window best matches the history before it: every
+// other lag on every other sample, then refined around the winner
+static size_t find_period(const audio_plc_t* plc) {
+    const int16_t* recent = plc->hist + plc->hist_fill - plc->window;
+    size_t best = plc->pitch_max;
+    float best_score = -1.0f;
+    for (size_t lag = plc->pitch_min; lag <= plc->pitch_max; lag += 2) {
+        float s = pitch_score(recent, recent - lag, plc->window, 2);
+        if (s > best_score) {
+            best_score = s;
+            best = lag;
+        }
+    }
+    size_t coarse = best;
+    best_score = -1.0f;
+    for (size_t lag = coarse - 1; lag <= coarse + 1 && lag <= plc->pitch_max; lag++) {
+        if (lag < plc->pitch_min) {
+            continue;
+        }
+        float s = pitch_score(recent, recent - lag, plc->window, 1);
+        if (s > best_score) {
+            best_score = s;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+// The last periods of history; the loop's end fades into the samples that
+// precede its start, so the wrap is as smooth as the waveform
+static void build_loop(audio_plc_t* plc, size_t periods) {
+    const int16_t* end = plc->hist + plc->hist_fill;
+    const size_t len = periods * plc->period;
+    const size_t seam = plc->period / 4 > 0 ? plc->period / 4 : 1;
+    const int16_t* start = end - len;
+    memcpy(plc->loop, start, (len - seam) * sizeof(int16_t));
+    for (size_t i = 0; i < seam; i++) {
+        int32_t a = end[i - seam];
+        int32_t b = start[i - seam];
+        plc->loop[len - seam + i] = (int16_t)((a * (int32_t)(seam - i) + b * (int32_t)i) / (int32_t)seam);
+    }
+    plc->loop_len = len;
+}
+
+// Linear ramp: 0 at from, unity at to
+static int32_t ramp_q15(size_t at, size_t from, size_t to) {
+    if (at <= from) {
+        return 0;
+    }
+    if (at >= to) {
+        return Q15_UNITY;
+    }
+    return (int32_t)((uint64_t)(at - from) * Q15_UNITY / (to - from));
+}
+
+static size_t synthesize(audio_plc_t* plc, int16_t* out, size_t count) {
+    const size_t hold = plc->per_ms * PLC_HOLD_MS;
+    const size_t noise_start = plc->per_ms * PLC_NOISE_START_MS;
+    const size_t noise_end = plc->max - plc->per_ms * PLC_NOISE_RAMP_MS;
+    // Uniform noise of amplitude A has an RMS of A / sqrt(3), and the
+    // lowpass takes off another 8.5 dB
+    const int32_t noise_amp = plc->noise_rms * 14 / 3;
+    size_t i = 0;
+    for (; i < count && plc->lost < plc->max; i++) {
+        if (plc->loop_pos == plc->loop_len) {
+            plc->loop_pos = 0;
+            if (plc->loop_len == plc->period && plc->lost >= hold && plc->hist_fill >= plc->hist_len) {
+                // Continue at the same point of a three-period loop
+                build_loop(plc, 3);
+                plc->loop_pos = 2 * plc->period;
+            }
+        }
+        int32_t sample = 0;
+        if (plc->lost < plc->fade) {
+            int32_t gain = Q15_UNITY - ramp_q15(plc->lost, hold, plc->fade);
+            sample = (plc->loop[plc->loop_pos] * gain) >> 15;
+        }
+        plc->loop_pos++;
+        if (plc->lost >= noise_start && noise_amp > 0) {
+            int32_t gain = plc->lost < noise_end ? ramp_q15(plc->lost, noise_start, plc->fade)
+                                                 : Q15_UNITY - ramp_q15(plc->lost, noise_end, plc->max);
+            plc->rng = plc->rng * 1664525u + 1013904223u;
+            int32_t noise = (int32_t)(((int64_t)(int16_t)(plc->rng >> 16) * noise_amp) >> 15);
+            plc->noise_lp += (noise - plc->noise_lp) >> 2;
+            sample += (plc->noise_lp * gain) >> 15;
+        }
+        out[i] = (int16_t)(sample > INT16_MAX ? INT16_MAX : (sample < INT16_MIN ? INT16_MIN : sample));
+        plc->noise_samples += plc->lost >= plc->fade;
+        plc->lost++;
+    }
+    if (plc->lost >= plc->max) {
+        plc->state = PLC_EXPIRED;
+    }
+    return i;
+}
+
+size_t audio_plc_conceal(audio_plc_t* plc, int16_t* out, size_t count) {
+    if (plc->state == PLC_IDLE || plc->state == PLC_EXPIRED) {
+        return 0;
+    }
+    if (plc->state == PLC_PLAYING) {
+        if (plc->hist_fill < plc->window + plc->pitch_max + plc->pitch_max / 4) {
+            // Too little audio yet to find a period in
+            plc->state = PLC_EXPIRED;
+            return 0;
+        }
+        plc->period = find_period(plc);
+        build_loop(plc, 1);
+        plc->loop_pos = 0;
+        plc->lost = 0;
+        plc->state = PLC_CONCEALING;
+        plc->stats.gaps++;
+    }
+    size_t n = synthesize(plc, out, count);
+    plc->concealed_samples += n;
+    plc->longest = plc->lost > plc->longest ? plc->lost : plc->longest;
+    return n;
+}
+
+static int32_t isqrt(uint32_t v) {
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return (int32_t)r;
+}
+
+void audio_plc_good(audio_plc_t* plc, int16_t* samples, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    size_t ov = count < plc->overlap ? count : plc->overlap;
+    if (plc->state == PLC_CONCEALING) {
+        size_t n = synthesize(plc, plc->xfade, ov);
+        memset(plc->xfade + n, 0, (ov - n) * sizeof(int16_t));
+        for (size_t i = 0; i < ov; i++) {
+            samples[i] = (int16_t)((plc->xfade[i] * (int32_t)(ov - i) + samples[i] * (int32_t)i) / (int32_t)ov);
+        }
+    } else if (plc->state == PLC_EXPIRED) {
+        for (size_t i = 0; i < ov; i++) {
+            samples[i] = (int16_t)(samples[i] * (int32_t)i / (int32_t)ov);
+        }
+    }
+    plc->state = PLC_PLAYING;
+    plc->lost = 0;
+
+    // Comfort noise level: drops straight to a quieter chunk and creeps up
+    // over seconds, so it settles on the pauses between words
+    uint64_t energy = 0;
+    for (size_t i = 0; i < count; i++) {
+        energy += (int32_t)samples[i] * samples[i];
+    }
+    int32_t rms = isqrt((uint32_t)(energy / count));
+    if (rms < plc->noise_rms) {
+        plc->noise_rms = rms;
+    } else {
+        plc->noise_rms += (rms - plc->noise_rms + 255) >> 8;
+    }
+
+    if (count >= plc->hist_len) {
+        memcpy(plc->hist, samples + count - plc->hist_len, plc->hist_len * sizeof(int16_t));
+        plc->hist_fill = plc->hist_len;
+        return;
+    }
+    size_t keep = plc->hist_len - count;
+    if (plc->hist_fill > keep) {
+        memmove(plc->hist, plc->hist + plc->hist_fill - keep, keep * sizeof(int16_t));
+        plc->hist_fill = keep;
+    }
+    memcpy(plc->hist + plc->hist_fill, samples, count * sizeof(int16_t));
+    plc->hist_fill += count;
+}
+
+void audio_plc_get_stats(const audio_plc_t* plc, audio_plc_stats_t* stats) {
+    *stats = plc->stats;
+    stats->concealed_ms = (uint32_t)(plc->concealed_samples / plc->per_ms);
+    stats->noise_ms = (uint32_t)(plc->noise_samples / plc->per_ms);
+    stats->longest_gap_ms = (uint32_t)(plc->longest / plc->per_ms);
+}
+
+void audio_plc_reset_stats(audio_plc_t* plc) {
+    memset(&plc->stats, 0, sizeof(plc->stats));
+    plc->concealed_samples = 0;
+    plc->noise_samples = 0;
+    plc->longest = 0;
+}
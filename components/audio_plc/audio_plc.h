@@ -0,0 +1,107 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Packet loss concealment for 16-bit mono speech
+ *
+ * Good audio passes through audio_plc_good, which keeps a short history.
+ * When audio is missing, audio_plc_conceal continues the waveform in the
+ * manner of ITU-T G.711 Appendix I: the pitch period is found by
+ * normalized autocorrelation of the history, and the last period is
+ * repeated, with its loop seam cross-faded. After 10 ms the loop grows to
+ * three periods so longer gaps do not buzz. The extension holds its level
+ * for 10 ms and fades out by fade_ms while comfort noise, at the level of
+ * the quietest recent audio, fades in; the noise fades out again at
+ * max_ms, after which nothing more is concealed.
+ *
+ * When good audio returns, its first overlap_ms are cross-faded from the
+ * continued concealment, or faded in if concealment had already ended.
+ *
+ * Not thread-safe: one task feeds and conceals.
+ */
+typedef struct audio_plc audio_plc_t;
+
+/**
+ * @brief Concealment settings
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t overlap_ms;    ///< Cross-fade into recovered audio
+    uint32_t fade_ms;       ///< Waveform extension is silent by then
+    uint32_t max_ms;        ///< Longest gap concealed, comfort noise included
+} audio_plc_config_t;
+
+#define AUDIO_PLC_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,            \
+    .overlap_ms = 5,                 \
+    .fade_ms = 60,                   \
+    .max_ms = 200,                   \
+}
+
+/**
+ * @brief Concealment statistics since create or audio_plc_reset_stats
+ */
+typedef struct {
+    uint32_t gaps;              ///< Runs of missing audio
+    uint32_t concealed_ms;      ///< Audio synthesized, extension and noise
+    uint32_t noise_ms;          ///< Part of it past fade_ms, comfort noise only
+    uint32_t longest_gap_ms;
+} audio_plc_stats_t;
+
+/**
+ * @brief Create a concealer
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_plc_create(const audio_plc_config_t* config, audio_plc_t** out_plc);
+
+/**
+ * @brief Free a concealer
+ */
+void audio_plc_destroy(audio_plc_t* plc);
+
+/**
+ * @brief Pass good audio, in place
+ *
+ * The start of the first chunk after a gap is blended with the
+ * concealment; the rest is unchanged.
+ */
+void audio_plc_good(audio_plc_t* plc, int16_t* samples, size_t count);
+
+/**
+ * @brief Synthesize audio for a gap
+ *
+ * @param out Receives the concealment
+ * @param count Samples missing
+ * @return Samples written; fewer than count once max_ms is reached, and 0
+ *         without good audio since create or audio_plc_reset
+ */
+size_t audio_plc_conceal(audio_plc_t* plc, int16_t* out, size_t count);
+
+/**
+ * @brief Forget the history, e.g. when a stream is cut; nothing is concealed
+ *        until good audio arrives again
+ */
+void audio_plc_reset(audio_plc_t* plc);
+
+/**
+ * @brief Get concealment statistics
+ */
+void audio_plc_get_stats(const audio_plc_t* plc, audio_plc_stats_t* stats);
+
+/**
+ * @brief Clear the statistics
+ */
+void audio_plc_reset_stats(audio_plc_t* plc);
+
+#ifdef __cplusplus
+}
+#endif
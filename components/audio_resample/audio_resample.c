@@ -0,0 +1,188 @@
+#include "audio_resample.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#define TAG "AUDIO_RESAMPLE"
+
+// Input is consumed in blocks of this many samples behind the filter history
+#define RESAMPLE_BLOCK          256
+// Default filter span, in milliseconds of input
+#define RESAMPLE_DEFAULT_SPAN_MS 2
+// Passband edge as a fraction of the lower Nyquist frequency
+#define RESAMPLE_CUTOFF         0.92
+// Kaiser window shape (~70 dB stopband)
+#define RESAMPLE_KAISER_BETA    7.0
+#define RESAMPLE_COEF_Q         14
+
+struct audio_resample {
+    uint32_t up;            // L
+    uint32_t down;          // M
+    uint32_t taps;          // coefficients per phase
+    int16_t* coef;          // up x taps, each phase stored reversed
+    int16_t* buf;           // taps - 1 history samples followed by one block
+    uint32_t step_int;      // M / L
+    uint32_t step_frac;     // M % L
+    uint32_t pos;           // next output's newest input sample, relative to the block
+    uint32_t phase;         // next output's phase, 0 .. L-1
+};
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth-order modified Bessel function of the first kind
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static void design_filter(audio_resample_t* rs) {
+    const uint32_t len = rs->up * rs->taps;
+    // Cutoff relative to the upsampled rate: the lower of the two Nyquists
+    const uint32_t lim = rs->up > rs->down ? rs->up : rs->down;
+    const double fc = RESAMPLE_CUTOFF * 0.5 / (double)lim;
+    const double center = (len - 1) / 2.0;
+    const double i0_beta = bessel_i0(RESAMPLE_KAISER_BETA);
+
+    // Phase p uses prototype taps p, p + L, p + 2L, ...; stored newest-last
+    // so the inner loop walks input and coefficients in the same direction
+    for (uint32_t p = 0; p < rs->up; p++) {
+        for (uint32_t k = 0; k < rs->taps; k++) {
+            double t = (double)(p + k * rs->up) - center;
+            double sinc = t == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+            double r = t / (center + 0.5);
+            double w = bessel_i0(RESAMPLE_KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta;
+            // Zero stuffing divides the signal by L; the filter gives it back
+            long q = lrint(sinc * w * rs->up * (1 << RESAMPLE_COEF_Q));
+            q = q > INT16_MAX ? INT16_MAX : (q < INT16_MIN ? INT16_MIN : q);
+            rs->coef[p * rs->taps + (rs->taps - 1 - k)] = (int16_t)q;
+        }
+    }
+}
+
+esp_err_t audio_resample_create(uint32_t in_rate, uint32_t out_rate, uint16_t taps, audio_resample_t** out_rs) {
+    if (!out_rs || in_rate == 0 || out_rate == 0 || (taps % 4) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t g = gcd(in_rate, out_rate);
+    uint32_t up = out_rate / g;
+    uint32_t down = in_rate / g;
+    // The table holds one phase per output position within L
+    if (up > 256) {
+        ESP_LOGE(TAG, "Ratio %lu/%lu too large for a polyphase table", (unsigned long)up, (unsigned long)down);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (taps == AUDIO_RESAMPLE_TAPS_DEFAULT) {
+        // A fixed span in time gives the same transition width (~2 kHz)
+        // whichever way we convert
+        uint32_t span = in_rate * RESAMPLE_DEFAULT_SPAN_MS / 1000;
+        taps = (uint16_t)((span + 3) & ~3u);
+        taps = taps < 8 ? 8 : taps;
+    }
+
+    audio_resample_t* rs = calloc(1, sizeof(audio_resample_t));
+    if (!rs) {
+        return ESP_ERR_NO_MEM;
+    }
+    rs->up = up;
+    rs->down = down;
+    rs->taps = taps;
+    rs->step_int = down / up;
+    rs->step_frac = down % up;
+    rs->coef = heap_caps_malloc(up * taps * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    rs->buf = heap_caps_calloc(taps - 1 + RESAMPLE_BLOCK, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    if (!rs->coef || !rs->buf) {
+        audio_resample_destroy(rs);
+        return ESP_ERR_NO_MEM;
+    }
+    design_filter(rs);
+
+    ESP_LOGI(TAG, "Resampler %lu -> %lu Hz (x%lu/%lu), %lu taps per phase",
+             (unsigned long)in_rate, (unsigned long)out_rate, (unsigned long)up,
+             (unsigned long)down, (unsigned long)taps);
+    *out_rs = rs;
+    return ESP_OK;
+}
+
+void audio_resample_destroy(audio_resample_t* rs) {
+    if (!rs) {
+        return;
+    }
+    heap_caps_free(rs->coef);
+    heap_caps_free(rs->buf);
+    free(rs);
+}
+
+void audio_resample_reset(audio_resample_t* rs) {
+    memset(rs->buf, 0, (rs->taps - 1) * sizeof(int16_t));
+    rs->pos = 0;
+    rs->phase = 0;
+}
+
+size_t audio_resample_max_output(const audio_resample_t* rs, size_t in_count) {
+    return (in_count * rs->up + rs->down - 1) / rs->down + 1;
+}
+
+uint32_t audio_resample_delay(const audio_resample_t* rs) {
+    return (rs->up * rs->taps - 1) / (2 * rs->down);
+}
+
+static inline int16_t dot_q14(const int16_t* x, const int16_t* h, uint32_t taps) {
+    // Q14 coefficients keep the sum of |h| * 32767 well inside 32 bits
+    int32_t acc = 1 << (RESAMPLE_COEF_Q - 1);
+    for (uint32_t k = 0; k < taps; k += 4) {
+        acc += x[k] * h[k] + x[k + 1] * h[k + 1] + x[k + 2] * h[k + 2] + x[k + 3] * h[k + 3];
+    }
+    acc >>= RESAMPLE_COEF_Q;
+    return (int16_t)(acc > INT16_MAX ? INT16_MAX : (acc < INT16_MIN ? INT16_MIN : acc));
+}
+
+size_t audio_resample_process(audio_resample_t* rs, const int16_t* in, size_t in_count, int16_t* out) {
+    const uint32_t hist = rs->taps - 1;
+    int16_t* block = rs->buf + hist;
+    size_t produced = 0;
+
+    while (in_count > 0) {
+        uint32_t n = in_count < RESAMPLE_BLOCK ? (uint32_t)in_count : RESAMPLE_BLOCK;
+        memcpy(block, in, n * sizeof(int16_t));
+
+        // buf[pos .. pos + taps) ends at the newest input the output depends on
+        uint32_t pos = rs->pos;
+        uint32_t phase = rs->phase;
+        while (pos < n) {
+            out[produced++] = dot_q14(&rs->buf[pos], &rs->coef[phase * rs->taps], rs->taps);
+            pos += rs->step_int;
+            phase += rs->step_frac;
+            if (phase >= rs->up) {
+                phase -= rs->up;
+                pos++;
+            }
+        }
+        rs->pos = pos - n;
+        rs->phase = phase;
+
+        memmove(rs->buf, rs->buf + n, hist * sizeof(int16_t));
+        in += n;
+        in_count -= n;
+    }
+
+    return produced;
+}
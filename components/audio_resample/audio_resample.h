@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Streaming polyphase sample-rate converter for 16-bit mono PCM
+ *
+ * Converts by any rational ratio L/M (the rates are reduced by their GCD).
+ * The anti-aliasing filter is a Kaiser-windowed sinc designed once at create
+ * time and stored as L phase tables of Q14 coefficients; each output sample
+ * costs one dot product of `taps` samples. Filter history and the phase are
+ * carried between calls, so a stream can be fed in chunks of any size.
+ */
+typedef struct audio_resample audio_resample_t;
+
+/** Let audio_resample_create pick the filter length (about 2 ms of input) */
+#define AUDIO_RESAMPLE_TAPS_DEFAULT 0
+
+/**
+ * @brief Create a resampler
+ *
+ * @param in_rate Input sample rate in Hz
+ * @param out_rate Output sample rate in Hz
+ * @param taps Filter length per phase in input samples, multiple of 4, or AUDIO_RESAMPLE_TAPS_DEFAULT
+ * @param out_rs Receives the resampler
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_resample_create(uint32_t in_rate, uint32_t out_rate, uint16_t taps, audio_resample_t** out_rs);
+
+/**
+ * @brief Free a resampler
+ */
+void audio_resample_destroy(audio_resample_t* rs);
+
+/**
+ * @brief Convert a chunk
+ *
+ * @param in Input samples
+ * @param in_count Number of input samples
+ * @param out Output buffer, at least audio_resample_max_output(rs, in_count) samples
+ * @return Number of output samples written
+ */
+size_t audio_resample_process(audio_resample_t* rs, const int16_t* in, size_t in_count, int16_t* out);
+
+/**
+ * @brief Largest number of output samples a chunk of in_count inputs can produce
+ */
+size_t audio_resample_max_output(const audio_resample_t* rs, size_t in_count);
+
+/**
+ * @brief Clear the filter history and phase, e.g. between utterances
+ */
+void audio_resample_reset(audio_resample_t* rs);
+
+/**
+ * @brief Filter group delay in output samples
+ */
+uint32_t audio_resample_delay(const audio_resample_t* rs);
+
+#ifdef __cplusplus
+}
+#endif
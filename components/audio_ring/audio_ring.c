@@ -0,0 +1,139 @@
+#include "audio_ring.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "AUDIO_RING"
+
+// Slots are 16-byte aligned so they can be handed to DMA and vector code
+#define AUDIO_RING_ALIGN 16
+
+struct audio_ring {
+    uint8_t* storage;
+    size_t* lengths;
+    size_t frame_size;      // slot stride, rounded up to AUDIO_RING_ALIGN
+    size_t frame_bytes;     // usable bytes per slot as requested
+    uint32_t mask;
+    // Free-running positions; head is only written by the producer and tail
+    // only by the consumer, so each side needs nothing stronger than
+    // acquire/release ordering on the other side's index.
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint high_water;
+    atomic_uint frames_written;
+    atomic_uint overruns;
+};
+
+esp_err_t audio_ring_create(uint32_t frame_count, size_t frame_size, uint32_t caps, audio_ring_t** out_ring) {
+    if (!out_ring || frame_count == 0 || frame_size == 0 || (frame_count & (frame_count - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_ring_t* ring = calloc(1, sizeof(audio_ring_t));
+    if (!ring) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t stride = (frame_size + AUDIO_RING_ALIGN - 1) & ~(size_t)(AUDIO_RING_ALIGN - 1);
+    ring->storage = heap_caps_aligned_calloc(AUDIO_RING_ALIGN, frame_count, stride, caps);
+    ring->lengths = calloc(frame_count, sizeof(size_t));
+    if (!ring->storage || !ring->lengths) {
+        ESP_LOGE(TAG, "Failed to allocate %lu x %u byte ring", (unsigned long)frame_count, (unsigned)stride);
+        heap_caps_free(ring->storage);
+        free(ring->lengths);
+        free(ring);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ring->frame_size = stride;
+    ring->frame_bytes = frame_size;
+    ring->mask = frame_count - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->high_water, 0);
+    atomic_init(&ring->frames_written, 0);
+    atomic_init(&ring->overruns, 0);
+
+    *out_ring = ring;
+    return ESP_OK;
+}
+
+void audio_ring_delete(audio_ring_t* ring) {
+    if (!ring) {
+        return;
+    }
+    heap_caps_free(ring->storage);
+    free(ring->lengths);
+    free(ring);
+}
+
+void* audio_ring_write_acquire(audio_ring_t* ring) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->mask) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+        return NULL;
+    }
+    return ring->storage + (size_t)(head & ring->mask) * ring->frame_size;
+}
+
+void audio_ring_write_commit(audio_ring_t* ring, size_t len) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring->lengths[head & ring->mask] = len < ring->frame_bytes ? len : ring->frame_bytes;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->frames_written, 1, memory_order_relaxed);
+
+    unsigned depth = head + 1 - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (depth > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, depth, memory_order_relaxed);
+    }
+}
+
+const void* audio_ring_read_acquire(audio_ring_t* ring, size_t* out_len) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+    if (out_len) {
+        *out_len = ring->lengths[tail & ring->mask];
+    }
+    return ring->storage + (size_t)(tail & ring->mask) * ring->frame_size;
+}
+
+void audio_ring_read_release(audio_ring_t* ring) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+uint32_t audio_ring_count(const audio_ring_t* ring) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
+
+size_t audio_ring_frame_size(const audio_ring_t* ring) {
+    return ring->frame_bytes;
+}
+
+void audio_ring_flush(audio_ring_t* ring) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+}
+
+void audio_ring_get_stats(const audio_ring_t* ring, audio_ring_stats_t* stats) {
+    stats->capacity = ring->mask + 1;
+    stats->count = audio_ring_count(ring);
+    stats->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+    stats->frames_written = atomic_load_explicit(&ring->frames_written, memory_order_relaxed);
+    stats->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+}
+
+void audio_ring_reset_stats(audio_ring_t* ring) {
+    atomic_store_explicit(&ring->high_water, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->frames_written, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->overruns, 0, memory_order_relaxed);
+}
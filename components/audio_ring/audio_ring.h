@@ -0,0 +1,104 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Single-producer/single-consumer ring of fixed-size audio frames
+ *
+ * Exactly one task may call the write functions and exactly one task may call
+ * the read functions. Neither side ever blocks or takes a lock; the producer
+ * writes straight into a ring slot and the consumer reads straight out of one.
+ */
+typedef struct audio_ring audio_ring_t;
+
+/**
+ * @brief Ring statistics snapshot
+ */
+typedef struct {
+    uint32_t capacity;      ///< Number of frame slots in the ring
+    uint32_t count;         ///< Frames currently waiting to be read
+    uint32_t high_water;    ///< Largest number of frames ever waiting at once
+    uint32_t frames_written;///< Frames committed by the producer
+    uint32_t overruns;      ///< Frames the producer could not store because the ring was full
+} audio_ring_stats_t;
+
+/**
+ * @brief Create a frame ring
+ *
+ * @param frame_count Number of frame slots, must be a power of two
+ * @param frame_size Size of each frame slot in bytes
+ * @param caps heap_caps flags for the slot storage (e.g. MALLOC_CAP_DMA)
+ * @param out_ring Receives the new ring
+ * @return ESP_OK on success, or an error code
+ */
+esp_err_t audio_ring_create(uint32_t frame_count, size_t frame_size, uint32_t caps, audio_ring_t** out_ring);
+
+/**
+ * @brief Free a ring created with audio_ring_create
+ */
+void audio_ring_delete(audio_ring_t* ring);
+
+/**
+ * @brief Get the next free slot for the producer to fill
+ *
+ * @return Pointer to a slot of audio_ring_frame_size() bytes, or NULL if the
+ *         ring is full. A NULL return is counted as an overrun.
+ */
+void* audio_ring_write_acquire(audio_ring_t* ring);
+
+/**
+ * @brief Publish the slot returned by audio_ring_write_acquire
+ *
+ * @param len Number of valid bytes in the slot
+ */
+void audio_ring_write_commit(audio_ring_t* ring, size_t len);
+
+/**
+ * @brief Get the oldest unread frame
+ *
+ * @param out_len Receives the number of valid bytes in the frame
+ * @return Pointer to the frame, or NULL if the ring is empty. The frame stays
+ *         valid until audio_ring_read_release is called.
+ */
+const void* audio_ring_read_acquire(audio_ring_t* ring, size_t* out_len);
+
+/**
+ * @brief Return the frame obtained from audio_ring_read_acquire to the producer
+ */
+void audio_ring_read_release(audio_ring_t* ring);
+
+/**
+ * @brief Number of frames waiting to be read
+ */
+uint32_t audio_ring_count(const audio_ring_t* ring);
+
+/**
+ * @brief Size of each frame slot in bytes
+ */
+size_t audio_ring_frame_size(const audio_ring_t* ring);
+
+/**
+ * @brief Drop all unread frames (consumer side only)
+ */
+void audio_ring_flush(audio_ring_t* ring);
+
+/**
+ * @brief Take a statistics snapshot; safe to call from any task
+ */
+void audio_ring_get_stats(const audio_ring_t* ring, audio_ring_stats_t* stats);
+
+/**
+ * @brief Reset overrun, frames_written and high-water counters
+ */
+void audio_ring_reset_stats(audio_ring_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
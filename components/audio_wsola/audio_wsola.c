@@ -0,0 +1,199 @@
+#include "audio_wsola.h"
+#include <stdlib.h>
+#include <string.h>
+#include "audio_dsp.h"
+
+struct audio_wsola {
+    uint32_t sample_rate;
+    size_t block;               // output per segment
+    size_t overlap;
+    size_t seek;                // offsets searched, 0 .. seek - 1
+    int16_t* buf;               // stored input, oldest first
+    size_t fill;
+    size_t capacity;
+    int16_t* tail;              // overlap samples the next segment fades in over
+    bool primed;                // tail holds audio
+    size_t resume;              // stored input that follows on from the tail
+    int32_t rate_q10;
+    uint32_t frac;              // fractional input position, Q10
+    audio_wsola_stats_t stats;
+    int64_t saved_samples;
+};
+
+esp_err_t audio_wsola_create(const audio_wsola_config_t* config, audio_wsola_t** out_ws) {
+    if (!config || !out_ws || config->sample_rate < 8000 || config->block_ms == 0 ||
+        config->overlap_ms == 0 || config->overlap_ms >= config->block_ms || config->seek_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    audio_wsola_t* ws = calloc(1, sizeof(audio_wsola_t));
+    if (!ws) {
+        return ESP_ERR_NO_MEM;
+    }
+    ws->sample_rate = config->sample_rate;
+    ws->block = (size_t)config->sample_rate * config->block_ms / 1000;
+    ws->overlap = (size_t)config->sample_rate * config->overlap_ms / 1000;
+    ws->seek = (size_t)config->sample_rate * config->seek_ms / 1000;
+    // A segment at the far end of the seek window after a 2x skip, plus a
+    // block of slack for the writer
+    ws->capacity = ws->seek + 3 * ws->block + 2 * ws->overlap;
+    // Draining puts the tail in front of what follows it, which can take
+    // up to an overlap more than the writer may fill
+    ws->buf = calloc(ws->capacity + ws->overlap, sizeof(int16_t));
+    ws->tail = calloc(ws->overlap, sizeof(int16_t));
+    if (!ws->buf || !ws->tail) {
+        audio_wsola_destroy(ws);
+        return ESP_ERR_NO_MEM;
+    }
+    ws->rate_q10 = AUDIO_WSOLA_RATE_UNITY;
+    *out_ws = ws;
+    return ESP_OK;
+}
+
+void audio_wsola_destroy(audio_wsola_t* ws) {
+    if (!ws) {
+        return;
+    }
+    free(ws->buf);
+    free(ws->tail);
+    free(ws);
+}
+
+size_t audio_wsola_block_samples(const audio_wsola_t* ws) {
+    return ws->block;
+}
+
+void audio_wsola_set_rate(audio_wsola_t* ws, int32_t rate_q10) {
+    ws->rate_q10 = rate_q10 < 512 ? 512 : (rate_q10 > 2048 ? 2048 : rate_q10);
+}
+
+int32_t audio_wsola_get_rate(const audio_wsola_t* ws) {
+    return ws->rate_q10;
+}
+
+size_t audio_wsola_write(audio_wsola_t* ws, const int16_t* samples, size_t count) {
+    size_t n = ws->capacity - ws->fill;
+    n = count < n ? count : n;
+    memcpy(ws->buf + ws->fill, samples, n * sizeof(int16_t));
+    ws->fill += n;
+    return n;
+}
+
+// How well the input at x continues the tail, every step-th sample
+static float score(const int16_t* tail, const int16_t* x, size_t count, size_t step) {
+    int32_t corr = audio_dsp_correlate_s16(tail, x, count, step);
+    int32_t energy = audio_dsp_correlate_s16(x, x, count, step);
+    return corr > 0 ? (float)corr * (float)corr / (float)(energy + 1) : 0.0f;
+}
+
+// Offset in 0 .. seek - 1 where the input continues the tail best: a
+// coarse search on every other sample and offset, refined around the
+// winner
+static size_t best_offset(const audio_wsola_t* ws) {
+    const int16_t* x = ws->buf;
+    const size_t ov = ws->overlap;
+    size_t best = 0;
+    float best_score = -1.0f;
+    for (size_t off = 0; off < ws->seek; off += 2) {
+        float s = score(ws->tail, x + off, ov, 2);
+        if (s > best_score) {
+            best_score = s;
+            best = off;
+        }
+    }
+    size_t lo = best > 0 ? best - 1 : 0;
+    size_t hi = best + 1 < ws->seek ? best + 1 : best;
+    best_score = -1.0f;
+    size_t coarse = best;
+    for (size_t off = lo; off <= hi; off++) {
+        float s = score(ws->tail, x + off, ov, 1);
+        if (s > best_score) {
+            best_score = s;
+            best = off;
+        }
+    }
+    return best_score > 0.0f ? best : coarse;
+}
+
+// One output block: fade the tail into the chosen segment, copy its middle,
+// keep its end as the next tail, then move the input on by rate x block
+static void produce_block(audio_wsola_t* ws, int16_t* out) {
+    const size_t ov = ws->overlap;
+    const bool stretch = ws->rate_q10 != AUDIO_WSOLA_RATE_UNITY;
+    size_t off = stretch && ws->primed ? best_offset(ws) : 0;
+    const int16_t* seg = ws->buf + off;
+
+    if (ws->primed) {
+        for (size_t i = 0; i < ov; i++) {
+            out[i] = (int16_t)(((int32_t)ws->tail[i] * (int32_t)(ov - i) + (int32_t)seg[i] * (int32_t)i) / (int32_t)ov);
+        }
+    } else {
+        memcpy(out, seg, ov * sizeof(int16_t));
+    }
+    memcpy(out + ov, seg + ov, (ws->block - ov) * sizeof(int16_t));
+    memcpy(ws->tail, seg + ws->block, ov * sizeof(int16_t));
+    ws->primed = true;
+
+    ws->frac += (uint32_t)ws->rate_q10 * ws->block;
+    size_t skip = ws->frac >> 10;
+    ws->frac &= AUDIO_WSOLA_RATE_UNITY - 1;
+    memmove(ws->buf, ws->buf + skip, (ws->fill - skip) * sizeof(int16_t));
+    ws->fill -= skip;
+    size_t next = off + ws->block + ov;
+    ws->resume = next > skip ? next - skip : 0;
+
+    ws->stats.blocks++;
+    ws->stats.fast_blocks += ws->rate_q10 > AUDIO_WSOLA_RATE_UNITY;
+    ws->stats.slow_blocks += ws->rate_q10 < AUDIO_WSOLA_RATE_UNITY;
+    ws->saved_samples += (int64_t)skip - (int64_t)ws->block;
+}
+
+size_t audio_wsola_read(audio_wsola_t* ws, int16_t* out, size_t count) {
+    size_t done = 0;
+    while (count - done >= ws->block) {
+        // The segment and its tail, anywhere in the seek window, and the
+        // whole skip must be stored
+        size_t skip = ((size_t)ws->rate_q10 * ws->block + ws->frac) >> 10;
+        size_t need = ws->block + ws->overlap;
+        need += ws->rate_q10 != AUDIO_WSOLA_RATE_UNITY ? ws->seek : 0;
+        need = need > skip ? need : skip;
+        if (ws->fill < need) {
+            break;
+        }
+        produce_block(ws, out + done);
+        done += ws->block;
+    }
+    return done;
+}
+
+size_t audio_wsola_drain(audio_wsola_t* ws, int16_t* out, size_t count) {
+    if (ws->primed) {
+        // The tail continues what was played; the input that followed it
+        // in its segment comes next
+        size_t resume = ws->resume < ws->fill ? ws->resume : ws->fill;
+        memmove(ws->buf + ws->overlap, ws->buf + resume, (ws->fill - resume) * sizeof(int16_t));
+        memcpy(ws->buf, ws->tail, ws->overlap * sizeof(int16_t));
+        ws->fill = ws->overlap + ws->fill - resume;
+        ws->primed = false;
+    }
+    size_t n = count < ws->fill ? count : ws->fill;
+    memcpy(out, ws->buf, n * sizeof(int16_t));
+    memmove(ws->buf, ws->buf + n, (ws->fill - n) * sizeof(int16_t));
+    ws->fill -= n;
+    return n;
+}
+
+void audio_wsola_reset(audio_wsola_t* ws) {
+    ws->fill = 0;
+    ws->frac = 0;
+    ws->primed = false;
+}
+
+void audio_wsola_get_stats(const audio_wsola_t* ws, audio_wsola_stats_t* stats) {
+    *stats = ws->stats;
+    stats->saved_ms = (int32_t)(ws->saved_samples * 1000 / ws->sample_rate);
+}
+
+void audio_wsola_reset_stats(audio_wsola_t* ws) {
+    memset(&ws->stats, 0, sizeof(ws->stats));
+    ws->saved_samples = 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Pitch-preserving time stretcher (WSOLA) for 16-bit mono speech
+ *
+ * Output is built one block at a time from overlapping input segments.
+ * Each segment is cross-faded onto the tail of the previous one at the
+ * offset, within a seek window around its nominal position, where the
+ * waveforms line up best (normalized cross-correlation). Segments are
+ * taken from the input at rate times the output block length, so the
+ * audio plays faster or slower while periods, and with them pitch, stay
+ * as they were.
+ *
+ * At unity rate the segments are taken at their nominal positions with
+ * no search, which makes the output bit-exact with the input and costs a
+ * copy.
+ *
+ * Not thread-safe: one task writes input and reads output.
+ */
+typedef struct audio_wsola audio_wsola_t;
+
+/** Rates are Q10: 1024 plays at normal speed, 1126 about 10 % faster */
+#define AUDIO_WSOLA_RATE_UNITY  1024
+
+/**
+ * @brief Stretcher sizing
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t block_ms;      ///< Output produced per segment
+    uint32_t overlap_ms;    ///< Cross-fade between segments, below block_ms
+    uint32_t seek_ms;       ///< Offsets searched for the best match
+} audio_wsola_config_t;
+
+#define AUDIO_WSOLA_CONFIG_DEFAULT() { \
+    .sample_rate = 16000,              \
+    .block_ms = 10,                    \
+    .overlap_ms = 5,                   \
+    .seek_ms = 8,                      \
+}
+
+/**
+ * @brief Stretcher statistics since create or audio_wsola_reset_stats
+ */
+typedef struct {
+    uint32_t blocks;            ///< Output blocks
+    uint32_t fast_blocks;       ///< Blocks produced above unity rate
+    uint32_t slow_blocks;       ///< Blocks produced below unity rate
+    int32_t saved_ms;           ///< Input played minus output time; negative when slowed down
+} audio_wsola_stats_t;
+
+/**
+ * @brief Create a stretcher at unity rate
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM
+ */
+esp_err_t audio_wsola_create(const audio_wsola_config_t* config, audio_wsola_t** out_ws);
+
+/**
+ * @brief Free a stretcher
+ */
+void audio_wsola_destroy(audio_wsola_t* ws);
+
+/**
+ * @brief Samples per output block
+ */
+size_t audio_wsola_block_samples(const audio_wsola_t* ws);
+
+/**
+ * @brief Set the playback rate for the following blocks
+ *
+ * @param rate_q10 Input consumed per output sample in Q10, clamped to
+ *                 0.5 .. 2.0 (512 .. 2048)
+ */
+void audio_wsola_set_rate(audio_wsola_t* ws, int32_t rate_q10);
+
+/**
+ * @brief Current playback rate in Q10
+ */
+int32_t audio_wsola_get_rate(const audio_wsola_t* ws);
+
+/**
+ * @brief Append input
+ *
+ * @return Samples taken; fewer than count when the input store is full,
+ *         which audio_wsola_read empties block by block
+ */
+size_t audio_wsola_write(audio_wsola_t* ws, const int16_t* samples, size_t count);
+
+/**
+ * @brief Produce output blocks from the stored input
+ *
+ * @param out Receives the output
+ * @param count Room in out
+ * @return Samples written, a whole number of blocks; 0 when more input is needed
+ */
+size_t audio_wsola_read(audio_wsola_t* ws, int16_t* out, size_t count);
+
+/**
+ * @brief Take the stored input as it is, without stretching
+ *
+ * For the end of a stream, when no more input is coming to complete a
+ * block. Call again until it returns 0.
+ *
+ * @return Samples written
+ */
+size_t audio_wsola_drain(audio_wsola_t* ws, int16_t* out, size_t count);
+
+/**
+ * @brief Drop stored input; the rate is kept
+ */
+void audio_wsola_reset(audio_wsola_t* ws);
+
+/**
+ * @brief Get stretcher statistics
+ */
+void audio_wsola_get_stats(const audio_wsola_t* ws, audio_wsola_stats_t* stats);
+
+/**
+ * @brief Clear the statistics
+ */
+void audio_wsola_reset_stats(audio_wsola_t* ws);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,6 +3,7 @@
 #include "esp_spiffs.h"
 #include <string.h>
 #include <stdio.h>
+#include <inttypes.h>
 
 #define TAG "CONFIG_MGR"
 
@@ -10,10 +11,221 @@ static app_config_t s_cfg = {
     .wifi = {"your-ssid", "your-password"},
     .openai = {"sk-xxxxx", "alloy"},
     .sleep_timeout_sec = 60,
+    .vad = {
+        .enabled = true,
+        .threshold_db = -45,
+        .margin_db = 9,
+        .zcr_max = 250,
+        .hangover_ms = 400,
+    },
+    .noise_suppression = {
+        .enabled = false,
+        .max_attenuation_db = 15,
+    },
+    .codec = {"pcm16", "pcm16"},
+    .mic = {
+        .preroll_ms = 500,
+    },
+    .wake_word = {
+        .enabled = false,
+        .model = "/spiffs/wakeword.bin",
+        .threshold_pct = 80,
+        .refractory_ms = 1500,
+    },
+    .jitter_buffer = {
+        .start_ms = 80,
+        .max_ms = 400,
+        .capacity_ms = 1500,
+        .stretch_pct = 10,
+        .conceal_ms = 200,
+    },
+    .barge_in = {
+        .enabled = true,
+        .discard_ms = 500,
+    },
+    .speaker = {
+        .volume_pct = 100,
+        .ceiling_db = -1,
+        .lookahead_ms = 2,
+        .threshold_db = -18,
+        .ratio = 3,
+        .attack_ms = 5,
+        .release_ms = 150,
+        .makeup_db = 6,
+    },
+    .session = {
+        .preconnect = true,
+        .keepalive_s = 20,
+        .max_age_s = 1500,
+    },
+    .uplink = {
+        .frame_ms = 40,
+    },
 };
 
+// Top-level YAML key the current indented lines belong to
+static char s_section[24];
+
+static bool parse_bool(const char* value) {
+    while (*value == ' ') value++;
+    return strncmp(value, "true", 4) == 0 || strncmp(value, "yes", 3) == 0 || *value == '1';
+}
+
+static void parse_vad_line(const char* line) {
+    if (strncmp(line, "enabled:", 8) == 0) {
+        s_cfg.vad.enabled = parse_bool(line + 8);
+    } else if (strncmp(line, "threshold_db:", 13) == 0) {
+        sscanf(line + 13, "%" SCNd32, &s_cfg.vad.threshold_db);
+    } else if (strncmp(line, "margin_db:", 10) == 0) {
+        sscanf(line + 10, "%" SCNu32, &s_cfg.vad.margin_db);
+    } else if (strncmp(line, "zcr_max:", 8) == 0) {
+        sscanf(line + 8, "%" SCNu32, &s_cfg.vad.zcr_max);
+    } else if (strncmp(line, "hangover_ms:", 12) == 0) {
+        sscanf(line + 12, "%" SCNu32, &s_cfg.vad.hangover_ms);
+    }
+}
+
+static void parse_ns_line(const char* line) {
+    if (strncmp(line, "enabled:", 8) == 0) {
+        s_cfg.noise_suppression.enabled = parse_bool(line + 8);
+    } else if (strncmp(line, "max_attenuation_db:", 19) == 0) {
+        sscanf(line + 19, "%" SCNu32, &s_cfg.noise_suppression.max_attenuation_db);
+    }
+}
+
+// Bare identifier, optionally quoted
+static void parse_name(const char* value, char* out) {
+    while (*value == ' ' || *value == '"') value++;
+    sscanf(value, "%15[a-z0-9_]", out);
+}
+
+static void parse_codec_line(const char* line) {
+    if (strncmp(line, "uplink:", 7) == 0) {
+        parse_name(line + 7, s_cfg.codec.uplink);
+    } else if (strncmp(line, "downlink:", 9) == 0) {
+        parse_name(line + 9, s_cfg.codec.downlink);
+    }
+}
+
+static void parse_mic_line(const char* line) {
+    if (strncmp(line, "preroll_ms:", 11) == 0) {
+        sscanf(line + 11, "%" SCNu32, &s_cfg.mic.preroll_ms);
+    }
+}
+
+static void parse_wake_word_line(const char* line) {
+    if (strncmp(line, "enabled:", 8) == 0) {
+        s_cfg.wake_word.enabled = parse_bool(line + 8);
+    } else if (strncmp(line, "model:", 6) == 0) {
+        const char* value = line + 6;
+        while (*value == ' ' || *value == '"') value++;
+        sscanf(value, "%47[^\" \r\n#]", s_cfg.wake_word.model);
+    } else if (strncmp(line, "threshold_pct:", 14) == 0) {
+        sscanf(line + 14, "%" SCNu32, &s_cfg.wake_word.threshold_pct);
+    } else if (strncmp(line, "refractory_ms:", 14) == 0) {
+        sscanf(line + 14, "%" SCNu32, &s_cfg.wake_word.refractory_ms);
+    }
+}
+
+static void parse_jitter_buffer_line(const char* line) {
+    if (strncmp(line, "start_ms:", 9) == 0) {
+        sscanf(line + 9, "%" SCNu32, &s_cfg.jitter_buffer.start_ms);
+    } else if (strncmp(line, "max_ms:", 7) == 0) {
+        sscanf(line + 7, "%" SCNu32, &s_cfg.jitter_buffer.max_ms);
+    } else if (strncmp(line, "capacity_ms:", 12) == 0) {
+        sscanf(line + 12, "%" SCNu32, &s_cfg.jitter_buffer.capacity_ms);
+    } else if (strncmp(line, "stretch_pct:", 12) == 0) {
+        sscanf(line + 12, "%" SCNu32, &s_cfg.jitter_buffer.stretch_pct);
+    } else if (strncmp(line, "conceal_ms:", 11) == 0) {
+        sscanf(line + 11, "%" SCNu32, &s_cfg.jitter_buffer.conceal_ms);
+    }
+}
+
+static void parse_barge_in_line(const char* line) {
+    if (strncmp(line, "enabled:", 8) == 0) {
+        s_cfg.barge_in.enabled = parse_bool(line + 8);
+    } else if (strncmp(line, "discard_ms:", 11) == 0) {
+        sscanf(line + 11, "%" SCNu32, &s_cfg.barge_in.discard_ms);
+    }
+}
+
+static void parse_speaker_line(const char* line) {
+    if (strncmp(line, "volume_pct:", 11) == 0) {
+        sscanf(line + 11, "%" SCNu32, &s_cfg.speaker.volume_pct);
+    } else if (strncmp(line, "ceiling_db:", 11) == 0) {
+        sscanf(line + 11, "%" SCNd32, &s_cfg.speaker.ceiling_db);
+    } else if (strncmp(line, "lookahead_ms:", 13) == 0) {
+        sscanf(line + 13, "%" SCNu32, &s_cfg.speaker.lookahead_ms);
+    } else if (strncmp(line, "threshold_db:", 13) == 0) {
+        sscanf(line + 13, "%" SCNd32, &s_cfg.speaker.threshold_db);
+    } else if (strncmp(line, "ratio:", 6) == 0) {
+        sscanf(line + 6, "%" SCNu32, &s_cfg.speaker.ratio);
+    } else if (strncmp(line, "attack_ms:", 10) == 0) {
+        sscanf(line + 10, "%" SCNu32, &s_cfg.speaker.attack_ms);
+    } else if (strncmp(line, "release_ms:", 11) == 0) {
+        sscanf(line + 11, "%" SCNu32, &s_cfg.speaker.release_ms);
+    } else if (strncmp(line, "makeup_db:", 10) == 0) {
+        sscanf(line + 10, "%" SCNd32, &s_cfg.speaker.makeup_db);
+    }
+}
+
+static void parse_session_line(const char* line) {
+    if (strncmp(line, "preconnect:", 11) == 0) {
+        s_cfg.session.preconnect = parse_bool(line + 11);
+    } else if (strncmp(line, "keepalive_s:", 12) == 0) {
+        sscanf(line + 12, "%" SCNu32, &s_cfg.session.keepalive_s);
+    } else if (strncmp(line, "max_age_s:", 10) == 0) {
+        sscanf(line + 10, "%" SCNu32, &s_cfg.session.max_age_s);
+    }
+}
+
+static void parse_uplink_line(const char* line) {
+    if (strncmp(line, "frame_ms:", 9) == 0) {
+        sscanf(line + 9, "%" SCNu32, &s_cfg.uplink.frame_ms);
+    }
+}
+
 static void parse_line(const char* line) {
-    if (strncmp(line, "ssid:", 5) == 0) {
+    if (line[0] == '#' || line[0] == '\r' || line[0] == '\n' || line[0] == '\0') {
+        return;
+    }
+
+    // An unindented "name:" with nothing after the colon opens a section
+    if (line[0] != ' ' && line[0] != '\t') {
+        const char* colon = strchr(line, ':');
+        if (colon && strspn(colon + 1, " \t\r\n") == strlen(colon + 1)) {
+            if (sscanf(line, "%23[^:]", s_section) != 1) {
+                s_section[0] = '\0';
+            }
+            return;
+        }
+        s_section[0] = '\0';
+    }
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+
+    if (strcmp(s_section, "vad") == 0) {
+        parse_vad_line(line);
+    } else if (strcmp(s_section, "noise_suppression") == 0) {
+        parse_ns_line(line);
+    } else if (strcmp(s_section, "codec") == 0) {
+        parse_codec_line(line);
+    } else if (strcmp(s_section, "mic") == 0) {
+        parse_mic_line(line);
+    } else if (strcmp(s_section, "wake_word") == 0) {
+        parse_wake_word_line(line);
+    } else if (strcmp(s_section, "jitter_buffer") == 0) {
+        parse_jitter_buffer_line(line);
+    } else if (strcmp(s_section, "barge_in") == 0) {
+        parse_barge_in_line(line);
+    } else if (strcmp(s_section, "speaker") == 0) {
+        parse_speaker_line(line);
+    } else if (strcmp(s_section, "session") == 0) {
+        parse_session_line(line);
+    } else if (strcmp(s_section, "uplink") == 0) {
+        parse_uplink_line(line);
+    } else if (strncmp(line, "ssid:", 5) == 0) {
         sscanf(line + 5, "%31s", s_cfg.wifi.ssid);
     } else if (strncmp(line, "password:", 9) == 0) {
         sscanf(line + 9, "%63s", s_cfg.wifi.password);
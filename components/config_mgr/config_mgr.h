@@ -4,6 +4,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef struct {
     char ssid[32];
@@ -15,10 +16,83 @@ typedef struct {
     char voice[16];
 } openai_config_t;
 
+typedef struct {
+    bool enabled;
+    int32_t threshold_db;
+    uint32_t margin_db;
+    uint32_t zcr_max;
+    uint32_t hangover_ms;
+} vad_config_t;
+
+typedef struct {
+    bool enabled;
+    uint32_t max_attenuation_db;
+} ns_config_t;
+
+typedef struct {
+    uint32_t preroll_ms;    // audio kept from before the press, 0 to disable
+} mic_config_t;
+
+typedef struct {
+    bool enabled;           // start conversations hands-free, needs pre-roll
+    char model[48];         // keyword model blob, see mic_kws.h
+    uint32_t threshold_pct;
+    uint32_t refractory_ms;
+} wake_word_config_t;
+
+typedef struct {
+    uint32_t start_ms;      // response audio buffered before playback starts
+    uint32_t max_ms;        // ceiling for the jitter-adapted depth
+    uint32_t capacity_ms;   // storage; audio beyond it is dropped
+    uint32_t stretch_pct;   // playback speed change that steers the depth to target, 0 to disable
+    uint32_t conceal_ms;    // longest gap filled by packet loss concealment, 0 to disable
+} jitter_buffer_config_t;
+
+typedef struct {
+    bool enabled;           // cut playback when the user starts speaking, needs the VAD
+    uint32_t discard_ms;    // response audio arriving this soon after the cut is dropped
+} barge_in_config_t;
+
+typedef struct {
+    uint32_t volume_pct;    // master volume, ramped on change
+    int32_t ceiling_db;     // limiter ceiling (dBFS)
+    uint32_t lookahead_ms;  // limiter look-ahead, added to playback latency
+    int32_t threshold_db;   // compressor threshold (dBFS)
+    uint32_t ratio;         // n:1 above the threshold, 1 disables the compressor
+    uint32_t attack_ms;
+    uint32_t release_ms;
+    int32_t makeup_db;      // gain after compression
+} speaker_config_t;
+
+typedef struct {
+    bool preconnect;        // open the Realtime session at boot and keep it between conversations
+    uint32_t keepalive_s;   // ping interval while the session is idle
+    uint32_t max_age_s;     // an idle session this old is replaced, under the service's limit
+} session_config_t;
+
+typedef struct {
+    uint32_t frame_ms;      // mic audio per append event: 20, 40 or 100
+} uplink_config_t;
+
+typedef struct {
+    char uplink[16];        // wire format names, see audio_codec_is_wire_format
+    char downlink[16];
+} codec_config_t;
+
 typedef struct {
     wifi_config_t wifi;
     openai_config_t openai;
     uint32_t sleep_timeout_sec;
+    vad_config_t vad;
+    ns_config_t noise_suppression;
+    codec_config_t codec;
+    mic_config_t mic;
+    wake_word_config_t wake_word;
+    jitter_buffer_config_t jitter_buffer;
+    barge_in_config_t barge_in;
+    speaker_config_t speaker;
+    session_config_t session;
+    uplink_config_t uplink;
 } app_config_t;
 
 const app_config_t* config_mgr_get(void);
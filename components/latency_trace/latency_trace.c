@@ -0,0 +1,223 @@
+#include "latency_trace.h"
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+
+#define TAG "LATENCY"
+
+// Bucket 0 holds spans under 2^10 us; after it each octave 2^e .. 2^(e+1)
+// is split in four, up to LATENCY_OCTAVE_MAX; the last bucket takes the rest
+#define LATENCY_OCTAVE_MIN      10
+#define LATENCY_OCTAVE_MAX      22
+#define LATENCY_SUB_BITS        2
+#define LATENCY_OVERFLOW_BUCKET (LATENCY_TRACE_BUCKETS - 1)
+
+_Static_assert(LATENCY_OVERFLOW_BUCKET ==
+               1 + (LATENCY_OCTAVE_MAX - LATENCY_OCTAVE_MIN + 1) * (1 << LATENCY_SUB_BITS),
+               "bucket count does not match the octave range");
+
+// The phase of an open span is the low two bits of its state word; the
+// rest counts begins, so an end that raced with a new begin cannot close
+// the new span with the old start
+#define SPAN_CLOSED     0u
+#define SPAN_WRITING    1u
+#define SPAN_OPEN       2u
+#define SPAN_PHASE      3u
+#define SPAN_GEN_STEP   4u
+
+typedef struct {
+    atomic_uint buckets[LATENCY_TRACE_BUCKETS];
+    atomic_uint max_us;
+} latency_hist_t;
+
+typedef struct {
+    atomic_uint state;
+    atomic_uint start_us;   // low 32 bits of the esp_timer time
+} latency_open_t;
+
+static latency_hist_t s_hist[LATENCY_SCOPE_COUNT][LATENCY_SPAN_COUNT];
+static latency_open_t s_open[LATENCY_SPAN_COUNT];
+
+static const char* const s_span_names[LATENCY_SPAN_COUNT] = {
+    [LATENCY_SPAN_PRESS_READY] = "press_ready",
+    [LATENCY_SPAN_UPLINK]      = "uplink",
+    [LATENCY_SPAN_RESPONSE]    = "response",
+    [LATENCY_SPAN_DOWNLINK]    = "downlink",
+    [LATENCY_SPAN_END_TO_END]  = "end_to_end",
+    [LATENCY_SPAN_OUTPUT]      = "output",
+    [LATENCY_SPAN_BARGE_IN]    = "barge_in",
+};
+
+static uint32_t bucket_of(uint32_t us) {
+    if (us < (1u << LATENCY_OCTAVE_MIN)) {
+        return 0;
+    }
+    uint32_t octave = 31 - (uint32_t)__builtin_clz(us);
+    if (octave > LATENCY_OCTAVE_MAX) {
+        return LATENCY_OVERFLOW_BUCKET;
+    }
+    uint32_t sub = (us >> (octave - LATENCY_SUB_BITS)) & ((1u << LATENCY_SUB_BITS) - 1);
+    return 1 + ((octave - LATENCY_OCTAVE_MIN) << LATENCY_SUB_BITS) + sub;
+}
+
+// Lower bound of a bucket; the next bucket's lower bound is its upper one
+static uint32_t bucket_floor(uint32_t bucket) {
+    if (bucket == 0) {
+        return 0;
+    }
+    if (bucket >= LATENCY_OVERFLOW_BUCKET) {
+        return 1u << (LATENCY_OCTAVE_MAX + 1);
+    }
+    uint32_t octave = LATENCY_OCTAVE_MIN + ((bucket - 1) >> LATENCY_SUB_BITS);
+    uint32_t sub = (bucket - 1) & ((1u << LATENCY_SUB_BITS) - 1);
+    return ((1u << LATENCY_SUB_BITS) + sub) << (octave - LATENCY_SUB_BITS);
+}
+
+static void hist_add(latency_hist_t* hist, uint32_t us) {
+    atomic_fetch_add_explicit(&hist->buckets[bucket_of(us)], 1, memory_order_relaxed);
+    uint32_t max = atomic_load_explicit(&hist->max_us, memory_order_relaxed);
+    while (us > max && !atomic_compare_exchange_weak_explicit(&hist->max_us, &max, us,
+                                                               memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void latency_trace_record(latency_span_t span, int64_t duration_us) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) {
+        return;
+    }
+    uint32_t us = duration_us <= 0 ? 0 : (duration_us >= UINT32_MAX ? UINT32_MAX : (uint32_t)duration_us);
+    for (int scope = 0; scope < LATENCY_SCOPE_COUNT; scope++) {
+        hist_add(&s_hist[scope][span], us);
+    }
+}
+
+void latency_trace_begin(latency_span_t span, int64_t at_us) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) {
+        return;
+    }
+    latency_open_t* open = &s_open[span];
+    uint32_t state = atomic_load_explicit(&open->state, memory_order_relaxed);
+    uint32_t claimed;
+    do {
+        // A begin already writing the start is just as recent as this one
+        if ((state & SPAN_PHASE) == SPAN_WRITING) {
+            return;
+        }
+        claimed = ((state & ~SPAN_PHASE) + SPAN_GEN_STEP) | SPAN_WRITING;
+    } while (!atomic_compare_exchange_weak_explicit(&open->state, &state, claimed,
+                                                    memory_order_acquire, memory_order_relaxed));
+    atomic_store_explicit(&open->start_us, (uint32_t)at_us, memory_order_relaxed);
+    atomic_store_explicit(&open->state, (claimed & ~SPAN_PHASE) | SPAN_OPEN, memory_order_release);
+}
+
+bool latency_trace_end(latency_span_t span, int64_t at_us) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) {
+        return false;
+    }
+    latency_open_t* open = &s_open[span];
+    uint32_t state = atomic_load_explicit(&open->state, memory_order_acquire);
+    if ((state & SPAN_PHASE) != SPAN_OPEN) {
+        return false;
+    }
+    uint32_t start_us = atomic_load_explicit(&open->start_us, memory_order_relaxed);
+    // Fails if another end took the span or a begin restarted it meanwhile
+    if (!atomic_compare_exchange_strong_explicit(&open->state, &state, state & ~SPAN_PHASE,
+                                                 memory_order_acq_rel, memory_order_relaxed)) {
+        return false;
+    }
+    // Modular difference of the low 32 bits; an end stamped before the
+    // begin (clock reads on two cores) comes out negative
+    latency_trace_record(span, (int32_t)((uint32_t)at_us - start_us));
+    return true;
+}
+
+void latency_trace_cancel(latency_span_t span) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) {
+        return;
+    }
+    latency_open_t* open = &s_open[span];
+    uint32_t state = atomic_load_explicit(&open->state, memory_order_relaxed);
+    while ((state & SPAN_PHASE) == SPAN_OPEN &&
+           !atomic_compare_exchange_weak_explicit(&open->state, &state, state & ~SPAN_PHASE,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+bool latency_trace_is_open(latency_span_t span) {
+    if ((unsigned)span >= LATENCY_SPAN_COUNT) {
+        return false;
+    }
+    return (atomic_load_explicit(&s_open[span].state, memory_order_relaxed) & SPAN_PHASE) == SPAN_OPEN;
+}
+
+void latency_trace_reset(void) {
+    for (int span = 0; span < LATENCY_SPAN_COUNT; span++) {
+        latency_trace_cancel((latency_span_t)span);
+        latency_hist_t* hist = &s_hist[LATENCY_SCOPE_RECENT][span];
+        for (int b = 0; b < LATENCY_TRACE_BUCKETS; b++) {
+            atomic_store_explicit(&hist->buckets[b], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&hist->max_us, 0, memory_order_relaxed);
+    }
+}
+
+// Value below which a fraction pct of the spans fall, interpolated in its bucket
+static uint32_t percentile(const uint32_t* counts, uint32_t total, uint32_t max_us, uint32_t pct) {
+    uint32_t rank = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+    rank = rank ? rank : 1;
+    uint32_t seen = 0;
+    for (uint32_t b = 0; b < LATENCY_TRACE_BUCKETS; b++) {
+        if (counts[b] == 0 || seen + counts[b] < rank) {
+            seen += counts[b];
+            continue;
+        }
+        uint32_t lo = bucket_floor(b);
+        uint32_t hi = b == LATENCY_OVERFLOW_BUCKET ? max_us : bucket_floor(b + 1);
+        hi = hi < max_us ? hi : max_us;
+        lo = lo < hi ? lo : hi;
+        return lo + (uint32_t)((uint64_t)(hi - lo) * (rank - seen) / counts[b]);
+    }
+    return max_us;
+}
+
+void latency_trace_get(latency_span_t span, latency_scope_t scope, latency_trace_summary_t* summary) {
+    memset(summary, 0, sizeof(*summary));
+    if ((unsigned)span >= LATENCY_SPAN_COUNT || (unsigned)scope >= LATENCY_SCOPE_COUNT) {
+        return;
+    }
+    // Writers keep going; the snapshot may be a few samples off between buckets
+    const latency_hist_t* hist = &s_hist[scope][span];
+    uint32_t counts[LATENCY_TRACE_BUCKETS];
+    for (int b = 0; b < LATENCY_TRACE_BUCKETS; b++) {
+        counts[b] = atomic_load_explicit(&hist->buckets[b], memory_order_relaxed);
+        summary->count += counts[b];
+    }
+    summary->max_us = atomic_load_explicit(&hist->max_us, memory_order_relaxed);
+    if (summary->count == 0) {
+        return;
+    }
+    summary->p50_us = percentile(counts, summary->count, summary->max_us, 50);
+    summary->p95_us = percentile(counts, summary->count, summary->max_us, 95);
+    summary->p99_us = percentile(counts, summary->count, summary->max_us, 99);
+}
+
+void latency_trace_dump(latency_scope_t scope) {
+    for (int span = 0; span < LATENCY_SPAN_COUNT; span++) {
+        latency_trace_summary_t s;
+        latency_trace_get((latency_span_t)span, scope, &s);
+        if (s.count == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-11s %s: %5lu, p50 %lu.%lu ms, p95 %lu.%lu ms, p99 %lu.%lu ms, max %lu.%lu ms",
+                 s_span_names[span], scope == LATENCY_SCOPE_BOOT ? "since boot" : "recent",
+                 (unsigned long)s.count,
+                 (unsigned long)(s.p50_us / 1000), (unsigned long)(s.p50_us / 100 % 10),
+                 (unsigned long)(s.p95_us / 1000), (unsigned long)(s.p95_us / 100 % 10),
+                 (unsigned long)(s.p99_us / 1000), (unsigned long)(s.p99_us / 100 % 10),
+                 (unsigned long)(s.max_us / 1000), (unsigned long)(s.max_us / 100 % 10));
+    }
+}
+
+const char* latency_trace_span_name(latency_span_t span) {
+    return (unsigned)span < LATENCY_SPAN_COUNT ? s_span_names[span] : "?";
+}
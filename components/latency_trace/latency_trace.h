@@ -0,0 +1,131 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Latency spans through the voice pipeline, kept as histograms
+ *
+ * A span runs between two pipeline milestones. It is opened with
+ * latency_trace_begin where the first milestone happens and closed with
+ * latency_trace_end where the second does; spans measured in one place are
+ * passed to latency_trace_record instead. Every closed span lands in two
+ * fixed-bucket histograms, one since boot and one since the last
+ * latency_trace_reset, from which p50/p95/p99 are read.
+ *
+ * Everything is lock-free: recording is a handful of relaxed atomic
+ * additions, safe from any task or esp_timer callback, and readers take a
+ * snapshot without stopping the writers. Times are esp_timer microseconds;
+ * only their low 32 bits are kept, so a span must be shorter than about
+ * 71 minutes.
+ */
+typedef enum {
+    LATENCY_SPAN_PRESS_READY = 0,   ///< Conversation requested -> session ready
+    LATENCY_SPAN_UPLINK,            ///< Mic frame captured -> handed to the SDK
+    LATENCY_SPAN_RESPONSE,          ///< User's speech ended -> first response byte received
+    LATENCY_SPAN_DOWNLINK,          ///< First response byte -> its first sample out of the speaker
+    LATENCY_SPAN_END_TO_END,        ///< User's speech ended -> first response sample out of the speaker
+    LATENCY_SPAN_OUTPUT,            ///< Audio queued to the output driver -> played
+    LATENCY_SPAN_BARGE_IN,          ///< Speech onset during playback -> speaker silent
+    LATENCY_SPAN_COUNT,
+} latency_span_t;
+
+/**
+ * @brief Which histogram of a span to read
+ */
+typedef enum {
+    LATENCY_SCOPE_BOOT = 0,         ///< Everything since boot
+    LATENCY_SCOPE_RECENT,           ///< Since the last latency_trace_reset, e.g. this conversation
+    LATENCY_SCOPE_COUNT,
+} latency_scope_t;
+
+/**
+ * Histogram buckets: one below 1.024 ms, four per octave up to 8.4 s (each
+ * a quarter of its lower bound wide or less), and one for longer spans
+ */
+#define LATENCY_TRACE_BUCKETS   54
+
+/**
+ * @brief Percentiles of one span's histogram
+ *
+ * Percentiles are interpolated linearly inside the bucket they fall in and
+ * never exceed the longest span seen, so they are good to about a bucket's
+ * width (a quarter of the value at most).
+ */
+typedef struct {
+    uint32_t count;     ///< Spans recorded
+    uint32_t p50_us;
+    uint32_t p95_us;
+    uint32_t p99_us;
+    uint32_t max_us;    ///< Longest span recorded
+} latency_trace_summary_t;
+
+/**
+ * @brief Open a span at the time its first milestone happened
+ *
+ * Opening a span that is already open moves its start, so the latest
+ * milestone wins (the user pausing and speaking again ends their turn
+ * later).
+ */
+void latency_trace_begin(latency_span_t span, int64_t at_us);
+
+/**
+ * @brief Close a span and record it
+ *
+ * Only the first end after a begin records anything, so the caller may
+ * call it for every occurrence of the closing milestone (every downlink
+ * chunk, every played period) and the first one after the opening
+ * milestone is taken.
+ *
+ * @return true if the span was open and has been recorded
+ */
+bool latency_trace_end(latency_span_t span, int64_t at_us);
+
+/**
+ * @brief Drop a span opened but not yet closed
+ */
+void latency_trace_cancel(latency_span_t span);
+
+/**
+ * @brief Check whether a span has been opened and not yet closed
+ */
+bool latency_trace_is_open(latency_span_t span);
+
+/**
+ * @brief Record a span measured by the caller
+ *
+ * @param duration_us Span length; negative values count as 0
+ */
+void latency_trace_record(latency_span_t span, int64_t duration_us);
+
+/**
+ * @brief Read the percentiles of a span
+ */
+void latency_trace_get(latency_span_t span, latency_scope_t scope, latency_trace_summary_t* summary);
+
+/**
+ * @brief Clear the LATENCY_SCOPE_RECENT histograms and close all open spans
+ *
+ * Call when a conversation starts, so a span left open by the previous
+ * one (a turn that got no response) cannot close in this one. Spans
+ * recorded concurrently with the reset may be lost.
+ */
+void latency_trace_reset(void);
+
+/**
+ * @brief Log count, p50/p95/p99 and max of every span that has samples
+ */
+void latency_trace_dump(latency_scope_t scope);
+
+/**
+ * @brief Short name of a span for logs
+ */
+const char* latency_trace_span_name(latency_span_t span);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,244 @@
+#include "media_clock.h"
+#include <stdatomic.h>
+#include <string.h>
+
+// Length of the windows whose lower envelope tracks each clock
+#define MEDIA_CLOCK_WINDOW_US   (1000 * 1000)
+
+typedef struct {
+    atomic_uint seq;            // odd while the writer updates the fields below
+    uint32_t nominal_rate;
+    uint32_t queue_samples;     // driver DMA queue depth
+    int64_t queue_us;
+    uint64_t next_index;
+    bool has_stamp;
+    media_clock_stamp_t last;
+    float rate_hz;              // measured, 0 until MEDIA_CLOCK_MIN_SPAN_MS
+    // Offsets are time - index / nominal rate; the true one is the lower
+    // envelope of the observed ones
+    int64_t anchor_off;         // provisional offset until the first observation
+    bool win_valid;
+    int64_t win_start_us;
+    int64_t win_min_off;
+    int64_t win_min_us;
+    bool prev_valid;
+    int64_t prev_min_off;
+    bool ref_valid;             // first complete window, the base of the rate estimate
+    int64_t ref_off;
+    int64_t ref_us;
+} media_clock_state_t;
+
+static media_clock_state_t s_streams[MEDIA_CLOCK_STREAM_COUNT];
+
+// Single writer per stream; readers retry while an update is in progress
+static inline void write_begin(media_clock_state_t* s) {
+    unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void write_end(media_clock_state_t* s) {
+    unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_release);
+}
+
+typedef struct {
+    bool has_stamp;
+    media_clock_stamp_t last;
+    float rate_hz;
+    uint32_t nominal_rate;
+} media_clock_snapshot_t;
+
+static void read_snapshot(media_clock_stream_t stream, media_clock_snapshot_t* snap) {
+    const media_clock_state_t* s = &s_streams[stream];
+    unsigned before, after;
+    do {
+        before = atomic_load_explicit(&s->seq, memory_order_acquire);
+        snap->has_stamp = s->has_stamp;
+        snap->last = s->last;
+        snap->rate_hz = s->rate_hz;
+        snap->nominal_rate = s->nominal_rate;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+static inline int64_t index_us(const media_clock_state_t* s, uint64_t index) {
+    return (int64_t)(index * 1000000ULL / s->nominal_rate);
+}
+
+static int64_t floor_offset(const media_clock_state_t* s) {
+    if (s->win_valid && s->prev_valid) {
+        return s->win_min_off < s->prev_min_off ? s->win_min_off : s->prev_min_off;
+    }
+    if (s->win_valid) {
+        return s->win_min_off;
+    }
+    return s->prev_valid ? s->prev_min_off : s->anchor_off;
+}
+
+// Drops the envelope after a discontinuity (underrun, samples lost in the
+// driver); the measured rate is kept
+static void restart_estimate(media_clock_state_t* s, int64_t offset, int64_t now_us) {
+    s->anchor_off = offset;
+    s->win_valid = false;
+    s->prev_valid = false;
+    s->ref_valid = false;
+    s->win_start_us = now_us;
+}
+
+// At now_us the stream is at most at `index`: the observed offset is never
+// earlier than the true one
+static void observe(media_clock_state_t* s, uint64_t index, int64_t now_us) {
+    int64_t off = now_us - index_us(s, index);
+
+    // Later than the whole driver queue can explain: samples went missing
+    if ((s->win_valid || s->prev_valid) && off > floor_offset(s) + s->queue_us) {
+        restart_estimate(s, off, now_us);
+    }
+
+    if (!s->win_valid || off < s->win_min_off) {
+        s->win_min_off = off;
+        s->win_min_us = now_us;
+        s->win_valid = true;
+    }
+    if (now_us - s->win_start_us < MEDIA_CLOCK_WINDOW_US) {
+        return;
+    }
+
+    if (!s->ref_valid) {
+        s->ref_off = s->win_min_off;
+        s->ref_us = s->win_min_us;
+        s->ref_valid = true;
+    } else if (s->win_min_us - s->ref_us >= MEDIA_CLOCK_MIN_SPAN_MS * 1000LL) {
+        // Offset growing by `slope` us per us means the clock runs slow by that fraction
+        double slope = (double)(s->win_min_off - s->ref_off) / (double)(s->win_min_us - s->ref_us);
+        s->rate_hz = (float)(s->nominal_rate * (1.0 - slope));
+    }
+    s->prev_min_off = s->win_min_off;
+    s->prev_valid = true;
+    s->win_valid = false;
+    s->win_start_us = now_us;
+}
+
+void media_clock_start(media_clock_stream_t stream, uint32_t sample_rate, uint32_t queue_samples) {
+    if (stream >= MEDIA_CLOCK_STREAM_COUNT || sample_rate == 0) {
+        return;
+    }
+    media_clock_state_t* s = &s_streams[stream];
+    write_begin(s);
+    s->nominal_rate = sample_rate;
+    s->queue_samples = queue_samples;
+    s->queue_us = (int64_t)queue_samples * 1000000 / sample_rate;
+    s->next_index = 0;
+    s->has_stamp = false;
+    memset(&s->last, 0, sizeof(s->last));
+    s->rate_hz = 0;
+    restart_estimate(s, 0, 0);
+    write_end(s);
+}
+
+media_clock_stamp_t media_clock_capture(uint32_t samples, int64_t now_us) {
+    media_clock_state_t* s = &s_streams[MEDIA_CLOCK_CAPTURE];
+    media_clock_stamp_t stamp = { 0 };
+    if (s->nominal_rate == 0) {
+        return stamp;
+    }
+
+    write_begin(s);
+    stamp.sample_index = s->next_index;
+    s->next_index += samples;
+    if (!s->has_stamp) {
+        restart_estimate(s, now_us - index_us(s, s->next_index), now_us);
+    }
+    // The read returns once the frame's last sample is in
+    observe(s, s->next_index, now_us);
+    stamp.time_us = index_us(s, stamp.sample_index) + floor_offset(s);
+    s->last = stamp;
+    s->has_stamp = true;
+    write_end(s);
+    return stamp;
+}
+
+media_clock_stamp_t media_clock_playback(uint32_t samples, bool queue_full, int64_t now_us) {
+    media_clock_state_t* s = &s_streams[MEDIA_CLOCK_PLAYBACK];
+    media_clock_stamp_t stamp = { 0 };
+    if (s->nominal_rate == 0) {
+        return stamp;
+    }
+
+    write_begin(s);
+    stamp.sample_index = s->next_index;
+    // If the queued audio already ran out, these samples start playing now
+    int64_t start_us = index_us(s, s->next_index) + floor_offset(s);
+    if (!s->has_stamp || (!queue_full && start_us < now_us)) {
+        restart_estimate(s, now_us - index_us(s, s->next_index), now_us);
+    }
+    s->next_index += samples;
+    if (queue_full && s->next_index >= s->queue_samples) {
+        // A full queue holds queue_samples, so playback is about here
+        observe(s, s->next_index - s->queue_samples, now_us);
+    }
+    stamp.time_us = index_us(s, stamp.sample_index) + floor_offset(s);
+    s->last = stamp;
+    s->has_stamp = true;
+    write_end(s);
+    return stamp;
+}
+
+bool media_clock_get(media_clock_stream_t stream, media_clock_stamp_t* last) {
+    if (stream >= MEDIA_CLOCK_STREAM_COUNT || !last) {
+        return false;
+    }
+    media_clock_snapshot_t snap;
+    read_snapshot(stream, &snap);
+    *last = snap.last;
+    return snap.has_stamp;
+}
+
+static inline double snapshot_rate(const media_clock_snapshot_t* snap) {
+    return snap->rate_hz > 0 ? snap->rate_hz : (double)snap->nominal_rate;
+}
+
+int64_t media_clock_time_of(media_clock_stream_t stream, uint64_t sample_index) {
+    if (stream >= MEDIA_CLOCK_STREAM_COUNT) {
+        return 0;
+    }
+    media_clock_snapshot_t snap;
+    read_snapshot(stream, &snap);
+    if (snap.nominal_rate == 0) {
+        return 0;
+    }
+    int64_t delta = (int64_t)(sample_index - snap.last.sample_index);
+    return snap.last.time_us + (int64_t)(delta * 1e6 / snapshot_rate(&snap));
+}
+
+uint64_t media_clock_sample_at(media_clock_stream_t stream, int64_t time_us) {
+    if (stream >= MEDIA_CLOCK_STREAM_COUNT) {
+        return 0;
+    }
+    media_clock_snapshot_t snap;
+    read_snapshot(stream, &snap);
+    int64_t delta = (int64_t)((time_us - snap.last.time_us) * snapshot_rate(&snap) / 1e6);
+    if (delta < 0 && (uint64_t)-delta > snap.last.sample_index) {
+        return 0;
+    }
+    return snap.last.sample_index + delta;
+}
+
+void media_clock_get_drift(media_clock_drift_t* drift) {
+    if (!drift) {
+        return;
+    }
+    media_clock_snapshot_t cap, play;
+    read_snapshot(MEDIA_CLOCK_CAPTURE, &cap);
+    read_snapshot(MEDIA_CLOCK_PLAYBACK, &play);
+
+    drift->capture_rate_hz = cap.rate_hz;
+    drift->playback_rate_hz = play.rate_hz;
+    drift->valid = cap.rate_hz > 0 && play.rate_hz > 0;
+    // Relative to each stream's nominal rate, so the streams may differ
+    drift->drift_ppm = drift->valid ?
+        (float)(((double)play.rate_hz / play.nominal_rate) /
+                ((double)cap.rate_hz / cap.nominal_rate) - 1.0) * 1e6f : 0.0f;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Sample-accurate clock shared by capture and playback
+ *
+ * Each stream counts samples from its start and pairs every frame with the
+ * esp_timer time its first sample was captured or will be played. The
+ * writer side of a stream (the I2S reader, the playback writer) calls
+ * media_clock_capture / media_clock_playback; any task may query a stream
+ * with the lock-free getters below.
+ *
+ * The actual rate of each I2S clock is estimated from the lower envelope of
+ * (time - index / nominal rate) over one-second windows, which rejects the
+ * scheduling delay that only ever makes an observation late. The ratio of
+ * the two rates is the RX/TX drift.
+ */
+typedef enum {
+    MEDIA_CLOCK_CAPTURE = 0,
+    MEDIA_CLOCK_PLAYBACK,
+    MEDIA_CLOCK_STREAM_COUNT,
+} media_clock_stream_t;
+
+/**
+ * @brief Position of a frame on the media clock
+ */
+typedef struct {
+    uint64_t sample_index;  ///< Index of the frame's first sample since the stream started
+    int64_t time_us;        ///< esp_timer time that sample was captured / will be played
+} media_clock_stamp_t;
+
+/**
+ * @brief Measured clock rates
+ */
+typedef struct {
+    float capture_rate_hz;  ///< 0 until measured
+    float playback_rate_hz; ///< 0 until measured
+    float drift_ppm;        ///< Playback clock relative to capture, positive when TX runs fast
+    bool valid;             ///< Both rates measured over at least MEDIA_CLOCK_MIN_SPAN_MS
+} media_clock_drift_t;
+
+/** Observation span needed before a measured rate is reported */
+#define MEDIA_CLOCK_MIN_SPAN_MS 5000
+
+/**
+ * @brief Start (or restart) a stream at sample index 0
+ *
+ * The last stamp and measured rate of a stream stay readable after its
+ * driver stops, until the stream is started again.
+ *
+ * @param sample_rate Nominal sample rate in Hz
+ * @param queue_samples Samples the driver's DMA queue holds when full
+ */
+void media_clock_start(media_clock_stream_t stream, uint32_t sample_rate, uint32_t queue_samples);
+
+/**
+ * @brief Account a frame the capture driver just returned
+ *
+ * Call from the reader for every frame read, including frames that are
+ * dropped afterwards, so indices keep tracking the I2S clock.
+ *
+ * @param samples Samples in the frame
+ * @param now_us esp_timer_get_time() when the read returned
+ * @return Stamp of the frame's first sample
+ */
+media_clock_stamp_t media_clock_capture(uint32_t samples, int64_t now_us);
+
+/**
+ * @brief Account samples the playback driver just queued
+ *
+ * @param samples Samples accepted by the driver
+ * @param queue_full True if the driver refused part of the write or blocked
+ *                   for space, i.e. its queue is full right now
+ * @param now_us esp_timer_get_time() when the write returned
+ * @return Stamp of the first queued sample, with its predicted play time
+ */
+media_clock_stamp_t media_clock_playback(uint32_t samples, bool queue_full, int64_t now_us);
+
+/**
+ * @brief Stamp of the most recent frame of a stream
+ *
+ * @return false if the stream has not seen a frame since it was started
+ */
+bool media_clock_get(media_clock_stream_t stream, media_clock_stamp_t* last);
+
+/**
+ * @brief Time a sample of the stream was captured / will be played
+ *
+ * Extrapolated from the most recent stamp at the measured rate, or at the
+ * nominal rate until one is available.
+ */
+int64_t media_clock_time_of(media_clock_stream_t stream, uint64_t sample_index);
+
+/**
+ * @brief Sample of the stream captured / played at the given time
+ */
+uint64_t media_clock_sample_at(media_clock_stream_t stream, int64_t time_us);
+
+/**
+ * @brief Measured rates and the drift between them
+ */
+void media_clock_get_drift(media_clock_drift_t* drift);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,9 +1,17 @@
 #include "mic_input.h"
+#include <string.h>
 #include "esp_log.h"
 #include "driver/i2s.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "audio_ring.h"
+#include "mic_preproc.h"
+#include "media_clock.h"
+#include "latency_trace.h"
 
 #define TAG "MIC_INPUT"
 
@@ -11,20 +19,81 @@
 #define I2S_NUM         I2S_NUM_1
 #define I2S_MIC_PIN     34  // Default microphone pin for M5Stack
 #define I2S_BUFFER_SIZE 2048
+#define I2S_DMA_BUF_COUNT 8
+
+// Capture ring between the I2S reader and the consumer task (power of two)
+#define MIC_RING_FRAMES         8
+// Upper bound on a single i2s_read so the reader notices a stop request
+#define MIC_READ_TIMEOUT_MS     100
+// Time mic_input_stop gives both tasks to exit before deleting them
+#define MIC_STOP_TIMEOUT_MS     500
+// Minimum interval between overrun warnings
+#define MIC_OVERRUN_LOG_INTERVAL_US (1000 * 1000)
+// Pre-roll reads one DMA buffer at a time
+#define MIC_PREROLL_READ_BYTES  (I2S_BUFFER_SIZE / 2)
+// The pre-roll task (and the keyword spotter it feeds) stays on the app core
+#define MIC_PREROLL_CORE        (portNUM_PROCESSORS - 1)
 
 typedef struct {
-    TaskHandle_t task_handle;
+    TaskHandle_t task_handle;       // I2S reader (ring producer)
+    TaskHandle_t consumer_handle;   // callback dispatcher, NULL in borrowed-frame mode
+    TaskHandle_t volatile waiter;   // task blocked in mic_input_acquire_frame
+    TaskHandle_t preroll_handle;    // history writer while pre-rolling
     mic_input_data_cb_t data_callback;
     void* user_data;
     size_t buffer_size;
-    bool is_running;
+    volatile bool is_running;
     SemaphoreHandle_t mutex;
+    audio_ring_t* ring;             // pool of DMA-capable frames lent to the consumer
+    media_clock_stamp_t stamps[MIC_RING_FRAMES];    // per ring slot, in commit order
+    bool frame_borrowed;
+    bool frame_from_preroll;
+    uint32_t frames_released;
+    uint32_t ring_frames_read;      // indexes stamps
+    media_clock_stamp_t callback_stamp; // frame currently in the data callback
+    volatile bool preroll_running;
+    int16_t* preroll;               // circular history, written only by the pre-roll task
+    uint32_t preroll_capacity;      // samples
+    uint32_t preroll_head;          // next write position
+    uint32_t preroll_fill;          // valid samples
+    uint64_t preroll_end_index;     // capture index just past the newest history sample
+    uint32_t preroll_pending;       // samples still to hand out after mic_input_start
+    uint32_t preroll_read;          // read position of the next pending sample
+    uint64_t preroll_next_index;    // capture index of the next pending sample
+    uint32_t preroll_delivered;     // samples handed out since mic_input_start
+    int16_t* preroll_frame;         // pending history copied out as one frame
+    size_t preroll_frame_size;
+    mic_kws_t* kws;                 // keyword spotter fed by the pre-roll task, owned by the caller
+    mic_input_kws_cb_t kws_callback;
+    void* kws_user_data;
+    mic_input_speech_cb_t speech_callback;
+    void* speech_user_data;
+    bool speech_open;               // the last frame passed the VAD
+    uint32_t frames_suppressed;
+    uint32_t sample_rate;
+    uint8_t bits_per_sample;
+    mic_preproc_config_t preproc_config;
+    mic_preproc_t preproc;
+    bool preproc_enabled;
+    audio_aec_t* aec;               // echo canceller, owned by the caller
+    mic_ns_config_t ns_config;
+    mic_ns_t ns;
+    bool ns_ready;                  // ns buffers allocated for ns_config
+    mic_vad_config_t vad_config;
+    mic_vad_t vad;
+    volatile bool stages_reconfigure;   // re-init stages before the next frame
+    uint64_t stage_cycles_total;
+    uint32_t stage_cycles_max;
+    uint32_t stage_frames;
 } mic_input_context_t;
 
 static mic_input_context_t s_context = {0};
 
-// Forward declaration
+// Forward declarations
 static void mic_input_task(void* arg);
+static void mic_preroll_task(void* arg);
+static void mic_consumer_task(void* arg);
+static bool mic_input_run_stages(void* data, size_t size);
 
 esp_err_t mic_input_init(uint32_t sample_rate, uint8_t bits_per_sample) {
     if (s_context.mutex != NULL) {
@@ -47,7 +116,7 @@ esp_err_t mic_input_init(uint32_t sample_rate, uint8_t bits_per_sample) {
         .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
+        .dma_buf_count = I2S_DMA_BUF_COUNT,
         .dma_buf_len = I2S_BUFFER_SIZE / 4,
         .use_apll = false,
         .tx_desc_auto_clear = false,
@@ -78,10 +147,20 @@ esp_err_t mic_input_init(uint32_t sample_rate, uint8_t bits_per_sample) {
         return ret;
     }
 
+    // The driver starts clocking straight away; DMA stays paused until
+    // mic_input_start so an idle microphone costs no bus time
+    i2s_stop(I2S_NUM);
+
     s_context.is_running = false;
     s_context.task_handle = NULL;
     s_context.data_callback = NULL;
     s_context.user_data = NULL;
+    s_context.sample_rate = sample_rate;
+    s_context.bits_per_sample = bits_per_sample;
+    s_context.preproc_config = (mic_preproc_config_t)MIC_PREPROC_CONFIG_DEFAULT();
+    s_context.preproc_enabled = true;
+    s_context.vad_config = (mic_vad_config_t)MIC_VAD_CONFIG_DEFAULT();
+    s_context.ns_config = (mic_ns_config_t)MIC_NS_CONFIG_DEFAULT();
 
     ESP_LOGI(TAG, "Microphone input initialized: %lu Hz, %u bits", 
              sample_rate, bits_per_sample);
@@ -99,6 +178,25 @@ void mic_input_deinit(void) {
     // Take mutex to ensure no one is using the microphone
     if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
         i2s_driver_uninstall(I2S_NUM);
+        audio_ring_delete(s_context.ring);
+        s_context.ring = NULL;
+        heap_caps_free(s_context.preroll);
+        heap_caps_free(s_context.preroll_frame);
+        s_context.preroll = NULL;
+        s_context.preroll_frame = NULL;
+        s_context.preroll_capacity = 0;
+        if (s_context.ns_ready) {
+            mic_ns_deinit(&s_context.ns);
+            s_context.ns_ready = false;
+        }
+        // The caller owns these and may free them once we are down; a later
+        // init must not pick up the stale pointers
+        s_context.aec = NULL;
+        s_context.kws = NULL;
+        s_context.kws_callback = NULL;
+        s_context.kws_user_data = NULL;
+        s_context.speech_callback = NULL;
+        s_context.speech_user_data = NULL;
         xSemaphoreGive(s_context.mutex);
     }
 
@@ -108,13 +206,108 @@ void mic_input_deinit(void) {
     ESP_LOGI(TAG, "Microphone input deinitialized");
 }
 
+// Ends the pre-roll task; the history it wrote stays valid. Caller holds the mutex.
+static void mic_stop_preroll_task(void) {
+    s_context.preroll_running = false;
+
+    TickType_t start_ticks = xTaskGetTickCount();
+    while (s_context.preroll_handle != NULL &&
+           (xTaskGetTickCount() - start_ticks) < pdMS_TO_TICKS(MIC_STOP_TIMEOUT_MS)) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    if (s_context.preroll_handle != NULL) {
+        vTaskDelete(s_context.preroll_handle);
+        s_context.preroll_handle = NULL;
+    }
+}
+
+// Hands the newest whole frames of pre-roll history to the consumer
+static esp_err_t mic_take_preroll(size_t buffer_size) {
+    size_t frame_samples = buffer_size / sizeof(int16_t);
+    uint32_t pending = frame_samples ? (s_context.preroll_fill / frame_samples) * frame_samples : 0;
+
+    if (pending > 0 && s_context.preroll_frame_size != buffer_size) {
+        heap_caps_free(s_context.preroll_frame);
+        s_context.preroll_frame = heap_caps_aligned_alloc(16, buffer_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        s_context.preroll_frame_size = s_context.preroll_frame ? buffer_size : 0;
+        if (!s_context.preroll_frame) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_context.preroll_pending = pending;
+    s_context.preroll_read = (s_context.preroll_head + s_context.preroll_capacity - pending) %
+                             (s_context.preroll_capacity ? s_context.preroll_capacity : 1);
+    s_context.preroll_next_index = s_context.preroll_end_index - pending;
+    s_context.preroll_fill = 0;
+    return ESP_OK;
+}
+
+esp_err_t mic_input_start_preroll(uint32_t preroll_ms) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_context.bits_per_sample != 16) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        uint32_t capacity = s_context.sample_rate * preroll_ms / 1000;
+        if (s_context.is_running || s_context.preroll_running) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else if (capacity == 0) {
+            ret = ESP_ERR_INVALID_ARG;
+        } else {
+            // Kept across pre-roll sessions unless the length changes
+            if (s_context.preroll && s_context.preroll_capacity != capacity) {
+                heap_caps_free(s_context.preroll);
+                s_context.preroll = NULL;
+            }
+            if (!s_context.preroll) {
+                s_context.preroll = heap_caps_malloc(capacity * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+            s_context.preroll_capacity = s_context.preroll ? capacity : 0;
+
+            if (!s_context.preroll) {
+                ret = ESP_ERR_NO_MEM;
+            } else {
+                s_context.preroll_head = 0;
+                s_context.preroll_fill = 0;
+                s_context.preroll_end_index = 0;
+                if (s_context.kws) {
+                    mic_kws_reset(s_context.kws);
+                }
+                s_context.preroll_running = true;
+                media_clock_start(MEDIA_CLOCK_CAPTURE, s_context.sample_rate,
+                                  I2S_DMA_BUF_COUNT * (I2S_BUFFER_SIZE / 4));
+                i2s_start(I2S_NUM);
+
+                if (xTaskCreatePinnedToCore(mic_preroll_task, "mic_preroll", 3072, NULL, 6,
+                                            &s_context.preroll_handle, MIC_PREROLL_CORE) != pdPASS) {
+                    s_context.preroll_running = false;
+                    i2s_stop(I2S_NUM);
+                    ret = ESP_ERR_NO_MEM;
+                }
+            }
+        }
+        xSemaphoreGive(s_context.mutex);
+    }
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Pre-roll capture running (%lu ms)%s", preroll_ms,
+                 s_context.kws ? ", listening for the wake word" : "");
+    }
+    return ret;
+}
+
 esp_err_t mic_input_start(mic_input_data_cb_t callback, size_t buffer_size, void* user_data) {
     if (s_context.mutex == NULL) {
         ESP_LOGE(TAG, "Microphone input not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (callback == NULL || buffer_size == 0) {
+    if (buffer_size == 0) {
         ESP_LOGE(TAG, "Invalid parameters");
         return ESP_ERR_INVALID_ARG;
     }
@@ -126,27 +319,100 @@ esp_err_t mic_input_start(mic_input_data_cb_t callback, size_t buffer_size, void
             ESP_LOGW(TAG, "Microphone input already running");
             ret = ESP_ERR_INVALID_STATE;
         } else {
-            s_context.data_callback = callback;
-            s_context.user_data = user_data;
-            s_context.buffer_size = buffer_size;
-            s_context.is_running = true;
-
-            // Create task to read microphone data
-            BaseType_t task_created = xTaskCreate(
-                mic_input_task,
-                "mic_input_task",
-                4096,
-                NULL,
-                5,
-                &s_context.task_handle
-            );
-
-            if (task_created != pdPASS) {
-                ESP_LOGE(TAG, "Failed to create microphone task");
-                s_context.is_running = false;
-                ret = ESP_ERR_NO_MEM;
+            // Pre-roll hands over without pausing I2S: whatever arrives while
+            // the tasks switch waits in the DMA queue
+            bool from_preroll = s_context.preroll_running;
+            s_context.preroll_pending = 0;
+            s_context.preroll_delivered = 0;
+            if (from_preroll) {
+                mic_stop_preroll_task();
+                if (mic_take_preroll(buffer_size) != ESP_OK) {
+                    ESP_LOGW(TAG, "No memory to replay pre-roll, dropping it");
+                    s_context.preroll_pending = 0;
+                }
+            }
+
+            // Reuse the ring across start/stop unless the frame size changed
+            if (s_context.ring && audio_ring_frame_size(s_context.ring) != buffer_size) {
+                audio_ring_delete(s_context.ring);
+                s_context.ring = NULL;
+            }
+            if (!s_context.ring) {
+                // Frames are read straight into this pool and lent out from
+                // it, so it lives in DMA-capable internal RAM.
+                ret = audio_ring_create(MIC_RING_FRAMES, buffer_size,
+                                        MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, &s_context.ring);
+            } else {
+                audio_ring_flush(s_context.ring);
+                audio_ring_reset_stats(s_context.ring);
+            }
+
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to create capture ring: %d", ret);
+                if (from_preroll) {
+                    i2s_stop(I2S_NUM);
+                }
             } else {
-                ESP_LOGI(TAG, "Microphone input started");
+                s_context.data_callback = callback;
+                s_context.user_data = user_data;
+                s_context.buffer_size = buffer_size;
+                s_context.frame_borrowed = false;
+                s_context.frame_from_preroll = false;
+                s_context.frames_released = 0;
+                s_context.ring_frames_read = 0;
+                s_context.frames_suppressed = 0;
+                s_context.speech_open = false;
+                s_context.stages_reconfigure = true;
+                s_context.stage_cycles_total = 0;
+                s_context.stage_cycles_max = 0;
+                s_context.stage_frames = 0;
+                s_context.is_running = true;
+                if (!from_preroll) {
+                    media_clock_start(MEDIA_CLOCK_CAPTURE, s_context.sample_rate,
+                                      I2S_DMA_BUF_COUNT * (I2S_BUFFER_SIZE / 4));
+                    i2s_start(I2S_NUM);
+                }
+
+                // The consumer runs the (possibly slow) data callback; the
+                // reader only ever touches I2S and the ring, at a higher
+                // priority, so a slow consumer costs ring depth, not samples.
+                // Without a callback the caller drains frames itself.
+                BaseType_t consumer_created = pdPASS;
+                if (callback != NULL) {
+                    consumer_created = xTaskCreate(
+                        mic_consumer_task,
+                        "mic_consumer",
+                        4096,
+                        NULL,
+                        5,
+                        &s_context.consumer_handle
+                    );
+                }
+
+                BaseType_t task_created = pdFAIL;
+                if (consumer_created == pdPASS) {
+                    task_created = xTaskCreate(
+                        mic_input_task,
+                        "mic_input_task",
+                        3072,
+                        NULL,
+                        6,
+                        &s_context.task_handle
+                    );
+                }
+
+                if (consumer_created != pdPASS || task_created != pdPASS) {
+                    ESP_LOGE(TAG, "Failed to create microphone tasks");
+                    s_context.is_running = false;
+                    i2s_stop(I2S_NUM);
+                    if (s_context.consumer_handle != NULL) {
+                        vTaskDelete(s_context.consumer_handle);
+                        s_context.consumer_handle = NULL;
+                    }
+                    ret = ESP_ERR_NO_MEM;
+                } else {
+                    ESP_LOGI(TAG, "Microphone input started%s", from_preroll ? " from pre-roll" : "");
+                }
             }
         }
         xSemaphoreGive(s_context.mutex);
@@ -165,17 +431,61 @@ void mic_input_stop(void) {
     if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
         if (s_context.is_running && s_context.task_handle != NULL) {
             s_context.is_running = false;
-            // Give task time to exit gracefully
             xSemaphoreGive(s_context.mutex);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            
-            // Delete task if it's still running
+
+            // Wake the consumer so it notices the stop without waiting for data
+            TaskHandle_t waiter = s_context.waiter;
+            if (waiter != NULL) {
+                xTaskNotifyGive(waiter);
+            }
+
+            // Give both tasks time to exit gracefully
+            TickType_t start_ticks = xTaskGetTickCount();
+            while ((s_context.task_handle != NULL || s_context.consumer_handle != NULL) &&
+                   (xTaskGetTickCount() - start_ticks) < pdMS_TO_TICKS(MIC_STOP_TIMEOUT_MS)) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+
+            // Delete tasks if they're still running
             if (s_context.task_handle != NULL) {
                 vTaskDelete(s_context.task_handle);
                 s_context.task_handle = NULL;
             }
-            
-            ESP_LOGI(TAG, "Microphone input stopped");
+            if (s_context.consumer_handle != NULL) {
+                vTaskDelete(s_context.consumer_handle);
+                s_context.consumer_handle = NULL;
+            }
+
+            // The driver stays installed; only its DMA pauses
+            i2s_stop(I2S_NUM);
+
+            mic_input_stats_t stats;
+            mic_input_get_stats(&stats);
+            ESP_LOGI(TAG, "Microphone input stopped: %lu frames, %lu suppressed, %lu overruns, ring high-water %lu/%lu",
+                     stats.frames_captured, stats.frames_suppressed, stats.overruns,
+                     stats.ring_high_water, stats.ring_capacity);
+            ESP_LOGI(TAG, "Processing cost per frame: avg %lu cycles, max %lu cycles",
+                     stats.stage_cycles_avg, stats.stage_cycles_max);
+            if (s_context.aec) {
+                audio_aec_stats_t aec_stats;
+                audio_aec_get_stats(s_context.aec, &aec_stats);
+                ESP_LOGI(TAG, "Echo canceller: ERLE %.1f dB, %lu cycles/block, %lu reference samples dropped, %lu realigned, %lu resets",
+                         aec_stats.erle_db, aec_stats.cycles_per_block, aec_stats.ref_dropped,
+                         aec_stats.ref_realigned, aec_stats.resets);
+            }
+            if (s_context.ns_ready) {
+                ESP_LOGI(TAG, "Noise suppressor: %lu ms latency, %lu cycles per hop",
+                         stats.ns_latency_ms, stats.ns_cycles_per_hop);
+            }
+            if (stats.preroll_ms) {
+                ESP_LOGI(TAG, "Pre-roll: %lu ms replayed ahead of live audio", stats.preroll_ms);
+            }
+            s_context.preroll_pending = 0;
+        } else if (s_context.preroll_running) {
+            mic_stop_preroll_task();
+            i2s_stop(I2S_NUM);
+            xSemaphoreGive(s_context.mutex);
+            ESP_LOGI(TAG, "Pre-roll capture stopped");
         } else {
             xSemaphoreGive(s_context.mutex);
         }
@@ -195,58 +505,453 @@ bool mic_input_is_active(void) {
     return is_active;
 }
 
+esp_err_t mic_input_acquire_frame(mic_input_frame_t* frame, uint32_t timeout_ms) {
+    if (!frame) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_context.ring || s_context.frame_borrowed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Pre-roll history goes first, copied out one frame at a time
+    if (s_context.preroll_pending > 0) {
+        size_t frame_samples = s_context.buffer_size / sizeof(int16_t);
+        size_t first = s_context.preroll_capacity - s_context.preroll_read;
+        first = first < frame_samples ? first : frame_samples;
+        memcpy(s_context.preroll_frame, s_context.preroll + s_context.preroll_read, first * sizeof(int16_t));
+        memcpy(s_context.preroll_frame + first, s_context.preroll, (frame_samples - first) * sizeof(int16_t));
+
+        frame->data = s_context.preroll_frame;
+        frame->size = s_context.buffer_size;
+        frame->seq = s_context.frames_released;
+        frame->sample_index = s_context.preroll_next_index;
+        frame->timestamp_us = media_clock_time_of(MEDIA_CLOCK_CAPTURE, s_context.preroll_next_index);
+        frame->is_speech = mic_input_run_stages(s_context.preroll_frame, s_context.buffer_size);
+        s_context.frame_from_preroll = true;
+        s_context.frame_borrowed = true;
+        return ESP_OK;
+    }
+
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    size_t len = 0;
+    const void* data;
+
+    s_context.waiter = xTaskGetCurrentTaskHandle();
+    while ((data = audio_ring_read_acquire(s_context.ring, &len)) == NULL) {
+        TickType_t elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        if (!s_context.is_running || elapsed_ticks >= timeout_ticks) {
+            s_context.waiter = NULL;
+            return s_context.is_running ? ESP_ERR_TIMEOUT : ESP_ERR_INVALID_STATE;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout_ticks - elapsed_ticks);
+    }
+
+    frame->data = data;
+    frame->size = len;
+    frame->seq = s_context.frames_released;
+    // The ring hands frames out in commit order, so its read count finds the stamp
+    const media_clock_stamp_t* stamp = &s_context.stamps[s_context.ring_frames_read & (MIC_RING_FRAMES - 1)];
+    frame->sample_index = stamp->sample_index;
+    frame->timestamp_us = stamp->time_us;
+    // The consumer owns the slot until release, so stages work in place
+    frame->is_speech = mic_input_run_stages((void*)data, len);
+    s_context.frame_borrowed = true;
+    return ESP_OK;
+}
+
+void mic_input_release_frame(mic_input_frame_t* frame) {
+    if (!frame || !frame->data || !s_context.frame_borrowed) {
+        return;
+    }
+
+    if (s_context.frame_from_preroll) {
+        size_t frame_samples = s_context.buffer_size / sizeof(int16_t);
+        s_context.preroll_read = (s_context.preroll_read + frame_samples) % s_context.preroll_capacity;
+        s_context.preroll_next_index += frame_samples;
+        s_context.preroll_pending -= frame_samples;
+        s_context.preroll_delivered += frame_samples;
+        s_context.frame_from_preroll = false;
+    } else {
+        audio_ring_read_release(s_context.ring);
+        s_context.ring_frames_read++;
+    }
+    s_context.frames_released++;
+    s_context.frame_borrowed = false;
+    frame->data = NULL;
+    frame->size = 0;
+}
+
+esp_err_t mic_input_set_preproc(const mic_preproc_config_t* config) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        s_context.preproc_enabled = (config != NULL);
+        if (config) {
+            s_context.preproc_config = *config;
+        }
+        s_context.stages_reconfigure = true;
+        xSemaphoreGive(s_context.mutex);
+    }
+    return ESP_OK;
+}
+
+esp_err_t mic_input_set_aec(audio_aec_t* aec) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        // The consumer uses the canceller without locking, so it can only
+        // change while no frames are flowing
+        if (s_context.is_running) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else {
+            s_context.aec = aec;
+        }
+        xSemaphoreGive(s_context.mutex);
+    }
+    return ret;
+}
+
+esp_err_t mic_input_set_kws(mic_kws_t* kws, mic_input_kws_cb_t callback, void* user_data) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        // The pre-roll task uses the spotter without locking
+        if (s_context.is_running || s_context.preroll_running) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else {
+            s_context.kws = kws;
+            s_context.kws_callback = callback;
+            s_context.kws_user_data = user_data;
+        }
+        xSemaphoreGive(s_context.mutex);
+    }
+    return ret;
+}
+
+esp_err_t mic_input_set_speech_cb(mic_input_speech_cb_t callback, void* user_data) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        // The consumer calls it without locking
+        if (s_context.is_running) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else {
+            s_context.speech_callback = callback;
+            s_context.speech_user_data = user_data;
+        }
+        xSemaphoreGive(s_context.mutex);
+    }
+    return ret;
+}
+
+esp_err_t mic_input_set_ns(const mic_ns_config_t* config) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        if (config) {
+            s_context.ns_config = *config;
+        } else {
+            s_context.ns_config.enabled = false;
+        }
+        // Buffers are (re)allocated by the consumer before the next frame
+        s_context.stages_reconfigure = true;
+        xSemaphoreGive(s_context.mutex);
+    }
+
+    ESP_LOGI(TAG, "Noise suppression %s (max attenuation %u dB)",
+             s_context.ns_config.enabled ? "enabled" : "disabled",
+             s_context.ns_config.max_attenuation_db);
+    return ESP_OK;
+}
+
+esp_err_t mic_input_set_vad(const mic_vad_config_t* config) {
+    if (s_context.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
+        if (config) {
+            s_context.vad_config = *config;
+        } else {
+            s_context.vad_config.enabled = false;
+        }
+        // Applied by the consumer before it classifies the next frame
+        s_context.stages_reconfigure = true;
+        xSemaphoreGive(s_context.mutex);
+    }
+
+    ESP_LOGI(TAG, "VAD %s (floor %d dBFS, margin %u dB, zcr %u, hangover %u ms)",
+             s_context.vad_config.enabled ? "enabled" : "disabled",
+             s_context.vad_config.threshold_db, s_context.vad_config.margin_db,
+             s_context.vad_config.zcr_max, s_context.vad_config.hangover_ms);
+    return ESP_OK;
+}
+
+void mic_input_get_callback_stamp(uint64_t* sample_index, int64_t* timestamp_us) {
+    if (sample_index) {
+        *sample_index = s_context.callback_stamp.sample_index;
+    }
+    if (timestamp_us) {
+        *timestamp_us = s_context.callback_stamp.time_us;
+    }
+}
+
+bool mic_input_is_speech(void) {
+    return !s_context.vad_config.enabled || s_context.vad.active;
+}
+
+void mic_input_get_stats(mic_input_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+
+    audio_ring_stats_t ring_stats = {0};
+    if (s_context.ring) {
+        audio_ring_get_stats(s_context.ring, &ring_stats);
+    }
+
+    stats->frames_captured = ring_stats.frames_written;
+    stats->overruns = ring_stats.overruns;
+    stats->ring_depth = ring_stats.count;
+    stats->ring_high_water = ring_stats.high_water;
+    stats->ring_capacity = ring_stats.capacity;
+    stats->frames_suppressed = s_context.frames_suppressed;
+    stats->stage_cycles_avg = s_context.stage_frames ?
+        (uint32_t)(s_context.stage_cycles_total / s_context.stage_frames) : 0;
+    stats->stage_cycles_max = s_context.stage_cycles_max;
+    stats->ns_cycles_per_hop = s_context.ns_ready ? mic_ns_cycles_per_hop(&s_context.ns) : 0;
+    stats->ns_latency_ms = (s_context.ns_ready && s_context.sample_rate) ?
+        mic_ns_latency_samples(&s_context.ns) * 1000 / s_context.sample_rate : 0;
+    stats->preroll_ms = s_context.sample_rate ?
+        (uint32_t)((uint64_t)s_context.preroll_delivered * 1000 / s_context.sample_rate) : 0;
+}
+
+// Runs the processing stages on the consumer side, so the I2S reader never
+// pays for them. Returns the VAD decision for the frame.
+static bool mic_input_run_stages(void* data, size_t size) {
+    if (s_context.bits_per_sample != 16) {
+        return true;
+    }
+
+    if (s_context.stages_reconfigure) {
+        uint32_t bytes_per_ms = s_context.sample_rate * (s_context.bits_per_sample / 8) / 1000;
+        uint32_t frame_ms = bytes_per_ms ? s_context.buffer_size / bytes_per_ms : 0;
+        mic_preproc_init(&s_context.preproc, &s_context.preproc_config, s_context.sample_rate);
+        mic_vad_init(&s_context.vad, &s_context.vad_config, frame_ms);
+        if (s_context.aec) {
+            audio_aec_reset(s_context.aec);
+        }
+        if (s_context.ns_ready) {
+            mic_ns_deinit(&s_context.ns);
+            s_context.ns_ready = false;
+        }
+        if (s_context.ns_config.enabled) {
+            s_context.ns_ready = (mic_ns_init(&s_context.ns, &s_context.ns_config) == ESP_OK);
+            if (!s_context.ns_ready) {
+                ESP_LOGE(TAG, "Failed to allocate noise suppressor, running without it");
+            }
+        }
+        s_context.stages_reconfigure = false;
+    }
+
+    int16_t* samples = data;
+    size_t count = size / sizeof(int16_t);
+    bool is_speech = true;
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+
+    // Filters -> echo canceller -> noise suppressor -> AGC -> VAD: the
+    // canceller needs a linear, time-invariant echo path, the suppressor
+    // should not mistake residual echo for speech, and the VAD should judge
+    // what is sent
+    if (s_context.preproc_enabled) {
+        mic_preproc_filter(&s_context.preproc, samples, count);
+    }
+    if (s_context.aec) {
+        audio_aec_process(s_context.aec, samples, count);
+    }
+    if (s_context.ns_ready) {
+        mic_ns_process(&s_context.ns, samples, count);
+    }
+    if (s_context.preproc_enabled) {
+        mic_preproc_agc(&s_context.preproc, samples, count);
+    }
+    if (s_context.vad_config.enabled) {
+        is_speech = mic_vad_process(&s_context.vad, samples, count);
+    }
+
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    s_context.stage_cycles_total += cycles;
+    s_context.stage_frames++;
+    if (cycles > s_context.stage_cycles_max) {
+        s_context.stage_cycles_max = cycles;
+    }
+
+    return is_speech;
+}
+
+// Producer: moves I2S data into the capture ring and never waits on anyone
+// but the I2S driver.
 static void mic_input_task(void* arg) {
+    audio_ring_t* ring = s_context.ring;
     size_t buffer_size = s_context.buffer_size;
-    uint8_t* buffer = heap_caps_malloc(buffer_size, MALLOC_CAP_8BIT);
-    
-    if (!buffer) {
+
+    // When the ring is full the frame still has to be read out of the DMA
+    // queue, otherwise the driver would silently drop older data instead.
+    uint8_t* discard = heap_caps_malloc(buffer_size, MALLOC_CAP_8BIT);
+    if (!discard) {
         ESP_LOGE(TAG, "Failed to allocate buffer");
-        if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
-            s_context.is_running = false;
-            s_context.task_handle = NULL;
-            xSemaphoreGive(s_context.mutex);
-        }
+        s_context.is_running = false;
+        s_context.task_handle = NULL;
         vTaskDelete(NULL);
         return;
     }
-    
+
+    int64_t last_overrun_log_us = 0;
+    uint32_t overruns_logged = 0;
+    uint32_t frames_committed = 0;
     size_t bytes_read = 0;
-    
-    while (1) {
-        // Check if we should exit
-        if (xSemaphoreTake(s_context.mutex, 0) == pdTRUE) {
-            if (!s_context.is_running) {
-                xSemaphoreGive(s_context.mutex);
-                break;
-            }
-            xSemaphoreGive(s_context.mutex);
-        }
-        
-        // Read data from I2S
-        esp_err_t ret = i2s_read(I2S_NUM, buffer, buffer_size, &bytes_read, portMAX_DELAY);
-        
+    const size_t bytes_per_sample = s_context.bits_per_sample / 8;
+
+    while (s_context.is_running) {
+        uint8_t* slot = audio_ring_write_acquire(ring);
+
+        esp_err_t ret = i2s_read(I2S_NUM, slot ? slot : discard, buffer_size, &bytes_read,
+                                 pdMS_TO_TICKS(MIC_READ_TIMEOUT_MS));
+
         if (ret == ESP_OK && bytes_read > 0) {
-            // Call the callback with the data
-            if (xSemaphoreTake(s_context.mutex, 0) == pdTRUE) {
-                if (s_context.is_running && s_context.data_callback) {
-                    s_context.data_callback(buffer, bytes_read, s_context.user_data);
+            // Dropped frames are stamped too, so indices keep following the I2S clock
+            media_clock_stamp_t stamp = media_clock_capture(bytes_read / bytes_per_sample, esp_timer_get_time());
+            if (slot) {
+                s_context.stamps[frames_committed++ & (MIC_RING_FRAMES - 1)] = stamp;
+                audio_ring_write_commit(ring, bytes_read);
+                TaskHandle_t waiter = s_context.waiter;
+                if (waiter != NULL) {
+                    xTaskNotifyGive(waiter);
+                }
+            } else {
+                int64_t now_us = esp_timer_get_time();
+                if (now_us - last_overrun_log_us >= MIC_OVERRUN_LOG_INTERVAL_US) {
+                    audio_ring_stats_t stats;
+                    audio_ring_get_stats(ring, &stats);
+                    ESP_LOGW(TAG, "Capture ring full, dropped %lu frame(s) (%lu total)",
+                             stats.overruns - overruns_logged, stats.overruns);
+                    overruns_logged = stats.overruns;
+                    last_overrun_log_us = now_us;
                 }
-                xSemaphoreGive(s_context.mutex);
             }
         } else if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Error reading from I2S: %d", ret);
             vTaskDelay(pdMS_TO_TICKS(10));
         }
     }
-    
+
     // Cleanup
-    heap_caps_free(buffer);
-    
-    if (xSemaphoreTake(s_context.mutex, portMAX_DELAY) == pdTRUE) {
-        s_context.task_handle = NULL;
-        xSemaphoreGive(s_context.mutex);
-    }
-    
+    heap_caps_free(discard);
+    s_context.task_handle = NULL;
+
     ESP_LOGI(TAG, "Microphone task exiting");
     vTaskDelete(NULL);
 }
+
+// Pre-roll writer: keeps the newest preroll_capacity samples and feeds the
+// keyword spotter, nothing else
+static void mic_preroll_task(void* arg) {
+    int16_t* chunk = heap_caps_malloc(MIC_PREROLL_READ_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    size_t bytes_read = 0;
+    if (!chunk) {
+        ESP_LOGE(TAG, "Failed to allocate pre-roll buffer");
+    }
+
+    while (chunk && s_context.preroll_running) {
+        esp_err_t ret = i2s_read(I2S_NUM, chunk, MIC_PREROLL_READ_BYTES, &bytes_read,
+                                 pdMS_TO_TICKS(MIC_READ_TIMEOUT_MS));
+        if (ret != ESP_OK || bytes_read == 0) {
+            continue;
+        }
+
+        uint32_t count = bytes_read / sizeof(int16_t);
+        media_clock_stamp_t stamp = media_clock_capture(count, esp_timer_get_time());
+        const int16_t* src = chunk;
+        // Only the newest capacity samples of an oversized chunk can survive
+        if (count > s_context.preroll_capacity) {
+            src += count - s_context.preroll_capacity;
+            count = s_context.preroll_capacity;
+        }
+        uint32_t first = s_context.preroll_capacity - s_context.preroll_head;
+        first = first < count ? first : count;
+        memcpy(s_context.preroll + s_context.preroll_head, src, first * sizeof(int16_t));
+        memcpy(s_context.preroll, src + first, (count - first) * sizeof(int16_t));
+        s_context.preroll_head = (s_context.preroll_head + count) % s_context.preroll_capacity;
+        s_context.preroll_fill += count;
+        if (s_context.preroll_fill > s_context.preroll_capacity) {
+            s_context.preroll_fill = s_context.preroll_capacity;
+        }
+        s_context.preroll_end_index = stamp.sample_index + bytes_read / sizeof(int16_t);
+
+        // The spotter hears the raw chunk; the history above is all it shares
+        if (s_context.kws && mic_kws_process(s_context.kws, chunk, bytes_read / sizeof(int16_t)) &&
+            s_context.preroll_running) {
+            mic_kws_stats_t kws_stats;
+            mic_kws_get_stats(s_context.kws, &kws_stats);
+            ESP_LOGI(TAG, "Wake word detected (score %u%%)", kws_stats.peak_score_pct);
+            if (s_context.kws_callback) {
+                s_context.kws_callback(s_context.kws_user_data);
+            }
+        }
+    }
+
+    heap_caps_free(chunk);
+    s_context.preroll_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// Consumer: lends each captured frame to the user callback, holding back
+// frames the VAD classified as silence.
+static void mic_consumer_task(void* arg) {
+    mic_input_frame_t frame;
+
+    while (s_context.is_running) {
+        if (mic_input_acquire_frame(&frame, MIC_READ_TIMEOUT_MS) == ESP_OK) {
+            // Onset is the gate opening; the hangover holds it open between words
+            if (frame.is_speech && !s_context.speech_open && s_context.vad_config.enabled &&
+                s_context.speech_callback && s_context.is_running) {
+                s_context.speech_callback(frame.timestamp_us, s_context.speech_user_data);
+            }
+            if (!frame.is_speech && s_context.speech_open) {
+                // The user's turn ended where the hangover began, right
+                // after the last frame classified as speech
+                int64_t frame_us = (int64_t)frame.size / (s_context.bits_per_sample / 8) * 1000000 /
+                                   s_context.sample_rate;
+                int64_t end_us = frame.timestamp_us - s_context.vad.hangover_frames * frame_us;
+                latency_trace_begin(LATENCY_SPAN_RESPONSE, end_us);
+                latency_trace_begin(LATENCY_SPAN_END_TO_END, end_us);
+            }
+            s_context.speech_open = frame.is_speech;
+            if (!frame.is_speech) {
+                s_context.frames_suppressed++;
+            } else if (s_context.is_running) {
+                s_context.callback_stamp.sample_index = frame.sample_index;
+                s_context.callback_stamp.time_us = frame.timestamp_us;
+                s_context.data_callback(frame.data, frame.size, s_context.user_data);
+            }
+            mic_input_release_frame(&frame);
+        }
+    }
+
+    s_context.consumer_handle = NULL;
+    vTaskDelete(NULL);
+}
@@ -5,8 +5,14 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "mic_vad.h"
+#include "mic_preproc.h"
+#include "mic_ns.h"
+#include "audio_aec.h"
+#include "mic_kws.h"
 
 /**
  * @brief Callback function for microphone data
@@ -17,6 +23,56 @@ extern "C" {
  */
 typedef void (*mic_input_data_cb_t)(const void* data, size_t size, void* user_data);
 
+/**
+ * @brief Called from the pre-roll task when the keyword spotter fires
+ *
+ * May start a conversation (which calls mic_input_start from another task)
+ * but must not call mic_input functions itself.
+ *
+ * @param user_data User data pointer passed to mic_input_set_kws
+ */
+typedef void (*mic_input_kws_cb_t)(void* user_data);
+
+/**
+ * @brief Called from the consumer task when the VAD detects speech onset
+ *
+ * Runs before the frame that opened the gate reaches the data callback, so
+ * it should return quickly.
+ *
+ * @param onset_us esp_timer time the first sample of that frame was captured
+ * @param user_data User data pointer passed to mic_input_set_speech_cb
+ */
+typedef void (*mic_input_speech_cb_t)(int64_t onset_us, void* user_data);
+
+/**
+ * @brief A captured frame lent out by mic_input_acquire_frame
+ */
+typedef struct {
+    const void* data;   ///< PCM samples, 16-byte aligned, in DMA-capable RAM
+    size_t size;        ///< Valid bytes in data
+    uint32_t seq;       ///< Frame sequence number since mic_input_start
+    uint64_t sample_index;  ///< Capture clock index of the first sample (see media_clock.h)
+    int64_t timestamp_us;   ///< esp_timer time the first sample was captured
+    bool is_speech;     ///< VAD decision for this frame (always true with VAD disabled)
+} mic_input_frame_t;
+
+/**
+ * @brief Capture statistics
+ */
+typedef struct {
+    uint32_t frames_captured;   ///< Frames read from I2S and queued for the callback
+    uint32_t overruns;          ///< Frames dropped because the callback fell behind
+    uint32_t ring_depth;        ///< Frames currently queued
+    uint32_t ring_high_water;   ///< Deepest the queue has been since mic_input_start
+    uint32_t ring_capacity;     ///< Queue size in frames
+    uint32_t frames_suppressed; ///< Frames withheld from the callback as silence
+    uint32_t stage_cycles_avg;  ///< Average CPU cycles per frame spent in processing stages
+    uint32_t stage_cycles_max;  ///< Worst-case CPU cycles for one frame
+    uint32_t ns_cycles_per_hop; ///< Noise suppressor cost per STFT hop, 0 when disabled
+    uint32_t ns_latency_ms;     ///< Delay added by the noise suppressor, 0 when disabled
+    uint32_t preroll_ms;        ///< Pre-roll audio delivered ahead of live frames since mic_input_start
+} mic_input_stats_t;
+
 /**
  * @brief Initialize the microphone input component
  * 
@@ -34,7 +90,26 @@ void mic_input_deinit(void);
 /**
  * @brief Start capturing audio from the microphone
  * 
- * @param callback Callback function to receive audio data
+ * I2S is read by a dedicated task into a lock-free frame ring; the callback
+ * runs on a separate consumer task, so a slow callback never stalls capture.
+ * If the callback falls more than the ring depth behind, frames are dropped
+ * and counted as overruns (see mic_input_get_stats).
+ * 
+ * On 16-bit capture each frame first passes through the preprocessing chain
+ * (mic_input_set_preproc), enabled with MIC_PREPROC_CONFIG_DEFAULT at init,
+ * with the echo canceller (mic_input_set_aec) and noise suppressor
+ * (mic_input_set_ns) between its filters and AGC.
+ * With the VAD enabled (mic_input_set_vad) the callback only receives frames
+ * classified as speech, including the hangover after speech ends.
+ * 
+ * If callback is NULL no consumer task is created and the caller drains
+ * frames itself with mic_input_acquire_frame / mic_input_release_frame.
+ * 
+ * When called during pre-roll (mic_input_start_preroll) capture carries on
+ * without a gap, and the buffered audio is delivered first, as whole frames
+ * back to back, ahead of live frames.
+ * 
+ * @param callback Callback function to receive audio data, or NULL
  * @param buffer_size Size of each buffer chunk to deliver to the callback
  * @param user_data User data to pass to the callback
  * @return ESP_OK on success, or an error code
@@ -42,7 +117,58 @@ void mic_input_deinit(void);
 esp_err_t mic_input_start(mic_input_data_cb_t callback, size_t buffer_size, void* user_data);
 
 /**
- * @brief Stop capturing audio from the microphone
+ * @brief Capture clock position of the frame being passed to the data callback
+ * 
+ * Only meaningful from inside the callback registered with mic_input_start.
+ * 
+ * @param sample_index Receives the frame's first sample index (see media_clock.h)
+ * @param timestamp_us Receives the esp_timer time that sample was captured, or NULL
+ */
+void mic_input_get_callback_stamp(uint64_t* sample_index, int64_t* timestamp_us);
+
+/**
+ * @brief Keep the last preroll_ms of audio while no one is capturing
+ * 
+ * Runs I2S capture into a circular history with no processing stages, so
+ * speech that starts before mic_input_start is not lost. The next
+ * mic_input_start takes the history over; mic_input_stop discards it.
+ * 
+ * With a keyword spotter attached (mic_input_set_kws) the same task feeds it
+ * every chunk, so this is also the always-listening wake-word mode.
+ * 
+ * @param preroll_ms History length in milliseconds
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not initialized or already
+ *         capturing, ESP_ERR_NOT_SUPPORTED for non-16-bit capture, or ESP_ERR_NO_MEM
+ */
+esp_err_t mic_input_start_preroll(uint32_t preroll_ms);
+
+/**
+ * @brief Borrow the oldest captured frame without copying it
+ * 
+ * The frame points into the capture pool that I2S reads into. Only one frame
+ * may be borrowed at a time and only by one task; hand it back with
+ * mic_input_release_frame before acquiring the next one. Use this only when
+ * mic_input_start was called without a callback.
+ * 
+ * @param frame Receives the borrowed frame
+ * @param timeout_ms Time to wait for a frame, 0 to return immediately
+ * @return ESP_OK, ESP_ERR_TIMEOUT if no frame arrived in time, or
+ *         ESP_ERR_INVALID_STATE if capture is stopped or a frame is already borrowed
+ */
+esp_err_t mic_input_acquire_frame(mic_input_frame_t* frame, uint32_t timeout_ms);
+
+/**
+ * @brief Return a frame obtained from mic_input_acquire_frame to the capture pool
+ * 
+ * @param frame Frame to release; its data pointer is cleared
+ */
+void mic_input_release_frame(mic_input_frame_t* frame);
+
+/**
+ * @brief Stop capturing audio from the microphone, or stop pre-roll
+ * 
+ * The I2S driver stays installed with its DMA paused, so the next
+ * mic_input_start needs no driver setup or allocation.
  */
 void mic_input_stop(void);
 
@@ -53,6 +179,98 @@ void mic_input_stop(void);
  */
 bool mic_input_is_active(void);
 
+/**
+ * @brief Configure the DC blocker / high-pass / AGC chain applied to each frame
+ * 
+ * Takes effect from the next frame; filter and AGC state are reset.
+ * 
+ * @param config Chain tuning, or NULL to pass samples through untouched
+ * @return ESP_OK on success, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t mic_input_set_preproc(const mic_preproc_config_t* config);
+
+/**
+ * @brief Attach an echo canceller to the capture path
+ * 
+ * Frames pass through audio_aec_process after the DC blocker and high-pass
+ * and before the AGC and VAD. The canceller is reset on mic_input_start so
+ * reference queued while capture was stopped is discarded. The caller keeps
+ * ownership and must not destroy it while it is attached.
+ * 
+ * @param aec Echo canceller, or NULL to detach
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized or
+ *         capture is running
+ */
+esp_err_t mic_input_set_aec(audio_aec_t* aec);
+
+/**
+ * @brief Attach a keyword spotter to pre-roll capture
+ * 
+ * While pre-roll runs, every chunk read from I2S is fed to mic_kws_process
+ * on the pre-roll task, which is pinned to one core; a detection calls the
+ * callback. The spotter is reset whenever pre-roll starts. The caller keeps
+ * ownership and must not destroy it while it is attached.
+ * 
+ * @param kws Keyword spotter, or NULL to detach
+ * @param callback Called on a detection
+ * @param user_data User data to pass to the callback
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized or capture
+ *         or pre-roll is running
+ */
+esp_err_t mic_input_set_kws(mic_kws_t* kws, mic_input_kws_cb_t callback, void* user_data);
+
+/**
+ * @brief Register a callback for speech onset
+ * 
+ * Fires each time the VAD gate opens during capture, i.e. on the first
+ * speech frame after silence; never with the VAD disabled. Detection
+ * costs one frame plus the processing stages, so the callback runs about
+ * a frame duration after onset_us.
+ * 
+ * @param callback Onset callback, or NULL to remove it
+ * @param user_data User data to pass to the callback
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized or capture
+ *         is running
+ */
+esp_err_t mic_input_set_speech_cb(mic_input_speech_cb_t callback, void* user_data);
+
+/**
+ * @brief Configure the spectral noise suppressor
+ * 
+ * Runs after echo cancellation and before the AGC. Takes effect from the
+ * next frame; enabling it delays the stream by mic_ns_latency_samples.
+ * 
+ * @param config Suppressor tuning, or NULL to disable it
+ * @return ESP_OK on success, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t mic_input_set_ns(const mic_ns_config_t* config);
+
+/**
+ * @brief Configure the voice activity detector that gates the callback
+ * 
+ * Takes effect from the next frame. The detector only runs on 16-bit capture.
+ * When the gate closes, the LATENCY_SPAN_RESPONSE and LATENCY_SPAN_END_TO_END
+ * spans are opened at the end of the last speech frame, before the hangover.
+ * 
+ * @param config VAD tuning, or NULL to disable gating
+ * @return ESP_OK on success, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t mic_input_set_vad(const mic_vad_config_t* config);
+
+/**
+ * @brief Check whether the VAD currently considers the input to be speech
+ * 
+ * @return true if speech (or its hangover) is present, or if the VAD is disabled
+ */
+bool mic_input_is_speech(void);
+
+/**
+ * @brief Get capture statistics for the current or most recent session
+ * 
+ * @param stats Receives the statistics
+ */
+void mic_input_get_stats(mic_input_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,223 @@
+#include "mic_kws.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "mic_mfcc.h"
+
+#define TAG "MIC_KWS"
+
+// The front end's band layout assumes this rate
+#define KWS_SAMPLE_RATE 16000
+// Largest output layer handled on the stack
+#define KWS_MAX_CLASSES 8
+// Requantization multipliers are Q24
+#define KWS_MULT_Q      24
+
+struct mic_kws {
+    mic_kws_config_t config;
+    const mic_kws_model_t* model;
+    const int32_t* b1;
+    const int32_t* b2;
+    const int8_t* w1;
+    const int8_t* w2;
+    int32_t input_mult;         // mfcc -> int8, Q24
+    int32_t hidden_mult;        // layer 1 accumulator -> int8, Q24
+    uint32_t window_len;        // frames x coeffs
+    mic_mfcc_t mfcc;
+    int8_t* window;             // quantized features, ring of frames
+    int8_t* hidden;
+    uint32_t head;              // slot of the oldest frame
+    uint32_t filled;            // frames in the window, up to model->frames
+    uint32_t hops;              // since the last classifier run
+    float scores[MIC_KWS_SMOOTH];
+    uint32_t score_pos;
+    uint32_t quiet_hops;        // refractory hops left
+    float score;
+    float peak_score;
+    uint32_t inferences;
+    uint32_t detections;
+    uint64_t inference_cycles_total;
+    uint32_t inference_cycles_max;
+};
+
+static inline int32_t requant(int32_t v, int32_t mult) {
+    return (int32_t)(((int64_t)v * mult + (1 << (KWS_MULT_Q - 1))) >> KWS_MULT_Q);
+}
+
+static inline int8_t clamp_s8(int32_t v, int32_t lo) {
+    return (int8_t)(v > 127 ? 127 : (v < lo ? lo : v));
+}
+
+esp_err_t mic_kws_create(const void* model, size_t size, const mic_kws_config_t* config, mic_kws_t** out_kws) {
+    const mic_kws_model_t* m = model;
+    if (!model || !out_kws || ((uintptr_t)model & 3) || size < sizeof(mic_kws_model_t)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (m->magic != MIC_KWS_MAGIC || m->coeffs != MIC_MFCC_COEFFS || m->frames == 0 ||
+        m->hidden == 0 || m->classes < 2 || m->classes > KWS_MAX_CLASSES || m->keyword >= m->classes) {
+        ESP_LOGE(TAG, "Unsupported model (%u frames x %u coeffs, %u hidden, %u classes)",
+                 m->frames, m->coeffs, m->hidden, m->classes);
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t window_len = (size_t)m->frames * m->coeffs;
+    size_t expected = sizeof(mic_kws_model_t) + (m->hidden + m->classes) * sizeof(int32_t) +
+                      m->hidden * window_len + m->classes * m->hidden;
+    if (size < expected) {
+        ESP_LOGE(TAG, "Model truncated: %u of %u bytes", (unsigned)size, (unsigned)expected);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mic_kws_t* kws = calloc(1, sizeof(mic_kws_t));
+    if (!kws) {
+        return ESP_ERR_NO_MEM;
+    }
+    kws->config = config ? *config : (mic_kws_config_t)MIC_KWS_CONFIG_DEFAULT();
+    kws->model = m;
+    kws->b1 = (const int32_t*)(m + 1);
+    kws->b2 = kws->b1 + m->hidden;
+    kws->w1 = (const int8_t*)(kws->b2 + m->classes);
+    kws->w2 = kws->w1 + m->hidden * window_len;
+    kws->input_mult = (int32_t)lrintf(m->input_scale * (1 << KWS_MULT_Q));
+    kws->hidden_mult = (int32_t)lrintf(m->hidden_scale * (1 << KWS_MULT_Q));
+    kws->window_len = window_len;
+    kws->window = calloc(window_len, 1);
+    kws->hidden = calloc(m->hidden, 1);
+
+    if (!kws->window || !kws->hidden || mic_mfcc_init(&kws->mfcc, KWS_SAMPLE_RATE) != ESP_OK) {
+        mic_kws_destroy(kws);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Keyword model: %u ms window, %u hidden, %u classes, %u bytes",
+             (unsigned)mic_kws_window_ms(kws), m->hidden, m->classes, (unsigned)expected);
+    *out_kws = kws;
+    return ESP_OK;
+}
+
+void mic_kws_destroy(mic_kws_t* kws) {
+    if (!kws) {
+        return;
+    }
+    mic_mfcc_deinit(&kws->mfcc);
+    free(kws->window);
+    free(kws->hidden);
+    free(kws);
+}
+
+void mic_kws_reset(mic_kws_t* kws) {
+    mic_mfcc_reset(&kws->mfcc);
+    kws->head = 0;
+    kws->filled = 0;
+    kws->hops = 0;
+    kws->quiet_hops = 0;
+    kws->score = 0.0f;
+    kws->peak_score = 0.0f;
+    memset(kws->scores, 0, sizeof(kws->scores));
+}
+
+uint32_t mic_kws_window_ms(const mic_kws_t* kws) {
+    return ((kws->model->frames - 1) * MIC_MFCC_HOP + MIC_MFCC_FRAME) * 1000 / KWS_SAMPLE_RATE;
+}
+
+static inline int32_t dot_s8(const int8_t* a, const int8_t* b, uint32_t n) {
+    int32_t acc = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc += a[i] * b[i] + a[i + 1] * b[i + 1] + a[i + 2] * b[i + 2] + a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+// Keyword probability for the current window
+static float classify(mic_kws_t* kws) {
+    const mic_kws_model_t* m = kws->model;
+    // The ring splits the window in two; weights follow frame age, not slot
+    const uint32_t older = (m->frames - kws->head) * m->coeffs;
+    const uint32_t newer = kws->window_len - older;
+    const int8_t* oldest = kws->window + kws->head * m->coeffs;
+
+    for (uint32_t h = 0; h < m->hidden; h++) {
+        const int8_t* row = kws->w1 + h * kws->window_len;
+        int32_t acc = kws->b1[h] + dot_s8(row, oldest, older) + dot_s8(row + older, kws->window, newer);
+        kws->hidden[h] = clamp_s8(requant(acc, kws->hidden_mult), 0);
+    }
+
+    float logits[KWS_MAX_CLASSES];
+    float max_logit = -INFINITY;
+    for (uint32_t c = 0; c < m->classes; c++) {
+        int32_t acc = kws->b2[c] + dot_s8(kws->w2 + c * m->hidden, kws->hidden, m->hidden);
+        logits[c] = (float)acc * m->output_scale;
+        max_logit = logits[c] > max_logit ? logits[c] : max_logit;
+    }
+    float sum = 0.0f;
+    for (uint32_t c = 0; c < m->classes; c++) {
+        logits[c] = expf(logits[c] - max_logit);
+        sum += logits[c];
+    }
+    return logits[m->keyword] / sum;
+}
+
+bool mic_kws_process(mic_kws_t* kws, const int16_t* samples, size_t count) {
+    const mic_kws_model_t* m = kws->model;
+    int16_t coeffs[MIC_MFCC_COEFFS];
+    bool detected = false;
+
+    while (mic_mfcc_process(&kws->mfcc, &samples, &count, coeffs)) {
+        // The newest frame overwrites the oldest slot
+        int8_t* slot = kws->window + kws->head * m->coeffs;
+        for (uint32_t c = 0; c < MIC_MFCC_COEFFS; c++) {
+            slot[c] = clamp_s8(requant(coeffs[c], kws->input_mult), -128);
+        }
+        kws->head = (kws->head + 1) % m->frames;
+        if (kws->filled < m->frames) {
+            kws->filled++;
+        }
+        if (kws->quiet_hops > 0) {
+            kws->quiet_hops--;
+        }
+        if (kws->filled < m->frames || ++kws->hops < MIC_KWS_STRIDE) {
+            continue;
+        }
+        kws->hops = 0;
+
+        uint32_t start_cycles = esp_cpu_get_cycle_count();
+        kws->scores[kws->score_pos] = classify(kws);
+        kws->score_pos = (kws->score_pos + 1) % MIC_KWS_SMOOTH;
+        uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+        kws->inference_cycles_total += cycles;
+        kws->inference_cycles_max = cycles > kws->inference_cycles_max ? cycles : kws->inference_cycles_max;
+        kws->inferences++;
+
+        float score = 0.0f;
+        for (uint32_t i = 0; i < MIC_KWS_SMOOTH; i++) {
+            score += kws->scores[i];
+        }
+        kws->score = score / MIC_KWS_SMOOTH;
+        kws->peak_score = kws->score > kws->peak_score ? kws->score : kws->peak_score;
+
+        if (kws->quiet_hops == 0 && kws->score * 100.0f >= kws->config.threshold_pct) {
+            kws->quiet_hops = kws->config.refractory_ms * (KWS_SAMPLE_RATE / 1000) / MIC_MFCC_HOP;
+            memset(kws->scores, 0, sizeof(kws->scores));
+            kws->detections++;
+            detected = true;
+        }
+    }
+    return detected;
+}
+
+void mic_kws_get_stats(const mic_kws_t* kws, mic_kws_stats_t* stats) {
+    stats->feature_frames = kws->mfcc.frames;
+    stats->inferences = kws->inferences;
+    stats->detections = kws->detections;
+    stats->feature_cycles_avg = mic_mfcc_cycles_per_frame(&kws->mfcc);
+    stats->inference_cycles_avg = kws->inferences ?
+        (uint32_t)(kws->inference_cycles_total / kws->inferences) : 0;
+    stats->inference_cycles_max = kws->inference_cycles_max;
+    stats->score_pct = (uint8_t)lrintf(kws->score * 100.0f);
+    stats->peak_score_pct = (uint8_t)lrintf(kws->peak_score * 100.0f);
+}
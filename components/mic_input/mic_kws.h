@@ -0,0 +1,126 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Keyword spotter: MFCC front end plus a quantized int8 classifier
+ *
+ * Every mic_mfcc hop (20 ms) adds one frame of cepstral features to a
+ * sliding window; every MIC_KWS_STRIDE hops the window goes through a
+ * two-layer int8 network (dense + ReLU, dense) whose keyword posterior is
+ * averaged over the last MIC_KWS_SMOOTH runs before it is compared with the
+ * threshold. After a detection the spotter stays quiet for refractory_ms.
+ */
+typedef struct mic_kws mic_kws_t;
+
+/**
+ * @brief Spotter tuning
+ */
+typedef struct {
+    uint8_t threshold_pct;      ///< Smoothed keyword probability that triggers, 1 .. 100
+    uint16_t refractory_ms;     ///< Quiet time after a detection
+} mic_kws_config_t;
+
+#define MIC_KWS_CONFIG_DEFAULT() { \
+    .threshold_pct = 80,           \
+    .refractory_ms = 1500,         \
+}
+
+/** Feature hops between classifier runs */
+#define MIC_KWS_STRIDE  2
+/** Classifier runs averaged into the score */
+#define MIC_KWS_SMOOTH  3
+
+/** "KWS1", little-endian */
+#define MIC_KWS_MAGIC   0x3153574BU
+
+/**
+ * @brief Model blob header
+ *
+ * The blob is this header followed by, in order:
+ *   int32 b1[hidden], int32 b2[classes],
+ *   int8  w1[hidden][frames][coeffs]  (frame 0 is the oldest),
+ *   int8  w2[classes][hidden].
+ * Features are quantized as q = round(mfcc * input_scale) clamped to int8;
+ * layer 1 accumulators become int8 activations as
+ * round(acc * hidden_scale) clamped to 0 .. 127; layer 2 accumulators times
+ * output_scale are logits. The blob must be 4-byte aligned.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t frames;        ///< Feature frames per window (49 spans 1 s)
+    uint16_t coeffs;        ///< Must be MIC_MFCC_COEFFS
+    uint16_t hidden;
+    uint16_t classes;
+    uint16_t keyword;       ///< Class index of the wake word
+    uint16_t reserved;
+    float input_scale;
+    float hidden_scale;
+    float output_scale;
+    uint32_t reserved2;
+} mic_kws_model_t;
+
+/**
+ * @brief Spotter statistics
+ */
+typedef struct {
+    uint32_t feature_frames;        ///< Feature hops computed since create
+    uint32_t inferences;            ///< Classifier runs
+    uint32_t detections;
+    uint32_t feature_cycles_avg;    ///< CPU cycles per feature hop
+    uint32_t inference_cycles_avg;  ///< CPU cycles per classifier run
+    uint32_t inference_cycles_max;
+    uint8_t score_pct;              ///< Latest smoothed keyword probability
+    uint8_t peak_score_pct;         ///< Highest smoothed probability since reset
+} mic_kws_stats_t;
+
+/**
+ * @brief Create a spotter for a model blob
+ *
+ * The blob is used in place (it may live in flash) and must outlive the spotter.
+ *
+ * @param model Model blob, see mic_kws_model_t
+ * @param size Blob size in bytes
+ * @param config Tuning, or NULL for MIC_KWS_CONFIG_DEFAULT
+ * @param out_kws Receives the spotter
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a malformed blob, or ESP_ERR_NO_MEM
+ */
+esp_err_t mic_kws_create(const void* model, size_t size, const mic_kws_config_t* config, mic_kws_t** out_kws);
+
+/**
+ * @brief Free a spotter
+ */
+void mic_kws_destroy(mic_kws_t* kws);
+
+/**
+ * @brief Forget the feature window and score, e.g. when capture restarts
+ */
+void mic_kws_reset(mic_kws_t* kws);
+
+/**
+ * @brief Feed 16 kHz 16-bit samples
+ *
+ * @return true if the keyword was detected in this block
+ */
+bool mic_kws_process(mic_kws_t* kws, const int16_t* samples, size_t count);
+
+/**
+ * @brief Audio the classifier looks at, in milliseconds
+ */
+uint32_t mic_kws_window_ms(const mic_kws_t* kws);
+
+/**
+ * @brief Get spotter statistics
+ */
+void mic_kws_get_stats(const mic_kws_t* kws, mic_kws_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+#include "mic_mfcc.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_cpu.h"
+
+// log2(1 + i/32) in Q15, interpolated linearly between entries
+static const uint16_t s_log2_table[33] = {
+    0, 1455, 2866, 4236, 5568, 6863, 8124, 9352, 10549, 11716, 12855, 13968, 15055,
+    16117, 17156, 18173, 19168, 20143, 21098, 22034, 22952, 23852, 24736, 25604,
+    26455, 27292, 28114, 28922, 29717, 30498, 31267, 32024, 32768,
+};
+
+static float hz_to_mel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+esp_err_t mic_mfcc_init(mic_mfcc_t* mfcc, uint32_t sample_rate) {
+    memset(mfcc, 0, sizeof(*mfcc));
+    if (sample_rate < 2 * MIC_MFCC_HIGH_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mfcc->window = malloc(MIC_MFCC_FRAME * sizeof(int16_t));
+    mfcc->input = calloc(MIC_MFCC_FRAME, sizeof(int16_t));
+    mfcc->spectrum = malloc(MIC_MFCC_FRAME * sizeof(int32_t));
+    mfcc->bin_interval = malloc(MIC_MFCC_FRAME / 2 + 1);
+    mfcc->bin_weight = malloc((MIC_MFCC_FRAME / 2 + 1) * sizeof(int16_t));
+    mfcc->dct = malloc(MIC_MFCC_COEFFS * MIC_MFCC_MEL_BANDS * sizeof(int16_t));
+
+    if (!mfcc->window || !mfcc->input || !mfcc->spectrum || !mfcc->bin_interval ||
+        !mfcc->bin_weight || !mfcc->dct ||
+        audio_dsp_rfft_s32_init(&mfcc->fft, MIC_MFCC_FRAME) != ESP_OK) {
+        mic_mfcc_deinit(mfcc);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Periodic Hann
+    for (uint32_t i = 0; i < MIC_MFCC_FRAME; i++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)i / (float)MIC_MFCC_FRAME);
+        mfcc->window[i] = (int16_t)lrintf(w * (float)INT16_MAX);
+    }
+
+    // Band b rises from point b to its center at point b + 1 and falls to
+    // point b + 2, so each bin sits in one interval between two points and
+    // splits its power between the band rising and the band falling there
+    const float mel_low = hz_to_mel(MIC_MFCC_LOW_HZ);
+    const float mel_step = (hz_to_mel(MIC_MFCC_HIGH_HZ) - mel_low) / (MIC_MFCC_MEL_BANDS + 1);
+    const float bin_hz = (float)sample_rate / MIC_MFCC_FRAME;
+    mfcc->first_bin = (uint16_t)ceilf(MIC_MFCC_LOW_HZ / bin_hz);
+    mfcc->last_bin = (uint16_t)floorf(MIC_MFCC_HIGH_HZ / bin_hz);
+    for (uint32_t k = mfcc->first_bin; k <= mfcc->last_bin; k++) {
+        float pos = (hz_to_mel(k * bin_hz) - mel_low) / mel_step;
+        uint32_t interval = (uint32_t)pos;
+        interval = interval > MIC_MFCC_MEL_BANDS ? MIC_MFCC_MEL_BANDS : interval;
+        float rise = pos - (float)interval;
+        rise = rise > 1.0f ? 1.0f : rise;
+        mfcc->bin_interval[k] = (uint8_t)interval;
+        mfcc->bin_weight[k] = (int16_t)lrintf(rise * (float)INT16_MAX);
+    }
+
+    // DCT-II scaled by 1/N for c0 (mean log energy) and 2/N above it; the
+    // scale is applied after the sum so the cosines keep their precision
+    for (uint32_t c = 0; c < MIC_MFCC_COEFFS; c++) {
+        for (uint32_t b = 0; b < MIC_MFCC_MEL_BANDS; b++) {
+            float v = cosf((float)M_PI * c * (b + 0.5f) / MIC_MFCC_MEL_BANDS);
+            mfcc->dct[c * MIC_MFCC_MEL_BANDS + b] = (int16_t)lrintf(v * 2048.0f);
+        }
+    }
+    return ESP_OK;
+}
+
+void mic_mfcc_deinit(mic_mfcc_t* mfcc) {
+    audio_dsp_rfft_s32_deinit(&mfcc->fft);
+    free(mfcc->window);
+    free(mfcc->input);
+    free(mfcc->spectrum);
+    free(mfcc->bin_interval);
+    free(mfcc->bin_weight);
+    free(mfcc->dct);
+    memset(mfcc, 0, sizeof(*mfcc));
+}
+
+void mic_mfcc_reset(mic_mfcc_t* mfcc) {
+    memset(mfcc->input, 0, MIC_MFCC_FRAME * sizeof(int16_t));
+    mfcc->fill = 0;
+}
+
+// log2(x) in Q8; the mantissa's top 5 bits index the table, the next 8 interpolate
+static int16_t log2_q8(uint64_t x) {
+    if (x < 2) {
+        return 0;
+    }
+    int msb = 63 - __builtin_clzll(x);
+    uint32_t frac = msb >= 13 ? (uint32_t)(x >> (msb - 13)) & 0x1FFF
+                              : (uint32_t)(x << (13 - msb)) & 0x1FFF;
+    uint32_t i = frac >> 8;
+    uint32_t t = frac & 0xFF;
+    uint32_t f = s_log2_table[i] + (((s_log2_table[i + 1] - s_log2_table[i]) * t + 128) >> 8);
+    return (int16_t)(msb * 256 + ((f + 64) >> 7));
+}
+
+static void compute_frame(mic_mfcc_t* mfcc, int16_t* coeffs) {
+    int32_t* x = mfcc->spectrum;
+    uint64_t mel[MIC_MFCC_MEL_BANDS] = {0};
+
+    for (uint32_t i = 0; i < MIC_MFCC_FRAME; i++) {
+        x[i] = ((int32_t)mfcc->input[i] * mfcc->window[i] + (1 << 14)) >> 15;
+    }
+    audio_dsp_rfft_s32_forward(&mfcc->fft, x);
+
+    // The band range never reaches DC or Nyquist, so every bin is a (re, im) pair
+    for (uint32_t k = mfcc->first_bin; k <= mfcc->last_bin; k++) {
+        int64_t re = x[2 * k];
+        int64_t im = x[2 * k + 1];
+        uint64_t p = (uint64_t)(re * re + im * im);
+        uint32_t j = mfcc->bin_interval[k];
+        uint64_t rise = (p * (uint64_t)mfcc->bin_weight[k]) >> 15;
+        if (j < MIC_MFCC_MEL_BANDS) {
+            mel[j] += rise;
+        }
+        if (j > 0) {
+            mel[j - 1] += p - rise;
+        }
+    }
+
+    for (uint32_t b = 0; b < MIC_MFCC_MEL_BANDS; b++) {
+        mfcc->log_mel[b] = log2_q8(mel[b]);
+    }
+
+    // |log_mel| < 2^14 and |dct| <= 2^11, so 40 terms stay inside 32 bits
+    for (uint32_t c = 0; c < MIC_MFCC_COEFFS; c++) {
+        const int16_t* row = &mfcc->dct[c * MIC_MFCC_MEL_BANDS];
+        int32_t acc = 0;
+        for (uint32_t b = 0; b < MIC_MFCC_MEL_BANDS; b++) {
+            acc += (int32_t)row[b] * mfcc->log_mel[b];
+        }
+        int32_t div = c == 0 ? (MIC_MFCC_MEL_BANDS << 11) : (MIC_MFCC_MEL_BANDS << 10);
+        acc += acc >= 0 ? div / 2 : -div / 2;
+        coeffs[c] = (int16_t)(acc / div);
+    }
+}
+
+bool mic_mfcc_process(mic_mfcc_t* mfcc, const int16_t** samples, size_t* count, int16_t* coeffs) {
+    int16_t* tail = mfcc->input + (MIC_MFCC_FRAME - MIC_MFCC_HOP);
+
+    while (*count > 0) {
+        size_t take = MIC_MFCC_HOP - mfcc->fill;
+        take = take < *count ? take : *count;
+        memcpy(tail + mfcc->fill, *samples, take * sizeof(int16_t));
+        mfcc->fill += take;
+        *samples += take;
+        *count -= take;
+
+        if (mfcc->fill == MIC_MFCC_HOP) {
+            uint32_t start_cycles = esp_cpu_get_cycle_count();
+            compute_frame(mfcc, coeffs);
+            memmove(mfcc->input, mfcc->input + MIC_MFCC_HOP, (MIC_MFCC_FRAME - MIC_MFCC_HOP) * sizeof(int16_t));
+            mfcc->fill = 0;
+            mfcc->cycles_total += esp_cpu_get_cycle_count() - start_cycles;
+            mfcc->frames++;
+            return true;
+        }
+    }
+    return false;
+}
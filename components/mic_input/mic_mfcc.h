@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "audio_dsp_fft.h"
+
+/** Analysis frame (32 ms) and hop (20 ms) at 16 kHz, in samples */
+#define MIC_MFCC_FRAME      512
+#define MIC_MFCC_HOP        320
+/** Triangular mel bands between MIC_MFCC_LOW_HZ and MIC_MFCC_HIGH_HZ */
+#define MIC_MFCC_MEL_BANDS  40
+#define MIC_MFCC_LOW_HZ     125
+#define MIC_MFCC_HIGH_HZ    7500
+/** Cepstral coefficients kept per frame, c0 included */
+#define MIC_MFCC_COEFFS     10
+
+/**
+ * @brief Streaming fixed-point log-mel / MFCC front end
+ *
+ * Hann-windowed frames go through the fixed-point real FFT; bin powers are
+ * summed into mel bands with Q15 triangle weights in 64-bit accumulators,
+ * and each band energy is turned into log2 in Q8 (256 per octave of power,
+ * so +6 dB of level adds 512). A DCT-II scaled so c0 is the mean log energy
+ * gives the cepstrum in the same units. A level change only moves c0.
+ */
+typedef struct {
+    audio_dsp_rfft_s32_t fft;
+    int16_t* window;            // Hann, Q15
+    int16_t* input;             // last MIC_MFCC_FRAME input samples
+    int32_t* spectrum;          // MIC_MFCC_FRAME scratch
+    uint8_t* bin_interval;      // per bin: mel interval it falls in
+    int16_t* bin_weight;        // per bin: Q15 weight of the band above
+    int16_t* dct;               // MIC_MFCC_COEFFS x MIC_MFCC_MEL_BANDS, Q11
+    uint16_t first_bin;
+    uint16_t last_bin;
+    uint32_t fill;              // new samples of the current hop taken in
+    int16_t log_mel[MIC_MFCC_MEL_BANDS];    // last frame, log2 Q8
+    uint32_t frames;
+    uint64_t cycles_total;
+} mic_mfcc_t;
+
+/**
+ * @brief Allocate the front end and build its tables
+ *
+ * @param sample_rate Input rate in Hz; the band edges are fixed in Hz
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the bands do not fit below Nyquist, or ESP_ERR_NO_MEM
+ */
+esp_err_t mic_mfcc_init(mic_mfcc_t* mfcc, uint32_t sample_rate);
+
+/**
+ * @brief Free the front end's buffers
+ */
+void mic_mfcc_deinit(mic_mfcc_t* mfcc);
+
+/**
+ * @brief Forget buffered input, e.g. after a gap in the stream
+ */
+void mic_mfcc_reset(mic_mfcc_t* mfcc);
+
+/**
+ * @brief Take in samples until the next feature frame is complete
+ *
+ * Call in a loop: each call consumes input from *samples / *count and
+ * returns true with one frame of coefficients whenever a hop completes.
+ *
+ * @param samples In/out: next unread sample
+ * @param count In/out: unread samples left
+ * @param coeffs Receives MIC_MFCC_COEFFS coefficients, log2 Q8
+ * @return true if coeffs was written
+ */
+bool mic_mfcc_process(mic_mfcc_t* mfcc, const int16_t** samples, size_t* count, int16_t* coeffs);
+
+/**
+ * @brief Average CPU cycles per feature frame since init
+ */
+static inline uint32_t mic_mfcc_cycles_per_frame(const mic_mfcc_t* mfcc) {
+    return mfcc->frames ? (uint32_t)(mfcc->cycles_total / mfcc->frames) : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,167 @@
+#include "mic_ns.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_cpu.h"
+#include "audio_dsp.h"
+
+// Power smoothing before the minimum search (~50 ms at 8 ms hops)
+#define NS_POWER_ALPHA      0.85f
+// The minimum of a smoothed periodogram sits below the mean noise power
+#define NS_MIN_BIAS         2.0f
+// Decision-directed a priori SNR weight
+#define NS_DD_BETA          0.98f
+
+esp_err_t mic_ns_init(mic_ns_t* ns, const mic_ns_config_t* config) {
+    memset(ns, 0, sizeof(*ns));
+    ns->config = *config;
+
+    ns->window = malloc(MIC_NS_FRAME * sizeof(int16_t));
+    ns->input = calloc(MIC_NS_FRAME, sizeof(int16_t));
+    ns->overlap = calloc(MIC_NS_HOP, sizeof(int32_t));
+    ns->output = calloc(MIC_NS_HOP, sizeof(int16_t));
+    ns->spectrum = malloc(MIC_NS_FRAME * sizeof(int32_t));
+    ns->smoothed = calloc(MIC_NS_BINS, sizeof(float));
+    ns->noise = calloc(MIC_NS_BINS, sizeof(float));
+    ns->min_current = malloc(MIC_NS_BINS * sizeof(float));
+    ns->min_windows = malloc(MIC_NS_MIN_WINDOWS * MIC_NS_BINS * sizeof(float));
+    ns->prev_clean = calloc(MIC_NS_BINS, sizeof(float));
+
+    if (!ns->window || !ns->input || !ns->overlap || !ns->output || !ns->spectrum ||
+        !ns->smoothed || !ns->noise || !ns->min_current || !ns->min_windows || !ns->prev_clean ||
+        audio_dsp_rfft_s32_init(&ns->fft, MIC_NS_FRAME) != ESP_OK) {
+        mic_ns_deinit(ns);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // sqrt of a periodic Hann: analysis x synthesis sums to one at 50% overlap
+    for (uint32_t i = 0; i < MIC_NS_FRAME; i++) {
+        float w = sinf((float)M_PI * (float)i / (float)MIC_NS_FRAME);
+        ns->window[i] = (int16_t)lrintf(w * (float)INT16_MAX);
+    }
+    for (uint32_t i = 0; i < MIC_NS_MIN_WINDOWS * MIC_NS_BINS; i++) {
+        ns->min_windows[i] = FLT_MAX;
+    }
+    for (uint32_t k = 0; k < MIC_NS_BINS; k++) {
+        ns->min_current[k] = FLT_MAX;
+    }
+    ns->gain_floor = powf(10.0f, -(float)config->max_attenuation_db / 20.0f);
+    return ESP_OK;
+}
+
+void mic_ns_deinit(mic_ns_t* ns) {
+    audio_dsp_rfft_s32_deinit(&ns->fft);
+    free(ns->window);
+    free(ns->input);
+    free(ns->overlap);
+    free(ns->output);
+    free(ns->spectrum);
+    free(ns->smoothed);
+    free(ns->noise);
+    free(ns->min_current);
+    free(ns->min_windows);
+    free(ns->prev_clean);
+    memset(ns, 0, sizeof(*ns));
+}
+
+// Minimum statistics: the noise floor is the lowest smoothed power seen over
+// MIC_NS_MIN_WINDOWS sub-windows; speech pauses long enough to expose it occur
+// well within that span, while the oldest sub-window ages out continuously.
+static void track_noise(mic_ns_t* ns, uint32_t k, float power) {
+    float s = NS_POWER_ALPHA * ns->smoothed[k] + (1.0f - NS_POWER_ALPHA) * power;
+    ns->smoothed[k] = s;
+
+    if (s < ns->min_current[k]) {
+        ns->min_current[k] = s;
+    }
+    float m = ns->min_current[k];
+    for (uint32_t w = 0; w < MIC_NS_MIN_WINDOWS; w++) {
+        float mw = ns->min_windows[w * MIC_NS_BINS + k];
+        m = mw < m ? mw : m;
+    }
+    ns->noise[k] = NS_MIN_BIAS * m;
+}
+
+static int16_t wiener_gain_q15(mic_ns_t* ns, uint32_t k, float power) {
+    float noise = ns->noise[k] + 1.0f;
+    float post = power / noise;
+    float prior = NS_DD_BETA * ns->prev_clean[k] / noise +
+                  (1.0f - NS_DD_BETA) * (post > 1.0f ? post - 1.0f : 0.0f);
+    float gain = prior / (1.0f + prior);
+
+    gain = gain < ns->gain_floor ? ns->gain_floor : gain;
+    ns->prev_clean[k] = gain * gain * power;
+    return (int16_t)lrintf(gain * (float)INT16_MAX);
+}
+
+static inline int32_t scale_q15(int32_t v, int16_t g) {
+    return (int32_t)(((int64_t)v * g + (1 << 14)) >> 15);
+}
+
+static void process_hop(mic_ns_t* ns) {
+    int32_t* x = ns->spectrum;
+
+    for (uint32_t i = 0; i < MIC_NS_FRAME; i++) {
+        x[i] = ((int32_t)ns->input[i] * ns->window[i] + (1 << 14)) >> 15;
+    }
+    audio_dsp_rfft_s32_forward(&ns->fft, x);
+
+    // Packed spectrum: DC and Nyquist are real and share the first pair
+    float p0 = (float)x[0] * x[0];
+    float pn = (float)x[1] * x[1];
+    track_noise(ns, 0, p0);
+    track_noise(ns, MIC_NS_BINS - 1, pn);
+    x[0] = scale_q15(x[0], wiener_gain_q15(ns, 0, p0));
+    x[1] = scale_q15(x[1], wiener_gain_q15(ns, MIC_NS_BINS - 1, pn));
+
+    for (uint32_t k = 1; k < MIC_NS_BINS - 1; k++) {
+        float p = (float)x[2 * k] * x[2 * k] + (float)x[2 * k + 1] * x[2 * k + 1];
+        track_noise(ns, k, p);
+        int16_t g = wiener_gain_q15(ns, k, p);
+        x[2 * k] = scale_q15(x[2 * k], g);
+        x[2 * k + 1] = scale_q15(x[2 * k + 1], g);
+    }
+
+    if (++ns->min_frame == MIC_NS_MIN_FRAMES) {
+        memcpy(&ns->min_windows[ns->min_window * MIC_NS_BINS], ns->min_current, MIC_NS_BINS * sizeof(float));
+        for (uint32_t k = 0; k < MIC_NS_BINS; k++) {
+            ns->min_current[k] = FLT_MAX;
+        }
+        ns->min_window = (ns->min_window + 1) % MIC_NS_MIN_WINDOWS;
+        ns->min_frame = 0;
+    }
+
+    // Synthesis window and overlap-add
+    audio_dsp_rfft_s32_inverse(&ns->fft, x);
+    for (uint32_t i = 0; i < MIC_NS_HOP; i++) {
+        int32_t head = scale_q15(x[i], ns->window[i]);
+        ns->output[i] = audio_dsp_sat16(ns->overlap[i] + head);
+        ns->overlap[i] = scale_q15(x[MIC_NS_HOP + i], ns->window[MIC_NS_HOP + i]);
+    }
+
+    memmove(ns->input, ns->input + MIC_NS_HOP, (MIC_NS_FRAME - MIC_NS_HOP) * sizeof(int16_t));
+}
+
+void mic_ns_process(mic_ns_t* ns, int16_t* samples, size_t count) {
+    int16_t* tail = ns->input + (MIC_NS_FRAME - MIC_NS_HOP);
+
+    while (count > 0) {
+        size_t take = MIC_NS_HOP - ns->fill;
+        take = take < count ? take : count;
+
+        memcpy(tail + ns->fill, samples, take * sizeof(int16_t));
+        memcpy(samples, ns->output + ns->fill, take * sizeof(int16_t));
+        ns->fill += take;
+        samples += take;
+        count -= take;
+
+        if (ns->fill == MIC_NS_HOP) {
+            uint32_t start = esp_cpu_get_cycle_count();
+            process_hop(ns);
+            ns->cycles_total += esp_cpu_get_cycle_count() - start;
+            ns->frames++;
+            ns->fill = 0;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "audio_dsp_fft.h"
+
+/**
+ * @brief Noise suppressor tuning
+ */
+typedef struct {
+    bool enabled;
+    uint16_t max_attenuation_db;    ///< Deepest cut applied to noise-only bins
+} mic_ns_config_t;
+
+#define MIC_NS_CONFIG_DEFAULT() { \
+    .enabled = false,             \
+    .max_attenuation_db = 15,     \
+}
+
+/** STFT frame length and hop, in samples */
+#define MIC_NS_FRAME    256
+#define MIC_NS_HOP      (MIC_NS_FRAME / 2)
+#define MIC_NS_BINS     (MIC_NS_FRAME / 2 + 1)
+/** Minimum-statistics search: sub-windows x frames per sub-window */
+#define MIC_NS_MIN_WINDOWS  4
+#define MIC_NS_MIN_FRAMES   48
+
+/**
+ * @brief STFT noise suppressor state
+ *
+ * 50% overlapped sqrt-Hann frames go through a fixed-point real FFT. The
+ * noise spectrum is tracked with minimum statistics (the minimum of the
+ * smoothed power over about 1.5 s, so it follows noise changes but never
+ * learns speech), and each bin is scaled by a decision-directed Wiener gain.
+ * Output is delayed by MIC_NS_FRAME samples: one hop to fill the frame and
+ * one to complete the overlap-add.
+ */
+typedef struct {
+    mic_ns_config_t config;
+    audio_dsp_rfft_s32_t fft;
+    int16_t* window;            // sqrt-Hann, Q15
+    int16_t* input;             // last MIC_NS_FRAME input samples
+    int32_t* overlap;           // synthesis tail waiting for the next hop
+    int16_t* output;            // MIC_NS_HOP samples ready to hand out
+    int32_t* spectrum;          // MIC_NS_FRAME scratch
+    float* smoothed;            // per-bin smoothed power
+    float* noise;               // per-bin noise estimate
+    float* min_current;         // minimum over the current sub-window
+    float* min_windows;         // MIC_NS_MIN_WINDOWS sub-window minima
+    float* prev_clean;          // |G X|^2 of the previous frame
+    uint32_t fill;              // samples of the current hop already taken in
+    uint32_t min_frame;         // position in the current sub-window
+    uint32_t min_window;        // sub-window being filled
+    uint32_t frames;
+    float gain_floor;
+    uint64_t cycles_total;
+} mic_ns_t;
+
+/**
+ * @brief Allocate and initialize the suppressor
+ */
+esp_err_t mic_ns_init(mic_ns_t* ns, const mic_ns_config_t* config);
+
+/**
+ * @brief Free the suppressor's buffers
+ */
+void mic_ns_deinit(mic_ns_t* ns);
+
+/**
+ * @brief Suppress noise in a block of 16-bit PCM in place
+ *
+ * Any block length works; output lags input by mic_ns_latency_samples.
+ */
+void mic_ns_process(mic_ns_t* ns, int16_t* samples, size_t count);
+
+/**
+ * @brief Algorithmic delay added to the stream, in samples
+ */
+static inline uint32_t mic_ns_latency_samples(const mic_ns_t* ns) {
+    return MIC_NS_FRAME;
+}
+
+/**
+ * @brief Average CPU cycles per STFT hop since init
+ */
+static inline uint32_t mic_ns_cycles_per_hop(const mic_ns_t* ns) {
+    return ns->frames ? (uint32_t)(ns->cycles_total / ns->frames) : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
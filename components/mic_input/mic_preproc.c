@@ -0,0 +1,87 @@
+#include "mic_preproc.h"
+#include <math.h>
+
+// DC blocker pole, 0.995 in Q15
+#define PREPROC_DC_POLE_Q15     32604
+// AGC never attenuates by more than 12 dB
+#define PREPROC_MIN_GAIN_Q10    (AUDIO_DSP_GAIN_UNITY / 4)
+
+static uint32_t db_to_level(int32_t db, uint32_t full_scale) {
+    return (uint32_t)lrintf((float)full_scale * powf(10.0f, (float)db / 20.0f));
+}
+
+void mic_preproc_init(mic_preproc_t* pp, const mic_preproc_config_t* config, uint32_t sample_rate) {
+    pp->config = *config;
+
+    audio_dsp_dc_block_init(&pp->dc, PREPROC_DC_POLE_Q15);
+    if (config->highpass_hz > 0) {
+        audio_dsp_biquad_highpass_init(&pp->hpf, config->highpass_hz, sample_rate, 707);
+    }
+
+    pp->envelope = 0;
+    pp->gain_q10 = AUDIO_DSP_GAIN_UNITY;
+    pp->target_peak = (int32_t)db_to_level(config->agc_target_db, INT16_MAX);
+    pp->max_gain_q10 = (int32_t)db_to_level(config->agc_max_gain_db, AUDIO_DSP_GAIN_UNITY);
+    if (pp->max_gain_q10 > INT16_MAX) {
+        pp->max_gain_q10 = INT16_MAX;
+    }
+    pp->gate_level = db_to_level(config->agc_gate_db, INT16_MAX);
+}
+
+static void agc_update(mic_preproc_t* pp, uint32_t peak) {
+    // Peak envelope: instant attack, ~0.5 s release at 32 ms blocks
+    if (peak > pp->envelope) {
+        pp->envelope = peak;
+    } else {
+        pp->envelope -= (pp->envelope - peak) >> 4;
+    }
+
+    int32_t gain = pp->gain_q10;
+
+    // Hold the gain through silence rather than pumping up the noise floor
+    if (pp->envelope > pp->gate_level) {
+        int32_t desired = (int32_t)(((int64_t)pp->target_peak * AUDIO_DSP_GAIN_UNITY) / pp->envelope);
+        desired = desired > pp->max_gain_q10 ? pp->max_gain_q10 : desired;
+        desired = desired < PREPROC_MIN_GAIN_Q10 ? PREPROC_MIN_GAIN_Q10 : desired;
+
+        if (desired < gain) {
+            // Back off quickly
+            gain -= (gain - desired + 1) >> 1;
+        } else {
+            // Creep up by at most ~0.5 dB per block so gain steps stay inaudible
+            int32_t step = (desired - gain) >> 3;
+            int32_t max_step = (gain >> 4) + 1;
+            gain += step > max_step ? max_step : step;
+        }
+    }
+
+    // Never let this block's peak clip
+    if (peak > 0 && ((int64_t)peak * gain >> 10) > INT16_MAX) {
+        gain = (int32_t)(((int64_t)INT16_MAX << 10) / peak);
+    }
+
+    pp->gain_q10 = gain;
+}
+
+void mic_preproc_filter(mic_preproc_t* pp, int16_t* samples, size_t count) {
+    if (pp->config.dc_block) {
+        audio_dsp_dc_block_s16(&pp->dc, samples, count);
+    }
+    if (pp->config.highpass_hz > 0) {
+        audio_dsp_biquad_s16(&pp->hpf, samples, count);
+    }
+}
+
+void mic_preproc_agc(mic_preproc_t* pp, int16_t* samples, size_t count) {
+    if (pp->config.agc) {
+        agc_update(pp, audio_dsp_peak_s16(samples, count));
+        if (pp->gain_q10 != AUDIO_DSP_GAIN_UNITY) {
+            audio_dsp_gain_s16(samples, count, (int16_t)pp->gain_q10);
+        }
+    }
+}
+
+void mic_preproc_process(mic_preproc_t* pp, int16_t* samples, size_t count) {
+    mic_preproc_filter(pp, samples, count);
+    mic_preproc_agc(pp, samples, count);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_dsp.h"
+
+/**
+ * @brief Microphone preprocessing tuning
+ */
+typedef struct {
+    bool dc_block;              ///< Remove the MEMS mic DC offset
+    uint16_t highpass_hz;       ///< High-pass corner in Hz, 0 to disable
+    bool agc;                   ///< Enable automatic gain control
+    int16_t agc_target_db;      ///< Target peak level in dBFS
+    uint16_t agc_max_gain_db;   ///< Upper bound on AGC gain
+    int16_t agc_gate_db;        ///< Below this level the gain is held instead of raised
+} mic_preproc_config_t;
+
+#define MIC_PREPROC_CONFIG_DEFAULT() { \
+    .dc_block = true,                  \
+    .highpass_hz = 100,                \
+    .agc = true,                       \
+    .agc_target_db = -9,               \
+    .agc_max_gain_db = 24,             \
+    .agc_gate_db = -55,                \
+}
+
+/**
+ * @brief Preprocessing chain state: DC blocker -> biquad high-pass -> AGC
+ */
+typedef struct {
+    mic_preproc_config_t config;
+    audio_dsp_dc_block_t dc;
+    audio_dsp_biquad_t hpf;
+    uint32_t envelope;          // peak envelope, 0 .. 32768
+    int32_t gain_q10;           // current AGC gain
+    int32_t target_peak;
+    int32_t max_gain_q10;
+    uint32_t gate_level;
+} mic_preproc_t;
+
+/**
+ * @brief Initialize the chain
+ */
+void mic_preproc_init(mic_preproc_t* pp, const mic_preproc_config_t* config, uint32_t sample_rate);
+
+/**
+ * @brief Process one block of 16-bit PCM in place
+ *
+ * Same as mic_preproc_filter followed by mic_preproc_agc.
+ */
+void mic_preproc_process(mic_preproc_t* pp, int16_t* samples, size_t count);
+
+/**
+ * @brief Run only the DC blocker and high-pass stages
+ *
+ * Lets linear stages such as echo cancellation sit between the filters and
+ * the AGC, which would otherwise change the echo path gain block by block.
+ */
+void mic_preproc_filter(mic_preproc_t* pp, int16_t* samples, size_t count);
+
+/**
+ * @brief Run only the AGC stage
+ */
+void mic_preproc_agc(mic_preproc_t* pp, int16_t* samples, size_t count);
+
+/**
+ * @brief Current AGC gain in Q10 (1024 = 0 dB)
+ */
+static inline int32_t mic_preproc_gain_q10(const mic_preproc_t* pp) {
+    return pp->gain_q10;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,103 @@
+#include "mic_vad.h"
+
+// Full-scale mean-square energy of 16-bit PCM
+#define VAD_FULL_SCALE_ENERGY (1u << 30)
+
+// 10^(k/10) for k = 0..9, Q16
+static const uint32_t s_db_step_q16[10] = {
+    65536, 82504, 103872, 130762, 164627, 207243, 260904, 328465, 413524, 520570
+};
+
+// value * 10^(db/10), saturated to 32 bits
+static uint32_t scale_db(uint32_t value, int db) {
+    uint64_t v = value;
+
+    if (db >= 0) {
+        for (; db >= 10 && v <= UINT32_MAX; db -= 10) {
+            v *= 10;
+        }
+        v = (v * s_db_step_q16[db % 10]) >> 16;
+    } else {
+        db = -db;
+        for (; db >= 10; db -= 10) {
+            v /= 10;
+        }
+        v = (v << 16) / s_db_step_q16[db];
+    }
+
+    return v > UINT32_MAX ? UINT32_MAX : (uint32_t)v;
+}
+
+void mic_vad_init(mic_vad_t* vad, const mic_vad_config_t* config, uint32_t frame_ms) {
+    if (frame_ms == 0) {
+        frame_ms = 1;
+    }
+
+    vad->abs_threshold = scale_db(VAD_FULL_SCALE_ENERGY, config->threshold_db);
+    vad->margin_q8 = scale_db(256, config->margin_db);
+    vad->noise_floor = 0;
+    vad->zcr_max = config->zcr_max;
+    vad->hangover_frames = (config->hangover_ms + frame_ms - 1) / frame_ms;
+    vad->hangover_left = 0;
+    vad->active = false;
+}
+
+uint32_t mic_vad_frame_energy(const int16_t* samples, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t s = samples[i];
+        sum += s * s;
+    }
+    return (uint32_t)(sum / (int64_t)count);
+}
+
+uint32_t mic_vad_zero_crossings(const int16_t* samples, size_t count) {
+    if (count < 2) {
+        return 0;
+    }
+
+    uint32_t crossings = 0;
+    for (size_t i = 1; i < count; i++) {
+        crossings += ((samples[i] ^ samples[i - 1]) < 0);
+    }
+    return (crossings * 1000) / (uint32_t)(count - 1);
+}
+
+bool mic_vad_process(mic_vad_t* vad, const int16_t* samples, size_t count) {
+    uint32_t energy = mic_vad_frame_energy(samples, count);
+    uint32_t zcr = mic_vad_zero_crossings(samples, count);
+
+    uint64_t required = ((uint64_t)vad->noise_floor * vad->margin_q8) >> 8;
+    if (required < vad->abs_threshold) {
+        required = vad->abs_threshold;
+    }
+
+    // Loud enough and either voiced-looking (low ZCR) or so far above the
+    // floor that a high ZCR is more likely a fricative than background hiss
+    bool loud = energy > required;
+    bool strong = (energy >> 2) > required;
+    bool speech = loud && (zcr <= vad->zcr_max || strong);
+
+    // Noise floor: follow drops quickly, rises slowly, and barely at all while
+    // speech is present so talking does not raise the floor
+    if (energy < vad->noise_floor) {
+        vad->noise_floor -= (vad->noise_floor - energy) >> 3;
+    } else {
+        vad->noise_floor += (energy - vad->noise_floor) >> (speech ? 10 : 6);
+    }
+
+    if (speech) {
+        vad->hangover_left = vad->hangover_frames;
+        vad->active = true;
+    } else if (vad->hangover_left > 0) {
+        vad->hangover_left--;
+    } else {
+        vad->active = false;
+    }
+
+    return vad->active;
+}
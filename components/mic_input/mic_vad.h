@@ -0,0 +1,74 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Voice activity detector tuning
+ */
+typedef struct {
+    bool enabled;           ///< Gate the uplink on detected speech
+    int16_t threshold_db;   ///< Absolute frame energy floor in dBFS (e.g. -45)
+    uint16_t margin_db;     ///< Required energy above the tracked noise floor in dB
+    uint16_t zcr_max;       ///< Zero crossings per 1000 samples above which a weak frame counts as noise
+    uint16_t hangover_ms;   ///< Time the gate stays open after the last speech frame
+} mic_vad_config_t;
+
+#define MIC_VAD_CONFIG_DEFAULT() { \
+    .enabled = false,              \
+    .threshold_db = -45,           \
+    .margin_db = 9,                \
+    .zcr_max = 250,                \
+    .hangover_ms = 400,            \
+}
+
+/**
+ * @brief Voice activity detector state
+ *
+ * Energy and zero-crossing rate are computed per frame in integer
+ * arithmetic; thresholds are converted from dB once in mic_vad_init.
+ */
+typedef struct {
+    uint32_t abs_threshold;     // mean-square energy floor
+    uint32_t margin_q8;         // noise floor multiplier, Q8
+    uint32_t noise_floor;       // tracked mean-square noise energy
+    uint16_t zcr_max;
+    uint16_t hangover_frames;
+    uint16_t hangover_left;
+    bool active;
+} mic_vad_t;
+
+/**
+ * @brief Initialize a detector
+ *
+ * @param vad Detector state
+ * @param config Tuning parameters
+ * @param frame_ms Duration of the frames that will be passed to mic_vad_process
+ */
+void mic_vad_init(mic_vad_t* vad, const mic_vad_config_t* config, uint32_t frame_ms);
+
+/**
+ * @brief Classify one frame of 16-bit PCM
+ *
+ * @return true while speech is present or the hangover has not yet expired
+ */
+bool mic_vad_process(mic_vad_t* vad, const int16_t* samples, size_t count);
+
+/**
+ * @brief Mean-square energy of a frame (0 .. 2^30)
+ */
+uint32_t mic_vad_frame_energy(const int16_t* samples, size_t count);
+
+/**
+ * @brief Zero crossings per 1000 samples
+ */
+uint32_t mic_vad_zero_crossings(const int16_t* samples, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,80 +1,579 @@
 #include "openai_rt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "openai_rt_sdk_stub.h"
+#include "openai_rt_session.h"
+#include "openai_rt_fsm.h"
+#include "openai_rt_uplink.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "sleep_mgr.h"
 #include "led_ctrl.h"
 #include "avatar.h"
 #include "esp_timer.h"
 #include "audio_output.h"
 #include "mic_input.h"
+#include "config_mgr.h"
+#include "audio_aec.h"
+#include "audio_resample.h"
+#include "audio_codec.h"
+#include "media_clock.h"
+#include "audio_jitter.h"
+#include "audio_ring.h"
+#include "audio_mixer.h"
+#include "audio_dynamics.h"
+#include "audio_wsola.h"
+#include "audio_plc.h"
+#include "asset_bundle.h"
+#include "latency_trace.h"
 
 #define TAG "OPENAI_RT"
 
 // Event group bits
-#define OPENAI_RT_EVENT_STOP_REQUEST    (1 << 0)
-#define OPENAI_RT_EVENT_CONVERSATION_END (1 << 1)
+#define OPENAI_RT_EVENT_PLAYOUT_EXIT    (1 << 0)
 
 // Maximum conversation time in milliseconds (2 minutes)
 #define MAX_CONVERSATION_TIME_MS (2 * 60 * 1000)
+// Longest a press waits for the session to open
+#define SESSION_ACQUIRE_TIMEOUT_MS  10000
+// First reconnect delay after a failed connect or keepalive
+#define SESSION_RETRY_MS            1000
+// Conversation events waiting for the state machine
+#define CONV_QUEUE_LEN              16
+// Uplink quiet this long after the VAD's hangover ends the user's turn
+#define SPEECH_END_GAP_MS           150
+// Response playback counts as finished after this long without voice
+#define PLAYBACK_DONE_MS            300
+
+// I2S runs at this rate; the wire rate depends on the configured codec
+#define DEVICE_SAMPLE_RATE          16000
+// Microphone frame handed to mic_data_callback, in bytes
+#define MIC_FRAME_BYTES             1024
+// Downlink audio is decoded and converted in slices of this many wire-rate samples
+#define DOWNLINK_SLICE_SAMPLES      480
+// SDK audio waits for the playout task in a ring of this many slots, each
+// holding up to DOWNLINK_SLOT_BYTES of wire data (power of two)
+#define DOWNLINK_RING_SLOTS         32
+#define DOWNLINK_SLOT_BYTES         1024
+// The playout task shares the audio core with mic capture
+#define PLAYOUT_CORE                (portNUM_PROCESSORS - 1)
+// The playout task moves response audio to I2S in periods of this length
+#define PLAYOUT_PERIOD_MS           20
+#define PLAYOUT_PERIOD_SAMPLES      (DEVICE_SAMPLE_RATE / 1000 * PLAYOUT_PERIOD_MS)
+// Response audio comes out of the jitter buffer through the time stretcher
+// in its 10 ms blocks. Playback speeds up while the buffer holds more than
+// PLAYOUT_FAST_MARGIN_MS over its target and slows down below half the
+// target, until the depth is back at the target
+#define PLAYOUT_STRETCH_SAMPLES     (DEVICE_SAMPLE_RATE / 1000 * 10)
+#define PLAYOUT_FAST_MARGIN_MS      40
+// Longest wait for DMA space; the queue drains a period every PLAYOUT_PERIOD_MS
+#define PLAYOUT_WRITE_TIMEOUT_MS    200
+// Time the end of a conversation gives buffered response audio to play
+#define PLAYOUT_DRAIN_TIMEOUT_MS    2000
+// Mixer channels in front of the speaker; earcons duck the voice by about 9 dB
+#define MIXER_CH_VOICE              0
+#define MIXER_CH_EARCON             1
+#define MIXER_CHANNELS              2
+#define EARCON_DUCK_Q10             360
+// Click played when a conversation starts: the bundle's "click" earcon,
+// or a synthesized one without it
+#define EARCON_CLICK_ASSET          "click"
+#define EARCON_CLICK_MS             40
+#define EARCON_CLICK_HZ             2000
+
+// Ring slot: wire data as the SDK delivered it, stamped on arrival
+typedef struct {
+    int64_t arrival_us;
+    uint8_t data[];
+} downlink_slot_t;
+
+// A conversation event, stamped where it happened
+typedef struct {
+    conv_event_t event;
+    int64_t at_us;
+} conv_msg_t;
 
 typedef struct {
     EventGroupHandle_t event_group;
-    esp_timer_handle_t timeout_timer;
+    esp_timer_handle_t connect_timer;   // session wait
+    esp_timer_handle_t timeout_timer;   // conversation length
+    esp_timer_handle_t speech_timer;    // re-armed by every uplink frame
     openai_rt_handle_t sdk_handle;
-    bool is_active;
+    audio_aec_t* aec;
+    audio_codec_t uplink_codec;
+    audio_codec_t downlink_codec;
+    audio_resample_t* uplink_rs;    // mic rate -> wire rate, NULL if equal
+    audio_resample_t* downlink_rs;  // wire rate -> speaker rate, NULL if equal
+    int16_t* uplink_buf;            // resampled mic frame
+    uint8_t* uplink_wire;           // encoded mic frame
+    openai_rt_uplink_t* uplink;     // encoded mic audio -> input_audio_buffer.append events
+    SemaphoreHandle_t uplink_lock;  // the mic callback against the speech-end flush
+    int16_t* downlink_pcm;          // decoded slice
+    int16_t* downlink_buf;          // resampled slice
+    audio_ring_t* downlink_ring;    // SDK callback -> playout task, lock-free
+    audio_jitter_t* jitter;         // response audio waiting for playout, playout task only
+    audio_mixer_t* mixer;           // voice and earcons, mixed by the playout task
+    audio_dynamics_t* dynamics;     // compressor, volume and limiter on the mix, playout task only
+    audio_wsola_t* wsola;           // time stretcher after the jitter buffer, NULL when disabled
+    int32_t stretch_q10;            // rate change the stretcher applies, Q10 (102 is 10 %)
+    audio_plc_t* plc;               // fills periods the jitter buffer could not, NULL when disabled
+    TaskHandle_t playout_task;
+    volatile bool playout_run;
+    volatile bool playout_drain;    // exit once everything received has played
+    bool voice_playing;             // response audio reached the mixer lately, playout task only
+    int64_t voice_last_us;
+    volatile bool barge_in;         // speech cut the response; the playout task drops what it holds
+    uint32_t barge_in_discard_ms;
+    int64_t discard_until_us;       // response audio arriving before this is dropped, playout task only
+    uint32_t barge_ins;             // this conversation
+    uint32_t barge_in_us_max;       // speech onset to silence
+    uint64_t barge_in_us_total;
+    uint32_t downlink_chunks;       // SDK callbacks this conversation
+    uint32_t enqueue_us_max;        // time the SDK callback spent
+    uint64_t enqueue_us_total;
+    mic_kws_t* kws;                 // wake-word spotter, NULL when disabled
+    void* kws_model;                // model blob the spotter runs from
+    bool is_active;                 // the SDK conversation is running
     bool mic_initialized;
+    bool mic_started;               // capture runs for this conversation
+    bool output_on;                 // speaker out of standby for this conversation
+    bool cold_start;                // this conversation installed the drivers
+    int64_t press_us;               // when the conversation was requested
+    bool first_uplink_logged;
 } openai_rt_context_t;
 
-static TaskHandle_t s_task = NULL;
+static TaskHandle_t s_conv_task = NULL;
+static QueueHandle_t s_conv_queue = NULL;
+static conv_fsm_t s_fsm;                // conversation task only, but for state snapshots
 static openai_rt_context_t s_context = {0};
+static bool s_audio_ready = false;  // drivers installed, stages and codecs allocated
+static bool s_session_ready = false;    // session manager running
+// Button press to session ready, over all conversations since boot
+static uint32_t s_presses = 0;
+static uint32_t s_presses_open = 0;     // found the session already open
+static uint32_t s_press_ready_ms_max = 0;
+static uint64_t s_press_ready_ms_total = 0;
 
 // Forward declarations
 static void conversation_task(void* pvParameters);
-static void cleanup_resources(openai_rt_context_t* context);
+static void conv_post(conv_event_t event);
 static void timeout_callback(void* arg);
 static void audio_data_callback(const void* audio_data, size_t data_size, void* user_data);
 static void conversation_end_callback(void* user_data);
 static void mic_data_callback(const void* audio_data, size_t data_size, void* user_data);
+static void playback_tap_callback(const void* audio_data, size_t data_size, void* user_data);
+static void wake_word_callback(void* user_data);
+static void speech_onset_callback(int64_t onset_us, void* user_data);
+static void playout_task(void* pvParameters);
 
+// Runs in the SDK's delivery context (an esp_timer callback in the stub):
+// copies the chunk into the ring and returns, never waiting on anything
 static void audio_data_callback(const void* audio_data, size_t data_size, void* user_data) {
+    openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
+    int64_t start_us = esp_timer_get_time();
     ESP_LOGD(TAG, "Received %d bytes of audio data", data_size);
     
     // Reset sleep timer whenever we receive audio data (user is engaged)
     sleep_mgr_reset_timer();
-    
-    // Send audio data to the audio output component
-    // We don't wait for completion here to avoid blocking the callback
-    int bytes_written = audio_output_write(audio_data, data_size, false);
-    
-    if (bytes_written < 0) {
-        ESP_LOGW(TAG, "Failed to write audio data to output");
-    } else if (bytes_written != data_size) {
-        ESP_LOGW(TAG, "Partial write: %d/%d bytes", bytes_written, data_size);
+
+    if (!ctx || !ctx->downlink_ring) {
+        return;
     }
+    // The first chunk after the user's turn ended is the response arriving
+    if (latency_trace_end(LATENCY_SPAN_RESPONSE, start_us)) {
+        latency_trace_begin(LATENCY_SPAN_DOWNLINK, start_us);
+    }
+
+    // A full ring counts an overrun per slot that did not fit
+    const uint8_t* wire = (const uint8_t*)audio_data;
+    size_t remaining = data_size;
+    while (remaining > 0) {
+        size_t n = remaining < DOWNLINK_SLOT_BYTES ? remaining : DOWNLINK_SLOT_BYTES;
+        downlink_slot_t* slot = audio_ring_write_acquire(ctx->downlink_ring);
+        if (slot) {
+            slot->arrival_us = start_us;
+            memcpy(slot->data, wire, n);
+            audio_ring_write_commit(ctx->downlink_ring, sizeof(downlink_slot_t) + n);
+        }
+        wire += n;
+        remaining -= n;
+    }
+
+    if (ctx->playout_task) {
+        xTaskNotifyGive(ctx->playout_task);
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    ctx->downlink_chunks++;
+    ctx->enqueue_us_total += elapsed_us;
+    ctx->enqueue_us_max = elapsed_us > ctx->enqueue_us_max ? elapsed_us : ctx->enqueue_us_max;
 }
 
-// Conversation end callback from OpenAI SDK
-static void conversation_end_callback(void* user_data) {
-    openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
-    if (ctx && ctx->event_group) {
-        xEventGroupSetBits(ctx->event_group, OPENAI_RT_EVENT_CONVERSATION_END);
+// Decodes and converts wire data to the speaker rate slice by slice into
+// the jitter buffer
+static void playout_decode(openai_rt_context_t* ctx, const uint8_t* wire, size_t size, int64_t arrival_us) {
+    const size_t slice = audio_codec_encoded_size(ctx->downlink_codec.type, DOWNLINK_SLICE_SAMPLES);
+    bool first = true;
+    while (size > 0) {
+        size_t n = size < slice ? size : slice;
+        size_t out = audio_codec_decode(&ctx->downlink_codec, wire, n, ctx->downlink_pcm);
+        const int16_t* pcm = ctx->downlink_pcm;
+        wire += n;
+        size -= n;
+        if (ctx->downlink_rs) {
+            out = audio_resample_process(ctx->downlink_rs, pcm, out, ctx->downlink_buf);
+            pcm = ctx->downlink_buf;
+        }
+        if (out == 0) {
+            continue;
+        }
+        // One chunk is one arrival for the jitter estimate, however sliced
+        size_t stored = first ? audio_jitter_put(ctx->jitter, pcm, out, arrival_us)
+                              : audio_jitter_append(ctx->jitter, pcm, out);
+        first = false;
+        if (stored < out) {
+            ESP_LOGW(TAG, "Jitter buffer full, dropped %d samples", (int)(out - stored));
+        }
+    }
+}
+
+// Chooses the playback rate from the jitter buffer's depth against its target
+static void playout_set_rate(openai_rt_context_t* ctx) {
+    audio_jitter_stats_t stats;
+    audio_jitter_get_stats(ctx->jitter, &stats);
+    int32_t rate = audio_wsola_get_rate(ctx->wsola);
+    if (stats.depth_ms > stats.target_ms + PLAYOUT_FAST_MARGIN_MS) {
+        rate = AUDIO_WSOLA_RATE_UNITY + ctx->stretch_q10;
+    } else if (stats.depth_ms < stats.target_ms / 2) {
+        rate = AUDIO_WSOLA_RATE_UNITY - ctx->stretch_q10;
+    } else if ((rate > AUDIO_WSOLA_RATE_UNITY && stats.depth_ms <= stats.target_ms) ||
+               (rate < AUDIO_WSOLA_RATE_UNITY && stats.depth_ms >= stats.target_ms)) {
+        rate = AUDIO_WSOLA_RATE_UNITY;
+    }
+    audio_wsola_set_rate(ctx->wsola, rate);
+}
+
+// Takes up to a period of response audio. With the stretcher, blocks are
+// pulled through it until the period is full; when the jitter buffer runs
+// short, what the stretcher still holds plays out as it is.
+static size_t playout_pull(openai_rt_context_t* ctx, int16_t* period) {
+    int64_t now_us = esp_timer_get_time();
+    if (!ctx->wsola) {
+        return audio_jitter_get(ctx->jitter, period, PLAYOUT_PERIOD_SAMPLES, now_us);
+    }
+
+    int16_t chunk[PLAYOUT_STRETCH_SAMPLES];
+    playout_set_rate(ctx);
+    size_t n = 0;
+    while (true) {
+        n += audio_wsola_read(ctx->wsola, period + n, PLAYOUT_PERIOD_SAMPLES - n);
+        if (n == PLAYOUT_PERIOD_SAMPLES) {
+            return n;
+        }
+        size_t got = audio_jitter_get(ctx->jitter, chunk, PLAYOUT_STRETCH_SAMPLES, now_us);
+        audio_wsola_write(ctx->wsola, chunk, got);
+        if (got < PLAYOUT_STRETCH_SAMPLES) {
+            return n + audio_wsola_drain(ctx->wsola, period + n, PLAYOUT_PERIOD_SAMPLES - n);
+        }
+    }
+}
+
+// Response audio passes through the concealer, which completes a period
+// the jitter buffer left short. The end of a response looks the same as a
+// stall, and gets a short decay into the background level.
+static size_t playout_conceal(openai_rt_context_t* ctx, int16_t* period, size_t n) {
+    if (n > 0) {
+        audio_plc_good(ctx->plc, period, n);
     }
-    ESP_LOGI(TAG, "Conversation ended by OpenAI service");
+    if (n < PLAYOUT_PERIOD_SAMPLES) {
+        n += audio_plc_conceal(ctx->plc, period + n, PLAYOUT_PERIOD_SAMPLES - n);
+    }
+    return n;
+}
+
+// Empties the ring into the jitter buffer, then mixes one period of voice
+// and earcons into the I2S queue, blocking for space so it runs at the
+// speaker clock; sleeps while there is nothing to play
+static void playout_task(void* pv) {
+    openai_rt_context_t* ctx = (openai_rt_context_t*)pv;
+    int16_t period[PLAYOUT_PERIOD_SAMPLES] __attribute__((aligned(16)));
+    int16_t mixed[PLAYOUT_PERIOD_SAMPLES] __attribute__((aligned(16)));
+    bool voice_started = false;     // this period carries the first voice of a response
+
+    while (ctx->playout_run) {
+        if (ctx->barge_in) {
+            // Drop the cut response, including what is still in flight
+            // while the cancel reaches the service
+            ctx->barge_in = false;
+            ctx->discard_until_us = esp_timer_get_time() + (int64_t)ctx->barge_in_discard_ms * 1000;
+            audio_jitter_flush(ctx->jitter);
+            audio_mixer_flush(ctx->mixer, MIXER_CH_VOICE);
+            audio_dynamics_reset(ctx->dynamics);
+            if (ctx->wsola) {
+                audio_wsola_reset(ctx->wsola);
+            }
+            if (ctx->plc) {
+                audio_plc_reset(ctx->plc);
+            }
+            // Catches a period written while the flag was being raised
+            audio_output_flush();
+        }
+
+        const downlink_slot_t* slot;
+        size_t len;
+        while ((slot = audio_ring_read_acquire(ctx->downlink_ring, &len)) != NULL) {
+            if (slot->arrival_us >= ctx->discard_until_us) {
+                playout_decode(ctx, slot->data, len - sizeof(downlink_slot_t), slot->arrival_us);
+            }
+            audio_ring_read_release(ctx->downlink_ring);
+        }
+
+        size_t n = playout_pull(ctx, period);
+        if (ctx->plc) {
+            n = playout_conceal(ctx, period, n);
+        }
+        int64_t now_us = esp_timer_get_time();
+        if (n > 0) {
+            audio_mixer_write(ctx->mixer, MIXER_CH_VOICE, period, n);
+            ctx->voice_last_us = now_us;
+            if (!ctx->voice_playing) {
+                ctx->voice_playing = true;
+                voice_started = true;
+                conv_post(CONV_EV_PLAYBACK_START);
+            }
+        } else if (ctx->voice_playing && now_us - ctx->voice_last_us >= (int64_t)PLAYBACK_DONE_MS * 1000) {
+            ctx->voice_playing = false;
+            conv_post(CONV_EV_PLAYBACK_DONE);
+        }
+        n = audio_mixer_mix(ctx->mixer, mixed);
+        if (n > 0) {
+            audio_dynamics_process(ctx->dynamics, mixed, n);
+        } else {
+            // Once the mix runs dry the limiter's look-ahead still holds audio
+            n = audio_dynamics_drain(ctx->dynamics, mixed);
+        }
+        if (n == 0) {
+            if (ctx->playout_drain && audio_jitter_depth_ms(ctx->jitter) == 0) {
+                break;
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PLAYOUT_PERIOD_MS));
+            continue;
+        }
+        int bytes_written = audio_output_enqueue(mixed, n * sizeof(int16_t), PLAYOUT_WRITE_TIMEOUT_MS);
+        if (bytes_written < 0) {
+            ESP_LOGW(TAG, "Failed to write audio data to output");
+        } else if (bytes_written != (int)(n * sizeof(int16_t))) {
+            ESP_LOGW(TAG, "Output stalled: %d/%d bytes", bytes_written, (int)(n * sizeof(int16_t)));
+        }
+        // The voice entered the mixer at the start of this period. The queue
+        // ran down while there was nothing to play, so the period went in
+        // with one write and the playback stamp is its first sample; the
+        // limiter's look-ahead comes on top
+        media_clock_stamp_t stamp;
+        if (voice_started && bytes_written > 0 && media_clock_get(MEDIA_CLOCK_PLAYBACK, &stamp)) {
+            latency_trace_end(LATENCY_SPAN_DOWNLINK, stamp.time_us);
+            latency_trace_end(LATENCY_SPAN_END_TO_END, stamp.time_us);
+        }
+        voice_started = false;
+    }
+
+    xEventGroupSetBits(ctx->event_group, OPENAI_RT_EVENT_PLAYOUT_EXIT);
+    vTaskDelete(NULL);
+}
+
+// The SDK is not started yet, so neither end of the ring is in use
+static esp_err_t playout_start(openai_rt_context_t* ctx) {
+    audio_ring_flush(ctx->downlink_ring);
+    audio_ring_reset_stats(ctx->downlink_ring);
+    audio_jitter_flush(ctx->jitter);
+    audio_jitter_reset_stats(ctx->jitter);
+    audio_mixer_flush(ctx->mixer, MIXER_CH_VOICE);
+    audio_mixer_flush(ctx->mixer, MIXER_CH_EARCON);
+    audio_dynamics_reset(ctx->dynamics);
+    audio_dynamics_reset_stats(ctx->dynamics);
+    if (ctx->wsola) {
+        audio_wsola_reset(ctx->wsola);
+        audio_wsola_set_rate(ctx->wsola, AUDIO_WSOLA_RATE_UNITY);
+        audio_wsola_reset_stats(ctx->wsola);
+    }
+    if (ctx->plc) {
+        audio_plc_reset(ctx->plc);
+        audio_plc_reset_stats(ctx->plc);
+    }
+    ctx->downlink_chunks = 0;
+    ctx->enqueue_us_max = 0;
+    ctx->enqueue_us_total = 0;
+    ctx->barge_in = false;
+    ctx->discard_until_us = 0;
+    ctx->barge_ins = 0;
+    ctx->barge_in_us_max = 0;
+    ctx->barge_in_us_total = 0;
+
+    xEventGroupClearBits(ctx->event_group, OPENAI_RT_EVENT_PLAYOUT_EXIT);
+    ctx->voice_playing = false;
+    ctx->playout_run = true;
+    ctx->playout_drain = false;
+    if (xTaskCreatePinnedToCore(playout_task, "openai_rt_play", 4096, ctx, 6,
+                                &ctx->playout_task, PLAYOUT_CORE) != pdPASS) {
+        ctx->playout_run = false;
+        ctx->playout_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// Lets received audio finish playing (up to drain_ms), then ends the task;
+// the SDK must be stopped first
+static void playout_stop(openai_rt_context_t* ctx, uint32_t drain_ms) {
+    if (!ctx->playout_task) {
+        return;
+    }
+    ctx->playout_drain = true;
+    xTaskNotifyGive(ctx->playout_task);
+    EventBits_t bits = xEventGroupWaitBits(ctx->event_group, OPENAI_RT_EVENT_PLAYOUT_EXIT, pdTRUE, pdTRUE,
+                                           pdMS_TO_TICKS(drain_ms));
+    if (!(bits & OPENAI_RT_EVENT_PLAYOUT_EXIT)) {
+        ctx->playout_run = false;
+        xTaskNotifyGive(ctx->playout_task);
+        xEventGroupWaitBits(ctx->event_group, OPENAI_RT_EVENT_PLAYOUT_EXIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    }
+    ctx->playout_task = NULL;
+
+    audio_ring_stats_t ring;
+    audio_jitter_stats_t stats;
+    audio_ring_get_stats(ctx->downlink_ring, &ring);
+    audio_jitter_get_stats(ctx->jitter, &stats);
+    audio_jitter_flush(ctx->jitter);
+    ESP_LOGI(TAG, "Downlink queue: %lu chunks in %lu buffers, deepest %lu/%lu, %lu dropped; "
+             "callback %lu us avg, %lu us max",
+             (unsigned long)ctx->downlink_chunks, (unsigned long)ring.frames_written,
+             (unsigned long)ring.high_water, (unsigned long)ring.capacity, (unsigned long)ring.overruns,
+             (unsigned long)(ctx->downlink_chunks ? ctx->enqueue_us_total / ctx->downlink_chunks : 0),
+             (unsigned long)ctx->enqueue_us_max);
+    ESP_LOGI(TAG, "Jitter buffer: %u chunks, %u late (%u ms of gaps), %u early, %u ms dropped; "
+             "jitter %u ms, target %u ms, deepest %u ms",
+             (unsigned)stats.chunks, (unsigned)stats.late, (unsigned)stats.gap_ms, (unsigned)stats.early,
+             (unsigned)stats.dropped_ms, (unsigned)stats.jitter_ms, (unsigned)stats.target_ms,
+             (unsigned)stats.max_depth_ms);
+    if (ctx->wsola) {
+        audio_wsola_stats_t ws;
+        audio_wsola_get_stats(ctx->wsola, &ws);
+        if (ws.blocks > 0) {
+            ESP_LOGI(TAG, "Time stretch: %lu%% of %lu ms faster, %lu%% slower, %ld ms of latency recovered",
+                     (unsigned long)(ws.fast_blocks * 100 / ws.blocks), (unsigned long)ws.blocks * 10,
+                     (unsigned long)(ws.slow_blocks * 100 / ws.blocks), (long)ws.saved_ms);
+        }
+    }
+    if (ctx->plc) {
+        audio_plc_stats_t plc;
+        audio_plc_get_stats(ctx->plc, &plc);
+        if (plc.gaps > 0) {
+            ESP_LOGI(TAG, "Concealment: %lu gaps, %lu ms synthesized (%lu ms of it comfort noise), longest %lu ms",
+                     (unsigned long)plc.gaps, (unsigned long)plc.concealed_ms, (unsigned long)plc.noise_ms,
+                     (unsigned long)plc.longest_gap_ms);
+        }
+    }
+    audio_dynamics_stats_t dyn;
+    audio_dynamics_get_stats(ctx->dynamics, &dyn);
+    if (dyn.blocks > 0) {
+        ESP_LOGI(TAG, "Speaker dynamics: limited %lu%% of %lu ms (up to %lu dB), compressed %lu%% (up to %lu dB)",
+                 (unsigned long)(dyn.limited_blocks * 100 / dyn.blocks), (unsigned long)dyn.blocks,
+                 (unsigned long)dyn.max_limit_db, (unsigned long)(dyn.compressed_blocks * 100 / dyn.blocks),
+                 (unsigned long)dyn.max_compress_db);
+    }
+    if (ctx->barge_ins > 0) {
+        ESP_LOGI(TAG, "Barge-in: %lu, speech onset to silence %lu ms avg, %lu ms max",
+                 (unsigned long)ctx->barge_ins,
+                 (unsigned long)(ctx->barge_in_us_total / ctx->barge_ins / 1000),
+                 (unsigned long)(ctx->barge_in_us_max / 1000));
+    }
+}
+
+// A short decaying tone on the earcon channel; only the conversation task
+// writes to that channel
+static void play_click(openai_rt_context_t* ctx) {
+    asset_t asset;
+    if (asset_bundle_find(EARCON_CLICK_ASSET, &asset) == ESP_OK && asset.type == ASSET_TYPE_PCM16 &&
+        ASSET_PCM_RATE(&asset) == DEVICE_SAMPLE_RATE) {
+        // Read straight from the flash mapping; the mixer copies all of it
+        // into the channel ring here
+        size_t count = asset.size / sizeof(int16_t);
+        if (audio_mixer_write(ctx->mixer, MIXER_CH_EARCON, asset.data, count) < count) {
+            ESP_LOGW(TAG, "Earcon '%s' longer than the mixer queue, truncated", EARCON_CLICK_ASSET);
+        }
+        xTaskNotifyGive(ctx->playout_task);
+        return;
+    }
+
+    int16_t click[DEVICE_SAMPLE_RATE / 1000 * EARCON_CLICK_MS];
+    const size_t count = sizeof(click) / sizeof(click[0]);
+    for (size_t i = 0; i < count; i++) {
+        float env = expf(-5.0f * (float)i / (float)count);
+        click[i] = (int16_t)(6000.0f * env * sinf(2.0f * (float)M_PI * EARCON_CLICK_HZ * i / DEVICE_SAMPLE_RATE));
+    }
+    audio_mixer_write(ctx->mixer, MIXER_CH_EARCON, click, count);
+    xTaskNotifyGive(ctx->playout_task);
+}
+
+// Conversation end callback from OpenAI SDK; also runs when the
+// conversation task stops the conversation, which the FSM then ignores
+static void conversation_end_callback(void* user_data) {
+    conv_post(CONV_EV_SESSION_END);
+}
+
+static void connect_timeout_callback(void* arg) {
+    conv_post(CONV_EV_CONNECT_TIMEOUT);
 }
 
 static void timeout_callback(void* arg) {
-    openai_rt_context_t* ctx = (openai_rt_context_t*)arg;
-    if (ctx && ctx->event_group) {
-        xEventGroupSetBits(ctx->event_group, OPENAI_RT_EVENT_STOP_REQUEST);
-        ESP_LOGW(TAG, "Conversation timeout reached");
+    conv_post(CONV_EV_TIMEOUT);
+}
+
+// The uplink went quiet: the VAD gate closed after the user's speech. The
+// conversation task flushes the framer; the send must not hold up the
+// esp_timer task
+static void speech_end_callback(void* arg) {
+    conv_post(CONV_EV_SPEECH_END);
+}
+
+// Uplink framer output: one append event, sent on the mic consumer task or
+// the conversation task with the uplink lock held
+static int uplink_send_callback(const char* json, size_t len, int64_t captured_us, void* user_data) {
+    openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
+    if (!ctx->is_active || !ctx->sdk_handle) {
+        return -1;
+    }
+
+    int result = openai_rt_send_event(ctx->sdk_handle, json, len);
+    if (result != 0) {
+        ESP_LOGW(TAG, "Failed to send audio event to OpenAI RT SDK: %d", result);
+        return result;
+    }
+    int64_t now_us = esp_timer_get_time();
+    if (captured_us >= ctx->press_us) {
+        // Pre-roll audio waited for the press, not for the pipeline
+        latency_trace_record(LATENCY_SPAN_UPLINK, now_us - captured_us);
+    }
+    if (!ctx->first_uplink_logged) {
+        // Negative when pre-roll delivered audio from before the press
+        ESP_LOGI(TAG, "First audio sent was captured %+lld ms from the press, sent %lld ms after it (%s pipeline)",
+                 (captured_us - ctx->press_us) / 1000,
+                 (now_us - ctx->press_us) / 1000, ctx->cold_start ? "cold" : "warm");
+        ctx->first_uplink_logged = true;
     }
+    ESP_LOGD(TAG, "Sent %d byte audio event to OpenAI RT SDK", (int)len);
+    return 0;
 }
 
-// Microphone data callback - forwards audio data to the OpenAI RT SDK
+// Microphone data callback - converts audio to the wire format and hands it
+// to the uplink framer, which sends it in events of uplink: frame_ms
 static void mic_data_callback(const void* data, size_t size, void* user_data) {
     openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
     
@@ -86,225 +585,847 @@ static void mic_data_callback(const void* data, size_t size, void* user_data) {
     // Reset sleep timer whenever we capture microphone data (user is speaking)
     sleep_mgr_reset_timer();
     
-    // Send audio data to the OpenAI RT SDK
-    int result = openai_rt_send_audio(ctx->sdk_handle, data, size);
-    if (result != 0) {
-        ESP_LOGW(TAG, "Failed to send audio data to OpenAI RT SDK: %d", result);
-    } else {
-        ESP_LOGD(TAG, "Sent %d bytes of audio data to OpenAI RT SDK", size);
+    // Convert to the wire rate and format
+    const int16_t* pcm = (const int16_t*)data;
+    size_t samples = size / sizeof(int16_t);
+    if (ctx->uplink_rs) {
+        samples = audio_resample_process(ctx->uplink_rs, pcm, samples, ctx->uplink_buf);
+        pcm = ctx->uplink_buf;
+    }
+    const void* wire = pcm;
+    size_t wire_size = samples * sizeof(int16_t);
+    if (ctx->uplink_codec.type != AUDIO_CODEC_PCM16) {
+        wire_size = audio_codec_encode(&ctx->uplink_codec, pcm, samples, ctx->uplink_wire);
+        wire = ctx->uplink_wire;
     }
+
+    int64_t captured_us;
+    mic_input_get_callback_stamp(NULL, &captured_us);
+    xSemaphoreTake(ctx->uplink_lock, portMAX_DELAY);
+    openai_rt_uplink_write(ctx->uplink, wire, wire_size, captured_us);
+    xSemaphoreGive(ctx->uplink_lock);
+    esp_timer_stop(ctx->speech_timer);
+    esp_timer_start_once(ctx->speech_timer, SPEECH_END_GAP_MS * 1000);
 }
 
-static void cleanup_resources(openai_rt_context_t* ctx) {
-    if (!ctx) return;
-    
-    // Stop microphone input if initialized
-    if (ctx->mic_initialized) {
-        mic_input_stop();
-        mic_input_deinit();
-        ctx->mic_initialized = false;
+// Playback tap - everything the speaker plays is the echo canceller's reference
+static void playback_tap_callback(const void* data, size_t size, void* user_data) {
+    openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
+
+    if (ctx && ctx->aec) {
+        audio_aec_push_reference(ctx->aec, (const int16_t*)data, size / sizeof(int16_t));
     }
-    
-    // Stop and delete timeout timer if active
-    if (ctx->timeout_timer) {
-        esp_timer_stop(ctx->timeout_timer);
-        esp_timer_delete(ctx->timeout_timer);
-        ctx->timeout_timer = NULL;
+}
+
+// Runs on the mic consumer task as the VAD opens, ahead of that frame's
+// uplink: silences the speaker here and now and leaves the buffers to the
+// playout task. Cancelling the response upstream is a network send, so
+// the conversation task does that on BARGE_IN
+static void speech_onset_callback(int64_t onset_us, void* user_data) {
+    openai_rt_context_t* ctx = (openai_rt_context_t*)user_data;
+
+    if (!ctx->is_active) {
+        return;
     }
-    
-    // Delete event group if created
-    if (ctx->event_group) {
-        vEventGroupDelete(ctx->event_group);
-        ctx->event_group = NULL;
+    if (!ctx->playout_task || !audio_output_is_busy()) {
+        conv_post(CONV_EV_SPEECH_START);
+        return;
     }
-    
-    // SDK handle is cleaned up by the caller
-    ctx->sdk_handle = NULL;
-    ctx->is_active = false;
+    ctx->barge_in = true;
+    audio_output_flush();
+    int64_t silent_us = esp_timer_get_time();
+    xTaskNotifyGive(ctx->playout_task);
+    conv_post(CONV_EV_BARGE_IN);
+
+    uint32_t latency_us = (uint32_t)(silent_us - onset_us);
+    latency_trace_record(LATENCY_SPAN_BARGE_IN, latency_us);
+    ctx->barge_ins++;
+    ctx->barge_in_us_total += latency_us;
+    ctx->barge_in_us_max = latency_us > ctx->barge_in_us_max ? latency_us : ctx->barge_in_us_max;
+    ESP_LOGI(TAG, "Barge-in: speaker silent %lu ms after speech onset", (unsigned long)(latency_us / 1000));
 }
 
-static void conversation_task(void* pv) {
-    // Get application configuration
-    extern const app_config_t* config_mgr_get(void);
-    const app_config_t* app_cfg = config_mgr_get();
-    
-    // Create event group for synchronization
-    s_context.event_group = xEventGroupCreate();
-    if (!s_context.event_group) {
-        ESP_LOGE(TAG, "Failed to create event group");
-        s_task = NULL;
-        vTaskDelete(NULL);
-        return;
+// Runs on the pre-roll task; starting a conversation only posts START to
+// the conversation task
+static void wake_word_callback(void* user_data) {
+    openai_rt_start_conversation();
+}
+
+// Codecs, sample-rate converters and their buffers between the 16 kHz I2S
+// devices and the configured wire formats
+static esp_err_t setup_audio_path(openai_rt_context_t* ctx, const codec_config_t* cfg) {
+    audio_codec_type_t up = AUDIO_CODEC_PCM16, down = AUDIO_CODEC_PCM16;
+    if (!audio_codec_from_name(cfg->uplink, &up)) {
+        ESP_LOGW(TAG, "Unknown uplink codec '%s', using pcm16", cfg->uplink);
     }
-    
-    // Create timeout timer
-    esp_timer_create_args_t timer_args = {
-        .callback = timeout_callback,
-        .arg = &s_context,
-        .name = "openai_timeout"
+    if (!audio_codec_from_name(cfg->downlink, &down)) {
+        ESP_LOGW(TAG, "Unknown downlink codec '%s', using pcm16", cfg->downlink);
+    }
+    // The names go to the session as its audio formats, so only ones the
+    // service accepts may pass
+    if (!audio_codec_is_wire_format(up)) {
+        ESP_LOGW(TAG, "Uplink codec '%s' is not a Realtime wire format, using pcm16", cfg->uplink);
+        up = AUDIO_CODEC_PCM16;
+    }
+    if (!audio_codec_is_wire_format(down)) {
+        ESP_LOGW(TAG, "Downlink codec '%s' is not a Realtime wire format, using pcm16", cfg->downlink);
+        down = AUDIO_CODEC_PCM16;
+    }
+    audio_codec_init(&ctx->uplink_codec, up);
+    audio_codec_init(&ctx->downlink_codec, down);
+
+    const uint32_t up_rate = audio_codec_sample_rate(up);
+    const uint32_t down_rate = audio_codec_sample_rate(down);
+    size_t up_samples = MIC_FRAME_BYTES / sizeof(int16_t);
+
+    if (up_rate != DEVICE_SAMPLE_RATE) {
+        if (audio_resample_create(DEVICE_SAMPLE_RATE, up_rate, AUDIO_RESAMPLE_TAPS_DEFAULT,
+                                  &ctx->uplink_rs) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+        up_samples = audio_resample_max_output(ctx->uplink_rs, up_samples);
+        ctx->uplink_buf = malloc(up_samples * sizeof(int16_t));
+        if (!ctx->uplink_buf) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (up != AUDIO_CODEC_PCM16) {
+        ctx->uplink_wire = malloc(audio_codec_encoded_size(up, up_samples));
+        if (!ctx->uplink_wire) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ctx->downlink_pcm = malloc(DOWNLINK_SLICE_SAMPLES * sizeof(int16_t));
+    if (!ctx->downlink_pcm) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (down_rate != DEVICE_SAMPLE_RATE) {
+        if (audio_resample_create(down_rate, DEVICE_SAMPLE_RATE, AUDIO_RESAMPLE_TAPS_DEFAULT,
+                                  &ctx->downlink_rs) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+        ctx->downlink_buf = malloc(audio_resample_max_output(ctx->downlink_rs, DOWNLINK_SLICE_SAMPLES) *
+                                   sizeof(int16_t));
+        if (!ctx->downlink_buf) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "Uplink %s at %lu Hz, downlink %s at %lu Hz",
+             audio_codec_name(up), (unsigned long)up_rate, audio_codec_name(down), (unsigned long)down_rate);
+    return ESP_OK;
+}
+
+// Mic audio leaves in append events of uplink: frame_ms; other lengths
+// fall back to the default
+static esp_err_t setup_uplink(openai_rt_context_t* ctx, const uplink_config_t* cfg) {
+    const audio_codec_type_t type = ctx->uplink_codec.type;
+    openai_rt_uplink_config_t up_cfg = OPENAI_RT_UPLINK_CONFIG_DEFAULT();
+    up_cfg.frame_ms = cfg->frame_ms;
+    up_cfg.bytes_per_second = audio_codec_encoded_size(type, audio_codec_sample_rate(type));
+    up_cfg.align = type == AUDIO_CODEC_PCM16 ? sizeof(int16_t) : 1;
+    up_cfg.send = uplink_send_callback;
+    up_cfg.user_data = ctx;
+    esp_err_t err = openai_rt_uplink_create(&up_cfg, &ctx->uplink);
+    if (err == ESP_ERR_INVALID_ARG) {
+        ESP_LOGW(TAG, "uplink: frame_ms must be 20, 40 or 100, using the default");
+        up_cfg.frame_ms = ((openai_rt_uplink_config_t)OPENAI_RT_UPLINK_CONFIG_DEFAULT()).frame_ms;
+        err = openai_rt_uplink_create(&up_cfg, &ctx->uplink);
+    }
+    ctx->uplink_lock = xSemaphoreCreateMutex();
+    if (err != ESP_OK || !ctx->uplink_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Uplink: %lu ms append events (%u bytes of audio)",
+             (unsigned long)up_cfg.frame_ms, (unsigned)openai_rt_uplink_frame_bytes(ctx->uplink));
+    return ESP_OK;
+}
+
+// Response audio queues as wire data for the playout task, which buffers
+// it at the speaker rate before I2S
+static esp_err_t setup_jitter_buffer(openai_rt_context_t* ctx, const jitter_buffer_config_t* cfg) {
+    audio_jitter_config_t jb_cfg = {
+        .sample_rate = DEVICE_SAMPLE_RATE,
+        .capacity_ms = cfg->capacity_ms,
+        .start_ms = cfg->start_ms,
+        .max_ms = cfg->max_ms,
     };
-    
-    if (esp_timer_create(&timer_args, &s_context.timeout_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timeout timer");
-        cleanup_resources(&s_context);
-        s_task = NULL;
-        vTaskDelete(NULL);
+    if (audio_jitter_create(&jb_cfg, &ctx->jitter) != ESP_OK) {
+        ESP_LOGW(TAG, "Invalid jitter_buffer settings, using defaults");
+        jb_cfg = (audio_jitter_config_t)AUDIO_JITTER_CONFIG_DEFAULT();
+        jb_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+        if (audio_jitter_create(&jb_cfg, &ctx->jitter) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (audio_ring_create(DOWNLINK_RING_SLOTS, sizeof(downlink_slot_t) + DOWNLINK_SLOT_BYTES,
+                          MALLOC_CAP_8BIT, &ctx->downlink_ring) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    audio_mixer_config_t mix_cfg = AUDIO_MIXER_CONFIG_DEFAULT();
+    mix_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+    mix_cfg.channels = MIXER_CHANNELS;
+    mix_cfg.period_ms = PLAYOUT_PERIOD_MS;
+    if (audio_mixer_create(&mix_cfg, &ctx->mixer) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    audio_mixer_set_duck(ctx->mixer, MIXER_CH_EARCON, EARCON_DUCK_Q10);
+
+    if (cfg->stretch_pct > 0) {
+        audio_wsola_config_t ws_cfg = AUDIO_WSOLA_CONFIG_DEFAULT();
+        ws_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+        if (audio_wsola_create(&ws_cfg, &ctx->wsola) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+        uint32_t pct = cfg->stretch_pct < 50 ? cfg->stretch_pct : 50;
+        ctx->stretch_q10 = (int32_t)(AUDIO_WSOLA_RATE_UNITY * pct / 100);
+    }
+    if (cfg->conceal_ms > 0) {
+        audio_plc_config_t plc_cfg = AUDIO_PLC_CONFIG_DEFAULT();
+        plc_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+        plc_cfg.max_ms = cfg->conceal_ms;
+        esp_err_t err = audio_plc_create(&plc_cfg, &ctx->plc);
+        if (err == ESP_ERR_INVALID_ARG) {
+            ESP_LOGW(TAG, "jitter_buffer: conceal_ms too short, using the default");
+            plc_cfg = (audio_plc_config_t)AUDIO_PLC_CONFIG_DEFAULT();
+            plc_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+            err = audio_plc_create(&plc_cfg, &ctx->plc);
+        }
+        if (err != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGI(TAG, "Jitter buffer: start %lu ms, up to %lu ms, time stretch %lu%%, concealment %lu ms",
+             (unsigned long)jb_cfg.start_ms, (unsigned long)jb_cfg.max_ms, (unsigned long)cfg->stretch_pct,
+             (unsigned long)cfg->conceal_ms);
+    return ESP_OK;
+}
+
+// Dynamics on the speaker mix; settings it rejects fall back to the defaults
+static esp_err_t setup_speaker(openai_rt_context_t* ctx, const speaker_config_t* cfg) {
+    audio_dynamics_config_t dyn_cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    dyn_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+    dyn_cfg.volume_pct = cfg->volume_pct;
+    dyn_cfg.ceiling_db = cfg->ceiling_db;
+    dyn_cfg.lookahead_ms = cfg->lookahead_ms;
+    dyn_cfg.threshold_db = cfg->threshold_db;
+    dyn_cfg.ratio = cfg->ratio;
+    dyn_cfg.attack_ms = cfg->attack_ms;
+    dyn_cfg.release_ms = cfg->release_ms;
+    dyn_cfg.makeup_db = cfg->makeup_db;
+    if (audio_dynamics_create(&dyn_cfg, &ctx->dynamics) != ESP_OK) {
+        ESP_LOGW(TAG, "Invalid speaker settings, using defaults");
+        dyn_cfg = (audio_dynamics_config_t)AUDIO_DYNAMICS_CONFIG_DEFAULT();
+        dyn_cfg.sample_rate = DEVICE_SAMPLE_RATE;
+        if (audio_dynamics_create(&dyn_cfg, &ctx->dynamics) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGI(TAG, "Speaker: volume %lu%%, compressor %lu:1 above %ld dBFS +%ld dB, limiter %ld dBFS",
+             (unsigned long)dyn_cfg.volume_pct, (unsigned long)dyn_cfg.ratio, (long)dyn_cfg.threshold_db,
+             (long)dyn_cfg.makeup_db, (long)dyn_cfg.ceiling_db);
+    return ESP_OK;
+}
+
+// The spotter listens during pre-roll; without a usable model the button
+// stays the only way to start a conversation
+static void setup_wake_word(openai_rt_context_t* ctx, const app_config_t* app_cfg) {
+    const wake_word_config_t* cfg = &app_cfg->wake_word;
+    if (!cfg->enabled) {
         return;
     }
-    
-    // Initialize OpenAI RT SDK
-    openai_rt_callbacks_t callbacks = {
-        .audio_data_cb = audio_data_callback,
-        .conversation_end_cb = conversation_end_callback,
-        .user_data = &s_context
-    };
-    
-    openai_rt_config_t cfg = {
-        .api_key = app_cfg->openai.api_key,
-        .voice = app_cfg->openai.voice[0] ? app_cfg->openai.voice : "alloy",
-    };
-    
-    s_context.sdk_handle = openai_rt_init(&cfg);
-    if (!s_context.sdk_handle) {
-        ESP_LOGE(TAG, "SDK init failed");
-        cleanup_resources(&s_context);
-        s_task = NULL;
-        vTaskDelete(NULL);
+    if (app_cfg->mic.preroll_ms == 0) {
+        ESP_LOGW(TAG, "Wake word needs pre-roll capture (mic: preroll_ms), disabled");
         return;
     }
-    
-    // Set callbacks for the SDK
-    if (openai_rt_set_callbacks(s_context.sdk_handle, &callbacks) != 0) {
-        ESP_LOGE(TAG, "Failed to set callbacks");
-        openai_rt_deinit(s_context.sdk_handle);
-        cleanup_resources(&s_context);
-        s_task = NULL;
-        vTaskDelete(NULL);
+
+    FILE* f = fopen(cfg->model, "rb");
+    if (!f) {
+        ESP_LOGW(TAG, "Wake word model %s not found", cfg->model);
         return;
     }
-    
-    // Initialize audio output component
-    esp_err_t audio_err = audio_output_init(16000, 16, 1); // 16kHz, 16-bit, mono
-    if (audio_err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize audio output: %d", audio_err);
-        openai_rt_deinit(s_context.sdk_handle);
-        cleanup_resources(&s_context);
-        s_task = NULL;
-        vTaskDelete(NULL);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    ctx->kws_model = size > 0 ? malloc(size) : NULL;
+    bool loaded = ctx->kws_model && fread(ctx->kws_model, 1, size, f) == (size_t)size;
+    fclose(f);
+
+    mic_kws_config_t kws_cfg = {
+        .threshold_pct = cfg->threshold_pct > 100 ? 100 : (cfg->threshold_pct < 1 ? 1 : cfg->threshold_pct),
+        .refractory_ms = cfg->refractory_ms > UINT16_MAX ? UINT16_MAX : cfg->refractory_ms,
+    };
+    if (!loaded || mic_kws_create(ctx->kws_model, size, &kws_cfg, &ctx->kws) != ESP_OK) {
+        ESP_LOGW(TAG, "Wake word model %s unusable", cfg->model);
+        free(ctx->kws_model);
+        ctx->kws_model = NULL;
         return;
     }
+    mic_input_set_kws(ctx->kws, wake_word_callback, ctx);
+    ESP_LOGI(TAG, "Wake word enabled (threshold %u%%)", kws_cfg.threshold_pct);
+}
+
+// Tears down whatever audio_pipeline_init set up; only needed when it fails,
+// the pipeline otherwise stays resident
+static void audio_pipeline_deinit(openai_rt_context_t* ctx) {
+    if (ctx->mic_initialized) {
+        // Detach what mic_input borrows before it is freed below
+        mic_input_set_aec(NULL);
+        mic_input_set_kws(NULL, NULL, NULL);
+        mic_input_deinit();
+        ctx->mic_initialized = false;
+    }
+    mic_kws_destroy(ctx->kws);
+    free(ctx->kws_model);
+    ctx->kws = NULL;
+    ctx->kws_model = NULL;
+    audio_output_deinit();
+
+    // The canceller is detached from both ends once mic and speaker are down
+    if (ctx->aec) {
+        audio_output_set_tap(NULL, NULL);
+        audio_aec_destroy(ctx->aec);
+        ctx->aec = NULL;
+    }
+
+    audio_resample_destroy(ctx->uplink_rs);
+    audio_resample_destroy(ctx->downlink_rs);
+    free(ctx->uplink_buf);
+    free(ctx->uplink_wire);
+    free(ctx->downlink_pcm);
+    free(ctx->downlink_buf);
+    ctx->uplink_rs = NULL;
+    ctx->downlink_rs = NULL;
+    ctx->uplink_buf = NULL;
+    ctx->uplink_wire = NULL;
+    ctx->downlink_pcm = NULL;
+    openai_rt_uplink_destroy(ctx->uplink);
+    ctx->uplink = NULL;
+    if (ctx->uplink_lock) {
+        vSemaphoreDelete(ctx->uplink_lock);
+        ctx->uplink_lock = NULL;
+    }
+    ctx->downlink_buf = NULL;
+    audio_jitter_destroy(ctx->jitter);
+    ctx->jitter = NULL;
+    audio_mixer_destroy(ctx->mixer);
+    ctx->mixer = NULL;
+    audio_wsola_destroy(ctx->wsola);
+    ctx->wsola = NULL;
+    audio_plc_destroy(ctx->plc);
+    ctx->plc = NULL;
+    audio_dynamics_t* dynamics = ctx->dynamics;
+    ctx->dynamics = NULL;
+    audio_dynamics_destroy(dynamics);
+    if (ctx->downlink_ring) {
+        audio_ring_delete(ctx->downlink_ring);
+        ctx->downlink_ring = NULL;
+    }
+    s_audio_ready = false;
+}
+
+// Installs both I2S drivers (left in standby), the processing stages and the
+// codec path once; conversations then only start and stop DMA
+static esp_err_t audio_pipeline_init(openai_rt_context_t* ctx, const app_config_t* app_cfg) {
+    int64_t start_us = esp_timer_get_time();
+
+    esp_err_t err = setup_audio_path(ctx, &app_cfg->codec);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up audio codecs");
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+
+    err = setup_uplink(ctx, &app_cfg->uplink);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up the uplink framer");
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+
+    err = setup_jitter_buffer(ctx, &app_cfg->jitter_buffer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up the jitter buffer");
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+
+    err = setup_speaker(ctx, &app_cfg->speaker);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up speaker dynamics");
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+
+    // Initialize audio output component
+    err = audio_output_init(DEVICE_SAMPLE_RATE, 16, 1); // 16-bit, mono
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize audio output: %d", err);
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+    audio_output_set_standby(true);
     
     // Initialize microphone input component
-    esp_err_t mic_err = mic_input_init(16000, 16); // 16kHz, 16-bit
-    if (mic_err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize microphone input: %d", mic_err);
-        audio_output_deinit();
-        openai_rt_deinit(s_context.sdk_handle);
-        cleanup_resources(&s_context);
-        s_task = NULL;
-        vTaskDelete(NULL);
-        return;
+    err = mic_input_init(DEVICE_SAMPLE_RATE, 16); // 16-bit
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize microphone input: %d", err);
+        audio_pipeline_deinit(ctx);
+        return err;
+    }
+    ctx->mic_initialized = true;
+
+    // Only forward speech to the SDK; silence costs airtime and API usage
+    mic_vad_config_t vad_cfg = {
+        .enabled = app_cfg->vad.enabled,
+        .threshold_db = app_cfg->vad.threshold_db,
+        .margin_db = app_cfg->vad.margin_db,
+        .zcr_max = app_cfg->vad.zcr_max,
+        .hangover_ms = app_cfg->vad.hangover_ms,
+    };
+    mic_input_set_vad(&vad_cfg);
+
+    mic_ns_config_t ns_cfg = {
+        .enabled = app_cfg->noise_suppression.enabled,
+        .max_attenuation_db = app_cfg->noise_suppression.max_attenuation_db,
+    };
+    mic_input_set_ns(&ns_cfg);
+
+    // Talking over the response cuts it; the VAD decides what is talking
+    if (app_cfg->barge_in.enabled && app_cfg->vad.enabled) {
+        ctx->barge_in_discard_ms = app_cfg->barge_in.discard_ms;
+        mic_input_set_speech_cb(speech_onset_callback, ctx);
+    } else if (app_cfg->barge_in.enabled) {
+        ESP_LOGW(TAG, "Barge-in needs the VAD (vad: enabled), disabled");
+    }
+
+    // Cancel the assistant's own voice from the uplink so it does not hear
+    // (and interrupt) itself; conversation still works without it
+    audio_aec_config_t aec_cfg = AUDIO_AEC_CONFIG_DEFAULT();
+    if (audio_aec_create(&aec_cfg, &ctx->aec) == ESP_OK) {
+        audio_output_set_tap(playback_tap_callback, ctx);
+        mic_input_set_aec(ctx->aec);
+    } else {
+        ESP_LOGW(TAG, "Echo cancellation unavailable");
+    }
+
+    setup_wake_word(ctx, app_cfg);
+
+    s_audio_ready = true;
+    ESP_LOGI(TAG, "Audio pipeline ready in standby (%lld ms)", (esp_timer_get_time() - start_us) / 1000);
+    return ESP_OK;
+}
+
+// Between conversations the microphone keeps the last moments of audio so
+// speech that starts with the button press is not lost; the wake-word
+// spotter, if any, listens on the same capture
+static void audio_pipeline_idle(const app_config_t* app_cfg) {
+    if (app_cfg->mic.preroll_ms > 0 && mic_input_start_preroll(app_cfg->mic.preroll_ms) != ESP_OK) {
+        ESP_LOGW(TAG, "Pre-roll capture unavailable");
+    }
+}
+
+// Streams restart from silence; leftovers of the last conversation would
+// otherwise ring into the filters
+static void audio_pipeline_reset(openai_rt_context_t* ctx) {
+    if (ctx->uplink_rs) {
+        audio_resample_reset(ctx->uplink_rs);
+    }
+    if (ctx->downlink_rs) {
+        audio_resample_reset(ctx->downlink_rs);
+    }
+    audio_codec_reset(&ctx->uplink_codec);
+    audio_codec_reset(&ctx->downlink_codec);
+}
+
+// Runs on the session task; matters only while a conversation waits for it
+static void session_ready_callback(void* user_data) {
+    conv_post(CONV_EV_SESSION_READY);
+}
+
+// The session manager connects with the wire formats the pipeline chose,
+// so it starts once the pipeline is up
+static esp_err_t session_start(openai_rt_context_t* ctx, const app_config_t* app_cfg) {
+    if (s_session_ready) {
+        return ESP_OK;
+    }
+    openai_rt_session_config_t cfg = {
+        .sdk = {
+            .api_key = app_cfg->openai.api_key,
+            .voice = app_cfg->openai.voice[0] ? app_cfg->openai.voice : "alloy",
+            .input_audio_format = audio_codec_name(ctx->uplink_codec.type),
+            .output_audio_format = audio_codec_name(ctx->downlink_codec.type),
+        },
+        .preconnect = app_cfg->session.preconnect,
+        .keepalive_ms = (app_cfg->session.keepalive_s > 0 ? app_cfg->session.keepalive_s : 20) * 1000,
+        .max_age_ms = (app_cfg->session.max_age_s > 0 ? app_cfg->session.max_age_s : 1500) * 1000,
+        .retry_ms = SESSION_RETRY_MS,
+        .ready_cb = session_ready_callback,
+    };
+    esp_err_t err = openai_rt_session_init(&cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Session manager failed to start: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_session_ready = true;
+    return ESP_OK;
+}
+
+// Logs how long this press waited for the session, with the running figures
+static void log_press_to_ready(bool open) {
+    int64_t wait_us = esp_timer_get_time() - s_context.press_us;
+    uint32_t ms = (uint32_t)(wait_us / 1000);
+    latency_trace_record(LATENCY_SPAN_PRESS_READY, wait_us);
+    s_presses++;
+    s_presses_open += open;
+    s_press_ready_ms_total += ms;
+    s_press_ready_ms_max = ms > s_press_ready_ms_max ? ms : s_press_ready_ms_max;
+    ESP_LOGI(TAG, "Session ready %lu ms after the press (%s); %lu ms avg, %lu ms max, %lu of %lu presses pre-connected",
+             (unsigned long)ms, open ? "pre-connected" : "connected on demand",
+             (unsigned long)(s_press_ready_ms_total / s_presses), (unsigned long)s_press_ready_ms_max,
+             (unsigned long)s_presses_open, (unsigned long)s_presses);
+}
+
+static const openai_rt_callbacks_t s_sdk_callbacks = {
+    .audio_data_cb = audio_data_callback,
+    .conversation_end_cb = conversation_end_callback,
+    .user_data = &s_context,
+};
+
+// Each state shows on the LED and the avatar
+static const struct {
+    led_mode_t led;
+    avatar_expression_t face;
+} s_state_ui[CONV_STATE_COUNT] = {
+    [CONV_IDLE] = { LED_MODE_BREATH, AVATAR_EXPRESSION_IDLE },
+    [CONV_CONNECTING] = { LED_MODE_BLINK, AVATAR_EXPRESSION_THINKING },
+    [CONV_LISTENING] = { LED_MODE_RAINBOW, AVATAR_EXPRESSION_IDLE },
+    [CONV_THINKING] = { LED_MODE_RAINBOW, AVATAR_EXPRESSION_THINKING },
+    [CONV_SPEAKING] = { LED_MODE_RAINBOW, AVATAR_EXPRESSION_SPEAKING },
+    [CONV_STOPPING] = { LED_MODE_BREATH, AVATAR_EXPRESSION_IDLE },
+};
+
+// Takes the session if it is open; otherwise asks for one and waits for
+// SESSION_READY, or CONNECT_TIMEOUT
+static conv_event_t act_connect(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us) {
+    const app_config_t* app_cfg = config_mgr_get();
+    ctx->press_us = at_us;
+    ctx->first_uplink_logged = false;
+    // A turn the last conversation left unanswered must not end in this one
+    latency_trace_reset();
+
+    // Without openai_rt_warm_up the first press pays for driver setup
+    ctx->cold_start = !s_audio_ready;
+    if (!s_audio_ready && audio_pipeline_init(ctx, app_cfg) != ESP_OK) {
+        return CONV_EV_FAILED;
+    }
+    audio_pipeline_reset(ctx);
+    if (session_start(ctx, app_cfg) != ESP_OK) {
+        return CONV_EV_FAILED;
+    }
+
+    bool open = false;
+    ctx->sdk_handle = openai_rt_session_acquire(&s_sdk_callbacks, 0, &open);
+    if (ctx->sdk_handle) {
+        log_press_to_ready(open);
+        return CONV_EV_SESSION_READY;
+    }
+    esp_timer_start_once(ctx->connect_timer, SESSION_ACQUIRE_TIMEOUT_MS * 1000);
+    return CONV_EV_NONE;
+}
+
+// Playback, the SDK conversation and capture, in that order so the first
+// response chunk and the first mic frame both have somewhere to go
+static conv_event_t act_open(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us) {
+    if (!ctx->sdk_handle) {
+        esp_timer_stop(ctx->connect_timer);
+        ctx->sdk_handle = openai_rt_session_acquire(&s_sdk_callbacks, 0, NULL);
+        if (!ctx->sdk_handle) {
+            return CONV_EV_FAILED;
+        }
+        log_press_to_ready(false);
     }
-    s_context.mic_initialized = true;
-    
-    // Update UI to show we're in conversation mode
-    led_ctrl_set_mode(LED_MODE_RAINBOW);
-    avatar_set_expression(AVATAR_EXPRESSION_SPEAKING);
     sleep_mgr_reset_timer(); // cancel sleep while talking
-    
-    // Start conversation and timer
-    s_context.is_active = true;
-    if (openai_rt_start(s_context.sdk_handle) != 0) {
+
+    audio_output_set_standby(false);
+    ctx->output_on = true;
+    if (playout_start(ctx) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the playout task");
+        return CONV_EV_FAILED;
+    }
+    if (openai_rt_start(ctx->sdk_handle) != 0) {
         ESP_LOGE(TAG, "Failed to start conversation");
-        openai_rt_deinit(s_context.sdk_handle);
-        cleanup_resources(&s_context);
-        led_ctrl_set_mode(LED_MODE_BREATH);
-        avatar_set_expression(AVATAR_EXPRESSION_IDLE);
-        s_task = NULL;
-        vTaskDelete(NULL);
-        return;
+        return CONV_EV_FAILED;
     }
-    
-    // Start microphone input
-    esp_err_t start_err = mic_input_start(mic_data_callback, 1024, &s_context);
-    if (start_err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start microphone input: %d", start_err);
-        openai_rt_stop(s_context.sdk_handle);
-        openai_rt_deinit(s_context.sdk_handle);
-        cleanup_resources(&s_context);
-        led_ctrl_set_mode(LED_MODE_BREATH);
-        avatar_set_expression(AVATAR_EXPRESSION_IDLE);
-        s_task = NULL;
-        vTaskDelete(NULL);
-        return;
+    ctx->is_active = true;
+
+    // The mic consumer is not running yet, nor the speech timer
+    openai_rt_uplink_reset(ctx->uplink);
+    openai_rt_uplink_reset_stats(ctx->uplink);
+    esp_err_t err = mic_input_start(mic_data_callback, MIC_FRAME_BYTES, ctx);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start microphone input: %d", err);
+        return CONV_EV_FAILED;
     }
-    
-    ESP_LOGI(TAG, "Conversation and microphone started successfully");
-    
-    // Start timeout timer
-    esp_timer_start_once(s_context.timeout_timer, MAX_CONVERSATION_TIME_MS * 1000);
-    
-    // Wait for conversation to end or timeout
-    EventBits_t bits = xEventGroupWaitBits(
-        s_context.event_group,
-        OPENAI_RT_EVENT_STOP_REQUEST | OPENAI_RT_EVENT_CONVERSATION_END,
-        pdTRUE,  // Clear bits on exit
-        pdFALSE, // Wait for any bit
-        portMAX_DELAY);
-    
-    // Stop conversation
-    if (s_context.is_active) {
-        openai_rt_stop(s_context.sdk_handle);
+    ctx->mic_started = true;
+
+    ESP_LOGI(TAG, "Conversation and microphone started %lld ms after the press (%s pipeline)",
+             (esp_timer_get_time() - ctx->press_us) / 1000, ctx->cold_start ? "cold" : "warm");
+    play_click(ctx);
+    esp_timer_start_once(ctx->timeout_timer, MAX_CONVERSATION_TIME_MS * 1000);
+    return CONV_EV_NONE;
+}
+
+// The one way out of a conversation, from wherever it got to
+static conv_event_t act_teardown(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us) {
+    const app_config_t* app_cfg = config_mgr_get();
+    esp_timer_stop(ctx->connect_timer);
+    esp_timer_stop(ctx->timeout_timer);
+
+    if (ctx->is_active) {
+        openai_rt_stop(ctx->sdk_handle);
     }
-    
-    // Stop microphone input
-    if (s_context.mic_initialized) {
+    // Pre-roll takes over once playback is done
+    if (ctx->mic_started) {
         ESP_LOGI(TAG, "Stopping microphone input");
         mic_input_stop();
+        ctx->mic_started = false;
     }
-    
-    // Wait for any remaining audio to finish playing (with a timeout)
-    if (audio_output_is_busy()) {
-        ESP_LOGI(TAG, "Waiting for audio playback to complete...");
-        audio_output_wait_completion(2000); // 2 second timeout
+    esp_timer_stop(ctx->speech_timer);
+    if (ctx->uplink) {
+        openai_rt_uplink_stats_t up;
+        openai_rt_uplink_get_stats(ctx->uplink, &up);
+        if (up.frames > 0) {
+            ESP_LOGI(TAG, "Uplink: %lu events (%lu flushed short, %lu failed), %lu bytes of audio; "
+                     "encoding took up to %lu us per mic frame",
+                     (unsigned long)up.frames, (unsigned long)up.partial, (unsigned long)up.failed,
+                     (unsigned long)up.bytes, (unsigned long)up.encode_us_max);
+        }
     }
-    
-    // Cleanup audio output
-    audio_output_deinit();
-    
-    // Cleanup SDK resources
-    openai_rt_deinit(s_context.sdk_handle);
-    
-    // Cleanup other resources
-    cleanup_resources(&s_context);
-    
-    // Return to idle state
-    led_ctrl_set_mode(LED_MODE_BREATH);
-    avatar_set_expression(AVATAR_EXPRESSION_IDLE);
+
+    // Let buffered response audio play out, then wait for the driver
+    if (ctx->playout_task) {
+        playout_stop(ctx, event == CONV_EV_FAILED ? 0 : PLAYOUT_DRAIN_TIMEOUT_MS);
+        if (audio_output_is_busy()) {
+            ESP_LOGI(TAG, "Waiting for audio playback to complete...");
+            audio_output_wait_completion(2000); // 2 second timeout
+        }
+    }
+    // Park audio output; the drivers stay installed for the next press
+    if (ctx->output_on) {
+        audio_output_set_standby(true);
+        ctx->output_on = false;
+    }
+    if (s_audio_ready) {
+        audio_pipeline_idle(app_cfg);
+    }
+
+    // Keep the session for the next press unless the service ended it or
+    // it failed; an acquire still waiting is withdrawn
+    openai_rt_session_release(ctx->sdk_handle && event != CONV_EV_SESSION_END && event != CONV_EV_FAILED);
+    if (ctx->is_active) {
+        media_clock_drift_t drift;
+        media_clock_get_drift(&drift);
+        if (drift.valid) {
+            ESP_LOGI(TAG, "I2S clocks: capture %.2f Hz, playback %.2f Hz, drift %.1f ppm",
+                     drift.capture_rate_hz, drift.playback_rate_hz, drift.drift_ppm);
+        }
+    }
+    ctx->sdk_handle = NULL;
+    ctx->is_active = false;
     sleep_mgr_reset_timer();
-    
-    ESP_LOGI(TAG, "Conversation finished%s", 
-             (bits & OPENAI_RT_EVENT_STOP_REQUEST) ? " (timeout)" : "");
-    
-    s_task = NULL;
-    vTaskDelete(NULL);
+
+    ESP_LOGI(TAG, "Conversation finished (%s)", conv_fsm_event_name(event));
+    latency_trace_dump(LATENCY_SCOPE_RECENT);
+    latency_trace_dump(LATENCY_SCOPE_BOOT);
+    return CONV_EV_STOPPED;
+}
+
+// The end of the hangover still waits in the framer; it goes out now
+// rather than with the next utterance. The device's VAD owns the turn:
+// the service only sees the hangover's silence, too short for its own
+// turn detection, so the turn is committed here
+static conv_event_t act_end_turn(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us) {
+    if (ctx->uplink) {
+        xSemaphoreTake(ctx->uplink_lock, portMAX_DELAY);
+        openai_rt_uplink_flush(ctx->uplink);
+        xSemaphoreGive(ctx->uplink_lock);
+    }
+    if (ctx->sdk_handle && openai_rt_commit_input(ctx->sdk_handle) != 0) {
+        ESP_LOGW(TAG, "Failed to commit the user's turn");
+    }
+    return CONV_EV_NONE;
+}
+
+// Barge-in, upstream half: the speaker is already silent
+static conv_event_t act_cancel(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us) {
+    if (ctx->sdk_handle && openai_rt_cancel_response(ctx->sdk_handle) != 0) {
+        ESP_LOGW(TAG, "Failed to cancel the response");
+    }
+    return CONV_EV_NONE;
+}
+
+typedef conv_event_t (*conv_action_fn_t)(openai_rt_context_t* ctx, conv_event_t event, int64_t at_us);
+
+static const conv_action_fn_t s_actions[CONV_ACT_COUNT] = {
+    [CONV_ACT_NONE] = NULL,
+    [CONV_ACT_CONNECT] = act_connect,
+    [CONV_ACT_OPEN] = act_open,
+    [CONV_ACT_TEARDOWN] = act_teardown,
+    [CONV_ACT_CANCEL] = act_cancel,
+    [CONV_ACT_END_TURN] = act_end_turn,
+};
+
+// Runs an event and the follow-ups its actions return through the table
+static void conv_dispatch(conv_event_t event, int64_t at_us) {
+    while (event != CONV_EV_NONE) {
+        conv_state_t from = s_fsm.state;
+        int64_t since_us = s_fsm.entered_us[from];
+        const conv_transition_t* t = conv_fsm_handle(&s_fsm, event, at_us);
+        if (!t) {
+            ESP_LOGD(TAG, "%s ignored in %s", conv_fsm_event_name(event), conv_fsm_state_name(from));
+            return;
+        }
+        ESP_LOGI(TAG, "%s -> %s on %s after %lld ms", conv_fsm_state_name(from), conv_fsm_state_name(t->next),
+                 conv_fsm_event_name(event), (at_us - since_us) / 1000);
+        if (from == CONV_THINKING && t->next == CONV_SPEAKING) {
+            ESP_LOGI(TAG, "Turn: response audible %lld ms after the end of speech", (at_us - since_us) / 1000);
+        }
+        led_ctrl_set_mode(s_state_ui[t->next].led);
+        avatar_set_expression(s_state_ui[t->next].face);
+
+        conv_action_fn_t action = s_actions[t->action];
+        event = action ? action(&s_context, event, at_us) : CONV_EV_NONE;
+        at_us = esp_timer_get_time();
+    }
+}
+
+// Posted from callbacks on other tasks and timers; never blocks
+static void conv_post(conv_event_t event) {
+    conv_msg_t msg = { .event = event, .at_us = esp_timer_get_time() };
+    if (s_conv_queue && xQueueSend(s_conv_queue, &msg, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Conversation queue full, %s dropped", conv_fsm_event_name(event));
+    }
+}
+
+// Lives as long as the device: every conversation is a walk through the
+// state machine, fed by the queue
+static void conversation_task(void* pv) {
+    conv_msg_t msg;
+    while (true) {
+        if (xQueueReceive(s_conv_queue, &msg, portMAX_DELAY) == pdTRUE) {
+            conv_dispatch(msg.event, msg.at_us);
+        }
+    }
+}
+
+// The state machine, its queue, timers and task, created once
+static esp_err_t conv_init(void) {
+    if (s_conv_task) {
+        return ESP_OK;
+    }
+    conv_fsm_init(&s_fsm, esp_timer_get_time());
+    s_context.event_group = xEventGroupCreate();
+    s_conv_queue = xQueueCreate(CONV_QUEUE_LEN, sizeof(conv_msg_t));
+    esp_timer_create_args_t connect_args = {
+        .callback = connect_timeout_callback,
+        .arg = &s_context,
+        .name = "openai_connect",
+    };
+    esp_timer_create_args_t timeout_args = {
+        .callback = timeout_callback,
+        .arg = &s_context,
+        .name = "openai_timeout",
+    };
+    esp_timer_create_args_t speech_args = {
+        .callback = speech_end_callback,
+        .arg = &s_context,
+        .name = "openai_speech",
+    };
+    if (!s_context.event_group || !s_conv_queue ||
+        esp_timer_create(&connect_args, &s_context.connect_timer) != ESP_OK ||
+        esp_timer_create(&timeout_args, &s_context.timeout_timer) != ESP_OK ||
+        esp_timer_create(&speech_args, &s_context.speech_timer) != ESP_OK ||
+        xTaskCreate(conversation_task, "openai_rt_conv", 8192, NULL, 5, &s_conv_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the conversation task");
+        if (s_context.connect_timer) {
+            esp_timer_delete(s_context.connect_timer);
+            s_context.connect_timer = NULL;
+        }
+        if (s_context.timeout_timer) {
+            esp_timer_delete(s_context.timeout_timer);
+            s_context.timeout_timer = NULL;
+        }
+        if (s_context.speech_timer) {
+            esp_timer_delete(s_context.speech_timer);
+            s_context.speech_timer = NULL;
+        }
+        if (s_conv_queue) {
+            vQueueDelete(s_conv_queue);
+            s_conv_queue = NULL;
+        }
+        if (s_context.event_group) {
+            vEventGroupDelete(s_context.event_group);
+            s_context.event_group = NULL;
+        }
+        s_conv_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t openai_rt_warm_up(void) {
+    if (s_fsm.state != CONV_IDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = conv_init();
+    if (err != ESP_OK || s_audio_ready) {
+        return err;
+    }
+    err = audio_pipeline_init(&s_context, config_mgr_get());
+    if (err == ESP_OK) {
+        audio_pipeline_idle(config_mgr_get());
+    }
+    return err;
+}
+
+esp_err_t openai_rt_preconnect(void) {
+    const app_config_t* app_cfg = config_mgr_get();
+    if (!app_cfg->session.preconnect) {
+        return ESP_OK;
+    }
+    if (!s_audio_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return session_start(&s_context, app_cfg);
+}
+
+esp_err_t openai_rt_set_volume(uint32_t volume_pct) {
+    if (!s_audio_ready || !s_context.dynamics) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    audio_dynamics_set_volume(s_context.dynamics, volume_pct);
+    return ESP_OK;
 }
 
 void openai_rt_start_conversation(void) {
-    if (s_task) {
+    if (conv_init() != ESP_OK) {
+        return;
+    }
+    if (s_fsm.state != CONV_IDLE) {
         ESP_LOGW(TAG, "Conversation already running");
         return;
     }
-    xTaskCreate(conversation_task, "openai_rt_conv", 8192, NULL, 5, &s_task);
+    conv_post(CONV_EV_START);
 }
 
 void openai_rt_stop_conversation(void) {
-    if (!s_task || !s_context.event_group) {
+    if (!s_conv_task || s_fsm.state == CONV_IDLE) {
         ESP_LOGW(TAG, "No active conversation to stop");
         return;
     }
-    
-    // Signal the conversation task to stop
-    xEventGroupSetBits(s_context.event_group, OPENAI_RT_EVENT_STOP_REQUEST);
+    conv_post(CONV_EV_STOP);
     ESP_LOGI(TAG, "Requested conversation stop");
 }
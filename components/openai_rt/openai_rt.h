@@ -4,6 +4,49 @@
 extern "C" {
 #endif
 
+#include "esp_err.h"
+
+/**
+ * @brief Install the audio drivers and processing pipeline ahead of time
+ * 
+ * Both I2S drivers, the echo canceller, noise suppressor and codec path are
+ * set up once and left in standby with DMA paused, so a conversation starts
+ * without any driver setup. Without this call the first conversation does
+ * it instead. Call after config_mgr_init.
+ * 
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while a conversation runs, or the
+ *         driver error
+ */
+esp_err_t openai_rt_warm_up(void);
+
+/**
+ * @brief Open the Realtime session in the background ahead of the first press
+ * 
+ * The session is authenticated and configured while the device idles, kept
+ * alive with pings, replaced before the service's session limit, and
+ * reopened after every conversation the service ended, so a press finds it
+ * ready. Does nothing with `session: preconnect: false`; each conversation
+ * then connects on the press and closes the session at its end. Call after
+ * openai_rt_warm_up.
+ * 
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before openai_rt_warm_up, or
+ *         ESP_ERR_NO_MEM
+ */
+esp_err_t openai_rt_preconnect(void);
+
+/**
+ * @brief Set the speaker volume
+ * 
+ * The gain ramps to the new level over about 50 ms, also mid-response.
+ * The `speaker: volume_pct` setting applies again when the audio pipeline
+ * is next set up.
+ * 
+ * @param volume_pct 0 (mute) to 100
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE before openai_rt_warm_up or the
+ *         first conversation
+ */
+esp_err_t openai_rt_set_volume(uint32_t volume_pct);
+
 /**
  * @brief Start a new OpenAI real-time conversation
  * 
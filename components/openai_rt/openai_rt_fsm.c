@@ -0,0 +1,106 @@
+#include "openai_rt_fsm.h"
+#include <stddef.h>
+#include <string.h>
+
+// Any active state ends the same way, and on its own timeout: each timer
+// has its own event, so one that fired just before the state changed
+// finds nothing to end
+#define CONV_ENDS(s, timeout)                                       \
+    { s, CONV_EV_STOP, CONV_STOPPING, CONV_ACT_TEARDOWN },          \
+    { s, timeout, CONV_STOPPING, CONV_ACT_TEARDOWN },               \
+    { s, CONV_EV_SESSION_END, CONV_STOPPING, CONV_ACT_TEARDOWN },   \
+    { s, CONV_EV_FAILED, CONV_STOPPING, CONV_ACT_TEARDOWN }
+
+static const conv_transition_t s_table[] = {
+    { CONV_IDLE, CONV_EV_START, CONV_CONNECTING, CONV_ACT_CONNECT },
+
+    { CONV_CONNECTING, CONV_EV_SESSION_READY, CONV_LISTENING, CONV_ACT_OPEN },
+    CONV_ENDS(CONV_CONNECTING, CONV_EV_CONNECT_TIMEOUT),
+
+    { CONV_LISTENING, CONV_EV_SPEECH_END, CONV_THINKING, CONV_ACT_END_TURN },
+    // Without the VAD there is no end of speech to wait for
+    { CONV_LISTENING, CONV_EV_PLAYBACK_START, CONV_SPEAKING, CONV_ACT_NONE },
+    // Playback started and was cut before its PLAYBACK_START got here
+    { CONV_LISTENING, CONV_EV_BARGE_IN, CONV_LISTENING, CONV_ACT_CANCEL },
+    CONV_ENDS(CONV_LISTENING, CONV_EV_TIMEOUT),
+
+    { CONV_THINKING, CONV_EV_PLAYBACK_START, CONV_SPEAKING, CONV_ACT_NONE },
+    { CONV_THINKING, CONV_EV_SPEECH_START, CONV_LISTENING, CONV_ACT_NONE },
+    { CONV_THINKING, CONV_EV_BARGE_IN, CONV_LISTENING, CONV_ACT_CANCEL },
+    CONV_ENDS(CONV_THINKING, CONV_EV_TIMEOUT),
+
+    { CONV_SPEAKING, CONV_EV_PLAYBACK_DONE, CONV_LISTENING, CONV_ACT_NONE },
+    { CONV_SPEAKING, CONV_EV_SPEECH_START, CONV_LISTENING, CONV_ACT_NONE },
+    // The speaker was already silenced where the VAD fired; what is left
+    // is telling the service
+    { CONV_SPEAKING, CONV_EV_BARGE_IN, CONV_LISTENING, CONV_ACT_CANCEL },
+    CONV_ENDS(CONV_SPEAKING, CONV_EV_TIMEOUT),
+
+    { CONV_STOPPING, CONV_EV_STOPPED, CONV_IDLE, CONV_ACT_NONE },
+};
+
+static const char* const s_state_names[CONV_STATE_COUNT] = {
+    [CONV_IDLE] = "IDLE",
+    [CONV_CONNECTING] = "CONNECTING",
+    [CONV_LISTENING] = "LISTENING",
+    [CONV_THINKING] = "THINKING",
+    [CONV_SPEAKING] = "SPEAKING",
+    [CONV_STOPPING] = "STOPPING",
+};
+
+static const char* const s_event_names[CONV_EV_COUNT] = {
+    [CONV_EV_NONE] = "NONE",
+    [CONV_EV_START] = "START",
+    [CONV_EV_STOP] = "STOP",
+    [CONV_EV_CONNECT_TIMEOUT] = "CONNECT_TIMEOUT",
+    [CONV_EV_TIMEOUT] = "TIMEOUT",
+    [CONV_EV_SESSION_READY] = "SESSION_READY",
+    [CONV_EV_SESSION_END] = "SESSION_END",
+    [CONV_EV_SPEECH_START] = "SPEECH_START",
+    [CONV_EV_BARGE_IN] = "BARGE_IN",
+    [CONV_EV_SPEECH_END] = "SPEECH_END",
+    [CONV_EV_PLAYBACK_START] = "PLAYBACK_START",
+    [CONV_EV_PLAYBACK_DONE] = "PLAYBACK_DONE",
+    [CONV_EV_FAILED] = "FAILED",
+    [CONV_EV_STOPPED] = "STOPPED",
+};
+
+void conv_fsm_init(conv_fsm_t* fsm, int64_t now_us) {
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->state = CONV_IDLE;
+    fsm->entered_us[CONV_IDLE] = now_us;
+}
+
+const conv_transition_t* conv_fsm_handle(conv_fsm_t* fsm, conv_event_t event, int64_t at_us) {
+    for (size_t i = 0; i < sizeof(s_table) / sizeof(s_table[0]); i++) {
+        const conv_transition_t* t = &s_table[i];
+        if (t->state != fsm->state || t->event != event) {
+            continue;
+        }
+        conv_fsm_record_t* rec = &fsm->history[fsm->transitions % CONV_FSM_HISTORY];
+        rec->from = fsm->state;
+        rec->to = t->next;
+        rec->event = event;
+        rec->at_us = at_us;
+        fsm->transitions++;
+        fsm->state = t->next;
+        fsm->entered_us[t->next] = at_us;
+        return t;
+    }
+    return NULL;
+}
+
+const conv_fsm_record_t* conv_fsm_recent(const conv_fsm_t* fsm, uint32_t back) {
+    if (back >= fsm->transitions || back >= CONV_FSM_HISTORY) {
+        return NULL;
+    }
+    return &fsm->history[(fsm->transitions - 1 - back) % CONV_FSM_HISTORY];
+}
+
+const char* conv_fsm_state_name(conv_state_t state) {
+    return state < CONV_STATE_COUNT ? s_state_names[state] : "?";
+}
+
+const char* conv_fsm_event_name(conv_event_t event) {
+    return event < CONV_EV_COUNT ? s_event_names[event] : "?";
+}
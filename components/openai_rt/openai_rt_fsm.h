@@ -0,0 +1,113 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Conversation state machine
+ *
+ * A transition table maps (state, event) to the next state and the action
+ * its owner runs on the way; pairs missing from the table leave the state
+ * as it is. The machine only keeps the state and its timing:
+ * conv_fsm_handle looks the transition up, moves to the next state and
+ * stamps it, and returns the entry for the owner to act on. An action can
+ * answer with a follow-up event (CONV_EV_FAILED, say), which the owner
+ * feeds straight back in.
+ *
+ * Not thread-safe: one task feeds every event.
+ */
+
+typedef enum {
+    CONV_IDLE,
+    CONV_CONNECTING,        ///< waiting for the session
+    CONV_LISTENING,         ///< capture running, the user may speak
+    CONV_THINKING,          ///< the user stopped speaking, no response audible yet
+    CONV_SPEAKING,          ///< response audio playing
+    CONV_STOPPING,          ///< tearing down
+    CONV_STATE_COUNT,
+} conv_state_t;
+
+typedef enum {
+    CONV_EV_NONE,           ///< no follow-up; never posted
+    CONV_EV_START,          ///< button press, wake word or API
+    CONV_EV_STOP,           ///< long press or API
+    CONV_EV_CONNECT_TIMEOUT, ///< the session did not open in time
+    CONV_EV_TIMEOUT,        ///< the conversation ran too long
+    CONV_EV_SESSION_READY,
+    CONV_EV_SESSION_END,    ///< the service ended the conversation
+    CONV_EV_SPEECH_START,   ///< the VAD opened
+    CONV_EV_BARGE_IN,       ///< the VAD opened over response audio, already silenced
+    CONV_EV_SPEECH_END,     ///< uplink went quiet after speech
+    CONV_EV_PLAYBACK_START, ///< response audio started playing
+    CONV_EV_PLAYBACK_DONE,  ///< response audio stopped playing
+    CONV_EV_FAILED,         ///< an action could not complete
+    CONV_EV_STOPPED,        ///< teardown finished
+    CONV_EV_COUNT,
+} conv_event_t;
+
+typedef enum {
+    CONV_ACT_NONE,
+    CONV_ACT_CONNECT,       ///< take the session, or wait for it to open
+    CONV_ACT_OPEN,          ///< start playback, the conversation and capture
+    CONV_ACT_TEARDOWN,      ///< stop whatever was started
+    CONV_ACT_CANCEL,        ///< cancel the response upstream
+    CONV_ACT_END_TURN,      ///< send the partial uplink frame, commit it and ask for a response
+    CONV_ACT_COUNT,
+} conv_action_t;
+
+typedef struct {
+    conv_state_t state;
+    conv_event_t event;
+    conv_state_t next;
+    conv_action_t action;
+} conv_transition_t;
+
+/** Transitions remembered for inspection */
+#define CONV_FSM_HISTORY 16
+
+typedef struct {
+    conv_state_t from;
+    conv_state_t to;
+    conv_event_t event;
+    int64_t at_us;
+} conv_fsm_record_t;
+
+typedef struct {
+    conv_state_t state;
+    int64_t entered_us[CONV_STATE_COUNT];   ///< last entry into each state, 0 if never
+    conv_fsm_record_t history[CONV_FSM_HISTORY];
+    uint32_t transitions;                   ///< since conv_fsm_init
+} conv_fsm_t;
+
+/**
+ * @brief Start in CONV_IDLE with no history
+ */
+void conv_fsm_init(conv_fsm_t* fsm, int64_t now_us);
+
+/**
+ * @brief Apply an event
+ *
+ * @param at_us When the event happened; stamps the transition
+ * @return The transition taken, or NULL if the event does not apply in
+ *         the current state
+ */
+const conv_transition_t* conv_fsm_handle(conv_fsm_t* fsm, conv_event_t event, int64_t at_us);
+
+/**
+ * @brief A recent transition
+ *
+ * @param back 0 for the latest, 1 for the one before, ...
+ * @return The record, or NULL if not that many are remembered
+ */
+const conv_fsm_record_t* conv_fsm_recent(const conv_fsm_t* fsm, uint32_t back);
+
+const char* conv_fsm_state_name(conv_state_t state);
+const char* conv_fsm_event_name(conv_event_t event);
+
+#ifdef __cplusplus
+}
+#endif
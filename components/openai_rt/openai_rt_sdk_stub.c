@@ -5,10 +5,13 @@
 #include "esp_timer.h"
 
 #define TAG "OPENAI_RT_SDK"
+// Simulated TLS handshake, WebSocket upgrade and session.update round trip
+#define STUB_CONNECT_MS 800
 
 // Stub implementation of the OpenAI RT SDK
 typedef struct {
     openai_rt_callbacks_t callbacks;
+    bool is_connected;
     bool is_active;
     TaskHandle_t response_task;
     esp_timer_handle_t response_timer;
@@ -32,6 +35,9 @@ openai_rt_handle_t openai_rt_init(const openai_rt_config_t* config) {
     ESP_LOGI(TAG, "Initializing OpenAI RT SDK (stub)");
     ESP_LOGI(TAG, "API Key: %s...", config->api_key[0] ? "set" : "not set");
     ESP_LOGI(TAG, "Voice: %s", config->voice);
+    ESP_LOGI(TAG, "Audio format: in %s, out %s",
+             config->input_audio_format ? config->input_audio_format : "pcm16",
+             config->output_audio_format ? config->output_audio_format : "pcm16");
     
     openai_rt_sdk_context_t* ctx = calloc(1, sizeof(openai_rt_sdk_context_t));
     if (!ctx) {
@@ -52,10 +58,32 @@ int openai_rt_set_callbacks(openai_rt_handle_t handle, const openai_rt_callbacks
     return 0;
 }
 
+// Open and authenticate the session
+int openai_rt_connect(openai_rt_handle_t handle) {
+    openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
+    if (!ctx) return -1;
+    if (ctx->is_connected) return 0;
+    
+    vTaskDelay(pdMS_TO_TICKS(STUB_CONNECT_MS));
+    ctx->is_connected = true;
+    ESP_LOGI(TAG, "Session connected");
+    return 0;
+}
+
+// Keepalive on an idle session
+int openai_rt_ping(openai_rt_handle_t handle) {
+    openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
+    if (!ctx || !ctx->is_connected) return -1;
+    
+    ESP_LOGD(TAG, "Ping");
+    return 0;
+}
+
 // Start a conversation
 int openai_rt_start(openai_rt_handle_t handle) {
     openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
     if (!ctx) return -1;
+    if (openai_rt_connect(handle) != 0) return -1;
     
     ctx->is_active = true;
     ESP_LOGI(TAG, "Conversation started");
@@ -99,6 +127,47 @@ int openai_rt_send_audio(openai_rt_handle_t handle, const void* audio_data, size
     return 0;
 }
 
+// Send a client event
+int openai_rt_send_event(openai_rt_handle_t handle, const char* json, size_t len) {
+    openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
+    if (!ctx || !ctx->is_active || !json || len == 0) return -1;
+    
+    ESP_LOGD(TAG, "Sending %d byte event", len);
+    
+    // In a real implementation, this would be written to the WebSocket as a text frame
+    
+    return 0;
+}
+
+// Cancel the current response
+int openai_rt_cancel_response(openai_rt_handle_t handle) {
+    openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
+    if (!ctx || !ctx->is_active) return -1;
+    
+    ESP_LOGI(TAG, "Response cancelled");
+    
+    // The stub's next response follows after the usual pause
+    if (ctx->response_timer) {
+        esp_timer_stop(ctx->response_timer);
+        esp_timer_start_once(ctx->response_timer, 1000 * 1000);
+    }
+    
+    return 0;
+}
+
+// Commit the input buffer and request a response
+int openai_rt_commit_input(openai_rt_handle_t handle) {
+    openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
+    if (!ctx || !ctx->is_active) return -1;
+    
+    ESP_LOGI(TAG, "Input committed, response requested");
+    
+    // In a real implementation, this would send input_audio_buffer.commit
+    // and response.create as two text frames
+    
+    return 0;
+}
+
 // Deinitialize the OpenAI RT SDK
 void openai_rt_deinit(openai_rt_handle_t handle) {
     openai_rt_sdk_context_t* ctx = (openai_rt_sdk_context_t*)handle;
@@ -108,6 +177,7 @@ void openai_rt_deinit(openai_rt_handle_t handle) {
     if (ctx->is_active) {
         openai_rt_stop(handle);
     }
+    ctx->is_connected = false;
     
     // Free resources
     free(ctx);
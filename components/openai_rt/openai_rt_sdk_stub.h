@@ -21,6 +21,8 @@ typedef struct {
 typedef struct {
     const char* api_key;
     const char* voice;
+    const char* input_audio_format;     // "pcm16", "g711_ulaw", ...; NULL for pcm16
+    const char* output_audio_format;
 } openai_rt_config_t;
 
 // SDK functions
@@ -30,6 +32,27 @@ int openai_rt_start(openai_rt_handle_t handle);
 void openai_rt_stop(openai_rt_handle_t handle);
 void openai_rt_deinit(openai_rt_handle_t handle);
 
+/**
+ * @brief Open and authenticate the session (TLS, WebSocket upgrade, session.update)
+ * 
+ * Blocks until the service has accepted the session. openai_rt_start
+ * connects first if this was not called; openai_rt_stop ends the
+ * conversation but leaves the session open for the next openai_rt_start,
+ * and openai_rt_deinit closes it.
+ * 
+ * @param handle OpenAI RT handle
+ * @return 0 on success, non-zero on failure
+ */
+int openai_rt_connect(openai_rt_handle_t handle);
+
+/**
+ * @brief Send a WebSocket ping on an idle session
+ * 
+ * @param handle OpenAI RT handle
+ * @return 0 when the pong arrived, non-zero when the session is gone
+ */
+int openai_rt_ping(openai_rt_handle_t handle);
+
 /**
  * @brief Send audio data from microphone to the OpenAI RT SDK
  * 
@@ -39,3 +62,40 @@ void openai_rt_deinit(openai_rt_handle_t handle);
  * @return 0 on success, non-zero on failure
  */
 int openai_rt_send_audio(openai_rt_handle_t handle, const void* audio_data, size_t data_size);
+
+/**
+ * @brief Send a client event, e.g. input_audio_buffer.append, as one text frame
+ * 
+ * The event goes out as it is, without being parsed or copied into an
+ * SDK-side buffer; the caller may reuse json as soon as this returns.
+ * 
+ * @param handle OpenAI RT handle
+ * @param json Event JSON
+ * @param len Length of the event in bytes
+ * @return 0 on success, non-zero on failure
+ */
+int openai_rt_send_event(openai_rt_handle_t handle, const char* json, size_t len);
+
+/**
+ * @brief Cancel the response in progress (the service's response.cancel)
+ * 
+ * The service stops generating audio; chunks already in flight may still
+ * be delivered. The conversation stays open.
+ * 
+ * @param handle OpenAI RT handle
+ * @return 0 on success, non-zero on failure
+ */
+int openai_rt_cancel_response(openai_rt_handle_t handle);
+
+/**
+ * @brief End the user's turn (input_audio_buffer.commit, then response.create)
+ * 
+ * For sessions where the device's voice activity detector decides when
+ * the user has finished: the audio appended so far becomes one user
+ * message and the service starts its response. The session's own turn
+ * detection should then be off, or it may commit and respond as well.
+ * 
+ * @param handle OpenAI RT handle
+ * @return 0 on success, non-zero on failure
+ */
+int openai_rt_commit_input(openai_rt_handle_t handle);
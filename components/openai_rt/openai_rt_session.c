@@ -0,0 +1,316 @@
+#include "openai_rt_session.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+#define TAG "OPENAI_RT_SESSION"
+
+#define SESSION_EVENT_READY     (1 << 0)    // an open session is waiting to be acquired
+#define SESSION_EVENT_EXIT      (1 << 1)
+
+typedef enum {
+    SESSION_CLOSED,
+    SESSION_CONNECTING,     // the task is opening one, outside the lock
+    SESSION_READY,
+    SESSION_PINGING,        // the task is pinging the idle one, outside the lock
+    SESSION_IN_USE,
+} session_state_t;
+
+typedef struct {
+    openai_rt_session_config_t config;
+    SemaphoreHandle_t lock;
+    EventGroupHandle_t events;
+    TaskHandle_t task;
+    volatile bool run;
+    session_state_t state;
+    openai_rt_handle_t handle;
+    bool wanted;                // a session should be open or opening
+    bool waiting;               // an acquire timed out and has not been withdrawn
+    volatile bool dead;         // the service ended the idle session
+    int64_t opened_us;
+    int64_t last_ping_us;
+    int64_t retry_at_us;
+    uint32_t backoff_ms;
+    openai_rt_session_stats_t stats;
+} session_mgr_t;
+
+static session_mgr_t s_session = {0};
+
+// Installed while no conversation holds the session
+static void idle_end_callback(void* user_data) {
+    session_mgr_t* mgr = (session_mgr_t*)user_data;
+    mgr->dead = true;
+    xEventGroupClearBits(mgr->events, SESSION_EVENT_READY);
+    xTaskNotifyGive(mgr->task);
+}
+
+static const openai_rt_callbacks_t s_idle_callbacks = {
+    .audio_data_cb = NULL,
+    .conversation_end_cb = idle_end_callback,
+    .user_data = &s_session,
+};
+
+// Lock held
+static void close_session(session_mgr_t* mgr, const char* why) {
+    xEventGroupClearBits(mgr->events, SESSION_EVENT_READY);
+    if (mgr->handle) {
+        ESP_LOGI(TAG, "Closing session: %s", why);
+        openai_rt_deinit(mgr->handle);
+        mgr->handle = NULL;
+    }
+    mgr->state = SESSION_CLOSED;
+    mgr->dead = false;
+}
+
+// Called by the task with the state at SESSION_CONNECTING; the lock is not
+// held while the handshake runs
+static void open_session(session_mgr_t* mgr) {
+    int64_t start_us = esp_timer_get_time();
+    openai_rt_handle_t handle = openai_rt_init(&mgr->config.sdk);
+    bool ok = handle && openai_rt_set_callbacks(handle, &s_idle_callbacks) == 0 && openai_rt_connect(handle) == 0;
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(mgr->lock, portMAX_DELAY);
+    if (!ok) {
+        if (handle) {
+            openai_rt_deinit(handle);
+        }
+        mgr->stats.failures++;
+        mgr->state = SESSION_CLOSED;
+        mgr->retry_at_us = now_us + (int64_t)mgr->backoff_ms * 1000;
+        ESP_LOGW(TAG, "Connect failed, retrying in %lu ms", (unsigned long)mgr->backoff_ms);
+        mgr->backoff_ms = mgr->backoff_ms * 2 < OPENAI_RT_SESSION_RETRY_MAX_MS ? mgr->backoff_ms * 2
+                                                                                : OPENAI_RT_SESSION_RETRY_MAX_MS;
+    } else {
+        mgr->handle = handle;
+        mgr->state = SESSION_READY;
+        mgr->dead = false;
+        mgr->opened_us = now_us;
+        mgr->last_ping_us = now_us;
+        mgr->backoff_ms = mgr->config.retry_ms;
+        mgr->stats.connects++;
+        mgr->stats.connect_ms_last = (uint32_t)((now_us - start_us) / 1000);
+        ESP_LOGI(TAG, "Session open in %lu ms", (unsigned long)mgr->stats.connect_ms_last);
+        xEventGroupSetBits(mgr->events, SESSION_EVENT_READY);
+    }
+    xSemaphoreGive(mgr->lock);
+    if (ok && mgr->config.ready_cb) {
+        mgr->config.ready_cb(mgr->config.user_data);
+    }
+}
+
+// Called by the task with the state at SESSION_PINGING. As with the
+// handshake, the lock is free for the round trip, so an acquire is never
+// stuck behind it: a zero-timeout one returns and hears from ready_cb
+static void ping_session(session_mgr_t* mgr) {
+    bool ok = openai_rt_ping(mgr->handle) == 0;
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(mgr->lock, portMAX_DELAY);
+    mgr->stats.keepalives++;
+    bool notify = ok && mgr->waiting;
+    if (!ok) {
+        mgr->stats.failures++;
+        close_session(mgr, "keepalive failed");
+        mgr->retry_at_us = now_us;
+    } else if (!mgr->wanted) {
+        // Released while the ping was out
+        close_session(mgr, "no longer wanted");
+        notify = false;
+    } else {
+        mgr->state = SESSION_READY;
+        mgr->last_ping_us = now_us;
+        xEventGroupSetBits(mgr->events, SESSION_EVENT_READY);
+    }
+    xSemaphoreGive(mgr->lock);
+    if (notify && mgr->config.ready_cb) {
+        mgr->config.ready_cb(mgr->config.user_data);
+    }
+}
+
+// Opens sessions when one is wanted, and keeps the idle one alive and fresh
+static void session_task(void* pv) {
+    session_mgr_t* mgr = (session_mgr_t*)pv;
+
+    while (mgr->run) {
+        TickType_t wait = portMAX_DELAY;
+        bool connect = false;
+        bool ping = false;
+
+        xSemaphoreTake(mgr->lock, portMAX_DELAY);
+        int64_t now_us = esp_timer_get_time();
+        if (mgr->state == SESSION_READY) {
+            if (mgr->dead) {
+                close_session(mgr, "ended by the service");
+                mgr->retry_at_us = now_us;
+            } else if (now_us - mgr->opened_us >= (int64_t)mgr->config.max_age_ms * 1000) {
+                close_session(mgr, "replacing before the service's session limit");
+                mgr->retry_at_us = now_us;
+            } else if (now_us - mgr->last_ping_us >= (int64_t)mgr->config.keepalive_ms * 1000) {
+                mgr->state = SESSION_PINGING;
+                xEventGroupClearBits(mgr->events, SESSION_EVENT_READY);
+                ping = true;
+            }
+        }
+        if (mgr->state == SESSION_CLOSED && mgr->wanted) {
+            if (now_us >= mgr->retry_at_us) {
+                mgr->state = SESSION_CONNECTING;
+                connect = true;
+            } else {
+                wait = pdMS_TO_TICKS((mgr->retry_at_us - now_us) / 1000 + 1);
+            }
+        } else if (mgr->state == SESSION_READY) {
+            int64_t ping_us = mgr->last_ping_us + (int64_t)mgr->config.keepalive_ms * 1000;
+            int64_t expire_us = mgr->opened_us + (int64_t)mgr->config.max_age_ms * 1000;
+            int64_t next_us = ping_us < expire_us ? ping_us : expire_us;
+            wait = pdMS_TO_TICKS((next_us > now_us ? next_us - now_us : 0) / 1000 + 1);
+        }
+        xSemaphoreGive(mgr->lock);
+
+        if (connect) {
+            open_session(mgr);
+        } else if (ping) {
+            ping_session(mgr);
+        } else {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+    }
+
+    xSemaphoreTake(mgr->lock, portMAX_DELAY);
+    close_session(mgr, "shutting down");
+    xSemaphoreGive(mgr->lock);
+    xEventGroupSetBits(mgr->events, SESSION_EVENT_EXIT);
+    vTaskDelete(NULL);
+}
+
+esp_err_t openai_rt_session_init(const openai_rt_session_config_t* config) {
+    if (!config || !config->sdk.api_key || !config->sdk.voice || config->keepalive_ms == 0 ||
+        config->max_age_ms == 0 || config->retry_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_session.task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(&s_session, 0, sizeof(s_session));
+    s_session.config = *config;
+    s_session.wanted = config->preconnect;
+    s_session.backoff_ms = config->retry_ms;
+    s_session.lock = xSemaphoreCreateMutex();
+    s_session.events = xEventGroupCreate();
+    s_session.run = true;
+    if (!s_session.lock || !s_session.events ||
+        xTaskCreate(session_task, "openai_rt_sess", 4096, &s_session, 4, &s_session.task) != pdPASS) {
+        if (s_session.lock) {
+            vSemaphoreDelete(s_session.lock);
+        }
+        if (s_session.events) {
+            vEventGroupDelete(s_session.events);
+        }
+        memset(&s_session, 0, sizeof(s_session));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void openai_rt_session_deinit(void) {
+    if (!s_session.task) {
+        return;
+    }
+    s_session.run = false;
+    xTaskNotifyGive(s_session.task);
+    xEventGroupWaitBits(s_session.events, SESSION_EVENT_EXIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    vSemaphoreDelete(s_session.lock);
+    vEventGroupDelete(s_session.events);
+    memset(&s_session, 0, sizeof(s_session));
+}
+
+openai_rt_handle_t openai_rt_session_acquire(const openai_rt_callbacks_t* callbacks, uint32_t timeout_ms,
+                                             bool* ready) {
+    if (!s_session.task || !callbacks) {
+        return NULL;
+    }
+    const int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+
+    xSemaphoreTake(s_session.lock, portMAX_DELAY);
+    // A session out on a keepalive is as good as ready
+    bool open = (s_session.state == SESSION_READY || s_session.state == SESSION_PINGING) && !s_session.dead &&
+                !s_session.waiting;
+    s_session.wanted = true;
+    s_session.retry_at_us = 0;
+    xSemaphoreGive(s_session.lock);
+    xTaskNotifyGive(s_session.task);
+
+    while (true) {
+        openai_rt_handle_t handle = NULL;
+        xSemaphoreTake(s_session.lock, portMAX_DELAY);
+        if (s_session.state == SESSION_READY && !s_session.dead &&
+            openai_rt_set_callbacks(s_session.handle, callbacks) == 0) {
+            s_session.state = SESSION_IN_USE;
+            s_session.waiting = false;
+            s_session.stats.acquires++;
+            s_session.stats.ready_acquires += open;
+            xEventGroupClearBits(s_session.events, SESSION_EVENT_READY);
+            handle = s_session.handle;
+        }
+        xSemaphoreGive(s_session.lock);
+        if (handle) {
+            if (ready) {
+                *ready = open;
+            }
+            return handle;
+        }
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            xSemaphoreTake(s_session.lock, portMAX_DELAY);
+            s_session.waiting = true;
+            xSemaphoreGive(s_session.lock);
+            return NULL;
+        }
+        xEventGroupWaitBits(s_session.events, SESSION_EVENT_READY, pdFALSE, pdFALSE,
+                            pdMS_TO_TICKS(remaining_us / 1000 + 1));
+    }
+}
+
+void openai_rt_session_release(bool reuse) {
+    if (!s_session.task) {
+        return;
+    }
+    xSemaphoreTake(s_session.lock, portMAX_DELAY);
+    if (s_session.state != SESSION_IN_USE && s_session.waiting) {
+        // Nobody took the session that was asked for; without pre-connect
+        // it is not wanted any more
+        s_session.waiting = false;
+        s_session.wanted = s_session.config.preconnect;
+        if (!s_session.wanted && s_session.state == SESSION_READY) {
+            close_session(&s_session, "no longer wanted");
+        }
+    } else if (s_session.state == SESSION_IN_USE) {
+        s_session.wanted = s_session.config.preconnect;
+        if (reuse && s_session.wanted && !s_session.dead &&
+            openai_rt_set_callbacks(s_session.handle, &s_idle_callbacks) == 0) {
+            // The conversation's traffic kept it alive until now
+            s_session.state = SESSION_READY;
+            s_session.last_ping_us = esp_timer_get_time();
+            xEventGroupSetBits(s_session.events, SESSION_EVENT_READY);
+        } else {
+            close_session(&s_session, "released");
+            s_session.retry_at_us = 0;
+        }
+    }
+    xSemaphoreGive(s_session.lock);
+    xTaskNotifyGive(s_session.task);
+}
+
+void openai_rt_session_get_stats(openai_rt_session_stats_t* stats) {
+    if (!s_session.task) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_session.lock, portMAX_DELAY);
+    *stats = s_session.stats;
+    xSemaphoreGive(s_session.lock);
+}
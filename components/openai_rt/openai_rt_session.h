@@ -0,0 +1,102 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "openai_rt_sdk_stub.h"
+
+/**
+ * @brief Realtime session kept open between conversations
+ *
+ * A background task opens and authenticates the session ahead of the next
+ * conversation, pings it every keepalive_ms while it sits idle, and
+ * replaces it once it is max_age_ms old, before the service's own session
+ * limit ends it mid-conversation. A session that cannot be opened or fails
+ * its ping is retried after retry_ms, doubling up to
+ * OPENAI_RT_SESSION_RETRY_MAX_MS; a conversation asking for one skips the
+ * wait. Handshakes and pings run without the manager's lock held, so an
+ * acquire never blocks behind a round trip: a zero-timeout acquire during
+ * one returns NULL, and ready_cb follows when it completes.
+ *
+ * One conversation at a time holds the session, between
+ * openai_rt_session_acquire and openai_rt_session_release. A caller that
+ * must not block acquires with a zero timeout and tries again from
+ * ready_cb.
+ */
+
+/** Longest pause between reconnect attempts */
+#define OPENAI_RT_SESSION_RETRY_MAX_MS  30000
+
+/**
+ * @brief Session manager settings
+ */
+typedef struct {
+    openai_rt_config_t sdk;     ///< Strings must stay valid while the manager runs
+    bool preconnect;            ///< Keep a session open while idle; otherwise open on acquire, close on release
+    uint32_t keepalive_ms;      ///< Ping interval while idle
+    uint32_t max_age_ms;        ///< An idle session this old is replaced
+    uint32_t retry_ms;          ///< First reconnect delay after a failure
+    void (*ready_cb)(void* user_data);  ///< A session opened; runs on the session task, may be NULL
+    void* user_data;
+} openai_rt_session_config_t;
+
+/**
+ * @brief Session statistics since openai_rt_session_init
+ */
+typedef struct {
+    uint32_t connects;          ///< Sessions opened
+    uint32_t failures;          ///< Connects and pings that failed
+    uint32_t keepalives;        ///< Pings sent while idle
+    uint32_t acquires;          ///< Successful ones
+    uint32_t ready_acquires;    ///< Of those, found a session open without waiting
+    uint32_t connect_ms_last;   ///< Time the last successful connect took
+} openai_rt_session_stats_t;
+
+/**
+ * @brief Start the session task; with preconnect it opens a session right away
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if already
+ *         running, or ESP_ERR_NO_MEM
+ */
+esp_err_t openai_rt_session_init(const openai_rt_session_config_t* config);
+
+/**
+ * @brief Stop the session task and close the session; it must not be held
+ */
+void openai_rt_session_deinit(void);
+
+/**
+ * @brief Take the session for a conversation, waiting for it to open
+ *
+ * @param callbacks Installed on the session for the conversation
+ * @param timeout_ms Longest wait for a session to open, 0 to only ask for one
+ * @param ready Set to whether a session was open without waiting, counting
+ *              earlier acquires that timed out as waiting; may be NULL
+ * @return SDK handle, or NULL if none opened in time
+ */
+openai_rt_handle_t openai_rt_session_acquire(const openai_rt_callbacks_t* callbacks, uint32_t timeout_ms,
+                                             bool* ready);
+
+/**
+ * @brief Give the session back after the conversation has stopped
+ *
+ * Without the session held, withdraws an acquire that timed out.
+ *
+ * @param reuse false if the session may be unusable, e.g. the service
+ *              ended the conversation; it is closed and, with preconnect,
+ *              a new one opened
+ */
+void openai_rt_session_release(bool reuse);
+
+/**
+ * @brief Get session statistics
+ */
+void openai_rt_session_get_stats(openai_rt_session_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
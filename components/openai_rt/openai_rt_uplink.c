@@ -0,0 +1,230 @@
+#include "openai_rt_uplink.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+// The audio field starts on a word boundary so the encoder stores whole
+// words; the spaces that pad the event to it are JSON whitespace
+#define EVENT_OPEN      "{"
+#define EVENT_HEAD      "\"type\":\"input_audio_buffer.append\",\"audio\":\""
+#define EVENT_TAIL      "\"}"
+
+struct openai_rt_uplink {
+    openai_rt_uplink_config_t config;
+    size_t frame_bytes;
+    char* event;                // head, audio field, tail
+    char* audio;                // start of the audio field in event
+    size_t chars;               // base64 written into the audio field
+    size_t fill;                // wire bytes in the current frame
+    uint8_t carry[3];           // a group split between writes
+    size_t carry_len;
+    int64_t captured_us;        // first sample of the current frame
+    openai_rt_uplink_stats_t stats;
+};
+
+static const char s_alphabet[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Characters for every 12-bit value, the first one in the low byte
+static uint16_t s_pairs[4096];
+static bool s_pairs_ready;
+
+static void pairs_build(void) {
+    for (uint32_t i = 0; i < 4096; i++) {
+        s_pairs[i] = (uint16_t)((uint8_t)s_alphabet[i >> 6] | (uint8_t)s_alphabet[i & 63] << 8);
+    }
+    s_pairs_ready = true;
+}
+
+// One or two bytes left over at the end, padded to four characters
+static size_t encode_tail(const uint8_t* src, size_t len, char* dst) {
+    if (len == 0) {
+        return 0;
+    }
+    uint32_t v = (uint32_t)src[0] << 16 | (len > 1 ? (uint32_t)src[1] << 8 : 0);
+    dst[0] = s_alphabet[v >> 18];
+    dst[1] = s_alphabet[(v >> 12) & 63];
+    dst[2] = len > 1 ? s_alphabet[(v >> 6) & 63] : '=';
+    dst[3] = '=';
+    return 4;
+}
+
+// Little-endian word stores put the low pair first; an aligned dst lets
+// the compiler use a single 32-bit store per group
+static inline __attribute__((always_inline)) char* encode_groups(const uint8_t* src, size_t groups, char* out,
+                                                                bool aligned) {
+    for (size_t g = 0; g < groups; g++, src += 3, out += 4) {
+        uint32_t v = (uint32_t)src[0] << 16 | (uint32_t)src[1] << 8 | src[2];
+        uint32_t w = s_pairs[v >> 12] | (uint32_t)s_pairs[v & 0xFFF] << 16;
+        if (aligned) {
+            memcpy(__builtin_assume_aligned(out, 4), &w, sizeof(w));
+        } else {
+            memcpy(out, &w, sizeof(w));
+        }
+    }
+    return out;
+}
+
+size_t openai_rt_base64_encode(const uint8_t* src, size_t len, char* dst) {
+    if (!s_pairs_ready) {
+        pairs_build();
+    }
+    size_t groups = len / 3;
+    char* out = ((uintptr_t)dst & 3) == 0 ? encode_groups(src, groups, dst, true)
+                                          : encode_groups(src, groups, dst, false);
+    return (size_t)(out - dst) + encode_tail(src + groups * 3, len - groups * 3, out);
+}
+
+size_t openai_rt_base64_encode_scalar(const uint8_t* src, size_t len, char* dst) {
+    char* out = dst;
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+        uint32_t v = (uint32_t)src[i] << 16 | (uint32_t)src[i + 1] << 8 | src[i + 2];
+        *out++ = s_alphabet[v >> 18];
+        *out++ = s_alphabet[(v >> 12) & 63];
+        *out++ = s_alphabet[(v >> 6) & 63];
+        *out++ = s_alphabet[v & 63];
+    }
+    return (size_t)(out - dst) + encode_tail(src + i, len - i, out);
+}
+
+esp_err_t openai_rt_uplink_create(const openai_rt_uplink_config_t* config, openai_rt_uplink_t** out_uplink) {
+    if (!config || !out_uplink || !config->send || config->align == 0 ||
+        (config->frame_ms != 20 && config->frame_ms != 40 && config->frame_ms != 100)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t frame_bytes = (size_t)config->bytes_per_second * config->frame_ms / 1000;
+    frame_bytes -= frame_bytes % config->align;
+    if (frame_bytes == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    openai_rt_uplink_t* uplink = calloc(1, sizeof(openai_rt_uplink_t));
+    if (!uplink) {
+        return ESP_ERR_NO_MEM;
+    }
+    const size_t head = strlen(EVENT_OPEN) + strlen(EVENT_HEAD);
+    const size_t audio_at = (head + 3) & ~(size_t)3;
+    uplink->event = heap_caps_aligned_alloc(4, audio_at + openai_rt_base64_size(frame_bytes) + sizeof(EVENT_TAIL),
+                                            MALLOC_CAP_8BIT);
+    if (!uplink->event) {
+        free(uplink);
+        return ESP_ERR_NO_MEM;
+    }
+    char* p = uplink->event;
+    memcpy(p, EVENT_OPEN, strlen(EVENT_OPEN));
+    p += strlen(EVENT_OPEN);
+    memset(p, ' ', audio_at - head);
+    p += audio_at - head;
+    memcpy(p, EVENT_HEAD, strlen(EVENT_HEAD));
+
+    uplink->config = *config;
+    uplink->frame_bytes = frame_bytes;
+    uplink->audio = uplink->event + audio_at;
+    if (!s_pairs_ready) {
+        pairs_build();
+    }
+    *out_uplink = uplink;
+    return ESP_OK;
+}
+
+void openai_rt_uplink_destroy(openai_rt_uplink_t* uplink) {
+    if (!uplink) {
+        return;
+    }
+    heap_caps_free(uplink->event);
+    free(uplink);
+}
+
+// Appends len bytes of the current frame, completing a group left over
+// from the last write first
+static void encode_bytes(openai_rt_uplink_t* uplink, const uint8_t* src, size_t len) {
+    if (uplink->carry_len > 0) {
+        while (uplink->carry_len < 3 && len > 0) {
+            uplink->carry[uplink->carry_len++] = *src++;
+            len--;
+        }
+        if (uplink->carry_len < 3) {
+            return;
+        }
+        uplink->chars += openai_rt_base64_encode(uplink->carry, 3, uplink->audio + uplink->chars);
+        uplink->carry_len = 0;
+    }
+    size_t whole = len - len % 3;
+    uplink->chars += openai_rt_base64_encode(src, whole, uplink->audio + uplink->chars);
+    memcpy(uplink->carry, src + whole, len - whole);
+    uplink->carry_len = len - whole;
+}
+
+static void send_frame(openai_rt_uplink_t* uplink) {
+    uplink->chars += openai_rt_base64_encode(uplink->carry, uplink->carry_len, uplink->audio + uplink->chars);
+    memcpy(uplink->audio + uplink->chars, EVENT_TAIL, sizeof(EVENT_TAIL));
+    size_t len = (size_t)(uplink->audio - uplink->event) + uplink->chars + strlen(EVENT_TAIL);
+
+    if (uplink->config.send(uplink->event, len, uplink->captured_us, uplink->config.user_data) != 0) {
+        uplink->stats.failed++;
+    }
+    uplink->stats.frames++;
+    uplink->stats.bytes += uplink->fill;
+    uplink->chars = 0;
+    uplink->fill = 0;
+    uplink->carry_len = 0;
+}
+
+size_t openai_rt_uplink_write(openai_rt_uplink_t* uplink, const void* data, size_t size, int64_t captured_us) {
+    const uint8_t* src = (const uint8_t*)data;
+    size_t done = 0;
+    size_t sent = 0;
+    uint32_t encode_us = 0;
+
+    while (done < size) {
+        if (uplink->fill == 0) {
+            uplink->captured_us = captured_us +
+                                  (int64_t)done * 1000000 / uplink->config.bytes_per_second;
+        }
+        size_t n = size - done;
+        n = n < uplink->frame_bytes - uplink->fill ? n : uplink->frame_bytes - uplink->fill;
+        int64_t start_us = esp_timer_get_time();
+        encode_bytes(uplink, src + done, n);
+        encode_us += (uint32_t)(esp_timer_get_time() - start_us);
+        uplink->fill += n;
+        done += n;
+        if (uplink->fill == uplink->frame_bytes) {
+            send_frame(uplink);
+            sent++;
+        }
+    }
+    uplink->stats.encode_us_max = encode_us > uplink->stats.encode_us_max ? encode_us : uplink->stats.encode_us_max;
+    return sent;
+}
+
+bool openai_rt_uplink_flush(openai_rt_uplink_t* uplink) {
+    if (uplink->fill == 0) {
+        return false;
+    }
+    uplink->stats.partial++;
+    send_frame(uplink);
+    return true;
+}
+
+void openai_rt_uplink_reset(openai_rt_uplink_t* uplink) {
+    uplink->chars = 0;
+    uplink->fill = 0;
+    uplink->carry_len = 0;
+}
+
+size_t openai_rt_uplink_pending(const openai_rt_uplink_t* uplink) {
+    return uplink->fill;
+}
+
+size_t openai_rt_uplink_frame_bytes(const openai_rt_uplink_t* uplink) {
+    return uplink->frame_bytes;
+}
+
+void openai_rt_uplink_get_stats(const openai_rt_uplink_t* uplink, openai_rt_uplink_stats_t* stats) {
+    *stats = uplink->stats;
+}
+
+void openai_rt_uplink_reset_stats(openai_rt_uplink_t* uplink) {
+    memset(&uplink->stats, 0, sizeof(uplink->stats));
+}
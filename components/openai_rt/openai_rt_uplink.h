@@ -0,0 +1,151 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Uplink framer: wire audio to input_audio_buffer.append events
+ *
+ * The Realtime API takes audio as base64 inside JSON events. The framer
+ * collects encoded mic chunks of any size into frames of frame_ms and
+ * base64-encodes them as they arrive, straight into the audio field of a
+ * preallocated event, so a frame costs no allocation and no copy of the
+ * raw audio. When a frame is complete the whole event is handed to the
+ * send callback, which may use the buffer until it returns.
+ *
+ * Not thread-safe: the caller serializes write, flush and reset.
+ */
+typedef struct openai_rt_uplink openai_rt_uplink_t;
+
+/**
+ * @brief Hands a finished event to the transport
+ *
+ * @param json NUL-terminated event, valid until the callback returns
+ * @param len Length of the event without the NUL
+ * @param captured_us esp_timer time the frame's first sample was captured
+ * @param user_data User data from the config
+ * @return 0 on success, non-zero if the event could not be sent
+ */
+typedef int (*openai_rt_uplink_send_t)(const char* json, size_t len, int64_t captured_us, void* user_data);
+
+/**
+ * @brief Framer settings
+ */
+typedef struct {
+    uint32_t frame_ms;          ///< 20, 40 or 100
+    uint32_t bytes_per_second;  ///< Wire bytes per second of audio
+    uint32_t align;             ///< Frames are a whole number of these, e.g. 2 for PCM16
+    openai_rt_uplink_send_t send;
+    void* user_data;
+} openai_rt_uplink_config_t;
+
+#define OPENAI_RT_UPLINK_CONFIG_DEFAULT() { \
+    .frame_ms = 40,                         \
+    .bytes_per_second = 48000,              \
+    .align = 2,                             \
+    .send = NULL,                           \
+    .user_data = NULL,                      \
+}
+
+/**
+ * @brief Framer statistics since create or openai_rt_uplink_reset_stats
+ */
+typedef struct {
+    uint32_t frames;            ///< Events sent, including flushed partial frames
+    uint32_t partial;           ///< Of those, cut short by openai_rt_uplink_flush
+    uint32_t failed;            ///< Events the send callback refused
+    uint32_t bytes;             ///< Wire audio bytes sent
+    uint32_t encode_us_max;     ///< Longest time a write spent encoding
+} openai_rt_uplink_stats_t;
+
+/**
+ * @brief Create a framer and its event buffer
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (frame_ms not 20, 40 or 100, no send
+ *         callback, or a frame shorter than align), or ESP_ERR_NO_MEM
+ */
+esp_err_t openai_rt_uplink_create(const openai_rt_uplink_config_t* config, openai_rt_uplink_t** out_uplink);
+
+/**
+ * @brief Free a framer
+ */
+void openai_rt_uplink_destroy(openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Add wire audio; every frame it completes is sent before returning
+ *
+ * @param data Encoded audio
+ * @param size Bytes of audio
+ * @param captured_us esp_timer time the first sample of data was captured
+ * @return Number of events sent
+ */
+size_t openai_rt_uplink_write(openai_rt_uplink_t* uplink, const void* data, size_t size, int64_t captured_us);
+
+/**
+ * @brief Send the frame collected so far, if any, e.g. when speech ends
+ *
+ * @return true if an event was sent
+ */
+bool openai_rt_uplink_flush(openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Drop the frame collected so far
+ */
+void openai_rt_uplink_reset(openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Wire bytes waiting for the current frame to fill
+ */
+size_t openai_rt_uplink_pending(const openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Bytes in a full frame
+ */
+size_t openai_rt_uplink_frame_bytes(const openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Get framer statistics
+ */
+void openai_rt_uplink_get_stats(const openai_rt_uplink_t* uplink, openai_rt_uplink_stats_t* stats);
+
+/**
+ * @brief Clear the statistics
+ */
+void openai_rt_uplink_reset_stats(openai_rt_uplink_t* uplink);
+
+/**
+ * @brief Characters base64 needs for len bytes, padding included
+ */
+static inline size_t openai_rt_base64_size(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+/**
+ * @brief Base64-encode (RFC 4648, padded, no line breaks) without a NUL
+ *
+ * Each 3-byte group becomes one 32-bit store of four characters taken two
+ * at a time from a 4096-entry table of character pairs, so a group costs
+ * two lookups instead of four. The table is built on the first call.
+ *
+ * @param dst At least openai_rt_base64_size(len) bytes; groups are stored
+ *            as whole words, which is fastest when dst is 4-byte aligned
+ * @return Characters written
+ */
+size_t openai_rt_base64_encode(const uint8_t* src, size_t len, char* dst);
+
+/**
+ * @brief Reference encoder: one character and one table lookup at a time
+ *
+ * Produces the same output as openai_rt_base64_encode.
+ */
+size_t openai_rt_base64_encode_scalar(const uint8_t* src, size_t len, char* dst);
+
+#ifdef __cplusplus
+}
+#endif
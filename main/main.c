@@ -11,6 +11,7 @@
 #include "avatar.h"
 #include "config_mgr.h"
 #include "led_ctrl.h"
+#include "asset_bundle.h"
 
 // Forward declaration of test function
 extern void run_openai_rt_test(void);
@@ -70,11 +71,15 @@ void app_main(void) {
     // Normal application initialization
     avatar_init();
     led_ctrl_init();
+    // Earcons, sprites and animations; everything has a built-in fallback
+    asset_bundle_init("assets");
     led_ctrl_set_mode(LED_MODE_BREATH);
     avatar_set_expression(AVATAR_EXPRESSION_IDLE);
     config_mgr_init();
     const app_config_t* cfg = config_mgr_get();
     sleep_mgr_init(cfg->sleep_timeout_sec);
+    openai_rt_warm_up();
+    openai_rt_preconnect();
     xTaskCreate(&button_task, "button_task", 2048, NULL, 5, NULL);
     
     ESP_LOGI(TAG, "Katyusha-Neco-AI started");
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Generate assets_test.bin, the asset bundle used by test_asset_bundle.c.
+
+It holds one asset of each type with contents the test can predict, plus
+filler entries so lookups search a realistically sized index. The bundle
+is built with tools/asset_pack.py, so the test also covers the pack tool's
+output format.
+
+    python3 make_asset_fixture.py   # writes assets_test.bin next to this script
+"""
+import math
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import wave
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PACK = os.path.join(HERE, "..", "..", "tools", "asset_pack.py")
+FILLERS = 60
+
+
+def main():
+    with tempfile.TemporaryDirectory() as tmp:
+        def path(name):
+            return os.path.join(tmp, name)
+
+        # 100 samples of a 1 kHz sine at 16 kHz
+        with wave.open(path("click.wav"), "wb") as w:
+            w.setnchannels(1)
+            w.setsampwidth(2)
+            w.setframerate(16000)
+            w.writeframes(b"".join(struct.pack("<h", int(10000 * math.sin(2 * math.pi * i / 16)))
+                                   for i in range(100)))
+        # 8x4 sprite, pixel value = y * 8 + x
+        with open(path("face.rgb565"), "wb") as f:
+            f.write(b"".join(struct.pack("<H", i) for i in range(8 * 4)))
+        # 3 frames of 2 LEDs, byte value = index
+        with open(path("blink.led"), "wb") as f:
+            f.write(bytes(range(3 * 2 * 3)))
+        # Odd length so the next asset needs padding
+        with open(path("note.txt"), "wb") as f:
+            f.write(b"hello")
+        specs = ["click=" + path("click.wav"), "face=" + path("face.rgb565") + "@8x4",
+                 "blink=" + path("blink.led") + "@2x50", "note=" + path("note.txt")]
+        for i in range(FILLERS):
+            name = "filler_%02d" % i
+            with open(path(name), "wb") as f:
+                f.write(bytes([i]) * (i + 1))
+            specs.append("%s=%s" % (name, path(name)))
+
+        subprocess.check_call([sys.executable, PACK, "-o", os.path.join(HERE, "assets_test.bin")] + specs)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Generate the synthetic WAV fixtures used by test_mic_kws.c.
+
+The "keyword" is three 200 ms voiced/unvoiced segments in a fixed order;
+the background fixture reuses the same segments in other orders plus
+steady tones and noise, so only the order tells them apart.
+
+    python3 make_kws_fixtures.py   # writes kws_*.wav next to this script
+"""
+import math
+import os
+import random
+import struct
+import wave
+
+RATE = 16000
+SEG = RATE // 5
+
+
+def voiced(f0, formants, n, seed):
+    rng = random.Random(seed)
+    out = []
+    phase = 0.0
+    for i in range(n):
+        f = f0 * (1.0 + 0.02 * math.sin(2 * math.pi * 4 * i / RATE))
+        phase += 2 * math.pi * f / RATE
+        s = 0.0
+        for h in range(1, int(4000 / f0)):
+            hz = h * f0
+            gain = sum(1.0 / (1.0 + ((hz - fc) / bw) ** 2) for fc, bw in formants)
+            s += gain * math.sin(h * phase)
+        out.append(s + 0.05 * rng.uniform(-1, 1))
+    return out
+
+
+def fricative(n, seed):
+    rng = random.Random(seed)
+    out, prev = [], 0.0
+    for _ in range(n):
+        x = rng.uniform(-1, 1)
+        out.append(x - 0.95 * prev)  # tilt toward high frequencies
+        prev = x
+    return out
+
+
+def envelope(seg):
+    n = len(seg)
+    ramp = n // 10
+    return [s * min(1.0, i / ramp, (n - 1 - i) / ramp) for i, s in enumerate(seg)]
+
+
+def normalize(seg, peak):
+    m = max(abs(s) for s in seg) or 1.0
+    return [s * peak / m for s in seg]
+
+
+A = envelope(voiced(140, [(700, 120), (1200, 150)], SEG, 1))
+I = envelope(voiced(150, [(300, 80), (2300, 200)], SEG, 2))
+S = envelope(fricative(SEG, 3))
+KEYWORD = normalize(A + I + S, 1.0)
+
+
+def tone(hz, n):
+    return [math.sin(2 * math.pi * hz * i / RATE) for i in range(n)]
+
+
+def render(length_s, events, noise_dbfs, seed):
+    rng = random.Random(seed)
+    noise = 32767 * 10 ** (noise_dbfs / 20) * math.sqrt(3)
+    buf = [rng.uniform(-noise, noise) for _ in range(int(length_s * RATE))]
+    for start_s, seg, dbfs in events:
+        start = int(start_s * RATE)
+        gain = 32767 * 10 ** (dbfs / 20)
+        for i, s in enumerate(seg):
+            buf[start + i] += gain * s
+    return buf
+
+
+def write(name, samples):
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+    with wave.open(path, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(RATE)
+        w.writeframes(b"".join(struct.pack("<h", max(-32768, min(32767, int(round(s))))) for s in samples))
+
+
+# Enrolment: exactly one 49-frame window, keyword ending 142 ms before the end
+write("kws_enroll.wav", render(15872 / RATE, [(0.25, KEYWORD, -12)], -60, 10))
+# Two occurrences: loud, then 12 dB quieter in more noise
+write("kws_keyword.wav", render(3.5, [(0.6, KEYWORD, -10), (2.4, KEYWORD, -22)], -50, 11))
+# Same material in the wrong order, single segments, tones and noise bursts
+write("kws_background.wav", render(3.5, [
+    (0.3, normalize(S + I + A, 1.0), -10),
+    (1.1, normalize(I + A + S, 1.0), -12),
+    (1.9, normalize(A, 1.0), -10),
+    (2.3, normalize(tone(1000, SEG * 2), 1.0), -20),
+    (2.9, normalize(S, 1.0), -15),
+], -45, 12))
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include "esp_rom_crc.h"
+#include "asset_bundle.h"
+
+#define TAG "TEST_ASSET_BUNDLE"
+
+// Built by fixtures/make_asset_fixture.py with tools/asset_pack.py
+extern const uint8_t assets_test_bin_start[] asm("_binary_assets_test_bin_start");
+extern const uint8_t assets_test_bin_end[] asm("_binary_assets_test_bin_end");
+
+static size_t fixture_size(void) {
+    return (size_t)(assets_test_bin_end - assets_test_bin_start);
+}
+
+TEST_CASE("Asset bundle finds each asset type in place", "[asset_bundle]") {
+    asset_t asset;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, asset_bundle_find("click", &asset));
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_init_image(assets_test_bin_start, fixture_size()));
+    TEST_ASSERT_EQUAL(64, asset_bundle_count());
+
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_find("click", &asset));
+    TEST_ASSERT_EQUAL(ASSET_TYPE_PCM16, asset.type);
+    TEST_ASSERT_EQUAL(16000, ASSET_PCM_RATE(&asset));
+    TEST_ASSERT_EQUAL(100 * sizeof(int16_t), asset.size);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)((const uint8_t*)asset.data - assets_test_bin_start) % 16);
+    const int16_t* pcm = asset.data;
+    TEST_ASSERT_EQUAL_INT16(0, pcm[0]);
+    TEST_ASSERT_EQUAL_INT16(10000, pcm[4]);     // quarter period of the 1 kHz sine
+
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_find("face", &asset));
+    TEST_ASSERT_EQUAL(ASSET_TYPE_SPRITE, asset.type);
+    TEST_ASSERT_EQUAL(8, ASSET_SPRITE_WIDTH(&asset));
+    TEST_ASSERT_EQUAL(4, ASSET_SPRITE_HEIGHT(&asset));
+    TEST_ASSERT_EQUAL(8 * 4 * 2, asset.size);
+    TEST_ASSERT_EQUAL_UINT16(2 * 8 + 3, ((const uint16_t*)asset.data)[2 * 8 + 3]);
+
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_find("blink", &asset));
+    TEST_ASSERT_EQUAL(ASSET_TYPE_LED_ANIM, asset.type);
+    TEST_ASSERT_EQUAL(2, ASSET_LED_COUNT(&asset));
+    TEST_ASSERT_EQUAL(50, ASSET_LED_FRAME_MS(&asset));
+    TEST_ASSERT_EQUAL(3, asset.size / (ASSET_LED_COUNT(&asset) * 3));
+
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_find("note", &asset));
+    TEST_ASSERT_EQUAL(ASSET_TYPE_RAW, asset.type);
+    TEST_ASSERT_EQUAL(5, asset.size);
+    TEST_ASSERT_EQUAL_MEMORY("hello", asset.data, 5);
+
+    // Every filler is reachable and holds its own bytes
+    for (int i = 0; i < 60; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "filler_%02d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_find(name, &asset));
+        TEST_ASSERT_EQUAL(i + 1, asset.size);
+        TEST_ASSERT_EQUAL_UINT8(i, ((const uint8_t*)asset.data)[i]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, asset_bundle_find("missing", &asset));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, asset_bundle_find("", &asset));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, asset_bundle_find("clic", &asset));
+
+    asset_bundle_deinit();
+    TEST_ASSERT_EQUAL(0, asset_bundle_count());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, asset_bundle_find("click", &asset));
+}
+
+TEST_CASE("Asset bundle rejects damaged images", "[asset_bundle]") {
+    size_t size = fixture_size();
+    uint8_t* image = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(image);
+    asset_bundle_header_t* header = (asset_bundle_header_t*)image;
+    asset_bundle_entry_t* index = (asset_bundle_entry_t*)(image + sizeof(asset_bundle_header_t));
+
+    // Erased flash reads as 0xFF
+    memset(image, 0xFF, size);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, asset_bundle_init_image(image, size));
+
+    memcpy(image, assets_test_bin_start, size);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, asset_bundle_init_image(image, size - 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, asset_bundle_init_image(image, 8));
+
+    index[3].size ^= 0x100;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, asset_bundle_init_image(image, size));
+    TEST_ASSERT_EQUAL(0, asset_bundle_count());
+
+    // An entry pointing past the image is caught even with a matching CRC
+    memcpy(image, assets_test_bin_start, size);
+    index[3].size = size;
+    header->index_crc = esp_rom_crc32_le(0, (const uint8_t*)index, header->count * sizeof(asset_bundle_entry_t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, asset_bundle_init_image(image, size));
+
+    memcpy(image, assets_test_bin_start, size);
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_init_image(image, size));
+    asset_bundle_deinit();
+    heap_caps_free(image);
+}
+
+TEST_CASE("Asset bundle boot check and lookup time", "[asset_bundle][benchmark]") {
+    const int iterations = 1000;
+    static const char* names[] = {"click", "face", "blink", "filler_42", "missing"};
+    asset_t asset;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    TEST_ASSERT_EQUAL(ESP_OK, asset_bundle_init_image(assets_test_bin_start, fixture_size()));
+    uint32_t init_cycles = esp_cpu_get_cycle_count() - start;
+
+    uint32_t cycles = 0;
+    for (int i = 0; i < iterations; i++) {
+        start = esp_cpu_get_cycle_count();
+        asset_bundle_find(names[i % 5], &asset);
+        cycles += esp_cpu_get_cycle_count() - start;
+    }
+    float init_us = (float)init_cycles / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    float find_us = (float)cycles / iterations / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    ESP_LOGI(TAG, "%lu assets: index check %.1f us, lookup %.2f us", (unsigned long)asset_bundle_count(), init_us,
+             find_us);
+    // Lookups are meant to be cheap enough to do per use instead of caching
+    TEST_ASSERT_LESS_THAN(5.0f, find_us);
+    asset_bundle_deinit();
+}
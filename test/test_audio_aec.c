@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_dsp_fft.h"
+#include "audio_aec.h"
+
+#define TAG "TEST_AUDIO_AEC"
+#define SAMPLE_RATE   16000
+#define BLOCK         128
+#define ECHO_DELAY    80    // path delay beyond the configured bulk delay
+#define ECHO_TAPS     400
+
+static float s_ir[ECHO_TAPS];
+static int16_t s_history[2048];   // far-end history, indexed modulo size
+static uint32_t s_pos;
+
+static void make_echo_path(void) {
+    srand(11);
+    for (int i = 0; i < ECHO_TAPS; i++) {
+        float r = (float)rand() / RAND_MAX - 0.5f;
+        s_ir[i] = r * 0.6f * expf(-(float)i / 60.0f);
+    }
+}
+
+// Generate one block of far-end noise and the mic signal it produces
+static void render_block(int16_t* far, int16_t* mic, uint32_t bulk_delay, float near_amp) {
+    for (int i = 0; i < BLOCK; i++, s_pos++) {
+        far[i] = (int16_t)((rand() % 16001) - 8000);
+        s_history[s_pos & 2047] = far[i];
+
+        float echo = 0.0f;
+        for (int k = 0; k < ECHO_TAPS; k++) {
+            echo += s_ir[k] * s_history[(s_pos - bulk_delay - ECHO_DELAY - k) & 2047];
+        }
+        float near = near_amp * sinf(2.0f * (float)M_PI * 440.0f * s_pos / SAMPLE_RATE);
+        mic[i] = (int16_t)lrintf(echo + near);
+    }
+}
+
+static float energy(const int16_t* s, int n) {
+    float e = 0.0f;
+    for (int i = 0; i < n; i++) {
+        e += (float)s[i] * s[i];
+    }
+    return e;
+}
+
+TEST_CASE("Real FFT round trip", "[audio_dsp]") {
+    audio_dsp_rfft_f32_t fft;
+    static float data[256], ref[256];
+
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dsp_rfft_f32_init(&fft, 256));
+    for (int i = 0; i < 256; i++) {
+        ref[i] = data[i] = sinf(2.0f * (float)M_PI * 8 * i / 256) + 0.25f * (i & 1);
+    }
+    audio_dsp_rfft_f32_forward(&fft, data);
+    // Bin 8 holds the tone (n/2 magnitude), Nyquist holds the alternating part
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, -128.0f, data[2 * 8 + 1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, -32.0f, data[1]);
+    audio_dsp_rfft_f32_inverse(&fft, data);
+    for (int i = 0; i < 256; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, ref[i], data[i]);
+    }
+    audio_dsp_rfft_f32_deinit(&fft);
+}
+
+TEST_CASE("Echo canceller converges and keeps near-end speech", "[audio_aec]") {
+    audio_aec_config_t cfg = AUDIO_AEC_CONFIG_DEFAULT();
+    audio_aec_t* aec = NULL;
+    int16_t far[BLOCK], mic[BLOCK], clean[BLOCK];
+    uint32_t bulk = SAMPLE_RATE * cfg.bulk_delay_ms / 1000;
+    float in_e = 0.0f, out_e = 0.0f;
+
+    TEST_ASSERT_EQUAL(ESP_OK, audio_aec_create(&cfg, &aec));
+    make_echo_path();
+    memset(s_history, 0, sizeof(s_history));
+    s_pos = 0;
+
+    // Three seconds of far-end only
+    for (int b = 0; b < 3 * SAMPLE_RATE / BLOCK; b++) {
+        render_block(far, mic, bulk, 0.0f);
+        audio_aec_push_reference(aec, far, BLOCK);
+        if (b > 2 * SAMPLE_RATE / BLOCK) {
+            in_e += energy(mic, BLOCK);
+        }
+        audio_aec_process(aec, mic, BLOCK);
+        if (b > 2 * SAMPLE_RATE / BLOCK) {
+            out_e += energy(mic, BLOCK);
+        }
+    }
+
+    audio_aec_stats_t stats;
+    audio_aec_get_stats(aec, &stats);
+    float erle = 10.0f * log10f(in_e / out_e);
+    ESP_LOGI(TAG, "ERLE after 2 s: measured %.1f dB, reported %.1f dB", erle, stats.erle_db);
+    TEST_ASSERT_GREATER_THAN(20.0f, erle);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.resets);
+
+    // Double talk: the near-end tone must survive while echo stays cancelled
+    float err_e = 0.0f, near_e = 0.0f;
+    for (int b = 0; b < SAMPLE_RATE / BLOCK; b++) {
+        render_block(far, mic, bulk, 4000.0f);
+        for (int i = 0; i < BLOCK; i++) {
+            uint32_t t = s_pos - BLOCK + i;
+            clean[i] = (int16_t)lrintf(4000.0f * sinf(2.0f * (float)M_PI * 440.0f * t / SAMPLE_RATE));
+        }
+        audio_aec_push_reference(aec, far, BLOCK);
+        audio_aec_process(aec, mic, BLOCK);
+        for (int i = 0; i < BLOCK; i++) {
+            float d = (float)mic[i] - clean[i];
+            err_e += d * d;
+        }
+        near_e += energy(clean, BLOCK);
+    }
+    float snr = 10.0f * log10f(near_e / err_e);
+    ESP_LOGI(TAG, "Near-end to residual ratio during double talk: %.1f dB", snr);
+    TEST_ASSERT_GREATER_THAN(10.0f, snr);
+
+    audio_aec_destroy(aec);
+}
+
+TEST_CASE("Echo canceller cost per block", "[audio_aec][benchmark]") {
+    audio_aec_config_t cfg = AUDIO_AEC_CONFIG_DEFAULT();
+    audio_aec_t* aec = NULL;
+    int16_t far[BLOCK], mic[BLOCK];
+    uint32_t bulk = SAMPLE_RATE * cfg.bulk_delay_ms / 1000;
+
+    TEST_ASSERT_EQUAL(ESP_OK, audio_aec_create(&cfg, &aec));
+    make_echo_path();
+    s_pos = 0;
+
+    for (int b = 0; b < 200; b++) {
+        render_block(far, mic, bulk, 0.0f);
+        audio_aec_push_reference(aec, far, BLOCK);
+        audio_aec_process(aec, mic, BLOCK);
+    }
+
+    audio_aec_stats_t stats;
+    audio_aec_get_stats(aec, &stats);
+
+    // One block is 8 ms of audio
+    uint32_t budget = (uint32_t)((uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * BLOCK * 1000000ULL / SAMPLE_RATE);
+    ESP_LOGI(TAG, "%d-sample block, %d ms tail: %lu cycles (%.2f%% of one core at %d MHz)",
+             BLOCK, cfg.tail_ms, (unsigned long)stats.cycles_per_block,
+             100.0 * stats.cycles_per_block / budget, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+
+    audio_aec_destroy(aec);
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_codec.h"
+
+#define TAG "TEST_AUDIO_CODEC"
+
+#define TEST_SAMPLES 4800
+
+static int16_t s_pcm[TEST_SAMPLES];
+static int16_t s_decoded[TEST_SAMPLES];
+static uint8_t s_encoded[TEST_SAMPLES * 2];
+
+static void make_tone(float freq, float amp) {
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        s_pcm[i] = (int16_t)lrintf(amp * sinf(2.0f * (float)M_PI * freq * i / 16000));
+    }
+}
+
+static float snr_db(const int16_t* ref, const int16_t* test, int count) {
+    double sig = 0, err = 0;
+    for (int i = 0; i < count; i++) {
+        sig += (double)ref[i] * ref[i];
+        err += (double)(ref[i] - test[i]) * (ref[i] - test[i]);
+    }
+    return (float)(10.0 * log10(sig / (err + 1e-9)));
+}
+
+TEST_CASE("G.711 codes survive a decode/encode round trip", "[audio_codec]") {
+    static const audio_codec_type_t types[] = { AUDIO_CODEC_G711_ULAW, AUDIO_CODEC_G711_ALAW };
+
+    for (int t = 0; t < 2; t++) {
+        audio_codec_t codec;
+        audio_codec_init(&codec, types[t]);
+        for (int code = 0; code < 256; code++) {
+            uint8_t in = (uint8_t)code, out;
+            int16_t pcm;
+            audio_codec_decode(&codec, &in, 1, &pcm);
+            audio_codec_encode(&codec, &pcm, 1, &out);
+            // μ-law has two codes for zero; both decode to the same value
+            int16_t again;
+            audio_codec_decode(&codec, &out, 1, &again);
+            TEST_ASSERT_EQUAL_INT16(pcm, again);
+        }
+    }
+}
+
+TEST_CASE("G.711 quantization error stays within the segment step", "[audio_codec]") {
+    static const audio_codec_type_t types[] = { AUDIO_CODEC_G711_ULAW, AUDIO_CODEC_G711_ALAW };
+
+    for (int t = 0; t < 2; t++) {
+        audio_codec_t codec;
+        audio_codec_init(&codec, types[t]);
+        for (int32_t x = INT16_MIN; x <= INT16_MAX; x += 7) {
+            int16_t pcm = (int16_t)x, decoded;
+            uint8_t code;
+            audio_codec_encode(&codec, &pcm, 1, &code);
+            audio_codec_decode(&codec, &code, 1, &decoded);
+            // Step size grows with the segment, roughly |x| / 16; the error
+            // is at most half a step, plus clipping at full scale
+            int32_t err = abs(x - decoded);
+            TEST_ASSERT_LESS_OR_EQUAL(abs(x) / 32 + 16, err);
+        }
+
+        make_tone(1000.0f, 12000.0f);
+        audio_codec_encode(&codec, s_pcm, TEST_SAMPLES, s_encoded);
+        audio_codec_decode(&codec, s_encoded, TEST_SAMPLES, s_decoded);
+        float snr = snr_db(s_pcm, s_decoded, TEST_SAMPLES);
+        ESP_LOGI(TAG, "%s SNR %.1f dB", audio_codec_name(types[t]), snr);
+        TEST_ASSERT_GREATER_THAN(30.0f, snr);
+    }
+}
+
+TEST_CASE("IMA-ADPCM streams across chunks and tracks a tone", "[audio_codec]") {
+    audio_codec_t enc, dec, enc_chunked;
+    audio_codec_init(&enc, AUDIO_CODEC_IMA_ADPCM);
+    audio_codec_init(&dec, AUDIO_CODEC_IMA_ADPCM);
+    audio_codec_init(&enc_chunked, AUDIO_CODEC_IMA_ADPCM);
+    make_tone(440.0f, 10000.0f);
+
+    size_t bytes = audio_codec_encode(&enc, s_pcm, TEST_SAMPLES, s_encoded);
+    TEST_ASSERT_EQUAL(TEST_SAMPLES / 2, bytes);
+    TEST_ASSERT_EQUAL(TEST_SAMPLES, audio_codec_decode(&dec, s_encoded, bytes, s_decoded));
+
+    // Skip the step-size ramp at the start
+    float snr = snr_db(s_pcm + 160, s_decoded + 160, TEST_SAMPLES - 160);
+    ESP_LOGI(TAG, "ima_adpcm SNR %.1f dB", snr);
+    TEST_ASSERT_GREATER_THAN(20.0f, snr);
+
+    // The same stream encoded in uneven, even-length chunks is bit identical
+    static uint8_t chunked[TEST_SAMPLES / 2];
+    size_t used = 0, out = 0;
+    static const size_t chunks[] = { 2, 160, 318, 640 };
+    for (int c = 0; used < TEST_SAMPLES; c = (c + 1) % 4) {
+        size_t n = chunks[c] < TEST_SAMPLES - used ? chunks[c] : TEST_SAMPLES - used;
+        out += audio_codec_encode(&enc_chunked, s_pcm + used, n, chunked + out);
+        used += n;
+    }
+    TEST_ASSERT_EQUAL(bytes, out);
+    TEST_ASSERT_EQUAL_MEMORY(s_encoded, chunked, bytes);
+}
+
+TEST_CASE("Codec names round trip", "[audio_codec]") {
+    for (int t = 0; t < AUDIO_CODEC_MAX; t++) {
+        audio_codec_type_t type;
+        TEST_ASSERT_TRUE(audio_codec_from_name(audio_codec_name((audio_codec_type_t)t), &type));
+        TEST_ASSERT_EQUAL(t, type);
+    }
+    audio_codec_type_t type;
+    TEST_ASSERT_FALSE(audio_codec_from_name("opus", &type));
+}
+
+TEST_CASE("Only PCM16 and G.711 go on the wire", "[audio_codec]") {
+    TEST_ASSERT_TRUE(audio_codec_is_wire_format(AUDIO_CODEC_PCM16));
+    TEST_ASSERT_TRUE(audio_codec_is_wire_format(AUDIO_CODEC_G711_ULAW));
+    TEST_ASSERT_TRUE(audio_codec_is_wire_format(AUDIO_CODEC_G711_ALAW));
+    TEST_ASSERT_FALSE(audio_codec_is_wire_format(AUDIO_CODEC_IMA_ADPCM));
+}
+
+TEST_CASE("Codec throughput", "[audio_codec][benchmark]") {
+    make_tone(440.0f, 10000.0f);
+
+    for (int t = 0; t < AUDIO_CODEC_MAX; t++) {
+        audio_codec_t codec;
+        audio_codec_init(&codec, (audio_codec_type_t)t);
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        size_t bytes = audio_codec_encode(&codec, s_pcm, TEST_SAMPLES, s_encoded);
+        uint32_t enc_cycles = esp_cpu_get_cycle_count() - start;
+
+        audio_codec_reset(&codec);
+        start = esp_cpu_get_cycle_count();
+        audio_codec_decode(&codec, s_encoded, bytes, s_decoded);
+        uint32_t dec_cycles = esp_cpu_get_cycle_count() - start;
+
+        // Throughput is measured in MB of PCM16 processed per second
+        double pcm_mb = TEST_SAMPLES * sizeof(int16_t) / 1e6;
+        double hz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6;
+        ESP_LOGI(TAG, "%-10s encode %.1f MB/s, decode %.1f MB/s (%.1f / %.1f cycles/sample), %u:1",
+                 audio_codec_name((audio_codec_type_t)t),
+                 pcm_mb / (enc_cycles / hz), pcm_mb / (dec_cycles / hz),
+                 (double)enc_cycles / TEST_SAMPLES, (double)dec_cycles / TEST_SAMPLES,
+                 (unsigned)(TEST_SAMPLES * sizeof(int16_t) / bytes));
+    }
+}
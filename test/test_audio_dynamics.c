@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_dynamics.h"
+
+#define TAG "TEST_AUDIO_DYNAMICS"
+#define FRAME_SAMPLES 320   // 20 ms at 16 kHz
+#define LOOKAHEAD 32        // 2 ms at 16 kHz
+
+static int16_t s_frame[FRAME_SAMPLES];
+
+static void sine(int16_t* buf, size_t count, size_t start, int32_t amplitude) {
+    for (size_t i = 0; i < count; i++) {
+        buf[i] = (int16_t)(amplitude * sinf(2.0f * (float)M_PI * 440.0f * (float)(start + i) / 16000.0f));
+    }
+}
+
+static int32_t peak(const int16_t* buf, size_t count) {
+    int32_t p = 0;
+    for (size_t i = 0; i < count; i++) {
+        p = abs(buf[i]) > p ? abs(buf[i]) : p;
+    }
+    return p;
+}
+
+TEST_CASE("Dynamics without gain is a pure delay", "[audio_dynamics]") {
+    audio_dynamics_config_t cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    cfg.ratio = 1;
+    cfg.makeup_db = 0;
+    cfg.ceiling_db = 0;
+    audio_dynamics_t* dyn = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dynamics_create(&cfg, &dyn));
+    TEST_ASSERT_EQUAL(16, audio_dynamics_block_samples(dyn));
+
+    static int16_t in[2 * FRAME_SAMPLES];
+    static int16_t out[2 * FRAME_SAMPLES + LOOKAHEAD];
+    sine(in, 2 * FRAME_SAMPLES, 0, 8000);
+    memcpy(out, in, sizeof(in));
+    audio_dynamics_process(dyn, out, FRAME_SAMPLES);
+    audio_dynamics_process(dyn, out + FRAME_SAMPLES, FRAME_SAMPLES);
+    TEST_ASSERT_EQUAL(LOOKAHEAD, audio_dynamics_drain(dyn, out + 2 * FRAME_SAMPLES));
+    TEST_ASSERT_EQUAL(0, audio_dynamics_drain(dyn, s_frame));
+
+    TEST_ASSERT_EQUAL(0, peak(out, LOOKAHEAD));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(in, out + LOOKAHEAD, 2 * FRAME_SAMPLES);
+
+    audio_dynamics_stats_t stats;
+    audio_dynamics_get_stats(dyn, &stats);
+    TEST_ASSERT_EQUAL(0, stats.limited_blocks);
+    audio_dynamics_destroy(dyn);
+}
+
+TEST_CASE("Limiter holds the ceiling on a sudden full-scale burst", "[audio_dynamics]") {
+    audio_dynamics_config_t cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    audio_dynamics_t* dyn = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dynamics_create(&cfg, &dyn));
+    const int32_t ceiling = (int32_t)(32768.0f * powf(10.0f, -1.0f / 20.0f));
+
+    // Quiet speech-level tone, then full-scale square wave edges with the
+    // makeup gain on top: the worst case for a driver that cannot clip
+    int32_t max_out = 0;
+    int32_t quiet_peak = 0;
+    for (int f = 0; f < 50; f++) {
+        if (f < 10) {
+            sine(s_frame, FRAME_SAMPLES, f * FRAME_SAMPLES, 2000);
+        } else {
+            for (int i = 0; i < FRAME_SAMPLES; i++) {
+                s_frame[i] = (i / 18) % 2 ? INT16_MAX : -INT16_MAX;
+            }
+        }
+        audio_dynamics_process(dyn, s_frame, FRAME_SAMPLES);
+        int32_t p = peak(s_frame, FRAME_SAMPLES);
+        max_out = p > max_out ? p : max_out;
+        if (f == 9) {
+            quiet_peak = p;
+        }
+    }
+    ESP_LOGI(TAG, "Quiet tone 2000 -> %ld, burst peak %ld (ceiling %ld)", (long)quiet_peak, (long)max_out,
+             (long)ceiling);
+    TEST_ASSERT_LESS_OR_EQUAL(ceiling, max_out);
+    // The burst still plays close to the ceiling, not ducked far below it
+    TEST_ASSERT_GREATER_THAN(ceiling * 9 / 10, max_out);
+    // Below the threshold the makeup gain (+6 dB) lifts quiet audio
+    TEST_ASSERT_INT_WITHIN(200, 4000, quiet_peak);
+
+    audio_dynamics_stats_t stats;
+    audio_dynamics_get_stats(dyn, &stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.limited_blocks);
+    TEST_ASSERT_GREATER_THAN(0, stats.compressed_blocks);
+    audio_dynamics_destroy(dyn);
+}
+
+TEST_CASE("Compressor settles at the ratio above the threshold", "[audio_dynamics]") {
+    audio_dynamics_config_t cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    cfg.makeup_db = 0;
+    audio_dynamics_t* dyn = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dynamics_create(&cfg, &dyn));
+
+    // -6 dBFS is 12 dB over a -18 dB threshold; 3:1 leaves 4 dB, so -14 dBFS
+    for (int f = 0; f < 50; f++) {
+        sine(s_frame, FRAME_SAMPLES, f * FRAME_SAMPLES, 16384);
+        audio_dynamics_process(dyn, s_frame, FRAME_SAMPLES);
+    }
+    float out_db = 20.0f * log10f((float)peak(s_frame, FRAME_SAMPLES) / 32768.0f);
+    ESP_LOGI(TAG, "-6 dBFS in, %.1f dBFS out", out_db);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, -14.0f, out_db);
+    audio_dynamics_destroy(dyn);
+}
+
+TEST_CASE("Volume changes ramp without steps", "[audio_dynamics]") {
+    audio_dynamics_config_t cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    cfg.ratio = 1;
+    cfg.makeup_db = 0;
+    audio_dynamics_t* dyn = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dynamics_create(&cfg, &dyn));
+
+    // DC makes the gain visible sample by sample
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        s_frame[i] = 16000;
+    }
+    audio_dynamics_process(dyn, s_frame, FRAME_SAMPLES);
+    audio_dynamics_set_volume(dyn, 50);
+    int16_t last = s_frame[FRAME_SAMPLES - 1];
+    int32_t max_step = 0;
+    for (int f = 0; f < 6; f++) {
+        for (int i = 0; i < FRAME_SAMPLES; i++) {
+            s_frame[i] = 16000;
+        }
+        audio_dynamics_process(dyn, s_frame, FRAME_SAMPLES);
+        for (int i = 0; i < FRAME_SAMPLES; i++) {
+            int32_t step = abs(s_frame[i] - last);
+            max_step = step > max_step ? step : max_step;
+            last = s_frame[i];
+        }
+    }
+    ESP_LOGI(TAG, "Volume 100 -> 50 %%: level %d, largest step %ld", last, (long)max_step);
+    // 50 % is a quarter of the gain, reached in 37.5 ms of the 50 ms ramp;
+    // per sample the gain moves at most two Q10 steps
+    TEST_ASSERT_INT_WITHIN(20, 4000, last);
+    TEST_ASSERT_LESS_OR_EQUAL(16000 * 2 / 1024 + 2, max_step);
+    audio_dynamics_destroy(dyn);
+}
+
+TEST_CASE("Dynamics cost per 20 ms frame", "[audio_dynamics][benchmark]") {
+    const int iterations = 100;
+    audio_dynamics_config_t cfg = AUDIO_DYNAMICS_CONFIG_DEFAULT();
+    audio_dynamics_t* dyn = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dynamics_create(&cfg, &dyn));
+
+    uint32_t cycles = 0;
+    for (int i = 0; i < iterations; i++) {
+        sine(s_frame, FRAME_SAMPLES, i * FRAME_SAMPLES, i % 2 ? 30000 : 3000);
+        uint32_t start = esp_cpu_get_cycle_count();
+        audio_dynamics_process(dyn, s_frame, FRAME_SAMPLES);
+        cycles += esp_cpu_get_cycle_count() - start;
+    }
+    ESP_LOGI(TAG, "%lu cycles per 20 ms frame (%.3f%% of a core)", (unsigned long)(cycles / iterations),
+             100.0 * cycles / iterations / (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 * 0.02));
+    audio_dynamics_destroy(dyn);
+}
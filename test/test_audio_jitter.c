@@ -0,0 +1,265 @@
+#include <stdint.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "audio_jitter.h"
+
+#define TAG "TEST_AUDIO_JITTER"
+
+#define SIM_CHUNK_MS        40
+#define SIM_CHUNK_SAMPLES   (SIM_CHUNK_MS * 16)
+#define SIM_PERIOD_MS       20
+#define SIM_PERIOD_SAMPLES  (SIM_PERIOD_MS * 16)
+#define SIM_PAUSE_MS        2000
+
+typedef struct {
+    uint32_t chunks;            ///< Per response
+    uint32_t responses;         ///< Separated by SIM_PAUSE_MS; 0 counts as 1
+    uint32_t jitter_ms;         ///< Arrival delay is uniform in 0 .. jitter_ms
+    uint32_t stall_every;       ///< Every Nth chunk is held back stall_ms, 0 for none
+    uint32_t stall_ms;
+    uint32_t seed;
+} sim_network_t;
+
+typedef struct {
+    uint32_t samples_out;
+    uint32_t out_of_order;
+    uint32_t first_play_ms;
+    audio_jitter_stats_t stats;
+} sim_result_t;
+
+static uint32_t next_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// Sends a counting ramp through the network model into the buffer while a
+// consumer takes one playout period every SIM_PERIOD_MS, on a 1 ms clock
+static void simulate(const audio_jitter_config_t* config, const sim_network_t* net, sim_result_t* result) {
+    audio_jitter_t* jb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_jitter_create(config, &jb));
+    memset(result, 0, sizeof(*result));
+
+    static int16_t chunk[SIM_CHUNK_SAMPLES];
+    int16_t period[SIM_PERIOD_SAMPLES];
+    uint32_t rng = net->seed;
+    uint32_t sent = 0;
+    uint32_t next_value = 0;
+    int64_t prev_arrival = 0;
+    int64_t arrival = 0;
+    bool have_arrival = false;
+
+    const uint32_t responses = net->responses ? net->responses : 1;
+    const uint32_t total = net->chunks * responses;
+    const uint32_t response_ms = net->chunks * SIM_CHUNK_MS + SIM_PAUSE_MS;
+    const uint32_t end_ms = responses * response_ms + 1000;
+    for (uint32_t t = 0; t < end_ms; t++) {
+        while (sent < total) {
+            if (!have_arrival) {
+                // The network keeps chunks in order, so a delayed one holds
+                // back the ones behind it
+                arrival = (int64_t)(sent / net->chunks) * response_ms + (int64_t)(sent % net->chunks) * SIM_CHUNK_MS +
+                          (net->jitter_ms ? next_rand(&rng) % (net->jitter_ms + 1) : 0);
+                if (net->stall_every && sent % net->stall_every == net->stall_every - 1) {
+                    arrival += net->stall_ms;
+                }
+                arrival = arrival > prev_arrival ? arrival : prev_arrival;
+                have_arrival = true;
+            }
+            if (arrival > t) {
+                break;
+            }
+            for (int i = 0; i < SIM_CHUNK_SAMPLES; i++) {
+                chunk[i] = (int16_t)((sent * SIM_CHUNK_SAMPLES + i) & 0x7FFF);
+            }
+            audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, (int64_t)t * 1000);
+            prev_arrival = arrival;
+            have_arrival = false;
+            sent++;
+        }
+
+        if (t % SIM_PERIOD_MS == 0) {
+            size_t got = audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, (int64_t)t * 1000);
+            if (got > 0 && result->samples_out == 0) {
+                result->first_play_ms = t;
+            }
+            for (size_t i = 0; i < got; i++) {
+                if (period[i] != (int16_t)(next_value & 0x7FFF)) {
+                    result->out_of_order++;
+                }
+                next_value++;
+            }
+            result->samples_out += got;
+        }
+    }
+
+    audio_jitter_get_stats(jb, &result->stats);
+    audio_jitter_destroy(jb);
+}
+
+TEST_CASE("Jitter buffer plays every sample in order", "[audio_jitter]") {
+    audio_jitter_config_t config = AUDIO_JITTER_CONFIG_DEFAULT();
+    sim_network_t net = { .chunks = 500, .jitter_ms = 120, .stall_every = 100, .stall_ms = 400, .seed = 1 };
+    sim_result_t r;
+    simulate(&config, &net, &r);
+
+    TEST_ASSERT_EQUAL_UINT32(net.chunks * SIM_CHUNK_SAMPLES, r.samples_out);
+    TEST_ASSERT_EQUAL_UINT32(0, r.out_of_order);
+    TEST_ASSERT_EQUAL_UINT32(0, r.stats.dropped_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, r.stats.depth_ms);
+    TEST_ASSERT_EQUAL_UINT32(net.chunks, r.stats.chunks);
+}
+
+TEST_CASE("Jitter buffer target follows arrival jitter", "[audio_jitter]") {
+    audio_jitter_config_t config = AUDIO_JITTER_CONFIG_DEFAULT();
+    sim_result_t r;
+
+    sim_network_t steady = { .chunks = 250, .seed = 2 };
+    simulate(&config, &steady, &r);
+    ESP_LOGI(TAG, "Steady: jitter %u ms, target %u ms, late %u, early %u",
+             r.stats.jitter_ms, r.stats.target_ms, r.stats.late, r.stats.early);
+    TEST_ASSERT_EQUAL_UINT32(0, r.stats.jitter_ms);
+    TEST_ASSERT_EQUAL_UINT32(config.start_ms, r.stats.target_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, r.stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, r.stats.early);
+    // The chunk arriving at 40 ms brings the depth to the start threshold
+    TEST_ASSERT_EQUAL_UINT32(config.start_ms - SIM_CHUNK_MS, r.first_play_ms);
+
+    // Delays uniform in 0 .. 150 ms would differ by 50 ms on average; in
+    // order delivery bunches the late ones and takes that down to about 30
+    sim_network_t bursty = { .chunks = 250, .jitter_ms = 150, .seed = 3 };
+    simulate(&config, &bursty, &r);
+    ESP_LOGI(TAG, "Bursty: jitter %u ms, target %u ms, late %u, early %u, gaps %u ms",
+             r.stats.jitter_ms, r.stats.target_ms, r.stats.late, r.stats.early, r.stats.gap_ms);
+    TEST_ASSERT_UINT32_WITHIN(15, 30, r.stats.jitter_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(r.stats.jitter_ms * AUDIO_JITTER_MULT, r.stats.target_ms);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(config.max_ms, r.stats.target_ms);
+}
+
+// A clean link delivering 100 ms chunks every 100 ms, each stored whole or
+// in slices the way the playout task decodes it
+static void put_periodic(uint32_t slices, audio_jitter_stats_t* stats) {
+    audio_jitter_config_t config = AUDIO_JITTER_CONFIG_DEFAULT();
+    audio_jitter_t* jb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_jitter_create(&config, &jb));
+    static int16_t chunk[1600];
+    int16_t period[SIM_PERIOD_SAMPLES];
+    memset(chunk, 0, sizeof(chunk));
+
+    for (uint32_t t = 0; t < 5000; t += SIM_PERIOD_MS) {
+        if (t % 100 == 0) {
+            const size_t slice = sizeof(chunk) / sizeof(chunk[0]) / slices;
+            TEST_ASSERT_EQUAL(slice, audio_jitter_put(jb, chunk, slice, (int64_t)t * 1000));
+            for (uint32_t s = 1; s < slices; s++) {
+                TEST_ASSERT_EQUAL(slice, audio_jitter_append(jb, chunk + s * slice, slice));
+            }
+        }
+        audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, (int64_t)t * 1000);
+    }
+    audio_jitter_get_stats(jb, stats);
+    audio_jitter_destroy(jb);
+}
+
+TEST_CASE("Slices of one chunk are one arrival", "[audio_jitter]") {
+    audio_jitter_stats_t whole;
+    audio_jitter_stats_t sliced;
+    put_periodic(1, &whole);
+    put_periodic(5, &sliced);
+    ESP_LOGI(TAG, "Periodic 100 ms chunks: jitter %u ms whole, %u ms in five slices; target %u / %u ms",
+             whole.jitter_ms, sliced.jitter_ms, whole.target_ms, sliced.target_ms);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, sliced.jitter_ms);
+    TEST_ASSERT_EQUAL_UINT32(whole.jitter_ms, sliced.jitter_ms);
+    TEST_ASSERT_EQUAL_UINT32(whole.target_ms, sliced.target_ms);
+    TEST_ASSERT_EQUAL_UINT32(whole.chunks, sliced.chunks);
+    TEST_ASSERT_EQUAL_UINT32(whole.early, sliced.early);
+}
+
+TEST_CASE("Adaptive target cuts gaps against a fixed start threshold", "[audio_jitter]") {
+    audio_jitter_config_t adaptive = AUDIO_JITTER_CONFIG_DEFAULT();
+    audio_jitter_config_t fixed = AUDIO_JITTER_CONFIG_DEFAULT();
+    fixed.max_ms = fixed.start_ms;
+    sim_network_t net = { .chunks = 100, .responses = 10, .jitter_ms = 60, .stall_every = 25, .stall_ms = 150, .seed = 4 };
+    sim_result_t a, f;
+
+    simulate(&adaptive, &net, &a);
+    simulate(&fixed, &net, &f);
+    ESP_LOGI(TAG, "Fixed %u ms: late %u, gaps %u ms", (unsigned)fixed.start_ms, f.stats.late, f.stats.gap_ms);
+    ESP_LOGI(TAG, "Adaptive: target %u ms, late %u, gaps %u ms", a.stats.target_ms, a.stats.late, a.stats.gap_ms);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, f.stats.late);
+    TEST_ASSERT_LESS_THAN_UINT32(f.stats.late / 2, a.stats.late);
+    TEST_ASSERT_LESS_THAN_UINT32(f.stats.gap_ms / 2, a.stats.gap_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, a.out_of_order);
+}
+
+TEST_CASE("Jitter buffer counts late and early chunks", "[audio_jitter]") {
+    audio_jitter_config_t config = AUDIO_JITTER_CONFIG_DEFAULT();
+    audio_jitter_t* jb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_jitter_create(&config, &jb));
+    static int16_t chunk[SIM_CHUNK_SAMPLES];
+    int16_t period[SIM_PERIOD_SAMPLES];
+    audio_jitter_stats_t stats;
+
+    // A burst of 10 chunks at once: the ones past twice the start depth are early
+    for (int i = 0; i < 10; i++) {
+        audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, 0);
+    }
+    audio_jitter_get_stats(jb, &stats);
+    TEST_ASSERT_EQUAL_UINT32(10 - 2 * config.start_ms / SIM_CHUNK_MS - 1, stats.early);
+    TEST_ASSERT_EQUAL_UINT32(400, stats.depth_ms);
+
+    // Drain it, then the next chunk comes 100 ms after playback ran dry
+    int64_t t = 0;
+    while (audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, t) == SIM_PERIOD_SAMPLES) {
+        t += SIM_PERIOD_MS * 1000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, audio_jitter_depth_ms(jb));
+    audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, t + 100000);
+    audio_jitter_get_stats(jb, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.gap_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(config.start_ms + AUDIO_JITTER_LATE_STEP_MS, stats.target_ms);
+
+    // After a long silence a chunk starts a new stream and is not late
+    audio_jitter_flush(jb);
+    audio_jitter_reset_stats(jb);
+    t += 1000000;
+    audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, t);
+    t += config.max_ms * 1000;
+    while (audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, t) == SIM_PERIOD_SAMPLES) {
+        t += SIM_PERIOD_MS * 1000;
+    }
+    audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, t + AUDIO_JITTER_TALKSPURT_MS * 1000);
+    audio_jitter_get_stats(jb, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.gap_ms);
+
+    audio_jitter_destroy(jb);
+}
+
+TEST_CASE("Jitter buffer plays out a short tail once arrivals stop", "[audio_jitter]") {
+    audio_jitter_config_t config = AUDIO_JITTER_CONFIG_DEFAULT();
+    audio_jitter_t* jb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_jitter_create(&config, &jb));
+    static int16_t chunk[SIM_CHUNK_SAMPLES];
+    int16_t period[SIM_PERIOD_SAMPLES];
+
+    // Less than the start depth: held until a target's worth of silence
+    audio_jitter_put(jb, chunk, SIM_PERIOD_SAMPLES + 100, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, (config.start_ms - 1) * 1000));
+    TEST_ASSERT_EQUAL_UINT32(SIM_PERIOD_SAMPLES, audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, config.start_ms * 1000));
+    TEST_ASSERT_EQUAL_UINT32(100, audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, (config.start_ms + SIM_PERIOD_MS) * 1000));
+    TEST_ASSERT_EQUAL_UINT32(0, audio_jitter_get(jb, period, SIM_PERIOD_SAMPLES, (config.start_ms + 2 * SIM_PERIOD_MS) * 1000));
+
+    // Storage is bounded; the excess is dropped and counted
+    audio_jitter_stats_t stats;
+    for (uint32_t i = 0; i < config.capacity_ms / SIM_CHUNK_MS + 5; i++) {
+        audio_jitter_put(jb, chunk, SIM_CHUNK_SAMPLES, 5000000);
+    }
+    audio_jitter_get_stats(jb, &stats);
+    TEST_ASSERT_EQUAL_UINT32(config.capacity_ms, stats.depth_ms);
+    TEST_ASSERT_EQUAL_UINT32(config.capacity_ms, stats.max_depth_ms);
+    TEST_ASSERT_EQUAL_UINT32(5 * SIM_CHUNK_MS - config.capacity_ms % SIM_CHUNK_MS, stats.dropped_ms);
+
+    audio_jitter_destroy(jb);
+}
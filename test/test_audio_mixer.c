@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_dsp.h"
+#include "audio_mixer.h"
+
+#define TAG "TEST_AUDIO_MIXER"
+#define PERIOD_SAMPLES 320  // 20 ms at 16 kHz
+
+static int16_t s_in[AUDIO_MIXER_MAX_CHANNELS][PERIOD_SAMPLES] __attribute__((aligned(16)));
+static int16_t s_out[PERIOD_SAMPLES] __attribute__((aligned(16)));
+
+static void fill(int16_t* buf, size_t count, int16_t value) {
+    for (size_t i = 0; i < count; i++) {
+        buf[i] = value;
+    }
+}
+
+TEST_CASE("Saturating mix and gain ramp match the scalar reference", "[audio_dsp]") {
+    static int16_t ref[PERIOD_SAMPLES + 5];
+    static int16_t dst[PERIOD_SAMPLES + 5] __attribute__((aligned(16)));
+    static int16_t src[PERIOD_SAMPLES + 5] __attribute__((aligned(16)));
+
+    srand(11);
+    for (int i = 0; i < PERIOD_SAMPLES + 5; i++) {
+        dst[i] = (int16_t)(rand() & 0xFFFF);
+        src[i] = (int16_t)(rand() & 0xFFFF);
+        int32_t sum = (int32_t)dst[i] + src[i];
+        ref[i] = (int16_t)(sum > INT16_MAX ? INT16_MAX : (sum < INT16_MIN ? INT16_MIN : sum));
+    }
+    // Odd length exercises the vector body and the scalar tail together
+    audio_dsp_mix_s16(dst, src, PERIOD_SAMPLES + 5);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(ref, dst, PERIOD_SAMPLES + 5);
+
+    // A ramp moves by at most one step per sample and lands on the target
+    fill(dst, PERIOD_SAMPLES, 20000);
+    audio_dsp_gain_ramp_s16(dst, PERIOD_SAMPLES, AUDIO_DSP_GAIN_UNITY, 256);
+    for (int i = 1; i < PERIOD_SAMPLES; i++) {
+        TEST_ASSERT_LESS_OR_EQUAL(dst[i - 1], dst[i]);
+        TEST_ASSERT_INT_WITHIN(20000 * 768 / 1024 / PERIOD_SAMPLES + 20, dst[i - 1], dst[i]);
+    }
+    TEST_ASSERT_EQUAL_INT16(5000, dst[PERIOD_SAMPLES - 1]);
+}
+
+TEST_CASE("Mixer sums channels with saturation and pads short writes", "[audio_mixer]") {
+    audio_mixer_config_t cfg = AUDIO_MIXER_CONFIG_DEFAULT();
+    audio_mixer_t* mixer = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mixer_create(&cfg, &mixer));
+    TEST_ASSERT_EQUAL(PERIOD_SAMPLES, audio_mixer_period_samples(mixer));
+    TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer, s_out));
+
+    fill(s_in[0], PERIOD_SAMPLES, 20000);
+    fill(s_in[1], PERIOD_SAMPLES, 20000);
+    TEST_ASSERT_EQUAL(PERIOD_SAMPLES, audio_mixer_write(mixer, 0, s_in[0], PERIOD_SAMPLES));
+    TEST_ASSERT_EQUAL(100, audio_mixer_write(mixer, 1, s_in[1], 100));
+    TEST_ASSERT_TRUE(audio_mixer_is_busy(mixer));
+
+    TEST_ASSERT_EQUAL(PERIOD_SAMPLES, audio_mixer_mix(mixer, s_out));
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, s_out[0]);
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, s_out[99]);
+    TEST_ASSERT_EQUAL_INT16(20000, s_out[100]);
+    TEST_ASSERT_EQUAL_INT16(20000, s_out[PERIOD_SAMPLES - 1]);
+
+    // Drained: nothing more is produced
+    TEST_ASSERT_FALSE(audio_mixer_is_busy(mixer));
+    TEST_ASSERT_EQUAL(0, audio_mixer_mix(mixer, s_out));
+
+    // A full queue takes what fits
+    size_t queued = 0;
+    for (int i = 0; i < 20; i++) {
+        queued += audio_mixer_write(mixer, 0, s_in[0], PERIOD_SAMPLES);
+    }
+    TEST_ASSERT_EQUAL(cfg.queue_periods * PERIOD_SAMPLES, queued);
+    audio_mixer_flush(mixer, 0);
+    TEST_ASSERT_FALSE(audio_mixer_is_busy(mixer));
+
+    audio_mixer_destroy(mixer);
+}
+
+TEST_CASE("Mixer ducks a channel under another without zipper steps", "[audio_mixer]") {
+    audio_mixer_config_t cfg = AUDIO_MIXER_CONFIG_DEFAULT();
+    cfg.ramp_ms = 40;
+    audio_mixer_t* mixer = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mixer_create(&cfg, &mixer));
+    audio_mixer_set_duck(mixer, 1, 256);    // channel 1 pulls others to -12 dB
+
+    // Voice at a constant level; the second channel plays silence from
+    // period 2 to 5, so the output shows the voice gain alone
+    fill(s_in[0], PERIOD_SAMPLES, 16000);
+    fill(s_in[1], PERIOD_SAMPLES, 0);
+    int16_t last = 16000;
+    int32_t max_jump = 0;
+    for (int p = 0; p < 10; p++) {
+        audio_mixer_write(mixer, 0, s_in[0], PERIOD_SAMPLES);
+        if (p >= 2 && p < 6) {
+            audio_mixer_write(mixer, 1, s_in[1], PERIOD_SAMPLES);
+        }
+        TEST_ASSERT_EQUAL(PERIOD_SAMPLES, audio_mixer_mix(mixer, s_out));
+        for (int i = 0; i < PERIOD_SAMPLES; i++) {
+            int32_t jump = abs(s_out[i] - last);
+            max_jump = jump > max_jump ? jump : max_jump;
+            last = s_out[i];
+        }
+        ESP_LOGI(TAG, "Period %d ends at %d", p, s_out[PERIOD_SAMPLES - 1]);
+        if (p == 1 || p == 9) {
+            TEST_ASSERT_EQUAL_INT16(16000, s_out[PERIOD_SAMPLES - 1]);
+        } else if (p == 3 || p == 5) {
+            // Two periods of ramp reach the ducked level
+            TEST_ASSERT_EQUAL_INT16(4000, s_out[PERIOD_SAMPLES - 1]);
+        }
+    }
+    // 12000 over 40 ms of samples, plus rounding
+    TEST_ASSERT_LESS_OR_EQUAL(12000 / 640 + 16, max_jump);
+
+    // Gain changes ramp the same way: half of unity takes one period
+    audio_mixer_set_gain(mixer, 0, 512);
+    audio_mixer_write(mixer, 0, s_in[0], PERIOD_SAMPLES);
+    audio_mixer_mix(mixer, s_out);
+    TEST_ASSERT_INT_WITHIN(50, 12000, s_out[PERIOD_SAMPLES / 2 - 1]);
+    TEST_ASSERT_EQUAL_INT16(8000, s_out[PERIOD_SAMPLES - 1]);
+
+    audio_mixer_destroy(mixer);
+}
+
+TEST_CASE("Mixer cost per channel per period", "[audio_mixer][benchmark]") {
+    const int iterations = 100;
+
+    for (uint32_t channels = 1; channels <= 4; channels *= 2) {
+        audio_mixer_config_t cfg = AUDIO_MIXER_CONFIG_DEFAULT();
+        cfg.channels = channels;
+        audio_mixer_t* mixer = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_mixer_create(&cfg, &mixer));
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            for (int i = 0; i < PERIOD_SAMPLES; i++) {
+                s_in[ch][i] = (int16_t)((i * 97 + ch * 1000) % 20000 - 10000);
+            }
+        }
+
+        // Unity gain (straight add) and a constant gain (scale, then add)
+        for (int scaled = 0; scaled < 2; scaled++) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                audio_mixer_set_gain(mixer, ch, scaled ? 700 : AUDIO_DSP_GAIN_UNITY);
+            }
+            // Let the gains settle before measuring
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                audio_mixer_write(mixer, ch, s_in[ch], PERIOD_SAMPLES);
+            }
+            audio_mixer_mix(mixer, s_out);
+
+            uint32_t cycles = 0;
+            for (int i = 0; i < iterations; i++) {
+                for (uint32_t ch = 0; ch < channels; ch++) {
+                    audio_mixer_write(mixer, ch, s_in[ch], PERIOD_SAMPLES);
+                }
+                uint32_t start = esp_cpu_get_cycle_count();
+                audio_mixer_mix(mixer, s_out);
+                cycles += esp_cpu_get_cycle_count() - start;
+            }
+            ESP_LOGI(TAG, "%lu channel(s), %s gain: %lu cycles per 20 ms period, %lu per channel (%.3f%% of a core)",
+                     (unsigned long)channels, scaled ? "Q10" : "unity", (unsigned long)(cycles / iterations),
+                     (unsigned long)(cycles / iterations / channels),
+                     100.0 * cycles / iterations / (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 * 0.02));
+        }
+        audio_mixer_destroy(mixer);
+    }
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "audio_plc.h"
+#include "test_audio_signals.h"
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#endif
+
+#define TAG "TEST_AUDIO_PLC"
+#ifndef PLC_TEST_LOSS_PCT
+#define PLC_TEST_LOSS_PCT 10    // packets dropped in the loss test; -D to try others
+#endif
+#define STREAM_SAMPLES 24000    // 1.5 s at 16 kHz
+#define PACKET 320              // 20 ms, as the downlink delivers
+
+static int16_t s_ref[STREAM_SAMPLES];
+static int16_t s_out[STREAM_SAMPLES];
+
+TEST_CASE("Concealment beats silence under random packet loss", "[audio_plc]") {
+    audio_plc_config_t cfg = AUDIO_PLC_CONFIG_DEFAULT();
+    audio_plc_t* plc = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_plc_create(&cfg, &plc));
+    test_voice(s_ref, STREAM_SAMPLES, 150.0f, 210.0f, 0.25f);
+
+    // The first packets always arrive so there is history to conceal from
+    srand(21);
+    double lost_energy = 0.0;
+    double error_energy = 0.0;
+    int lost = 0;
+    for (size_t p = 0; p < STREAM_SAMPLES / PACKET; p++) {
+        int16_t* out = s_out + p * PACKET;
+        const int16_t* ref = s_ref + p * PACKET;
+        if (p >= 3 && rand() % 100 < PLC_TEST_LOSS_PCT) {
+            TEST_ASSERT_EQUAL(PACKET, audio_plc_conceal(plc, out, PACKET));
+            for (int i = 0; i < PACKET; i++) {
+                lost_energy += (double)ref[i] * ref[i];
+                error_energy += (double)(out[i] - ref[i]) * (out[i] - ref[i]);
+            }
+            lost++;
+        } else {
+            memcpy(out, ref, PACKET * sizeof(int16_t));
+            audio_plc_good(plc, out, PACKET);
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, lost);
+
+    // Silence leaves an error as loud as the lost audio; the extension
+    // tracks the waveform for a while. No concealed frame or seam may jump
+    // more than the voice itself does
+    audio_plc_stats_t stats;
+    audio_plc_get_stats(plc, &stats);
+    ESP_LOGI(TAG, "%d of %d packets lost, %lu gaps, %lu ms concealed, error %.1f dB below silence",
+             lost, STREAM_SAMPLES / PACKET, (unsigned long)stats.gaps, (unsigned long)stats.concealed_ms,
+             10.0 * log10(lost_energy / error_energy));
+    TEST_ASSERT_EQUAL(lost * 20, stats.concealed_ms);
+    TEST_ASSERT_LESS_THAN(lost_energy / 2.0, error_energy);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * test_max_jump(s_ref, STREAM_SAMPLES), test_max_jump(s_out, STREAM_SAMPLES));
+
+    audio_plc_destroy(plc);
+}
+
+TEST_CASE("Long gaps fade to comfort noise and stop at max_ms", "[audio_plc]") {
+    audio_plc_config_t cfg = AUDIO_PLC_CONFIG_DEFAULT();
+    audio_plc_t* plc = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_plc_create(&cfg, &plc));
+
+    // Nothing to conceal from yet
+    TEST_ASSERT_EQUAL(0, audio_plc_conceal(plc, s_out, PACKET));
+
+    test_voice(s_ref, STREAM_SAMPLES, 150.0f, 210.0f, 0.25f);
+    for (int p = 0; p < 10; p++) {
+        memcpy(s_out, s_ref + p * PACKET, PACKET * sizeof(int16_t));
+        audio_plc_good(plc, s_out, PACKET);
+    }
+    size_t concealed = 0;
+    size_t n;
+    while ((n = audio_plc_conceal(plc, s_out + concealed, PACKET)) > 0) {
+        concealed += n;
+    }
+    TEST_ASSERT_EQUAL(cfg.max_ms * 16, concealed);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * test_max_jump(s_ref, STREAM_SAMPLES), test_max_jump(s_out, concealed));
+
+    // Extension at full level first, only noise well below it after fade_ms,
+    // and silence at the end
+    int32_t early = 0;
+    int32_t late = 0;
+    for (size_t i = 0; i < 160; i++) {
+        early = abs(s_out[i]) > early ? abs(s_out[i]) : early;
+    }
+    for (size_t i = cfg.fade_ms * 16; i < concealed; i++) {
+        late = abs(s_out[i]) > late ? abs(s_out[i]) : late;
+    }
+    TEST_ASSERT_GREATER_THAN(5000, early);
+    TEST_ASSERT_LESS_THAN(early / 2, late);
+    TEST_ASSERT_INT_WITHIN(late / 10 + 1, 0, s_out[concealed - 1]);
+
+    // Audio after an expired gap fades in from silence
+    memcpy(s_out, s_ref + 20 * PACKET, PACKET * sizeof(int16_t));
+    audio_plc_good(plc, s_out, PACKET);
+    TEST_ASSERT_EQUAL_INT16(0, s_out[0]);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(s_ref + 20 * PACKET + 80, s_out + 80, PACKET - 80);
+
+    audio_plc_stats_t stats;
+    audio_plc_get_stats(plc, &stats);
+    TEST_ASSERT_EQUAL(1, stats.gaps);
+    TEST_ASSERT_EQUAL(cfg.max_ms, stats.concealed_ms);
+    TEST_ASSERT_EQUAL(cfg.max_ms - cfg.fade_ms, stats.noise_ms);
+    TEST_ASSERT_EQUAL(cfg.max_ms, stats.longest_gap_ms);
+
+    // A reset stream has nothing to continue
+    audio_plc_reset(plc);
+    TEST_ASSERT_EQUAL(0, audio_plc_conceal(plc, s_out, PACKET));
+    audio_plc_destroy(plc);
+}
+
+#ifdef ESP_PLATFORM
+// Cycle counts only mean something on the target
+TEST_CASE("Concealment cost per frame", "[audio_plc][benchmark]") {
+    const int iterations = 50;
+    audio_plc_config_t cfg = AUDIO_PLC_CONFIG_DEFAULT();
+    audio_plc_t* plc = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_plc_create(&cfg, &plc));
+    test_voice(s_ref, STREAM_SAMPLES, 150.0f, 210.0f, 0.25f);
+
+    // A frame that opens a gap pays for the pitch search, the next one only
+    // for the synthesis; the good frame after it for the cross-fade
+    uint32_t first = 0;
+    uint32_t next = 0;
+    uint32_t recover = 0;
+    for (int i = 0; i < iterations; i++) {
+        const int16_t* ref = s_ref + (i % 8) * 8 * PACKET;
+        for (int p = 0; p < 4; p++) {
+            memcpy(s_out, ref + p * PACKET, PACKET * sizeof(int16_t));
+            audio_plc_good(plc, s_out, PACKET);
+        }
+        uint32_t start = esp_cpu_get_cycle_count();
+        audio_plc_conceal(plc, s_out, PACKET);
+        first += esp_cpu_get_cycle_count() - start;
+        start = esp_cpu_get_cycle_count();
+        audio_plc_conceal(plc, s_out, PACKET);
+        next += esp_cpu_get_cycle_count() - start;
+        memcpy(s_out, ref + 6 * PACKET, PACKET * sizeof(int16_t));
+        start = esp_cpu_get_cycle_count();
+        audio_plc_good(plc, s_out, PACKET);
+        recover += esp_cpu_get_cycle_count() - start;
+    }
+    ESP_LOGI(TAG, "Cycles per 20 ms frame: %lu opening a gap, %lu continuing, %lu recovering (%.3f%% of a core at worst)",
+             (unsigned long)(first / iterations), (unsigned long)(next / iterations),
+             (unsigned long)(recover / iterations),
+             100.0 * first / iterations / (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 * 0.02));
+    audio_plc_destroy(plc);
+}
+#endif
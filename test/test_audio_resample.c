@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_resample.h"
+
+#define TAG "TEST_AUDIO_RESAMPLE"
+
+static int16_t s_in[4800];
+static int16_t s_out[7300];
+
+static void make_tone(int16_t* buf, size_t count, float freq, uint32_t rate, float amp) {
+    for (size_t i = 0; i < count; i++) {
+        buf[i] = (int16_t)lrintf(amp * sinf(2.0f * (float)M_PI * freq * i / rate));
+    }
+}
+
+// Amplitude of freq in buf by correlation, skipping the filter start-up
+static float tone_amplitude(const int16_t* buf, size_t count, float freq, uint32_t rate) {
+    double re = 0, im = 0;
+    size_t start = count / 4;
+    for (size_t i = start; i < count; i++) {
+        re += buf[i] * cos(2.0 * M_PI * freq * i / rate);
+        im += buf[i] * sin(2.0 * M_PI * freq * i / rate);
+    }
+    return (float)(2.0 * sqrt(re * re + im * im) / (count - start));
+}
+
+// Feed the input in awkward chunk sizes to exercise state carry-over
+static size_t run_chunked(audio_resample_t* rs, const int16_t* in, size_t count) {
+    static const size_t chunks[] = { 1, 7, 160, 333, 480, 999 };
+    size_t produced = 0, used = 0;
+    for (int c = 0; used < count; c = (c + 1) % 6) {
+        size_t n = chunks[c] < count - used ? chunks[c] : count - used;
+        produced += audio_resample_process(rs, in + used, n, s_out + produced);
+        used += n;
+    }
+    return produced;
+}
+
+TEST_CASE("Resampler converts 16 kHz to 24 kHz in arbitrary chunks", "[audio_resample]") {
+    audio_resample_t* rs = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_resample_create(16000, 24000, AUDIO_RESAMPLE_TAPS_DEFAULT, &rs));
+
+    make_tone(s_in, 3200, 1000.0f, 16000, 10000.0f);
+    size_t produced = run_chunked(rs, s_in, 3200);
+    TEST_ASSERT_UINT32_WITHIN(1, 4800, produced);
+
+    // Passband tone keeps its level, and its frequency maps to the new rate
+    TEST_ASSERT_FLOAT_WITHIN(150.0f, 10000.0f, tone_amplitude(s_out, produced, 1000.0f, 24000));
+    audio_resample_destroy(rs);
+}
+
+TEST_CASE("Resampler 24 kHz to 16 kHz rejects content above the new Nyquist", "[audio_resample]") {
+    audio_resample_t* rs = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_resample_create(24000, 16000, AUDIO_RESAMPLE_TAPS_DEFAULT, &rs));
+
+    make_tone(s_in, 4800, 3000.0f, 24000, 10000.0f);
+    size_t produced = run_chunked(rs, s_in, 4800);
+    TEST_ASSERT_UINT32_WITHIN(1, 3200, produced);
+    TEST_ASSERT_FLOAT_WITHIN(150.0f, 10000.0f, tone_amplitude(s_out, produced, 3000.0f, 16000));
+
+    // 11 kHz would alias to 5 kHz; expect better than -50 dB
+    audio_resample_reset(rs);
+    make_tone(s_in, 4800, 11000.0f, 24000, 10000.0f);
+    produced = run_chunked(rs, s_in, 4800);
+    TEST_ASSERT_LESS_THAN(10000.0f * 0.00316f, tone_amplitude(s_out, produced, 5000.0f, 16000));
+    audio_resample_destroy(rs);
+}
+
+TEST_CASE("Resampler throughput", "[audio_resample][benchmark]") {
+    static const uint32_t rates[][2] = { { 16000, 24000 }, { 24000, 16000 }, { 44100, 16000 } };
+
+    for (int r = 0; r < 3; r++) {
+        audio_resample_t* rs = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_resample_create(rates[r][0], rates[r][1], AUDIO_RESAMPLE_TAPS_DEFAULT, &rs));
+        make_tone(s_in, 4800, 440.0f, rates[r][0], 8000.0f);
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        size_t produced = 0;
+        for (int i = 0; i < 10; i++) {
+            produced += audio_resample_process(rs, s_in, 480, s_out);
+        }
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+        // Output samples one core could produce per second
+        double per_sample = (double)cycles / produced;
+        ESP_LOGI(TAG, "%lu -> %lu Hz: %.1f cycles/sample, %.0f samples/s per core at %d MHz (%.1fx real time)",
+                 (unsigned long)rates[r][0], (unsigned long)rates[r][1], per_sample,
+                 CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 / per_sample, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+                 CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 / per_sample / rates[r][1]);
+        audio_resample_destroy(rs);
+    }
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "audio_ring.h"
+
+#define TAG "TEST_AUDIO_RING"
+
+TEST_CASE("Audio ring counts overruns and high-water mark", "[audio_ring]") {
+    audio_ring_t* ring = NULL;
+    TEST_ESP_OK(audio_ring_create(4, 32, MALLOC_CAP_8BIT, &ring));
+
+    // Fill the ring completely
+    for (int i = 0; i < 4; i++) {
+        uint8_t* slot = audio_ring_write_acquire(ring);
+        TEST_ASSERT_NOT_NULL(slot);
+        memset(slot, i, 32);
+        audio_ring_write_commit(ring, 32);
+    }
+
+    // The fifth frame has nowhere to go
+    TEST_ASSERT_NULL(audio_ring_write_acquire(ring));
+
+    audio_ring_stats_t stats;
+    audio_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(4, stats.capacity);
+    TEST_ASSERT_EQUAL(4, stats.count);
+    TEST_ASSERT_EQUAL(4, stats.high_water);
+    TEST_ASSERT_EQUAL(1, stats.overruns);
+
+    // Frames come out in order
+    for (int i = 0; i < 4; i++) {
+        size_t len = 0;
+        const uint8_t* frame = audio_ring_read_acquire(ring, &len);
+        TEST_ASSERT_NOT_NULL(frame);
+        TEST_ASSERT_EQUAL(32, len);
+        TEST_ASSERT_EQUAL(i, frame[0]);
+        audio_ring_read_release(ring);
+    }
+    TEST_ASSERT_NULL(audio_ring_read_acquire(ring, NULL));
+
+    audio_ring_delete(ring);
+}
+
+static audio_ring_t* s_stress_ring;
+static volatile bool s_stress_done;
+
+static void stress_producer_task(void* arg) {
+    uint32_t next = 0;
+    while (next < 10000) {
+        uint32_t* slot = audio_ring_write_acquire(s_stress_ring);
+        if (!slot) {
+            taskYIELD();
+            continue;
+        }
+        slot[0] = next;
+        slot[1] = ~next;
+        audio_ring_write_commit(s_stress_ring, 2 * sizeof(uint32_t));
+        next++;
+    }
+    s_stress_done = true;
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Audio ring keeps frame order across cores", "[audio_ring]") {
+    TEST_ESP_OK(audio_ring_create(8, 2 * sizeof(uint32_t), MALLOC_CAP_8BIT, &s_stress_ring));
+    s_stress_done = false;
+
+    xTaskCreatePinnedToCore(stress_producer_task, "ring_producer", 2048, NULL, 5, NULL, 1);
+
+    uint32_t expected = 0;
+    while (expected < 10000) {
+        const uint32_t* frame = audio_ring_read_acquire(s_stress_ring, NULL);
+        if (!frame) {
+            taskYIELD();
+            continue;
+        }
+        TEST_ASSERT_EQUAL_UINT32(expected, frame[0]);
+        TEST_ASSERT_EQUAL_UINT32(~expected, frame[1]);
+        audio_ring_read_release(s_stress_ring);
+        expected++;
+    }
+
+    while (!s_stress_done) {
+        vTaskDelay(1);
+    }
+
+    audio_ring_stats_t stats;
+    audio_ring_get_stats(s_stress_ring, &stats);
+    ESP_LOGI(TAG, "Stress: %lu frames, high-water %lu", stats.frames_written, stats.high_water);
+    audio_ring_delete(s_stress_ring);
+}
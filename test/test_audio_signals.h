@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Test signals and measures shared by the 16 kHz playout DSP tests
+
+/**
+ * @brief Voiced-speech stand-in at 16 kHz
+ *
+ * A fundamental gliding linearly from f0_from to f0_to Hz with two
+ * harmonics. Its level swings at 2 Hz by +-swing (0 for a steady level).
+ */
+static inline void test_voice(int16_t* buf, size_t count, float f0_from, float f0_to, float swing) {
+    float phase = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float f0 = f0_from + (f0_to - f0_from) * (float)i / (float)count;
+        phase += 2.0f * (float)M_PI * f0 / 16000.0f;
+        float level = 1.0f - swing + swing * sinf(2.0f * (float)M_PI * 2.0f * (float)i / 16000.0f);
+        buf[i] = (int16_t)(level * (7000.0f * sinf(phase) + 3000.0f * sinf(2.0f * phase + 0.5f) +
+                                    1500.0f * sinf(3.0f * phase + 1.0f)));
+    }
+}
+
+/**
+ * @brief Largest step between neighbouring samples; a click shows up here
+ */
+static inline int32_t test_max_jump(const int16_t* buf, size_t count) {
+    int32_t m = 0;
+    for (size_t i = 1; i < count; i++) {
+        int32_t d = abs(buf[i] - buf[i - 1]);
+        m = d > m ? d : m;
+    }
+    return m;
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_wsola.h"
+#include "test_audio_signals.h"
+
+#define TAG "TEST_AUDIO_WSOLA"
+#define INPUT_SAMPLES 16000     // 1 s at 16 kHz
+#define CHUNK 320               // written like the playout task, 20 ms at a time
+#define BLOCK 160               // 10 ms blocks
+
+static int16_t s_in[INPUT_SAMPLES];
+static int16_t s_out[2 * INPUT_SAMPLES];
+
+// Feeds the whole input and collects everything, drained at the end
+static size_t stretch(audio_wsola_t* ws, const int16_t* in, size_t count, int16_t* out) {
+    size_t written = 0;
+    size_t produced = 0;
+    while (written < count) {
+        size_t n = count - written < CHUNK ? count - written : CHUNK;
+        written += audio_wsola_write(ws, in + written, n);
+        produced += audio_wsola_read(ws, out + produced, 2 * INPUT_SAMPLES - produced);
+    }
+    size_t n;
+    while ((n = audio_wsola_drain(ws, out + produced, 2 * INPUT_SAMPLES - produced)) > 0) {
+        produced += n;
+    }
+    return produced;
+}
+
+// Fundamental period from the strongest autocorrelation peak in 2.5-10 ms
+static int pitch_period(const int16_t* buf) {
+    int best = 0;
+    int64_t best_corr = 0;
+    for (int lag = 40; lag <= 160; lag++) {
+        int64_t corr = 0;
+        for (int i = 0; i < 1600; i++) {
+            corr += (int32_t)buf[i] * buf[i + lag];
+        }
+        if (corr > best_corr) {
+            best_corr = corr;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+TEST_CASE("WSOLA at unity rate is bit-exact", "[audio_wsola]") {
+    audio_wsola_config_t cfg = AUDIO_WSOLA_CONFIG_DEFAULT();
+    audio_wsola_t* ws = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_wsola_create(&cfg, &ws));
+    TEST_ASSERT_EQUAL(BLOCK, audio_wsola_block_samples(ws));
+
+    for (int i = 0; i < INPUT_SAMPLES; i++) {
+        s_in[i] = (int16_t)(rand() & 0xFFFF);
+    }
+    TEST_ASSERT_EQUAL(INPUT_SAMPLES, stretch(ws, s_in, INPUT_SAMPLES, s_out));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(s_in, s_out, INPUT_SAMPLES);
+
+    audio_wsola_stats_t stats;
+    audio_wsola_get_stats(ws, &stats);
+    TEST_ASSERT_EQUAL(0, stats.fast_blocks + stats.slow_blocks);
+    TEST_ASSERT_EQUAL(0, stats.saved_ms);
+    audio_wsola_destroy(ws);
+}
+
+TEST_CASE("WSOLA changes duration and keeps pitch and continuity", "[audio_wsola]") {
+    audio_wsola_config_t cfg = AUDIO_WSOLA_CONFIG_DEFAULT();
+    test_voice(s_in, INPUT_SAMPLES, 180.0f, 180.0f, 0.0f);
+    const int in_period = pitch_period(s_in);
+    const int32_t in_jump = test_max_jump(s_in, INPUT_SAMPLES);
+
+    static const int32_t rates[] = {1126, 922};     // 10 % faster, 10 % slower
+    for (int r = 0; r < 2; r++) {
+        audio_wsola_t* ws = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_wsola_create(&cfg, &ws));
+        audio_wsola_set_rate(ws, rates[r]);
+        size_t produced = stretch(ws, s_in, INPUT_SAMPLES, s_out);
+
+        size_t expected = (size_t)INPUT_SAMPLES * AUDIO_WSOLA_RATE_UNITY / rates[r];
+        int period = pitch_period(s_out + 4000);
+        audio_wsola_stats_t stats;
+        audio_wsola_get_stats(ws, &stats);
+        ESP_LOGI(TAG, "Rate %ld: %u -> %u samples (expected %u), pitch period %d -> %d, largest step %ld -> %ld, "
+                 "saved %ld ms", (long)rates[r], (unsigned)INPUT_SAMPLES, (unsigned)produced, (unsigned)expected,
+                 in_period, period, (long)in_jump, (long)test_max_jump(s_out, produced), (long)stats.saved_ms);
+
+        // Duration follows the rate to within the samples still stored
+        // when the input ran out, and the pitch does not move
+        TEST_ASSERT_INT_WITHIN(2 * BLOCK, expected, produced);
+        TEST_ASSERT_INT_WITHIN(1, in_period, period);
+        // Segments join in phase: no step much beyond the signal's own slope
+        TEST_ASSERT_LESS_OR_EQUAL(in_jump * 3 / 2, test_max_jump(s_out, produced));
+        TEST_ASSERT_INT_WITHIN(20, ((int32_t)INPUT_SAMPLES - (int32_t)expected) / 16, stats.saved_ms);
+        audio_wsola_destroy(ws);
+    }
+}
+
+TEST_CASE("WSOLA cost per 10 ms block", "[audio_wsola][benchmark]") {
+    audio_wsola_config_t cfg = AUDIO_WSOLA_CONFIG_DEFAULT();
+    test_voice(s_in, INPUT_SAMPLES, 180.0f, 180.0f, 0.0f);
+
+    static const int32_t rates[] = {AUDIO_WSOLA_RATE_UNITY, 1126, 922};
+    for (int r = 0; r < 3; r++) {
+        audio_wsola_t* ws = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_wsola_create(&cfg, &ws));
+        audio_wsola_set_rate(ws, rates[r]);
+        uint32_t cycles = 0;
+        uint32_t blocks = 0;
+        size_t written = 0;
+        while (written + CHUNK <= INPUT_SAMPLES) {
+            written += audio_wsola_write(ws, s_in + written, CHUNK);
+            uint32_t start = esp_cpu_get_cycle_count();
+            size_t n = audio_wsola_read(ws, s_out, 2 * CHUNK);
+            cycles += esp_cpu_get_cycle_count() - start;
+            blocks += n / BLOCK;
+        }
+        ESP_LOGI(TAG, "Rate %ld: %lu cycles per 10 ms block (%.3f%% of a core)", (long)rates[r],
+                 (unsigned long)(cycles / blocks), 100.0 * cycles / blocks / (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 * 0.01));
+        audio_wsola_destroy(ws);
+    }
+}
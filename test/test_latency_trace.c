@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "latency_trace.h"
+
+#define TAG "TEST_LATENCY_TRACE"
+
+TEST_CASE("Latency histogram percentiles follow the recorded spans", "[latency_trace]") {
+    latency_trace_reset();
+
+    // 1 .. 1000 ms, shuffled so the order does not matter
+    srand(3);
+    static uint32_t ms[1000];
+    for (int i = 0; i < 1000; i++) {
+        ms[i] = i + 1;
+    }
+    for (int i = 999; i > 0; i--) {
+        int j = rand() % (i + 1);
+        uint32_t t = ms[i];
+        ms[i] = ms[j];
+        ms[j] = t;
+    }
+    for (int i = 0; i < 1000; i++) {
+        latency_trace_record(LATENCY_SPAN_END_TO_END, (int64_t)ms[i] * 1000);
+    }
+
+    latency_trace_summary_t s;
+    latency_trace_get(LATENCY_SPAN_END_TO_END, LATENCY_SCOPE_RECENT, &s);
+    ESP_LOGI(TAG, "p50 %lu us, p95 %lu us, p99 %lu us, max %lu us", (unsigned long)s.p50_us,
+             (unsigned long)s.p95_us, (unsigned long)s.p99_us, (unsigned long)s.max_us);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.count);
+    TEST_ASSERT_EQUAL_UINT32(1000000, s.max_us);
+    // Within a bucket the spans are spread evenly, so interpolation is close
+    TEST_ASSERT_UINT32_WITHIN(10000, 500000, s.p50_us);
+    TEST_ASSERT_UINT32_WITHIN(10000, 950000, s.p95_us);
+    TEST_ASSERT_UINT32_WITHIN(10000, 990000, s.p99_us);
+
+    // A single outlier moves the maximum but not the median
+    latency_trace_record(LATENCY_SPAN_END_TO_END, 20 * 1000 * 1000);
+    latency_trace_get(LATENCY_SPAN_END_TO_END, LATENCY_SCOPE_RECENT, &s);
+    TEST_ASSERT_EQUAL_UINT32(20000000, s.max_us);
+    TEST_ASSERT_UINT32_WITHIN(10000, 500000, s.p50_us);
+
+    // Sub-millisecond spans and negative ones land in the first bucket
+    latency_trace_record(LATENCY_SPAN_OUTPUT, 300);
+    latency_trace_record(LATENCY_SPAN_OUTPUT, -5);
+    latency_trace_get(LATENCY_SPAN_OUTPUT, LATENCY_SCOPE_RECENT, &s);
+    TEST_ASSERT_EQUAL_UINT32(2, s.count);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(300, s.p99_us);
+    latency_trace_dump(LATENCY_SCOPE_RECENT);
+
+    // A reset clears this conversation's view and keeps the one since boot
+    latency_trace_summary_t boot;
+    latency_trace_get(LATENCY_SPAN_END_TO_END, LATENCY_SCOPE_BOOT, &boot);
+    latency_trace_reset();
+    latency_trace_get(LATENCY_SPAN_END_TO_END, LATENCY_SCOPE_RECENT, &s);
+    TEST_ASSERT_EQUAL_UINT32(0, s.count);
+    TEST_ASSERT_EQUAL_UINT32(0, s.p50_us);
+    latency_trace_get(LATENCY_SPAN_END_TO_END, LATENCY_SCOPE_BOOT, &s);
+    TEST_ASSERT_EQUAL_UINT32(boot.count, s.count);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1001, s.count);
+}
+
+TEST_CASE("Latency spans close once per begin", "[latency_trace]") {
+    latency_trace_reset();
+    latency_trace_summary_t s;
+
+    // Nothing to close before a begin
+    TEST_ASSERT_FALSE(latency_trace_end(LATENCY_SPAN_RESPONSE, 1000));
+
+    // The latest begin wins, the first end closes, later ends are ignored
+    latency_trace_begin(LATENCY_SPAN_RESPONSE, 1000000);
+    latency_trace_begin(LATENCY_SPAN_RESPONSE, 1200000);
+    TEST_ASSERT_TRUE(latency_trace_is_open(LATENCY_SPAN_RESPONSE));
+    TEST_ASSERT_TRUE(latency_trace_end(LATENCY_SPAN_RESPONSE, 1650000));
+    TEST_ASSERT_FALSE(latency_trace_end(LATENCY_SPAN_RESPONSE, 1700000));
+    TEST_ASSERT_FALSE(latency_trace_is_open(LATENCY_SPAN_RESPONSE));
+    latency_trace_get(LATENCY_SPAN_RESPONSE, LATENCY_SCOPE_RECENT, &s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(450000, s.max_us);
+    TEST_ASSERT_EQUAL_UINT32(450000, s.p50_us);
+
+    // Spans are independent, and only the low 32 bits of the clock matter
+    int64_t base = ((int64_t)1 << 32) - 100000;
+    latency_trace_begin(LATENCY_SPAN_DOWNLINK, base);
+    latency_trace_cancel(LATENCY_SPAN_RESPONSE);
+    TEST_ASSERT_TRUE(latency_trace_end(LATENCY_SPAN_DOWNLINK, base + 250000));
+    latency_trace_get(LATENCY_SPAN_DOWNLINK, LATENCY_SCOPE_RECENT, &s);
+    TEST_ASSERT_EQUAL_UINT32(250000, s.max_us);
+
+    // Cancel and reset both drop an open span
+    latency_trace_begin(LATENCY_SPAN_RESPONSE, 2000000);
+    latency_trace_cancel(LATENCY_SPAN_RESPONSE);
+    TEST_ASSERT_FALSE(latency_trace_end(LATENCY_SPAN_RESPONSE, 2100000));
+    latency_trace_begin(LATENCY_SPAN_END_TO_END, 3000000);
+    latency_trace_reset();
+    TEST_ASSERT_FALSE(latency_trace_end(LATENCY_SPAN_END_TO_END, 3100000));
+    TEST_ASSERT_EQUAL_STRING("end_to_end", latency_trace_span_name(LATENCY_SPAN_END_TO_END));
+}
+
+TEST_CASE("Latency trace cost per span", "[latency_trace][benchmark]") {
+    const int iterations = 1000;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        latency_trace_record(LATENCY_SPAN_UPLINK, 20000 + i * 37);
+    }
+    uint32_t record_cycles = esp_cpu_get_cycle_count() - start;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        latency_trace_begin(LATENCY_SPAN_RESPONSE, (int64_t)i * 100000);
+        latency_trace_end(LATENCY_SPAN_RESPONSE, (int64_t)i * 100000 + 500000);
+    }
+    uint32_t span_cycles = esp_cpu_get_cycle_count() - start;
+
+    latency_trace_summary_t s;
+    start = esp_cpu_get_cycle_count();
+    latency_trace_get(LATENCY_SPAN_UPLINK, LATENCY_SCOPE_RECENT, &s);
+    uint32_t get_cycles = esp_cpu_get_cycle_count() - start;
+
+    ESP_LOGI(TAG, "record %lu cycles, begin+end %lu cycles, summary %lu cycles",
+             (unsigned long)(record_cycles / iterations), (unsigned long)(span_cycles / iterations),
+             (unsigned long)get_cycles);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(iterations, s.count);
+}
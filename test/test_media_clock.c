@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "media_clock.h"
+
+#define TAG "TEST_MEDIA_CLOCK"
+
+#define RATE            16000
+#define CAPTURE_FRAME   512
+#define DMA_BUF         512
+#define DMA_QUEUE       (8 * DMA_BUF)
+
+// Deterministic scheduling jitter in [0, max_us)
+static uint32_t s_lcg = 12345;
+static int64_t jitter_us(int64_t max_us) {
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return (int64_t)((s_lcg >> 8) % (uint32_t)max_us);
+}
+
+// Simulated I2S pair: capture runs at cap_ppm, playback at play_ppm off
+// nominal. Returns the capture stamp error of the last frame in us.
+static int64_t simulate(double cap_ppm, double play_ppm, double seconds, int64_t* play_err_us) {
+    const double cap_rate = RATE * (1.0 + cap_ppm * 1e-6);
+    const double play_rate = RATE * (1.0 + play_ppm * 1e-6);
+    const int64_t t0 = 1000000;
+    int64_t cap_err = 0;
+
+    media_clock_start(MEDIA_CLOCK_CAPTURE, RATE, DMA_QUEUE);
+    media_clock_start(MEDIA_CLOCK_PLAYBACK, RATE, DMA_QUEUE);
+
+    uint64_t frame = 0, written = 0;
+    int64_t play_start = -1;
+    for (int64_t now = t0; now < t0 + (int64_t)(seconds * 1e6); now += 10000 + jitter_us(2000)) {
+        // Capture: every frame completed by now is read, a little late
+        while (t0 + (int64_t)((frame + 1) * CAPTURE_FRAME * 1e6 / cap_rate) <= now) {
+            int64_t done = t0 + (int64_t)((frame + 1) * CAPTURE_FRAME * 1e6 / cap_rate);
+            int64_t read_at = done + jitter_us(3000);
+            media_clock_stamp_t st = media_clock_capture(CAPTURE_FRAME, read_at < now ? read_at : now);
+            int64_t truth = t0 + (int64_t)(st.sample_index * 1e6 / cap_rate);
+            cap_err = st.time_us - truth;
+            frame++;
+        }
+
+        // Playback: the writer tops the queue up in 480-sample chunks; the
+        // DMA frees whole buffers
+        if (play_start < 0) {
+            play_start = now;
+        }
+        uint64_t played = (uint64_t)((now - play_start) * play_rate / 1e6) / DMA_BUF * DMA_BUF;
+        for (;;) {
+            uint64_t space = DMA_QUEUE - (written - played);
+            uint32_t accepted = space < 480 ? (uint32_t)space : 480;
+            if (accepted == 0) {
+                break;
+            }
+            media_clock_stamp_t st = media_clock_playback(accepted, accepted < 480, now);
+            int64_t truth = play_start + (int64_t)(st.sample_index * 1e6 / play_rate);
+            *play_err_us = st.time_us - truth;
+            written += accepted;
+            if (accepted < 480) {
+                break;
+            }
+        }
+    }
+    return cap_err;
+}
+
+TEST_CASE("Media clock stamps frames and measures RX/TX drift", "[media_clock]") {
+    int64_t play_err = 0;
+    int64_t cap_err = simulate(50.0, -20.0, 60.0, &play_err);
+
+    media_clock_drift_t drift;
+    media_clock_get_drift(&drift);
+    ESP_LOGI(TAG, "capture %.3f Hz, playback %.3f Hz, drift %.1f ppm; stamp error capture %lld us, playback %lld us",
+             drift.capture_rate_hz, drift.playback_rate_hz, drift.drift_ppm,
+             (long long)cap_err, (long long)play_err);
+
+    TEST_ASSERT_TRUE(drift.valid);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, RATE * (1 + 50e-6), drift.capture_rate_hz);
+    TEST_ASSERT_FLOAT_WITHIN(25.0f, -70.0f, drift.drift_ppm);
+    // Capture is within the scheduling jitter floor; playback within one DMA buffer
+    TEST_ASSERT_INT32_WITHIN(1000, 0, (int32_t)cap_err);
+    TEST_ASSERT_INT32_WITHIN(DMA_BUF * 1000000 / RATE, 0, (int32_t)play_err);
+}
+
+TEST_CASE("Media clock restarts playback timing after an underrun", "[media_clock]") {
+    media_clock_start(MEDIA_CLOCK_PLAYBACK, RATE, DMA_QUEUE);
+
+    media_clock_stamp_t first = media_clock_playback(480, false, 1000000);
+    TEST_ASSERT_EQUAL_UINT64(0, first.sample_index);
+    TEST_ASSERT_INT32_WITHIN(1, 1000000, (int32_t)first.time_us);
+
+    // Back to back writes are scheduled after the audio already queued
+    media_clock_stamp_t second = media_clock_playback(480, false, 1001000);
+    TEST_ASSERT_EQUAL_UINT64(480, second.sample_index);
+    TEST_ASSERT_INT32_WITHIN(1, 1000000 + 30000, (int32_t)second.time_us);
+
+    // After the queue ran dry the next write plays immediately
+    media_clock_stamp_t late = media_clock_playback(480, false, 2000000);
+    TEST_ASSERT_EQUAL_UINT64(960, late.sample_index);
+    TEST_ASSERT_INT32_WITHIN(1, 2000000, (int32_t)late.time_us);
+
+    media_clock_stamp_t last;
+    TEST_ASSERT_TRUE(media_clock_get(MEDIA_CLOCK_PLAYBACK, &last));
+    TEST_ASSERT_EQUAL_UINT64(960, last.sample_index);
+    TEST_ASSERT_INT32_WITHIN(1, 2000000 + 30000, (int32_t)media_clock_time_of(MEDIA_CLOCK_PLAYBACK, 1440));
+    TEST_ASSERT_UINT32_WITHIN(1, 1440, (uint32_t)media_clock_sample_at(MEDIA_CLOCK_PLAYBACK, 2030000));
+}
+
+TEST_CASE("Media clock query cost", "[media_clock][benchmark]") {
+    media_clock_start(MEDIA_CLOCK_CAPTURE, RATE, DMA_QUEUE);
+    media_clock_capture(CAPTURE_FRAME, 1000000);
+
+    media_clock_stamp_t last;
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < 1000; i++) {
+        media_clock_get(MEDIA_CLOCK_CAPTURE, &last);
+    }
+    uint32_t get_cycles = esp_cpu_get_cycle_count() - start;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < 1000; i++) {
+        media_clock_capture(CAPTURE_FRAME, 1000000 + 32000 * (i + 1));
+    }
+    uint32_t capture_cycles = esp_cpu_get_cycle_count() - start;
+
+    ESP_LOGI(TAG, "media_clock_get %lu cycles, media_clock_capture %lu cycles",
+             (unsigned long)(get_cycles / 1000), (unsigned long)(capture_cycles / 1000));
+}
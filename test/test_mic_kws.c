@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "mic_mfcc.h"
+#include "mic_kws.h"
+
+#define TAG "TEST_MIC_KWS"
+#define SAMPLE_RATE     16000
+#define FRAMES          49      // 1 s window
+#define CHUNK           512     // one pre-roll read
+
+// Synthetic fixtures from test/fixtures/make_kws_fixtures.py, embedded by CMake.
+// The tree has no host build, so these cases run on the target with the
+// rest of the Unity suite rather than offline
+extern const uint8_t kws_enroll_wav_start[] asm("_binary_kws_enroll_wav_start");
+extern const uint8_t kws_enroll_wav_end[] asm("_binary_kws_enroll_wav_end");
+extern const uint8_t kws_keyword_wav_start[] asm("_binary_kws_keyword_wav_start");
+extern const uint8_t kws_keyword_wav_end[] asm("_binary_kws_keyword_wav_end");
+extern const uint8_t kws_background_wav_start[] asm("_binary_kws_background_wav_start");
+extern const uint8_t kws_background_wav_end[] asm("_binary_kws_background_wav_end");
+
+static int16_t s_tone[SAMPLE_RATE / 2];
+static int16_t s_chunk[CHUNK];
+// One hidden unit over FRAMES x MIC_MFCC_COEFFS features, two classes
+static int32_t s_model[(sizeof(mic_kws_model_t) + 3 * 4 + FRAMES * MIC_MFCC_COEFFS + 2 + 3) / 4];
+
+static uint32_t read_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Finds the samples of a 16 kHz mono 16-bit PCM WAV
+static const int16_t* wav_samples(const uint8_t* start, const uint8_t* end, size_t* count) {
+    TEST_ASSERT_EQUAL_MEMORY("RIFF", start, 4);
+    TEST_ASSERT_EQUAL_MEMORY("WAVE", start + 8, 4);
+    const uint8_t* p = start + 12;
+    bool format_ok = false;
+    while (p + 8 <= end) {
+        uint32_t len = read_le32(p + 4);
+        if (memcmp(p, "fmt ", 4) == 0) {
+            format_ok = (p[8] | (p[9] << 8)) == 1 && (p[10] | (p[11] << 8)) == 1 &&
+                        read_le32(p + 12) == SAMPLE_RATE && (p[22] | (p[23] << 8)) == 16;
+        } else if (memcmp(p, "data", 4) == 0) {
+            TEST_ASSERT_TRUE(format_ok);
+            *count = len / sizeof(int16_t);
+            return (const int16_t*)(p + 8);
+        }
+        p += 8 + len + (len & 1);
+    }
+    TEST_FAIL_MESSAGE("no data chunk");
+    return NULL;
+}
+
+// Streams a fixture through the spotter the way the pre-roll task does and
+// records the time of each detection
+static uint32_t run_fixture(mic_kws_t* kws, const int16_t* samples, size_t count, uint32_t* times_ms, uint32_t max) {
+    uint32_t detections = 0;
+    for (size_t pos = 0; pos < count; pos += CHUNK) {
+        size_t n = count - pos < CHUNK ? count - pos : CHUNK;
+        // Embedded data has no alignment guarantee
+        memcpy(s_chunk, samples + pos, n * sizeof(int16_t));
+        if (mic_kws_process(kws, s_chunk, n) && detections < max) {
+            times_ms[detections++] = (uint32_t)((pos + n) * 1000 / SAMPLE_RATE);
+        }
+    }
+    return detections;
+}
+
+// A one-unit matched filter "trained" on the enrolment fixture: the hidden
+// unit correlates c1..c9 (level-independent) with the mean-removed template
+static void build_template_model(void) {
+    mic_mfcc_t mfcc;
+    static int16_t feats[FRAMES][MIC_MFCC_COEFFS];
+    size_t count = 0;
+    const int16_t* wav = wav_samples(kws_enroll_wav_start, kws_enroll_wav_end, &count);
+    TEST_ASSERT_EQUAL(ESP_OK, mic_mfcc_init(&mfcc, SAMPLE_RATE));
+
+    // The fixture is exactly one window long
+    uint32_t frames = 0;
+    int16_t* buf = malloc(count * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(buf);
+    memcpy(buf, wav, count * sizeof(int16_t));
+    const int16_t* p = buf;
+    while (frames < FRAMES && mic_mfcc_process(&mfcc, &p, &count, feats[frames])) {
+        frames++;
+    }
+    TEST_ASSERT_EQUAL(FRAMES, frames);
+    free(buf);
+    mic_mfcc_deinit(&mfcc);
+
+    float peak = 1.0f;
+    float mean[MIC_MFCC_COEFFS] = {0};
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        for (uint32_t c = 1; c < MIC_MFCC_COEFFS; c++) {
+            peak = abs(feats[f][c]) > peak ? abs(feats[f][c]) : peak;
+            mean[c] += feats[f][c] / (float)FRAMES;
+        }
+    }
+
+    mic_kws_model_t* m = (mic_kws_model_t*)s_model;
+    memset(s_model, 0, sizeof(s_model));
+    *m = (mic_kws_model_t){
+        .magic = MIC_KWS_MAGIC, .frames = FRAMES, .coeffs = MIC_MFCC_COEFFS,
+        .hidden = 1, .classes = 2, .keyword = 1,
+        .input_scale = 100.0f / peak,
+    };
+    int32_t* b1 = (int32_t*)(m + 1);
+    int32_t* b2 = b1 + 1;
+    int8_t* w1 = (int8_t*)(b2 + 2);
+    int8_t* w2 = w1 + FRAMES * MIC_MFCC_COEFFS;
+
+    // Averaging the template over +-2 hops (a shift-augmented "training
+    // set") widens the match peak to about the classifier stride
+    static float tmpl[FRAMES][MIC_MFCC_COEFFS];
+    float wpeak = 1.0f;
+    for (int f = 0; f < FRAMES; f++) {
+        for (int c = 1; c < MIC_MFCC_COEFFS; c++) {
+            float sum = 0.0f;
+            for (int s = -2; s <= 2; s++) {
+                int g = f + s < 0 ? 0 : (f + s >= FRAMES ? FRAMES - 1 : f + s);
+                sum += feats[g][c] - mean[c];
+            }
+            tmpl[f][c] = sum / 5.0f;
+            wpeak = fabsf(tmpl[f][c]) > wpeak ? fabsf(tmpl[f][c]) : wpeak;
+        }
+    }
+    int32_t match = 0;
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        for (uint32_t c = 1; c < MIC_MFCC_COEFFS; c++) {
+            int8_t w = (int8_t)lrintf(127.0f * tmpl[f][c] / wpeak);
+            int32_t x = lrintf(feats[f][c] * m->input_scale);
+            w1[f * MIC_MFCC_COEFFS + c] = w;
+            match += w * (x > 127 ? 127 : (x < -128 ? -128 : x));
+        }
+    }
+    // Fires from 40% of a perfect match, full scale from 60%
+    b1[0] = -(match * 4) / 10;
+    m->hidden_scale = 127.0f / (match * 0.2f);
+    w2[0] = 0;
+    w2[1] = 127;
+    b2[0] = 127 * 64;
+    b2[1] = 0;
+    m->output_scale = 10.0f / (127 * 64);
+}
+
+TEST_CASE("MFCC front end: a level change only moves c0", "[mic_kws]") {
+    mic_mfcc_t mfcc;
+    int16_t quiet[MIC_MFCC_COEFFS], loud[MIC_MFCC_COEFFS];
+    int16_t quiet_mel[MIC_MFCC_MEL_BANDS];
+    TEST_ASSERT_EQUAL(ESP_OK, mic_mfcc_init(&mfcc, SAMPLE_RATE));
+
+    // A 440 Hz tone over white noise, so every band scales with the level
+    for (int pass = 0; pass < 2; pass++) {
+        float amp = pass ? 8000.0f : 4000.0f;
+        srand(7);
+        for (size_t i = 0; i < sizeof(s_tone) / sizeof(s_tone[0]); i++) {
+            float noise = (float)rand() / RAND_MAX - 0.5f;
+            s_tone[i] = (int16_t)lrintf(amp * (sinf(2.0f * (float)M_PI * 440.0f * i / SAMPLE_RATE) + 0.2f * noise));
+        }
+        mic_mfcc_reset(&mfcc);
+        const int16_t* p = s_tone;
+        size_t left = sizeof(s_tone) / sizeof(s_tone[0]);
+        int16_t* out = pass ? loud : quiet;
+        while (mic_mfcc_process(&mfcc, &p, &left, out)) {
+        }
+        if (!pass) {
+            memcpy(quiet_mel, mfcc.log_mel, sizeof(quiet_mel));
+        }
+    }
+
+    // The strongest band holds the 440 Hz tone
+    uint32_t best = 0;
+    for (uint32_t b = 1; b < MIC_MFCC_MEL_BANDS; b++) {
+        best = quiet_mel[b] > quiet_mel[best] ? b : best;
+    }
+    ESP_LOGI(TAG, "Peak band %lu, c0 %d -> %d", best, quiet[0], loud[0]);
+    TEST_ASSERT_INT_WITHIN(1, 5, best);
+
+    // +6 dB is one octave of amplitude, two of power: 512 in log2 Q8
+    TEST_ASSERT_INT_WITHIN(16, 512, loud[0] - quiet[0]);
+    for (uint32_t c = 1; c < MIC_MFCC_COEFFS; c++) {
+        TEST_ASSERT_INT_WITHIN(16, quiet[c], loud[c]);
+    }
+    mic_mfcc_deinit(&mfcc);
+}
+
+TEST_CASE("Keyword spotter rejects malformed models", "[mic_kws]") {
+    mic_kws_t* kws = NULL;
+    build_template_model();
+    mic_kws_model_t* m = (mic_kws_model_t*)s_model;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, mic_kws_create(s_model, sizeof(s_model) - 8, NULL, &kws));
+    m->coeffs = 13;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, mic_kws_create(s_model, sizeof(s_model), NULL, &kws));
+    m->coeffs = MIC_MFCC_COEFFS;
+    m->magic = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, mic_kws_create(s_model, sizeof(s_model), NULL, &kws));
+    TEST_ASSERT_NULL(kws);
+}
+
+TEST_CASE("Keyword spotter finds the keyword in WAV fixtures", "[mic_kws]") {
+    mic_kws_t* kws = NULL;
+    mic_kws_stats_t stats;
+    uint32_t times[4];
+    size_t count;
+    const int16_t* wav;
+
+    build_template_model();
+    mic_kws_config_t cfg = MIC_KWS_CONFIG_DEFAULT();
+    TEST_ASSERT_EQUAL(ESP_OK, mic_kws_create(s_model, sizeof(s_model), &cfg, &kws));
+    TEST_ASSERT_EQUAL(992, mic_kws_window_ms(kws));
+
+    // Keywords end at 1.2 s and 3.0 s; the second is 12 dB quieter in more noise
+    wav = wav_samples(kws_keyword_wav_start, kws_keyword_wav_end, &count);
+    uint32_t found = run_fixture(kws, wav, count, times, 4);
+    mic_kws_get_stats(kws, &stats);
+    ESP_LOGI(TAG, "Keyword fixture: %lu detections (%lu, %lu ms), peak score %u%%",
+             found, times[0], found > 1 ? times[1] : 0, stats.peak_score_pct);
+    TEST_ASSERT_EQUAL(2, found);
+    TEST_ASSERT_UINT32_WITHIN(250, 1350, times[0]);
+    TEST_ASSERT_UINT32_WITHIN(250, 3150, times[1]);
+
+    // The same sounds in other orders, tones and noise
+    mic_kws_reset(kws);
+    wav = wav_samples(kws_background_wav_start, kws_background_wav_end, &count);
+    found = run_fixture(kws, wav, count, times, 4);
+    mic_kws_get_stats(kws, &stats);
+    ESP_LOGI(TAG, "Background fixture: %lu detections, peak score %u%%", found, stats.peak_score_pct);
+    TEST_ASSERT_EQUAL(0, found);
+    TEST_ASSERT_LESS_THAN(50, stats.peak_score_pct);
+
+    mic_kws_destroy(kws);
+}
+
+TEST_CASE("Keyword spotter cost per frame", "[mic_kws][benchmark]") {
+    mic_kws_t* kws = NULL;
+    mic_kws_stats_t stats;
+    size_t count;
+
+    build_template_model();
+    TEST_ASSERT_EQUAL(ESP_OK, mic_kws_create(s_model, sizeof(s_model), NULL, &kws));
+    const int16_t* wav = wav_samples(kws_keyword_wav_start, kws_keyword_wav_end, &count);
+    uint32_t times[4];
+    run_fixture(kws, wav, count, times, 4);
+    mic_kws_get_stats(kws, &stats);
+
+    // Share of one core while listening: a feature hop every 20 ms plus a
+    // classifier run every MIC_KWS_STRIDE hops
+    const double hop_cycles = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6 * MIC_MFCC_HOP / SAMPLE_RATE;
+    double load = (stats.feature_cycles_avg + (double)stats.inference_cycles_avg / MIC_KWS_STRIDE) / hop_cycles;
+    ESP_LOGI(TAG, "Features: %lu cycles (%.1f us) per 20 ms hop; classifier: avg %lu, max %lu cycles (%.1f us)",
+             stats.feature_cycles_avg, stats.feature_cycles_avg / (double)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             stats.inference_cycles_avg, stats.inference_cycles_max,
+             stats.inference_cycles_avg / (double)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    ESP_LOGI(TAG, "Listening load %.2f%% of one core at %d MHz", load * 100.0, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    TEST_ASSERT_GREATER_THAN(0, stats.inferences);
+
+    mic_kws_destroy(kws);
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "audio_dsp_fft.h"
+#include "mic_ns.h"
+
+#define TAG "TEST_MIC_NS"
+#define SAMPLE_RATE   16000
+#define FRAME_SAMPLES 512   // one 1024-byte capture frame
+
+static int16_t s_frame[FRAME_SAMPLES];
+static int16_t s_clean[FRAME_SAMPLES];
+static uint32_t s_pos;
+
+// Gaussian-ish noise plus an optional 500 Hz tone standing in for a talker
+static void make_frame(float noise_rms, float tone_amp) {
+    for (int i = 0; i < FRAME_SAMPLES; i++, s_pos++) {
+        float n = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            n += (float)rand() / RAND_MAX - 0.5f;
+        }
+        float tone = tone_amp * sinf(2.0f * (float)M_PI * 500.0f * s_pos / SAMPLE_RATE);
+        s_clean[i] = (int16_t)lrintf(tone);
+        s_frame[i] = (int16_t)lrintf(tone + n * noise_rms * 1.732f);
+    }
+}
+
+static float rms(const int16_t* s, int n) {
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += (double)s[i] * s[i];
+    }
+    return sqrtf((float)(sum / n));
+}
+
+TEST_CASE("Fixed-point real FFT matches float and round-trips", "[audio_dsp]") {
+    audio_dsp_rfft_s32_t q;
+    audio_dsp_rfft_f32_t f;
+    static int32_t data[512], orig[512];
+    static float ref[512];
+
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dsp_rfft_s32_init(&q, 512));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_dsp_rfft_f32_init(&f, 512));
+    srand(3);
+    for (int i = 0; i < 512; i++) {
+        orig[i] = data[i] = (rand() & 0xFFFF) - 32768;
+        ref[i] = (float)data[i];
+    }
+
+    audio_dsp_rfft_s32_forward(&q, data);
+    audio_dsp_rfft_f32_forward(&f, ref);
+    for (int i = 0; i < 512; i++) {
+        // Q15 twiddle rounding: a few parts in 1e5 of full scale
+        TEST_ASSERT_FLOAT_WITHIN(64.0f, ref[i], (float)data[i]);
+    }
+
+    audio_dsp_rfft_s32_inverse(&q, data);
+    for (int i = 0; i < 512; i++) {
+        TEST_ASSERT_INT32_WITHIN(4, orig[i], data[i]);
+    }
+
+    audio_dsp_rfft_s32_deinit(&q);
+    audio_dsp_rfft_f32_deinit(&f);
+}
+
+TEST_CASE("Noise suppressor is transparent with no attenuation allowed", "[mic_input][ns]") {
+    mic_ns_config_t cfg = { .enabled = true, .max_attenuation_db = 0 };
+    mic_ns_t ns;
+    static int16_t history[FRAME_SAMPLES * 2];
+
+    TEST_ASSERT_EQUAL(ESP_OK, mic_ns_init(&ns, &cfg));
+    s_pos = 0;
+    for (int f = 0; f < 4; f++) {
+        make_frame(1000.0f, 3000.0f);
+        memcpy(history, history + FRAME_SAMPLES, sizeof(s_frame));
+        memcpy(history + FRAME_SAMPLES, s_frame, sizeof(s_frame));
+        // Odd chunk sizes exercise the hop bookkeeping
+        mic_ns_process(&ns, s_frame, 100);
+        mic_ns_process(&ns, s_frame + 100, FRAME_SAMPLES - 100);
+    }
+
+    uint32_t delay = mic_ns_latency_samples(&ns);
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        TEST_ASSERT_INT_WITHIN(4, history[FRAME_SAMPLES + i - delay], s_frame[i]);
+    }
+    mic_ns_deinit(&ns);
+}
+
+TEST_CASE("Noise suppressor removes stationary noise and keeps the talker", "[mic_input][ns]") {
+    mic_ns_config_t cfg = MIC_NS_CONFIG_DEFAULT();
+    mic_ns_t ns;
+    static int16_t delayed_clean[FRAME_SAMPLES * 2];
+
+    cfg.enabled = true;
+    TEST_ASSERT_EQUAL(ESP_OK, mic_ns_init(&ns, &cfg));
+    srand(5);
+    s_pos = 0;
+
+    // Three seconds with the talker on for 0.5 s out of every 1.5 s
+    float noise_in = 0, noise_out = 0, err = 0, speech = 0;
+    uint32_t delay = mic_ns_latency_samples(&ns);
+    for (int f = 0; f < 3 * SAMPLE_RATE / FRAME_SAMPLES * 2; f++) {
+        bool talking = (f % 47) < 16;
+        make_frame(500.0f, talking ? 4000.0f : 0.0f);
+        memcpy(delayed_clean, delayed_clean + FRAME_SAMPLES, sizeof(s_clean));
+        memcpy(delayed_clean + FRAME_SAMPLES, s_clean, sizeof(s_clean));
+        float in = rms(s_frame, FRAME_SAMPLES);
+        mic_ns_process(&ns, s_frame, FRAME_SAMPLES);
+
+        if (f < 3 * SAMPLE_RATE / FRAME_SAMPLES) {
+            continue;   // let the noise estimate settle
+        }
+        if (!talking && (f % 47) > 17) {
+            noise_in += in;
+            noise_out += rms(s_frame, FRAME_SAMPLES);
+        } else if (talking && (f % 47) > 1) {
+            for (int i = 0; i < FRAME_SAMPLES; i++) {
+                float d = (float)s_frame[i] - delayed_clean[FRAME_SAMPLES + i - delay];
+                err += d * d;
+                speech += (float)delayed_clean[FRAME_SAMPLES + i - delay] * delayed_clean[FRAME_SAMPLES + i - delay];
+            }
+        }
+    }
+
+    float reduction = 20.0f * log10f(noise_in / noise_out);
+    float snr_out = 10.0f * log10f(speech / err);
+    ESP_LOGI(TAG, "Noise reduction %.1f dB, talker-to-residual %.1f dB (input %.1f dB)",
+             reduction, snr_out, 20.0f * log10f(4000.0f / 1.414f / 500.0f));
+    TEST_ASSERT_GREATER_THAN(10.0f, reduction);
+    TEST_ASSERT_GREATER_THAN(20.0f * log10f(4000.0f / 1.414f / 500.0f), snr_out);
+    mic_ns_deinit(&ns);
+}
+
+TEST_CASE("Noise suppressor latency and cost per frame", "[mic_input][benchmark]") {
+    mic_ns_config_t cfg = MIC_NS_CONFIG_DEFAULT();
+    mic_ns_t ns;
+    const int iterations = 100;
+
+    cfg.enabled = true;
+    TEST_ASSERT_EQUAL(ESP_OK, mic_ns_init(&ns, &cfg));
+    for (int i = 0; i < iterations; i++) {
+        make_frame(500.0f, 2000.0f);
+        mic_ns_process(&ns, s_frame, FRAME_SAMPLES);
+    }
+
+    uint32_t per_hop = mic_ns_cycles_per_hop(&ns);
+    uint32_t per_frame = per_hop * FRAME_SAMPLES / MIC_NS_HOP;
+    // One frame is 32 ms of audio
+    uint32_t budget = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 32000;
+    ESP_LOGI(TAG, "Latency %lu samples (%lu ms), %lu cycles per %d-sample hop",
+             (unsigned long)mic_ns_latency_samples(&ns),
+             (unsigned long)(mic_ns_latency_samples(&ns) * 1000 / SAMPLE_RATE),
+             (unsigned long)per_hop, MIC_NS_HOP);
+    ESP_LOGI(TAG, "%lu cycles per %d-sample frame (%.2f%% of one core at %d MHz)",
+             (unsigned long)per_frame, FRAME_SAMPLES, 100.0 * per_frame / budget,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    mic_ns_deinit(&ns);
+}
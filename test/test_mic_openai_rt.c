@@ -4,6 +4,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "openai_rt.h"
 #include "mic_input.h"
 #include "audio_output.h"
@@ -61,6 +62,121 @@ TEST_CASE("Test microphone to OpenAI RT integration", "[openai_rt][mic_input]")
     ESP_LOGI(TAG, "Microphone to OpenAI RT integration test completed");
 }
 
+TEST_CASE("Test borrowed microphone frames", "[mic_input]") {
+    TEST_ESP_OK(mic_input_init(16000, 16));
+    TEST_ESP_OK(mic_input_start(NULL, 1024, NULL));
+
+    mic_input_frame_t frame;
+    for (uint32_t i = 0; i < 30; i++) {
+        TEST_ESP_OK(mic_input_acquire_frame(&frame, 1000));
+        TEST_ASSERT_EQUAL(i, frame.seq);
+        TEST_ASSERT_EQUAL(1024, frame.size);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)frame.data % 16);
+
+        // Only one frame may be out at a time
+        mic_input_frame_t second;
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, mic_input_acquire_frame(&second, 0));
+
+        mic_input_release_frame(&frame);
+        TEST_ASSERT_NULL(frame.data);
+    }
+
+    mic_input_stats_t stats;
+    mic_input_get_stats(&stats);
+    ESP_LOGI(TAG, "Borrowed %lu frames, %lu overruns", stats.frames_captured, stats.overruns);
+
+    mic_input_stop();
+    mic_input_deinit();
+}
+
+TEST_CASE("Test pre-roll is replayed ahead of live frames", "[mic_input]") {
+    TEST_ESP_OK(mic_input_init(16000, 16));
+    TEST_ESP_OK(mic_input_start_preroll(300));
+    vTaskDelay(pdMS_TO_TICKS(500));
+
+    int64_t start_us = esp_timer_get_time();
+    TEST_ESP_OK(mic_input_start(NULL, 1024, NULL));
+
+    // The history comes out first, then live frames with no gap in the sample clock
+    mic_input_frame_t frame;
+    uint64_t next_index = 0;
+    for (uint32_t i = 0; i < 30; i++) {
+        TEST_ESP_OK(mic_input_acquire_frame(&frame, 1000));
+        TEST_ASSERT_EQUAL(i, frame.seq);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)frame.data % 16);
+        if (i == 0) {
+            TEST_ASSERT_LESS_THAN(start_us - 250000, frame.timestamp_us);
+        } else {
+            TEST_ASSERT_EQUAL_UINT64(next_index, frame.sample_index);
+        }
+        next_index = frame.sample_index + frame.size / sizeof(int16_t);
+        mic_input_release_frame(&frame);
+    }
+
+    mic_input_stats_t stats;
+    mic_input_get_stats(&stats);
+    ESP_LOGI(TAG, "Pre-roll delivered %lu ms", stats.preroll_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL(250, stats.preroll_ms);
+
+    mic_input_stop();
+    mic_input_deinit();
+}
+
+TEST_CASE("Test playback position follows TX-done events", "[audio_output]") {
+    TEST_ESP_OK(audio_output_init(16000, 16, 1));
+    static int16_t silence[4800];   // 300 ms
+    uint64_t base = audio_output_get_played_samples();
+
+    int64_t start_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(sizeof(silence), audio_output_enqueue(silence, sizeof(silence), 1000));
+    TEST_ASSERT_TRUE(audio_output_is_busy());
+    TEST_ASSERT_LESS_THAN(base + 4800, audio_output_get_played_samples());
+
+    // Halfway through, the position runs with the clock
+    vTaskDelay(pdMS_TO_TICKS(150));
+    uint64_t played = audio_output_get_played_samples() - base;
+    uint64_t expected = (esp_timer_get_time() - start_us) * 16 / 1000;
+    ESP_LOGI(TAG, "Played %llu of %llu samples expected so far", played, expected);
+    TEST_ASSERT_UINT32_WITHIN(1100, expected, played);
+
+    TEST_ASSERT_TRUE(audio_output_wait_completion(1000));
+    int64_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+    ESP_LOGI(TAG, "Completion after %lld ms", elapsed_ms);
+    TEST_ASSERT_FALSE(audio_output_is_busy());
+    TEST_ASSERT_EQUAL_UINT64(base + 4800, audio_output_get_played_samples());
+    TEST_ASSERT_GREATER_OR_EQUAL(300, elapsed_ms);
+    TEST_ASSERT_LESS_THAN(400, elapsed_ms);
+
+    audio_output_deinit();
+}
+
+TEST_CASE("Test flush silences queued audio at once", "[audio_output]") {
+    TEST_ESP_OK(audio_output_init(16000, 16, 1));
+    static int16_t tone[4800];      // 300 ms, a full queue and some
+    for (int i = 0; i < 4800; i++) {
+        tone[i] = (i & 16) ? 8000 : -8000;
+    }
+    TEST_ASSERT_EQUAL(sizeof(tone), audio_output_enqueue(tone, sizeof(tone), 1000));
+    TEST_ASSERT_TRUE(audio_output_is_busy());
+
+    // Barge-in budget: the cut itself must be a small part of 50 ms
+    int64_t start_us = esp_timer_get_time();
+    TEST_ESP_OK(audio_output_flush());
+    int64_t flush_us = esp_timer_get_time() - start_us;
+    ESP_LOGI(TAG, "Flush took %lld us", flush_us);
+    TEST_ASSERT_LESS_THAN(2000, flush_us);
+    TEST_ASSERT_FALSE(audio_output_is_busy());
+    TEST_ASSERT_TRUE(audio_output_wait_completion(10));
+
+    // Output carries on after the zeroed buffers
+    uint64_t base = audio_output_get_played_samples();
+    TEST_ASSERT_EQUAL(640, audio_output_enqueue(tone, 640, 100));
+    TEST_ASSERT_TRUE(audio_output_wait_completion(1000));
+    TEST_ASSERT_EQUAL_UINT64(base + 320, audio_output_get_played_samples());
+
+    audio_output_deinit();
+}
+
 // Test the full conversation flow
 TEST_CASE("Test full conversation flow", "[openai_rt][integration]") {
     // Initialize LED control for visual feedback
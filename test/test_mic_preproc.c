@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "audio_dsp.h"
+#include "mic_preproc.h"
+
+#define TAG "TEST_MIC_PREPROC"
+#define SAMPLE_RATE   16000
+#define FRAME_SAMPLES 512   // one 1024-byte capture frame
+
+static int16_t s_frame[FRAME_SAMPLES] __attribute__((aligned(16)));
+static uint32_t s_phase;
+
+static void make_tone(float freq, float amplitude, int16_t offset) {
+    for (int i = 0; i < FRAME_SAMPLES; i++, s_phase++) {
+        s_frame[i] = (int16_t)(offset + amplitude * sinf(2.0f * (float)M_PI * freq * s_phase / SAMPLE_RATE));
+    }
+}
+
+static float frame_rms(void) {
+    double sum = 0;
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        sum += (double)s_frame[i] * s_frame[i];
+    }
+    return sqrtf((float)(sum / FRAME_SAMPLES));
+}
+
+TEST_CASE("DC blocker removes a constant offset", "[audio_dsp]") {
+    audio_dsp_dc_block_t dc;
+    audio_dsp_dc_block_init(&dc, 32604);
+
+    for (int i = 0; i < 20; i++) {
+        make_tone(1000.0f, 1000.0f, 5000);
+        audio_dsp_dc_block_s16(&dc, s_frame, FRAME_SAMPLES);
+    }
+
+    int32_t sum = 0;
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        sum += s_frame[i];
+    }
+    TEST_ASSERT_INT_WITHIN(50, 0, sum / FRAME_SAMPLES);
+}
+
+TEST_CASE("High-pass biquad rejects rumble and passes speech band", "[audio_dsp]") {
+    audio_dsp_biquad_t hpf;
+
+    audio_dsp_biquad_highpass_init(&hpf, 100, SAMPLE_RATE, 707);
+    for (int i = 0; i < 10; i++) {
+        make_tone(25.0f, 10000.0f, 0);
+        audio_dsp_biquad_s16(&hpf, s_frame, FRAME_SAMPLES);
+    }
+    // 25 Hz is two octaves below the corner: expect better than -20 dB
+    TEST_ASSERT_LESS_THAN(10000.0f * 0.707f * 0.1f, frame_rms());
+
+    audio_dsp_biquad_highpass_init(&hpf, 100, SAMPLE_RATE, 707);
+    for (int i = 0; i < 10; i++) {
+        make_tone(1000.0f, 10000.0f, 0);
+        audio_dsp_biquad_s16(&hpf, s_frame, FRAME_SAMPLES);
+    }
+    TEST_ASSERT_INT_WITHIN(200, 7071, (int)frame_rms());
+}
+
+TEST_CASE("Gain kernel saturates and matches the scalar reference", "[audio_dsp]") {
+    const int16_t gains[] = { 0, 512, AUDIO_DSP_GAIN_UNITY, 1500, 4096, 32767 };
+    static int16_t ref[FRAME_SAMPLES + 3];
+    static int16_t buf[FRAME_SAMPLES + 3] __attribute__((aligned(16)));
+
+    srand(7);
+    for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+        for (int i = 0; i < FRAME_SAMPLES + 3; i++) {
+            buf[i] = (int16_t)(rand() & 0xFFFF);
+            int32_t limit = gains[g] ? ((int32_t)INT16_MAX << 10) / gains[g] : 0;
+            limit = limit > INT16_MAX ? INT16_MAX : limit;
+            int32_t x = buf[i] > limit ? limit : (buf[i] < -limit ? -limit : buf[i]);
+            ref[i] = (int16_t)((x * gains[g]) >> 10);
+        }
+        // Odd length exercises the vector body and the scalar tail together
+        audio_dsp_gain_s16(buf, FRAME_SAMPLES + 3, gains[g]);
+        TEST_ASSERT_EQUAL_INT16_ARRAY(ref, buf, FRAME_SAMPLES + 3);
+    }
+}
+
+TEST_CASE("AGC raises a quiet talker without clipping", "[mic_input][preproc]") {
+    mic_preproc_config_t cfg = MIC_PREPROC_CONFIG_DEFAULT();
+    mic_preproc_t pp;
+    mic_preproc_init(&pp, &cfg, SAMPLE_RATE);
+
+    // -30 dBFS tone; target is -9 dBFS, so the AGC should add close to 21 dB
+    for (int i = 0; i < 200; i++) {
+        make_tone(300.0f, 1036.0f, 0);
+        mic_preproc_process(&pp, s_frame, FRAME_SAMPLES);
+        TEST_ASSERT_LESS_OR_EQUAL(INT16_MAX, audio_dsp_peak_s16(s_frame, FRAME_SAMPLES));
+    }
+    TEST_ASSERT_GREATER_THAN(8 * AUDIO_DSP_GAIN_UNITY, mic_preproc_gain_q10(&pp));
+
+    // A sudden shout is pulled back within a couple of frames
+    for (int i = 0; i < 3; i++) {
+        make_tone(300.0f, 20000.0f, 0);
+        mic_preproc_process(&pp, s_frame, FRAME_SAMPLES);
+    }
+    TEST_ASSERT_LESS_THAN(2 * AUDIO_DSP_GAIN_UNITY, mic_preproc_gain_q10(&pp));
+}
+
+TEST_CASE("Preprocessing cost per 1024-byte frame", "[mic_input][benchmark]") {
+    const int iterations = 200;
+    mic_preproc_config_t cfg = MIC_PREPROC_CONFIG_DEFAULT();
+    mic_preproc_t pp;
+    audio_dsp_dc_block_t dc;
+    audio_dsp_biquad_t hpf;
+    uint32_t start;
+    uint32_t dc_cycles = 0, hpf_cycles = 0, gain_cycles = 0, chain_cycles = 0;
+
+    mic_preproc_init(&pp, &cfg, SAMPLE_RATE);
+    audio_dsp_dc_block_init(&dc, 32604);
+    audio_dsp_biquad_highpass_init(&hpf, 100, SAMPLE_RATE, 707);
+
+    for (int i = 0; i < iterations; i++) {
+        make_tone(300.0f, 2000.0f, 300);
+
+        start = esp_cpu_get_cycle_count();
+        audio_dsp_dc_block_s16(&dc, s_frame, FRAME_SAMPLES);
+        dc_cycles += esp_cpu_get_cycle_count() - start;
+
+        start = esp_cpu_get_cycle_count();
+        audio_dsp_biquad_s16(&hpf, s_frame, FRAME_SAMPLES);
+        hpf_cycles += esp_cpu_get_cycle_count() - start;
+
+        start = esp_cpu_get_cycle_count();
+        audio_dsp_gain_s16(s_frame, FRAME_SAMPLES, 1500);
+        gain_cycles += esp_cpu_get_cycle_count() - start;
+
+        make_tone(300.0f, 2000.0f, 300);
+        start = esp_cpu_get_cycle_count();
+        mic_preproc_process(&pp, s_frame, FRAME_SAMPLES);
+        chain_cycles += esp_cpu_get_cycle_count() - start;
+    }
+
+    // One frame is 32 ms of audio
+    uint32_t budget = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 32000;
+    ESP_LOGI(TAG, "Per %d-sample frame: dc %lu, biquad %lu, gain %lu cycles",
+             FRAME_SAMPLES, (unsigned long)(dc_cycles / iterations),
+             (unsigned long)(hpf_cycles / iterations), (unsigned long)(gain_cycles / iterations));
+    ESP_LOGI(TAG, "Full chain: %lu cycles/frame (%.2f%% of one core at %d MHz)",
+             (unsigned long)(chain_cycles / iterations),
+             100.0 * (chain_cycles / iterations) / budget, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+}
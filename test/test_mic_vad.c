@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "mic_vad.h"
+
+#define TAG "TEST_MIC_VAD"
+#define FRAME_SAMPLES 512   // 32 ms at 16 kHz
+
+static int16_t s_frame[FRAME_SAMPLES];
+static uint32_t s_phase;
+
+// Low-level white noise plus an optional 200 Hz tone
+static void make_frame(float tone_amplitude, float noise_amplitude) {
+    for (int i = 0; i < FRAME_SAMPLES; i++, s_phase++) {
+        float noise = noise_amplitude * ((float)rand() / RAND_MAX * 2.0f - 1.0f);
+        float tone = tone_amplitude * sinf(2.0f * (float)M_PI * 200.0f * s_phase / 16000.0f);
+        s_frame[i] = (int16_t)(tone + noise);
+    }
+}
+
+TEST_CASE("VAD opens on speech and closes after hangover", "[mic_input][vad]") {
+    mic_vad_config_t cfg = MIC_VAD_CONFIG_DEFAULT();
+    cfg.enabled = true;
+    cfg.hangover_ms = 320;  // 10 frames
+
+    mic_vad_t vad;
+    mic_vad_init(&vad, &cfg, 32);
+    srand(1);
+
+    // Room noise alone never opens the gate
+    for (int i = 0; i < 30; i++) {
+        make_frame(0.0f, 300.0f);
+        TEST_ASSERT_FALSE(mic_vad_process(&vad, s_frame, FRAME_SAMPLES));
+    }
+
+    // A voiced tone opens it immediately
+    make_frame(3000.0f, 300.0f);
+    TEST_ASSERT_TRUE(mic_vad_process(&vad, s_frame, FRAME_SAMPLES));
+
+    // It stays open for the hangover, then closes
+    for (int i = 0; i < 10; i++) {
+        make_frame(0.0f, 300.0f);
+        TEST_ASSERT_TRUE(mic_vad_process(&vad, s_frame, FRAME_SAMPLES));
+    }
+    make_frame(0.0f, 300.0f);
+    TEST_ASSERT_FALSE(mic_vad_process(&vad, s_frame, FRAME_SAMPLES));
+}
+
+TEST_CASE("VAD energy and zero-crossing features", "[mic_input][vad]") {
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        s_frame[i] = (i & 1) ? 1000 : -1000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(1000000, mic_vad_frame_energy(s_frame, FRAME_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(1000, mic_vad_zero_crossings(s_frame, FRAME_SAMPLES));
+
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        s_frame[i] = 1000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mic_vad_zero_crossings(s_frame, FRAME_SAMPLES));
+}
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include "unity.h"
+#include "openai_rt_fsm.h"
+
+static const conv_state_t s_active[] = { CONV_CONNECTING, CONV_LISTENING, CONV_THINKING, CONV_SPEAKING };
+
+// Drives the machine to a state through the usual path
+static void walk_to(conv_fsm_t* fsm, conv_state_t target) {
+    static const conv_event_t path[] = { CONV_EV_START, CONV_EV_SESSION_READY, CONV_EV_SPEECH_END,
+                                         CONV_EV_PLAYBACK_START };
+    conv_fsm_init(fsm, 0);
+    for (size_t i = 0; i < sizeof(path) / sizeof(path[0]) && fsm->state != target; i++) {
+        TEST_ASSERT_NOT_NULL(conv_fsm_handle(fsm, path[i], (int64_t)(i + 1) * 1000));
+    }
+    TEST_ASSERT_EQUAL(target, fsm->state);
+}
+
+TEST_CASE("Conversation runs through its states with timestamps", "[openai_rt][fsm]") {
+    conv_fsm_t fsm;
+    conv_fsm_init(&fsm, 0);
+    TEST_ASSERT_EQUAL(CONV_IDLE, fsm.state);
+
+    // Stopping an idle machine does nothing
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_STOP, 10));
+    TEST_ASSERT_EQUAL(0, fsm.transitions);
+
+    const conv_transition_t* t = conv_fsm_handle(&fsm, CONV_EV_START, 1000);
+    TEST_ASSERT_NOT_NULL(t);
+    TEST_ASSERT_EQUAL(CONV_ACT_CONNECT, t->action);
+    TEST_ASSERT_EQUAL(CONV_CONNECTING, fsm.state);
+    // A second press while connecting is not a new conversation
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_START, 1500));
+
+    t = conv_fsm_handle(&fsm, CONV_EV_SESSION_READY, 2000);
+    TEST_ASSERT_EQUAL(CONV_ACT_OPEN, t->action);
+    TEST_ASSERT_EQUAL(CONV_LISTENING, fsm.state);
+
+    // The user speaks and stops, the response plays, the user cuts it
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_SPEECH_START, 3000));
+    t = conv_fsm_handle(&fsm, CONV_EV_SPEECH_END, 5000);
+    TEST_ASSERT_EQUAL(CONV_ACT_END_TURN, t->action);
+    TEST_ASSERT_EQUAL(CONV_THINKING, fsm.state);
+    TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_PLAYBACK_START, 5800));
+    TEST_ASSERT_EQUAL(CONV_SPEAKING, fsm.state);
+    TEST_ASSERT_EQUAL(800, fsm.entered_us[CONV_SPEAKING] - fsm.entered_us[CONV_THINKING]);
+    TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_SPEECH_START, 7000));
+    TEST_ASSERT_EQUAL(CONV_LISTENING, fsm.state);
+
+    // Without a detected end of speech, playback alone moves to speaking
+    TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_PLAYBACK_START, 8000));
+    TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_PLAYBACK_DONE, 9000));
+    TEST_ASSERT_EQUAL(CONV_LISTENING, fsm.state);
+
+    t = conv_fsm_handle(&fsm, CONV_EV_STOP, 10000);
+    TEST_ASSERT_EQUAL(CONV_ACT_TEARDOWN, t->action);
+    TEST_ASSERT_EQUAL(CONV_STOPPING, fsm.state);
+    // Late events from the conversation are ignored while it tears down
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_SESSION_END, 10100));
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_PLAYBACK_DONE, 10200));
+    TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_STOPPED, 11000));
+    TEST_ASSERT_EQUAL(CONV_IDLE, fsm.state);
+
+    // History, newest first
+    TEST_ASSERT_EQUAL(9, fsm.transitions);
+    const conv_fsm_record_t* rec = conv_fsm_recent(&fsm, 0);
+    TEST_ASSERT_EQUAL(CONV_STOPPING, rec->from);
+    TEST_ASSERT_EQUAL(CONV_IDLE, rec->to);
+    TEST_ASSERT_EQUAL(CONV_EV_STOPPED, rec->event);
+    TEST_ASSERT_EQUAL(11000, rec->at_us);
+    rec = conv_fsm_recent(&fsm, 8);
+    TEST_ASSERT_EQUAL(CONV_EV_START, rec->event);
+    TEST_ASSERT_NULL(conv_fsm_recent(&fsm, 9));
+}
+
+TEST_CASE("Barge-in cancels the response and returns to listening", "[openai_rt][fsm]") {
+    static const conv_state_t from[] = { CONV_LISTENING, CONV_THINKING, CONV_SPEAKING };
+    conv_fsm_t fsm;
+
+    for (size_t s = 0; s < sizeof(from) / sizeof(from[0]); s++) {
+        walk_to(&fsm, from[s]);
+        const conv_transition_t* t = conv_fsm_handle(&fsm, CONV_EV_BARGE_IN, 50000);
+        TEST_ASSERT_NOT_NULL_MESSAGE(t, conv_fsm_state_name(from[s]));
+        TEST_ASSERT_EQUAL(CONV_ACT_CANCEL, t->action);
+        TEST_ASSERT_EQUAL(CONV_LISTENING, fsm.state);
+        TEST_ASSERT_EQUAL(50000, fsm.entered_us[CONV_LISTENING]);
+    }
+
+    // Nothing to cancel before the conversation is open
+    walk_to(&fsm, CONV_CONNECTING);
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_BARGE_IN, 60000));
+}
+
+TEST_CASE("A timeout queued before the state changed is ignored", "[openai_rt][fsm]") {
+    conv_fsm_t fsm;
+
+    // The acquire timer fired just as the session came up
+    walk_to(&fsm, CONV_LISTENING);
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_CONNECT_TIMEOUT, 50000));
+    TEST_ASSERT_EQUAL(CONV_LISTENING, fsm.state);
+    walk_to(&fsm, CONV_SPEAKING);
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_CONNECT_TIMEOUT, 50000));
+
+    // The last conversation's limit, queued behind a stop and a new press
+    walk_to(&fsm, CONV_CONNECTING);
+    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, CONV_EV_TIMEOUT, 50000));
+    TEST_ASSERT_EQUAL(CONV_CONNECTING, fsm.state);
+}
+
+TEST_CASE("Every active state ends in teardown", "[openai_rt][fsm]") {
+    conv_event_t ends[] = { CONV_EV_STOP, CONV_EV_TIMEOUT, CONV_EV_SESSION_END, CONV_EV_FAILED };
+    conv_fsm_t fsm;
+
+    for (size_t s = 0; s < sizeof(s_active) / sizeof(s_active[0]); s++) {
+        // Waiting for the session has a timer of its own
+        ends[1] = s_active[s] == CONV_CONNECTING ? CONV_EV_CONNECT_TIMEOUT : CONV_EV_TIMEOUT;
+        for (size_t e = 0; e < sizeof(ends) / sizeof(ends[0]); e++) {
+            walk_to(&fsm, s_active[s]);
+            const conv_transition_t* t = conv_fsm_handle(&fsm, ends[e], 100000);
+            TEST_ASSERT_NOT_NULL_MESSAGE(t, conv_fsm_state_name(s_active[s]));
+            TEST_ASSERT_EQUAL(CONV_STOPPING, fsm.state);
+            TEST_ASSERT_EQUAL(CONV_ACT_TEARDOWN, t->action);
+            // And nothing but the end of teardown leaves it
+            for (int ev = CONV_EV_START; ev < CONV_EV_COUNT; ev++) {
+                if (ev != CONV_EV_STOPPED) {
+                    TEST_ASSERT_NULL(conv_fsm_handle(&fsm, (conv_event_t)ev, 100001));
+                }
+            }
+            TEST_ASSERT_NOT_NULL(conv_fsm_handle(&fsm, CONV_EV_STOPPED, 100002));
+            TEST_ASSERT_EQUAL(CONV_IDLE, fsm.state);
+        }
+    }
+
+    // Every state and event has a name for the log
+    for (int st = 0; st < CONV_STATE_COUNT; st++) {
+        TEST_ASSERT_NOT_NULL(conv_fsm_state_name((conv_state_t)st));
+    }
+    for (int ev = 0; ev < CONV_EV_COUNT; ev++) {
+        TEST_ASSERT_NOT_NULL(conv_fsm_event_name((conv_event_t)ev));
+    }
+}
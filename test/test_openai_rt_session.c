@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "openai_rt_session.h"
+
+#define TAG "TEST_OPENAI_RT_SESSION"
+// Comfortably longer than the stub's simulated handshake
+#define CONNECT_WAIT_MS 3000
+
+static void test_end_cb(void* user_data) {
+}
+
+static const openai_rt_callbacks_t s_callbacks = {
+    .audio_data_cb = NULL,
+    .conversation_end_cb = test_end_cb,
+    .user_data = NULL,
+};
+
+static openai_rt_session_config_t test_config(bool preconnect) {
+    openai_rt_session_config_t cfg = {
+        .sdk = {
+            .api_key = "test_api_key",
+            .voice = "test_voice",
+        },
+        .preconnect = preconnect,
+        .keepalive_ms = 200,
+        .max_age_ms = 60000,
+        .retry_ms = 100,
+    };
+    return cfg;
+}
+
+// Press-to-ready, the way the conversation task measures it
+static openai_rt_handle_t acquire_timed(bool* ready, int64_t* wait_ms) {
+    int64_t start = esp_timer_get_time();
+    openai_rt_handle_t handle = openai_rt_session_acquire(&s_callbacks, CONNECT_WAIT_MS, ready);
+    *wait_ms = (esp_timer_get_time() - start) / 1000;
+    return handle;
+}
+
+TEST_CASE("Pre-connected session is ready at the press and kept alive", "[openai_rt][session]") {
+    openai_rt_session_config_t cfg = test_config(true);
+    TEST_ESP_OK(openai_rt_session_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, openai_rt_session_init(&cfg));
+
+    // Opened in the background, then pinged while idle
+    vTaskDelay(pdMS_TO_TICKS(CONNECT_WAIT_MS));
+    openai_rt_session_stats_t stats;
+    openai_rt_session_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.connects);
+    TEST_ASSERT_GREATER_OR_EQUAL(3, stats.keepalives);
+    ESP_LOGI(TAG, "Connect took %lu ms", (unsigned long)stats.connect_ms_last);
+
+    bool ready = false;
+    int64_t wait_ms = 0;
+    openai_rt_handle_t handle = acquire_timed(&ready, &wait_ms);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ASSERT_TRUE(ready);
+    TEST_ASSERT_LESS_THAN(50, wait_ms);
+    ESP_LOGI(TAG, "Pre-connected: ready %lld ms after the press", wait_ms);
+
+    // A conversation on the session; the next press gets the same one
+    TEST_ASSERT_EQUAL(0, openai_rt_start(handle));
+    openai_rt_stop(handle);
+    openai_rt_session_release(true);
+    TEST_ASSERT_EQUAL_PTR(handle, acquire_timed(&ready, &wait_ms));
+    TEST_ASSERT_TRUE(ready);
+
+    // A session the service ended is replaced; the press waits for it
+    openai_rt_session_release(false);
+    handle = acquire_timed(&ready, &wait_ms);
+    TEST_ASSERT_NOT_NULL(handle);
+    ESP_LOGI(TAG, "After a closed session: ready %lld ms after the press (%s)", wait_ms,
+             ready ? "pre-connected" : "connected on demand");
+    openai_rt_session_release(true);
+
+    openai_rt_session_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.connects);
+    TEST_ASSERT_EQUAL(3, stats.acquires);
+    TEST_ASSERT_EQUAL(0, stats.failures);
+    openai_rt_session_deinit();
+}
+
+TEST_CASE("Without pre-connect the press opens the session", "[openai_rt][session]") {
+    openai_rt_session_config_t cfg = test_config(false);
+    TEST_ESP_OK(openai_rt_session_init(&cfg));
+    vTaskDelay(pdMS_TO_TICKS(500));
+    openai_rt_session_stats_t stats;
+    openai_rt_session_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.connects);
+
+    bool ready = true;
+    int64_t wait_ms = 0;
+    openai_rt_handle_t handle = acquire_timed(&ready, &wait_ms);
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ASSERT_FALSE(ready);
+    ESP_LOGI(TAG, "On demand: ready %lld ms after the press", wait_ms);
+
+    // Closed at release and not reopened until the next press
+    openai_rt_session_release(true);
+    vTaskDelay(pdMS_TO_TICKS(500));
+    openai_rt_session_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.connects);
+    TEST_ASSERT_EQUAL(0, stats.ready_acquires);
+    openai_rt_session_deinit();
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include "openai_rt_uplink.h"
+
+#define TAG "TEST_OPENAI_RT_UPLINK"
+// 24 kHz PCM16, the Realtime API's default input format
+#define WIRE_BYTES_PER_SECOND   48000
+// A 32 ms mic frame after resampling to 24 kHz
+#define MIC_CHUNK_BYTES         1536
+#define EVENT_PREFIX            "\"type\":\"input_audio_buffer.append\",\"audio\":\""
+
+typedef struct {
+    uint8_t audio[WIRE_BYTES_PER_SECOND];   // decoded audio of every event, in order
+    size_t audio_len;
+    size_t events;
+    size_t last_event_bytes;
+    int64_t captured_us[64];
+} capture_t;
+
+static uint8_t s_wire[WIRE_BYTES_PER_SECOND / 2];
+
+static int b64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    return c == '+' ? 62 : (c == '/' ? 63 : -1);
+}
+
+// Checks the envelope and appends the decoded audio field
+static int capture_send(const char* json, size_t len, int64_t captured_us, void* user_data) {
+    capture_t* cap = (capture_t*)user_data;
+    TEST_ASSERT_EQUAL(len, strlen(json));
+    TEST_ASSERT_EQUAL('{', json[0]);
+    const char* audio = strstr(json, EVENT_PREFIX);
+    TEST_ASSERT_NOT_NULL(audio);
+    audio += strlen(EVENT_PREFIX);
+    // The field starts on a word boundary for the encoder's stores
+    TEST_ASSERT_EQUAL(0, (uintptr_t)audio & 3);
+    TEST_ASSERT_EQUAL_STRING("\"}", json + len - 2);
+
+    size_t chars = (size_t)(json + len - 2 - audio);
+    TEST_ASSERT_EQUAL(0, chars % 4);
+    for (size_t i = 0; i < chars; i += 4) {
+        int v[4];
+        for (int k = 0; k < 4; k++) {
+            v[k] = audio[i + k] == '=' ? 0 : b64_value(audio[i + k]);
+            TEST_ASSERT_TRUE(v[k] >= 0);
+        }
+        uint32_t bits = (uint32_t)v[0] << 18 | (uint32_t)v[1] << 12 | (uint32_t)v[2] << 6 | (uint32_t)v[3];
+        size_t n = audio[i + 2] == '=' ? 1 : (audio[i + 3] == '=' ? 2 : 3);
+        for (size_t k = 0; k < n; k++) {
+            cap->audio[cap->audio_len++] = (uint8_t)(bits >> (16 - 8 * k));
+        }
+    }
+    if (cap->events < sizeof(cap->captured_us) / sizeof(cap->captured_us[0])) {
+        cap->captured_us[cap->events] = captured_us;
+    }
+    cap->events++;
+    cap->last_event_bytes = len;
+    return 0;
+}
+
+TEST_CASE("Base64 encoders match RFC 4648 and each other", "[openai_rt][uplink]") {
+    static const char* const vectors[][2] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+    };
+    char out[16];
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        size_t len = strlen(vectors[i][0]);
+        memset(out, 0, sizeof(out));
+        TEST_ASSERT_EQUAL(strlen(vectors[i][1]), openai_rt_base64_encode((const uint8_t*)vectors[i][0], len, out));
+        TEST_ASSERT_EQUAL_STRING(vectors[i][1], out);
+        memset(out, 0, sizeof(out));
+        TEST_ASSERT_EQUAL(openai_rt_base64_size(len),
+                          openai_rt_base64_encode_scalar((const uint8_t*)vectors[i][0], len, out));
+        TEST_ASSERT_EQUAL_STRING(vectors[i][1], out);
+    }
+
+    // Every byte value, every tail length and every destination alignment
+    static uint8_t src[256 + 2];
+    static char fast[400] __attribute__((aligned(4)));
+    static char ref[400];
+    for (int i = 0; i < (int)sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 167 + 13);
+    }
+    for (size_t len = 250; len < sizeof(src); len++) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            size_t n = openai_rt_base64_encode(src, len, fast + offset);
+            TEST_ASSERT_EQUAL(n, openai_rt_base64_encode_scalar(src, len, ref));
+            TEST_ASSERT_EQUAL_MEMORY(ref, fast + offset, n);
+        }
+    }
+}
+
+TEST_CASE("Uplink framer coalesces mic chunks into 20/40/100 ms events", "[openai_rt][uplink]") {
+    static capture_t cap;
+    for (size_t i = 0; i < sizeof(s_wire); i++) {
+        s_wire[i] = (uint8_t)(rand() & 0xFF);
+    }
+
+    static const uint32_t frames_ms[] = { 20, 40, 100 };
+    for (size_t f = 0; f < sizeof(frames_ms) / sizeof(frames_ms[0]); f++) {
+        memset(&cap, 0, sizeof(cap));
+        openai_rt_uplink_config_t cfg = OPENAI_RT_UPLINK_CONFIG_DEFAULT();
+        cfg.frame_ms = frames_ms[f];
+        cfg.bytes_per_second = WIRE_BYTES_PER_SECOND;
+        cfg.send = capture_send;
+        cfg.user_data = &cap;
+        openai_rt_uplink_t* up = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, openai_rt_uplink_create(&cfg, &up));
+        const size_t frame_bytes = WIRE_BYTES_PER_SECOND / 1000 * frames_ms[f];
+        TEST_ASSERT_EQUAL(frame_bytes, openai_rt_uplink_frame_bytes(up));
+
+        // Half a second of 32 ms chunks; one odd-sized chunk splits a base64 group
+        size_t done = 0;
+        size_t sent = 0;
+        int64_t t_us = 1000000;
+        while (done < sizeof(s_wire)) {
+            size_t n = done == MIC_CHUNK_BYTES ? 1001 : MIC_CHUNK_BYTES;
+            n = n < sizeof(s_wire) - done ? n : sizeof(s_wire) - done;
+            sent += openai_rt_uplink_write(up, s_wire + done, n, t_us);
+            t_us += (int64_t)n * 1000000 / WIRE_BYTES_PER_SECOND;
+            done += n;
+        }
+        TEST_ASSERT_EQUAL(sizeof(s_wire) / frame_bytes, sent);
+        TEST_ASSERT_EQUAL(sent, cap.events);
+        TEST_ASSERT_EQUAL(sizeof(s_wire) % frame_bytes, openai_rt_uplink_pending(up));
+        // Each event is stamped with its own first sample
+        for (size_t e = 0; e < cap.events && e < 64; e++) {
+            TEST_ASSERT_INT_WITHIN(2, 1000000 + (int64_t)e * frames_ms[f] * 1000, cap.captured_us[e]);
+        }
+
+        // Speech ends: the rest goes out short, then nothing is pending
+        bool flushed = openai_rt_uplink_flush(up);
+        TEST_ASSERT_EQUAL(sizeof(s_wire) % frame_bytes != 0, flushed);
+        TEST_ASSERT_FALSE(openai_rt_uplink_flush(up));
+        TEST_ASSERT_EQUAL(sizeof(s_wire), cap.audio_len);
+        TEST_ASSERT_EQUAL_MEMORY(s_wire, cap.audio, sizeof(s_wire));
+
+        openai_rt_uplink_stats_t stats;
+        openai_rt_uplink_get_stats(up, &stats);
+        TEST_ASSERT_EQUAL(cap.events, stats.frames);
+        TEST_ASSERT_EQUAL(flushed ? 1 : 0, stats.partial);
+        TEST_ASSERT_EQUAL(0, stats.failed);
+        TEST_ASSERT_EQUAL(sizeof(s_wire), stats.bytes);
+        ESP_LOGI(TAG, "%lu ms: %u events, %u byte envelope, encoding up to %lu us per chunk",
+                 (unsigned long)frames_ms[f], (unsigned)cap.events, (unsigned)cap.last_event_bytes,
+                 (unsigned long)stats.encode_us_max);
+
+        // A reset drops the partial frame
+        openai_rt_uplink_write(up, s_wire, 100, 0);
+        openai_rt_uplink_reset(up);
+        TEST_ASSERT_EQUAL(0, openai_rt_uplink_pending(up));
+        TEST_ASSERT_FALSE(openai_rt_uplink_flush(up));
+        openai_rt_uplink_destroy(up);
+    }
+
+    openai_rt_uplink_config_t cfg = OPENAI_RT_UPLINK_CONFIG_DEFAULT();
+    cfg.send = capture_send;
+    openai_rt_uplink_t* up = NULL;
+    cfg.frame_ms = 30;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, openai_rt_uplink_create(&cfg, &up));
+    cfg.frame_ms = 20;
+    cfg.send = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, openai_rt_uplink_create(&cfg, &up));
+}
+
+TEST_CASE("Base64 throughput, pair table against scalar", "[openai_rt][uplink][benchmark]") {
+    // One 100 ms frame of 24 kHz PCM16, into a word-aligned field as in the framer
+    static uint8_t src[4800];
+    static char dst[6400 + 4] __attribute__((aligned(4)));
+    const int iterations = 50;
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 31 + 7);
+    }
+    openai_rt_base64_encode(src, sizeof(src), dst);     // builds the table
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        openai_rt_base64_encode_scalar(src, sizeof(src), dst);
+    }
+    uint32_t scalar_cycles = esp_cpu_get_cycle_count() - start;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        openai_rt_base64_encode(src, sizeof(src), dst);
+    }
+    uint32_t fast_cycles = esp_cpu_get_cycle_count() - start;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        openai_rt_base64_encode(src, sizeof(src), dst + 1);
+    }
+    uint32_t unaligned_cycles = esp_cpu_get_cycle_count() - start;
+
+    const double bytes = (double)sizeof(src) * iterations;
+    const double hz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6;
+    ESP_LOGI(TAG, "scalar %.2f cycles/byte (%.1f MB/s), pair table %.2f cycles/byte (%.1f MB/s, %.2fx), "
+             "unaligned %.2f cycles/byte",
+             scalar_cycles / bytes, bytes * hz / scalar_cycles / 1e6, fast_cycles / bytes,
+             bytes * hz / fast_cycles / 1e6, (double)scalar_cycles / fast_cycles, unaligned_cycles / bytes);
+    // A 100 ms frame per 100 ms must be a small fraction of a core either way
+    TEST_ASSERT_LESS_THAN_UINT32((uint32_t)(hz * 0.1 / 100), fast_cycles / iterations);
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Pack earcons, sprites and LED animations into an asset bundle image.
+
+The image is what components/asset_bundle maps from the "assets" partition
+(see asset_bundle.h for the layout). Each argument is NAME=FILE; the type
+comes from the file:
+
+    NAME=click.wav              mono 16-bit PCM WAV, stored as raw samples
+    NAME=face.rgb565@128x128    RGB565 pixels, width x height
+    NAME=blink.led@1x50         RGB888 frames, LED count x frame ms
+    NAME=anything.else          stored as is
+
+    python3 asset_pack.py -o assets.bin click=click.wav face=face.rgb565@128x128
+    python3 asset_pack.py --list assets.bin
+    parttool.py write_partition --partition-name assets --input assets.bin
+"""
+import argparse
+import struct
+import sys
+import wave
+import zlib
+
+MAGIC = 0x4241434E  # "NCAB"
+VERSION = 1
+NAME_MAX = 28
+ALIGN = 16
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<IIIIHH%ds" % NAME_MAX)
+
+RAW, PCM16, SPRITE, LED_ANIM = range(4)
+TYPE_NAMES = {RAW: "raw", PCM16: "pcm16", SPRITE: "sprite", LED_ANIM: "led_anim"}
+
+
+def fnv1a(name):
+    h = 2166136261
+    for b in name.encode():
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def load(spec):
+    name, sep, path = spec.partition("=")
+    if not sep or not name or not path:
+        raise ValueError("expected NAME=FILE, got %r" % spec)
+    if len(name.encode()) >= NAME_MAX:
+        raise ValueError("name %r is longer than %d bytes" % (name, NAME_MAX - 1))
+    path, _, dims = path.partition("@")
+
+    if path.endswith(".wav"):
+        with wave.open(path, "rb") as w:
+            if w.getnchannels() != 1 or w.getsampwidth() != 2:
+                raise ValueError("%s: need mono 16-bit PCM" % path)
+            return name, PCM16, w.getframerate(), w.readframes(w.getnframes())
+
+    with open(path, "rb") as f:
+        data = f.read()
+    if path.endswith(".rgb565") or path.endswith(".led"):
+        try:
+            a, b = (int(x) for x in dims.split("x"))
+        except ValueError:
+            raise ValueError("%s: needs @AxB dimensions" % path) from None
+        if path.endswith(".rgb565"):
+            if len(data) != a * b * 2:
+                raise ValueError("%s: %d bytes is not %dx%d RGB565" % (path, len(data), a, b))
+            return name, SPRITE, a << 16 | b, data
+        if a == 0 or len(data) % (a * 3) != 0:
+            raise ValueError("%s: %d bytes is not whole frames of %d LEDs" % (path, len(data), a))
+        return name, LED_ANIM, a << 16 | b, data
+    return name, RAW, 0, data
+
+
+def pack(assets):
+    names = [a[0] for a in assets]
+    if len(set(names)) != len(names):
+        raise ValueError("duplicate asset names")
+    assets = sorted(assets, key=lambda a: (fnv1a(a[0]), a[0]))
+
+    offset = HEADER.size + ENTRY.size * len(assets)
+    index, blobs = [], []
+    for name, kind, param, data in assets:
+        pad = -offset % ALIGN
+        blobs.append(b"\0" * pad + data)
+        offset += pad
+        index.append(ENTRY.pack(fnv1a(name), offset, len(data), param, kind, 0, name.encode()))
+        offset += len(data)
+
+    index = b"".join(index)
+    header = HEADER.pack(MAGIC, VERSION, len(assets), offset, zlib.crc32(index))
+    return header + index + b"".join(blobs)
+
+
+def unpack(image):
+    magic, version, count, size, crc = HEADER.unpack_from(image)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a version %d asset bundle" % VERSION)
+    index = image[HEADER.size:HEADER.size + ENTRY.size * count]
+    if zlib.crc32(index) != crc:
+        raise ValueError("index CRC mismatch")
+    for i in range(count):
+        h, off, n, param, kind, _, name = ENTRY.unpack_from(index, i * ENTRY.size)
+        yield name.rstrip(b"\0").decode(), kind, param, off, n
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-o", "--output", help="bundle image to write")
+    ap.add_argument("--list", metavar="BUNDLE", help="print the index of a bundle image")
+    ap.add_argument("--max-size", type=lambda s: int(s, 0), default=0x60000,
+                    help="fail if the image exceeds this (default: the assets partition, 0x60000)")
+    ap.add_argument("assets", nargs="*", help="NAME=FILE[@AxB]")
+    args = ap.parse_args()
+
+    try:
+        if args.list:
+            with open(args.list, "rb") as f:
+                for name, kind, param, off, n in unpack(f.read()):
+                    print("%-28s %-8s 0x%08x %8d bytes at 0x%06x" % (name, TYPE_NAMES.get(kind, kind), param, n, off))
+            return 0
+        if not args.output or not args.assets:
+            ap.error("need -o and at least one asset")
+        image = pack([load(spec) for spec in args.assets])
+        if len(image) > args.max_size:
+            raise ValueError("bundle is %d bytes, partition holds %d" % (len(image), args.max_size))
+    except (OSError, ValueError, wave.Error) as e:
+        print("asset_pack: %s" % e, file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("%s: %d assets, %d bytes" % (args.output, len(args.assets), len(image)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())